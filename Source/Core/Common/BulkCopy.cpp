@@ -0,0 +1,178 @@
+// Copyright 2015 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <cstring>
+
+#include "Common/BulkCopy.h"
+#include "Common/Common.h"
+#include "Common/CommonFuncs.h"
+#include "Common/CPUDetect.h"
+#include "Common/Intrinsics.h"
+
+// The vector kernels are picked at runtime, so they're compiled for their
+// instruction set whatever the rest of the build targets.
+#if defined(_M_X86) && defined(__GNUC__)
+#define TARGET_SSSE3 __attribute__((target("ssse3")))
+#define TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define TARGET_SSSE3
+#define TARGET_AVX2
+#endif
+
+namespace Common
+{
+
+template <typename T, T (*Swap)(T)>
+static void CopySwapScalar(u8* dst, const u8* src, size_t size)
+{
+	for (size_t i = 0; i + sizeof(T) <= size; i += sizeof(T))
+	{
+		T value;
+		memcpy(&value, src + i, sizeof(T));
+		value = Swap(value);
+		memcpy(dst + i, &value, sizeof(T));
+	}
+}
+
+static void CopySwapScalar(u8* dst, const u8* src, size_t size, int element_size)
+{
+	switch (element_size)
+	{
+	case 2:
+		CopySwapScalar<u16, swap16>(dst, src, size);
+		break;
+	case 4:
+		CopySwapScalar<u32, swap32>(dst, src, size);
+		break;
+	case 8:
+		CopySwapScalar<u64, swap64>(dst, src, size);
+		break;
+	}
+}
+
+#ifdef _M_X86
+
+// pshufb masks reversing each 2, 4 and 8 bytes, for both 128-bit lanes.
+static const u8 GC_ALIGNED32(s_swap_masks[3][32]) = {
+	{ 1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14,
+	  1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14 },
+	{ 3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12,
+	  3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12 },
+	{ 7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8,
+	  7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8 },
+};
+
+static const u8* GetSwapMask(int element_size)
+{
+	return s_swap_masks[element_size == 2 ? 0 : element_size == 4 ? 1 : 2];
+}
+
+// Each vector kernel returns how many bytes it did; the scalar code does the
+// rest.
+TARGET_SSSE3 static size_t CopySwapSSSE3(u8* dst, const u8* src, size_t size, int element_size)
+{
+	const __m128i mask = _mm_load_si128((const __m128i*)GetSwapMask(element_size));
+	size_t i = 0;
+	for (; i + 64 <= size; i += 64)
+	{
+		__m128i a = _mm_loadu_si128((const __m128i*)(src + i));
+		__m128i b = _mm_loadu_si128((const __m128i*)(src + i + 16));
+		__m128i c = _mm_loadu_si128((const __m128i*)(src + i + 32));
+		__m128i d = _mm_loadu_si128((const __m128i*)(src + i + 48));
+		_mm_storeu_si128((__m128i*)(dst + i), _mm_shuffle_epi8(a, mask));
+		_mm_storeu_si128((__m128i*)(dst + i + 16), _mm_shuffle_epi8(b, mask));
+		_mm_storeu_si128((__m128i*)(dst + i + 32), _mm_shuffle_epi8(c, mask));
+		_mm_storeu_si128((__m128i*)(dst + i + 48), _mm_shuffle_epi8(d, mask));
+	}
+	for (; i + 16 <= size; i += 16)
+		_mm_storeu_si128((__m128i*)(dst + i), _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(src + i)), mask));
+	return i;
+}
+
+TARGET_AVX2 static size_t CopySwapAVX2(u8* dst, const u8* src, size_t size, int element_size)
+{
+	const __m256i mask = _mm256_load_si256((const __m256i*)GetSwapMask(element_size));
+	size_t i = 0;
+	for (; i + 128 <= size; i += 128)
+	{
+		__m256i a = _mm256_loadu_si256((const __m256i*)(src + i));
+		__m256i b = _mm256_loadu_si256((const __m256i*)(src + i + 32));
+		__m256i c = _mm256_loadu_si256((const __m256i*)(src + i + 64));
+		__m256i d = _mm256_loadu_si256((const __m256i*)(src + i + 96));
+		_mm256_storeu_si256((__m256i*)(dst + i), _mm256_shuffle_epi8(a, mask));
+		_mm256_storeu_si256((__m256i*)(dst + i + 32), _mm256_shuffle_epi8(b, mask));
+		_mm256_storeu_si256((__m256i*)(dst + i + 64), _mm256_shuffle_epi8(c, mask));
+		_mm256_storeu_si256((__m256i*)(dst + i + 96), _mm256_shuffle_epi8(d, mask));
+	}
+	for (; i + 32 <= size; i += 32)
+		_mm256_storeu_si256((__m256i*)(dst + i), _mm256_shuffle_epi8(_mm256_loadu_si256((const __m256i*)(src + i)), mask));
+	// Avoid the penalty for mixing VEX and legacy SSE code afterwards.
+	_mm256_zeroupper();
+	return i;
+}
+
+#endif
+
+const char* GetSwapKernelName(SwapKernel kernel)
+{
+	static const char* const names[NUM_SWAP_KERNELS] = { "scalar", "SSSE3", "AVX2" };
+	return names[kernel];
+}
+
+bool IsSwapKernelSupported(SwapKernel kernel)
+{
+	switch (kernel)
+	{
+	case SWAP_KERNEL_SCALAR:
+		return true;
+#ifdef _M_X86
+	case SWAP_KERNEL_SSSE3:
+		return cpu_info.bSSSE3;
+	case SWAP_KERNEL_AVX2:
+		return cpu_info.bAVX2;
+#endif
+	default:
+		return false;
+	}
+}
+
+void CopySwap(SwapKernel kernel, void* dst, const void* src, size_t size, int element_size)
+{
+	u8* d = static_cast<u8*>(dst);
+	const u8* s = static_cast<const u8*>(src);
+	size_t done = 0;
+#ifdef _M_X86
+	if (kernel == SWAP_KERNEL_AVX2)
+		done = CopySwapAVX2(d, s, size, element_size);
+	else if (kernel == SWAP_KERNEL_SSSE3)
+		done = CopySwapSSSE3(d, s, size, element_size);
+#endif
+	CopySwapScalar(d + done, s + done, size - done, element_size);
+}
+
+static SwapKernel GetBestSwapKernel()
+{
+	static const SwapKernel best =
+		IsSwapKernelSupported(SWAP_KERNEL_AVX2) ? SWAP_KERNEL_AVX2 :
+		IsSwapKernelSupported(SWAP_KERNEL_SSSE3) ? SWAP_KERNEL_SSSE3 :
+		SWAP_KERNEL_SCALAR;
+	return best;
+}
+
+void CopySwap16(void* dst, const void* src, size_t count)
+{
+	CopySwap(GetBestSwapKernel(), dst, src, count * 2, 2);
+}
+
+void CopySwap32(void* dst, const void* src, size_t count)
+{
+	CopySwap(GetBestSwapKernel(), dst, src, count * 4, 4);
+}
+
+void CopySwap64(void* dst, const void* src, size_t count)
+{
+	CopySwap(GetBestSwapKernel(), dst, src, count * 8, 8);
+}
+
+}
@@ -0,0 +1,36 @@
+// Copyright 2015 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <cstddef>
+
+#include "Common/CommonTypes.h"
+
+// Bulk copies between emulated big-endian memory and the host, for the DMA
+// engines. The destination and source needn't be aligned; they must either
+// be the same buffer or not overlap.
+namespace Common
+{
+
+void CopySwap16(void* dst, const void* src, size_t count);
+void CopySwap32(void* dst, const void* src, size_t count);
+void CopySwap64(void* dst, const void* src, size_t count);
+
+// The functions above use the widest kernel the CPU supports. The others are
+// here for the tests and the benchmark.
+enum SwapKernel
+{
+	SWAP_KERNEL_SCALAR,
+	SWAP_KERNEL_SSSE3,
+	SWAP_KERNEL_AVX2,
+	NUM_SWAP_KERNELS
+};
+
+const char* GetSwapKernelName(SwapKernel kernel);
+bool IsSwapKernelSupported(SwapKernel kernel);
+// Swaps each element_size (2, 4 or 8) bytes of size bytes.
+void CopySwap(SwapKernel kernel, void* dst, const void* src, size_t size, int element_size);
+
+}
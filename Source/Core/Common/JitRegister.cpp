@@ -2,11 +2,16 @@
 // Licensed under GPLv2+
 // Refer to the license.txt file included.
 
+#include <atomic>
 #include <cinttypes>
 #include <cstddef>
 #include <cstdio>
 #include <fstream>
+#include <iterator>
+#include <map>
 #include <string>
+#include <thread>
+#include <vector>
 
 #include "Common/CommonTypes.h"
 #include "Common/FileUtil.h"
@@ -34,11 +39,52 @@ static op_agent_t s_agent = nullptr;
 
 static File::IOFile s_perf_map_file;
 
+// In-memory symbol table: start address -> end address and symbol number.
+struct SymbolRange
+{
+	u64 end;
+	u32 symbol;
+};
+static bool s_symbol_table_enabled;
+static std::map<u64, SymbolRange> s_symbol_ranges;
+static std::vector<std::string> s_symbol_names;
+// Held while the table is read or changed. Never waited for by FindSymbol,
+// which may interrupt a thread holding it.
+static std::atomic<bool> s_symbol_table_busy(false);
+
+static void LockSymbolTable()
+{
+	while (s_symbol_table_busy.exchange(true, std::memory_order_acquire))
+		std::this_thread::yield();
+}
+
+static void UnlockSymbolTable()
+{
+	s_symbol_table_busy.store(false, std::memory_order_release);
+}
+
+static void AddSymbol(u64 start, u32 size, const std::string& name)
+{
+	u64 end = start + size;
+	LockSymbolTable();
+	// Whatever was registered in the range before has been overwritten.
+	auto it = s_symbol_ranges.upper_bound(start);
+	if (it != s_symbol_ranges.begin() && std::prev(it)->second.end > start)
+		std::prev(it)->second.end = start;
+	while (it != s_symbol_ranges.end() && it->first < end)
+		it = s_symbol_ranges.erase(it);
+	s_symbol_ranges[start] = {end, (u32)s_symbol_names.size()};
+	s_symbol_names.push_back(name);
+	UnlockSymbolTable();
+}
+
 namespace JitRegister
 {
 
-void Init(const std::string& perf_dir)
+void Init(const std::string& perf_dir, bool symbol_table)
 {
+	s_symbol_table_enabled = symbol_table;
+
 #if defined USE_OPROFILE && USE_OPROFILE
 	s_agent = op_open_agent();
 #endif
@@ -66,18 +112,27 @@ void Shutdown()
 
 	if (s_perf_map_file.IsOpen())
 		s_perf_map_file.Close();
+
+	LockSymbolTable();
+	s_symbol_table_enabled = false;
+	s_symbol_ranges.clear();
+	s_symbol_names.clear();
+	UnlockSymbolTable();
 }
 
 void RegisterV(const void* base_address, u32 code_size,
 	const char* format, va_list args)
 {
 #if !(defined USE_OPROFILE && USE_OPROFILE) && !defined(USE_VTUNE)
-	if (!s_perf_map_file.IsOpen())
+	if (!s_perf_map_file.IsOpen() && !s_symbol_table_enabled)
 		return;
 #endif
 
 	std::string symbol_name = StringFromFormatV(format, args);
 
+	if (s_symbol_table_enabled && code_size)
+		AddSymbol((u64)base_address, code_size, symbol_name);
+
 #if defined USE_OPROFILE && USE_OPROFILE
 	op_write_native_code(s_agent, symbol_name.data(), (u64)base_address,
 		base_address, code_size);
@@ -102,4 +157,28 @@ void RegisterV(const void* base_address, u32 code_size,
 	}
 }
 
+u32 FindSymbol(const void* address)
+{
+	if (s_symbol_table_busy.exchange(true, std::memory_order_acquire))
+		return SYMBOL_TABLE_BUSY;
+
+	u32 symbol = NO_SYMBOL;
+	auto it = s_symbol_ranges.upper_bound((u64)address);
+	if (it != s_symbol_ranges.begin() && (u64)address < std::prev(it)->second.end)
+		symbol = std::prev(it)->second.symbol;
+
+	UnlockSymbolTable();
+	return symbol;
+}
+
+std::string GetSymbolName(u32 symbol)
+{
+	std::string name;
+	LockSymbolTable();
+	if (symbol < s_symbol_names.size())
+		name = s_symbol_names[symbol];
+	UnlockSymbolTable();
+	return name;
+}
+
 }
@@ -4,12 +4,15 @@
 
 #pragma once
 #include <stdarg.h>
+#include <string>
 #include "Common/CommonTypes.h"
 
 namespace JitRegister
 {
 
-void Init(const std::string& perf_dir);
+// With symbol_table set, the registered symbols are also kept in memory for
+// FindSymbol, which the sampling profiler uses to attribute host PCs.
+void Init(const std::string& perf_dir, bool symbol_table = false);
 void Shutdown();
 void RegisterV(const void* base_address, u32 code_size,
 	const char* format, va_list args);
@@ -33,4 +36,17 @@ inline void Register(const void* start, const void* end,
 	va_end(args);
 }
 
+enum : u32
+{
+	NO_SYMBOL = 0xFFFFFFFF,
+	SYMBOL_TABLE_BUSY = 0xFFFFFFFE,
+};
+
+// Returns the number of the symbol most recently registered at address, or
+// NO_SYMBOL. Safe to call from a signal handler: it doesn't allocate or wait,
+// and returns SYMBOL_TABLE_BUSY if the table is being changed at the time.
+// Symbols keep their numbers until Shutdown, even once their code is reused.
+u32 FindSymbol(const void* address);
+std::string GetSymbolName(u32 symbol);
+
 }
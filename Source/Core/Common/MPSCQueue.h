@@ -0,0 +1,101 @@
+// Copyright 2015 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#pragma once
+
+// A bounded lock-free queue that any number of threads can push to and a
+// single thread pops from.
+//
+// Every cell carries a sequence number saying whose turn it is: a producer
+// claims the write position with a CAS and publishes the value by bumping the
+// cell's sequence, and the consumer hands the cell back to the producers one
+// lap later. Items from one thread come out in the order they went in.
+
+#include <atomic>
+#include <cstddef>
+#include <utility>
+
+#include "Common/CommonTypes.h"
+
+namespace Common
+{
+
+template <typename T, size_t Capacity>
+class MPSCQueue
+{
+	static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+public:
+	MPSCQueue() : m_write(0), m_read(0)
+	{
+		for (size_t i = 0; i < Capacity; i++)
+			m_cells[i].sequence.store(i, std::memory_order_relaxed);
+	}
+
+	// Any thread. Returns false if the queue is full.
+	bool TryPush(const T& value)
+	{
+		size_t pos = m_write.load(std::memory_order_relaxed);
+		for (;;)
+		{
+			Cell& cell = m_cells[pos & (Capacity - 1)];
+			size_t sequence = cell.sequence.load(std::memory_order_acquire);
+			ptrdiff_t diff = (ptrdiff_t)(sequence - pos);
+			if (diff == 0)
+			{
+				if (m_write.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+				{
+					cell.value = value;
+					cell.sequence.store(pos + 1, std::memory_order_release);
+					return true;
+				}
+			}
+			else if (diff < 0)
+			{
+				// The consumer hasn't freed this cell from the last lap yet.
+				return false;
+			}
+			else
+			{
+				pos = m_write.load(std::memory_order_relaxed);
+			}
+		}
+	}
+
+	// Consumer only. Stops at a cell a producer has claimed but not finished
+	// writing, even if there are finished ones behind it.
+	bool Pop(T& value)
+	{
+		Cell& cell = m_cells[m_read & (Capacity - 1)];
+		if (cell.sequence.load(std::memory_order_acquire) != m_read + 1)
+			return false;
+
+		value = std::move(cell.value);
+		cell.sequence.store(m_read + Capacity, std::memory_order_release);
+		m_read++;
+		return true;
+	}
+
+	// Consumer only. True if nothing has been pushed, or started being
+	// pushed, that hasn't been popped.
+	bool Empty() const
+	{
+		return m_write.load(std::memory_order_acquire) == m_read;
+	}
+
+private:
+	struct Cell
+	{
+		std::atomic<size_t> sequence;
+		T value;
+	};
+
+	Cell m_cells[Capacity];
+	// Keep the producers' and the consumer's positions on separate cache lines.
+	std::atomic<size_t> m_write;
+	u8 m_padding[64];
+	size_t m_read;
+};
+
+}
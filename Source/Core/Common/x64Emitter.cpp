@@ -1430,6 +1430,13 @@ void XEmitter::WriteAVXOp4(u8 opPrefix, u16 op, X64Reg regOp1, X64Reg regOp2, Op
 	WriteVEXOp4(opPrefix, op, regOp1, regOp2, arg, regOp3, W);
 }
 
+void XEmitter::WriteAVX2Op(u8 opPrefix, u16 op, X64Reg regOp1, X64Reg regOp2, OpArg arg, int W, int extrabytes)
+{
+	if (!cpu_info.bAVX2)
+		PanicAlert("Trying to use AVX2 on a system that doesn't support it. Bad programmer.");
+	WriteVEXOp(opPrefix, op, regOp1, regOp2, arg, W, extrabytes);
+}
+
 void XEmitter::WriteFMA3Op(u8 op, X64Reg regOp1, X64Reg regOp2, OpArg arg, int W)
 {
 	if (!cpu_info.bFMA)
@@ -1775,6 +1782,8 @@ void XEmitter::PMOVZXDQ(X64Reg dest, OpArg arg) {WriteSSE41Op(0x66, 0x3835, dest
 void XEmitter::PBLENDVB(X64Reg dest, OpArg arg) {WriteSSE41Op(0x66, 0x3810, dest, arg);}
 void XEmitter::BLENDVPS(X64Reg dest, OpArg arg) {WriteSSE41Op(0x66, 0x3814, dest, arg);}
 void XEmitter::BLENDVPD(X64Reg dest, OpArg arg) {WriteSSE41Op(0x66, 0x3815, dest, arg);}
+void XEmitter::BLENDPS(X64Reg dest, OpArg arg, u8 blend) {WriteSSE41Op(0x66, 0x3A0C, dest, arg, 1); Write8(blend);}
+void XEmitter::BLENDPD(X64Reg dest, OpArg arg, u8 blend) {WriteSSE41Op(0x66, 0x3A0D, dest, arg, 1); Write8(blend);}
 
 void XEmitter::PAND(X64Reg dest, OpArg arg)     {WriteSSEOp(0x66, 0xDB, dest, arg);}
 void XEmitter::PANDN(X64Reg dest, OpArg arg)    {WriteSSEOp(0x66, 0xDF, dest, arg);}
@@ -1829,6 +1838,14 @@ void XEmitter::PSHUFLW(X64Reg regOp, OpArg arg, u8 shuffle)   {WriteSSEOp(0xF2,
 void XEmitter::PSHUFHW(X64Reg regOp, OpArg arg, u8 shuffle)   {WriteSSEOp(0xF3, 0x70, regOp, arg, 1); Write8(shuffle);}
 
 // VEX
+void XEmitter::VADDSS(X64Reg regOp1, X64Reg regOp2, OpArg arg)   {WriteAVXOp(0xF3, sseADD, regOp1, regOp2, arg);}
+void XEmitter::VSUBSS(X64Reg regOp1, X64Reg regOp2, OpArg arg)   {WriteAVXOp(0xF3, sseSUB, regOp1, regOp2, arg);}
+void XEmitter::VMULSS(X64Reg regOp1, X64Reg regOp2, OpArg arg)   {WriteAVXOp(0xF3, sseMUL, regOp1, regOp2, arg);}
+void XEmitter::VDIVSS(X64Reg regOp1, X64Reg regOp2, OpArg arg)   {WriteAVXOp(0xF3, sseDIV, regOp1, regOp2, arg);}
+void XEmitter::VADDPS(X64Reg regOp1, X64Reg regOp2, OpArg arg)   {WriteAVXOp(0x00, sseADD, regOp1, regOp2, arg);}
+void XEmitter::VSUBPS(X64Reg regOp1, X64Reg regOp2, OpArg arg)   {WriteAVXOp(0x00, sseSUB, regOp1, regOp2, arg);}
+void XEmitter::VMULPS(X64Reg regOp1, X64Reg regOp2, OpArg arg)   {WriteAVXOp(0x00, sseMUL, regOp1, regOp2, arg);}
+void XEmitter::VDIVPS(X64Reg regOp1, X64Reg regOp2, OpArg arg)   {WriteAVXOp(0x00, sseDIV, regOp1, regOp2, arg);}
 void XEmitter::VADDSD(X64Reg regOp1, X64Reg regOp2, OpArg arg)   {WriteAVXOp(0xF2, sseADD, regOp1, regOp2, arg);}
 void XEmitter::VSUBSD(X64Reg regOp1, X64Reg regOp2, OpArg arg)   {WriteAVXOp(0xF2, sseSUB, regOp1, regOp2, arg);}
 void XEmitter::VMULSD(X64Reg regOp1, X64Reg regOp2, OpArg arg)   {WriteAVXOp(0xF2, sseMUL, regOp1, regOp2, arg);}
@@ -1843,6 +1860,14 @@ void XEmitter::VSHUFPD(X64Reg regOp1, X64Reg regOp2, OpArg arg, u8 shuffle) {Wri
 void XEmitter::VUNPCKLPD(X64Reg regOp1, X64Reg regOp2, OpArg arg){WriteAVXOp(0x66, 0x14, regOp1, regOp2, arg);}
 void XEmitter::VUNPCKHPD(X64Reg regOp1, X64Reg regOp2, OpArg arg){WriteAVXOp(0x66, 0x15, regOp1, regOp2, arg);}
 void XEmitter::VBLENDVPD(X64Reg regOp1, X64Reg regOp2, OpArg arg, X64Reg regOp3) {WriteAVXOp4(0x66, 0x3A4B, regOp1, regOp2, arg, regOp3);}
+void XEmitter::VBLENDPS(X64Reg regOp1, X64Reg regOp2, OpArg arg, u8 blend) {WriteAVXOp(0x66, 0x3A0C, regOp1, regOp2, arg, 0, 1); Write8(blend);}
+void XEmitter::VBLENDPD(X64Reg regOp1, X64Reg regOp2, OpArg arg, u8 blend) {WriteAVXOp(0x66, 0x3A0D, regOp1, regOp2, arg, 0, 1); Write8(blend);}
+
+void XEmitter::VMOVDDUP(X64Reg regOp, OpArg arg)                      {WriteAVXOp(0xF2, 0x12, regOp, INVALID_REG, arg);}
+void XEmitter::VCVTSD2SS(X64Reg regOp1, X64Reg regOp2, OpArg arg)     {WriteAVXOp(0xF2, 0x5A, regOp1, regOp2, arg);}
+void XEmitter::VCVTSS2SD(X64Reg regOp1, X64Reg regOp2, OpArg arg)     {WriteAVXOp(0xF3, 0x5A, regOp1, regOp2, arg);}
+void XEmitter::VCVTPD2PS(X64Reg regOp, OpArg arg)                     {WriteAVXOp(0x66, 0x5A, regOp, INVALID_REG, arg);}
+void XEmitter::VCVTPS2PD(X64Reg regOp, OpArg arg)                     {WriteAVXOp(0x00, 0x5A, regOp, INVALID_REG, arg);}
 
 void XEmitter::VANDPS(X64Reg regOp1, X64Reg regOp2, OpArg arg)   {WriteAVXOp(0x00, sseAND, regOp1, regOp2, arg);}
 void XEmitter::VANDPD(X64Reg regOp1, X64Reg regOp2, OpArg arg)   {WriteAVXOp(0x66, sseAND, regOp1, regOp2, arg);}
@@ -1857,6 +1882,20 @@ void XEmitter::VPAND(X64Reg regOp1, X64Reg regOp2, OpArg arg)    {WriteAVXOp(0x6
 void XEmitter::VPANDN(X64Reg regOp1, X64Reg regOp2, OpArg arg)   {WriteAVXOp(0x66, 0xDF, regOp1, regOp2, arg);}
 void XEmitter::VPOR(X64Reg regOp1, X64Reg regOp2, OpArg arg)     {WriteAVXOp(0x66, 0xEB, regOp1, regOp2, arg);}
 void XEmitter::VPXOR(X64Reg regOp1, X64Reg regOp2, OpArg arg)    {WriteAVXOp(0x66, 0xEF, regOp1, regOp2, arg);}
+void XEmitter::VPADDQ(X64Reg regOp1, X64Reg regOp2, OpArg arg)   {WriteAVXOp(0x66, 0xD4, regOp1, regOp2, arg);}
+void XEmitter::VPSUBQ(X64Reg regOp1, X64Reg regOp2, OpArg arg)   {WriteAVXOp(0x66, 0xFB, regOp1, regOp2, arg);}
+void XEmitter::VPSHUFB(X64Reg regOp1, X64Reg regOp2, OpArg arg)  {WriteAVXOp(0x66, 0x3800, regOp1, regOp2, arg);}
+
+void XEmitter::VPBLENDD(X64Reg regOp1, X64Reg regOp2, OpArg arg, u8 blend) {WriteAVX2Op(0x66, 0x3A02, regOp1, regOp2, arg, 0, 1); Write8(blend);}
+void XEmitter::VPSLLVD(X64Reg regOp1, X64Reg regOp2, OpArg arg)  {WriteAVX2Op(0x66, 0x3847, regOp1, regOp2, arg);}
+void XEmitter::VPSLLVQ(X64Reg regOp1, X64Reg regOp2, OpArg arg)  {WriteAVX2Op(0x66, 0x3847, regOp1, regOp2, arg, 1);}
+void XEmitter::VPSRLVD(X64Reg regOp1, X64Reg regOp2, OpArg arg)  {WriteAVX2Op(0x66, 0x3845, regOp1, regOp2, arg);}
+void XEmitter::VPSRLVQ(X64Reg regOp1, X64Reg regOp2, OpArg arg)  {WriteAVX2Op(0x66, 0x3845, regOp1, regOp2, arg, 1);}
+void XEmitter::VPSRAVD(X64Reg regOp1, X64Reg regOp2, OpArg arg)  {WriteAVX2Op(0x66, 0x3846, regOp1, regOp2, arg);}
+void XEmitter::VPBROADCASTB(X64Reg regOp, OpArg arg)             {WriteAVX2Op(0x66, 0x3878, regOp, INVALID_REG, arg);}
+void XEmitter::VPBROADCASTW(X64Reg regOp, OpArg arg)             {WriteAVX2Op(0x66, 0x3879, regOp, INVALID_REG, arg);}
+void XEmitter::VPBROADCASTD(X64Reg regOp, OpArg arg)             {WriteAVX2Op(0x66, 0x3858, regOp, INVALID_REG, arg);}
+void XEmitter::VPBROADCASTQ(X64Reg regOp, OpArg arg)             {WriteAVX2Op(0x66, 0x3859, regOp, INVALID_REG, arg);}
 
 void XEmitter::VFMADD132PS(X64Reg regOp1, X64Reg regOp2, OpArg arg)    {WriteFMA3Op(0x98, regOp1, regOp2, arg);}
 void XEmitter::VFMADD213PS(X64Reg regOp1, X64Reg regOp2, OpArg arg)    {WriteFMA3Op(0xA8, regOp1, regOp2, arg);}
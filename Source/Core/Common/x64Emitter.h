@@ -317,6 +317,7 @@ private:
 	void WriteVEXOp4(u8 opPrefix, u16 op, X64Reg regOp1, X64Reg regOp2, OpArg arg, X64Reg regOp3, int W = 0);
 	void WriteAVXOp(u8 opPrefix, u16 op, X64Reg regOp1, X64Reg regOp2, OpArg arg, int W = 0, int extrabytes = 0);
 	void WriteAVXOp4(u8 opPrefix, u16 op, X64Reg regOp1, X64Reg regOp2, OpArg arg, X64Reg regOp3, int W = 0);
+	void WriteAVX2Op(u8 opPrefix, u16 op, X64Reg regOp1, X64Reg regOp2, OpArg arg, int W = 0, int extrabytes = 0);
 	void WriteFMA3Op(u8 op, X64Reg regOp1, X64Reg regOp2, OpArg arg, int W = 0);
 	void WriteBMIOp(int size, u8 opPrefix, u16 op, X64Reg regOp1, X64Reg regOp2, OpArg arg, int extrabytes = 0);
 	void WriteBMI1Op(int size, u8 opPrefix, u16 op, X64Reg regOp1, X64Reg regOp2, OpArg arg, int extrabytes = 0);
@@ -794,7 +795,19 @@ public:
 	void BLENDVPS(X64Reg dest, OpArg arg);
 	void BLENDVPD(X64Reg dest, OpArg arg);
 
+	// SSE4: blend instructions with an immediate mask
+	void BLENDPS(X64Reg dest, OpArg arg, u8 blend);
+	void BLENDPD(X64Reg dest, OpArg arg, u8 blend);
+
 	// AVX
+	void VADDSS(X64Reg regOp1, X64Reg regOp2, OpArg arg);
+	void VSUBSS(X64Reg regOp1, X64Reg regOp2, OpArg arg);
+	void VMULSS(X64Reg regOp1, X64Reg regOp2, OpArg arg);
+	void VDIVSS(X64Reg regOp1, X64Reg regOp2, OpArg arg);
+	void VADDPS(X64Reg regOp1, X64Reg regOp2, OpArg arg);
+	void VSUBPS(X64Reg regOp1, X64Reg regOp2, OpArg arg);
+	void VMULPS(X64Reg regOp1, X64Reg regOp2, OpArg arg);
+	void VDIVPS(X64Reg regOp1, X64Reg regOp2, OpArg arg);
 	void VADDSD(X64Reg regOp1, X64Reg regOp2, OpArg arg);
 	void VSUBSD(X64Reg regOp1, X64Reg regOp2, OpArg arg);
 	void VMULSD(X64Reg regOp1, X64Reg regOp2, OpArg arg);
@@ -809,6 +822,14 @@ public:
 	void VUNPCKLPD(X64Reg regOp1, X64Reg regOp2, OpArg arg);
 	void VUNPCKHPD(X64Reg regOp1, X64Reg regOp2, OpArg arg);
 	void VBLENDVPD(X64Reg regOp1, X64Reg regOp2, OpArg arg, X64Reg mask);
+	void VBLENDPS(X64Reg regOp1, X64Reg regOp2, OpArg arg, u8 blend);
+	void VBLENDPD(X64Reg regOp1, X64Reg regOp2, OpArg arg, u8 blend);
+
+	void VMOVDDUP(X64Reg regOp, OpArg arg);
+	void VCVTSD2SS(X64Reg regOp1, X64Reg regOp2, OpArg arg);
+	void VCVTSS2SD(X64Reg regOp1, X64Reg regOp2, OpArg arg);
+	void VCVTPD2PS(X64Reg regOp, OpArg arg);
+	void VCVTPS2PD(X64Reg regOp, OpArg arg);
 
 	void VANDPS(X64Reg regOp1, X64Reg regOp2, OpArg arg);
 	void VANDPD(X64Reg regOp1, X64Reg regOp2, OpArg arg);
@@ -823,6 +844,21 @@ public:
 	void VPANDN(X64Reg regOp1, X64Reg regOp2, OpArg arg);
 	void VPOR(X64Reg regOp1, X64Reg regOp2, OpArg arg);
 	void VPXOR(X64Reg regOp1, X64Reg regOp2, OpArg arg);
+	void VPADDQ(X64Reg regOp1, X64Reg regOp2, OpArg arg);
+	void VPSUBQ(X64Reg regOp1, X64Reg regOp2, OpArg arg);
+	void VPSHUFB(X64Reg regOp1, X64Reg regOp2, OpArg arg);
+
+	// AVX2 (128-bit forms only)
+	void VPBLENDD(X64Reg regOp1, X64Reg regOp2, OpArg arg, u8 blend);
+	void VPSLLVD(X64Reg regOp1, X64Reg regOp2, OpArg arg);
+	void VPSLLVQ(X64Reg regOp1, X64Reg regOp2, OpArg arg);
+	void VPSRLVD(X64Reg regOp1, X64Reg regOp2, OpArg arg);
+	void VPSRLVQ(X64Reg regOp1, X64Reg regOp2, OpArg arg);
+	void VPSRAVD(X64Reg regOp1, X64Reg regOp2, OpArg arg);
+	void VPBROADCASTB(X64Reg regOp, OpArg arg);
+	void VPBROADCASTW(X64Reg regOp, OpArg arg);
+	void VPBROADCASTD(X64Reg regOp, OpArg arg);
+	void VPBROADCASTQ(X64Reg regOp, OpArg arg);
 
 	// FMA3
 	void VFMADD132PS(X64Reg regOp1, X64Reg regOp2, OpArg arg);
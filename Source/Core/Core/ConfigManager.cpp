@@ -324,6 +324,15 @@ void SConfig::SaveCoreSettings(IniFile& ini)
 	core->Set("HLE_BS2", m_LocalCoreStartupParameter.bHLE_BS2);
 	core->Set("CPUCore", m_LocalCoreStartupParameter.iCPUCore);
 	core->Set("Fastmem", m_LocalCoreStartupParameter.bFastmem);
+	core->Set("JITPersistentCache", m_LocalCoreStartupParameter.bJITPersistentCache);
+	core->Set("JITTierThreshold", m_LocalCoreStartupParameter.iJITTierThreshold);
+	core->Set("JITBackgroundCompile", m_LocalCoreStartupParameter.bJITBackgroundCompile);
+	core->Set("JITFollowBranch", m_LocalCoreStartupParameter.bJITFollowBranch);
+	core->Set("JITCodeGC", m_LocalCoreStartupParameter.bJITCodeGC);
+	core->Set("JITLockstep", m_LocalCoreStartupParameter.bJITLockstep);
+	core->Set("HLEFastPaths", m_LocalCoreStartupParameter.bHLEFastPaths);
+	core->Set("HLEVerifyFastPaths", m_LocalCoreStartupParameter.bHLEVerifyFastPaths);
+	core->Set("InterpreterBlockCache", m_LocalCoreStartupParameter.bInterpreterBlockCache);
 	core->Set("CPUThread", m_LocalCoreStartupParameter.bCPUThread);
 	core->Set("DSPHLE", m_LocalCoreStartupParameter.bDSPHLE);
 	core->Set("SkipIdle", m_LocalCoreStartupParameter.bSkipIdle);
@@ -588,6 +597,15 @@ void SConfig::LoadCoreSettings(IniFile& ini)
 	core->Get("CPUCore",      &m_LocalCoreStartupParameter.iCPUCore, PowerPC::CORE_INTERPRETER);
 #endif
 	core->Get("Fastmem",           &m_LocalCoreStartupParameter.bFastmem,      true);
+	core->Get("JITPersistentCache", &m_LocalCoreStartupParameter.bJITPersistentCache, false);
+	core->Get("JITTierThreshold",  &m_LocalCoreStartupParameter.iJITTierThreshold, 0);
+	core->Get("JITBackgroundCompile", &m_LocalCoreStartupParameter.bJITBackgroundCompile, false);
+	core->Get("JITFollowBranch", &m_LocalCoreStartupParameter.bJITFollowBranch, false);
+	core->Get("JITCodeGC", &m_LocalCoreStartupParameter.bJITCodeGC, true);
+	core->Get("JITLockstep", &m_LocalCoreStartupParameter.bJITLockstep, false);
+	core->Get("HLEFastPaths", &m_LocalCoreStartupParameter.bHLEFastPaths, false);
+	core->Get("HLEVerifyFastPaths", &m_LocalCoreStartupParameter.bHLEVerifyFastPaths, false);
+	core->Get("InterpreterBlockCache", &m_LocalCoreStartupParameter.bInterpreterBlockCache, true);
 	core->Get("DSPHLE",            &m_LocalCoreStartupParameter.bDSPHLE,       true);
 	core->Get("CPUThread",         &m_LocalCoreStartupParameter.bCPUThread,    true);
 	core->Get("SkipIdle",          &m_LocalCoreStartupParameter.bSkipIdle,     true);
@@ -620,6 +638,7 @@ void SConfig::LoadCoreSettings(IniFile& ini)
 	core->Get("RunCompareServer",          &m_LocalCoreStartupParameter.bRunCompareServer, false);
 	core->Get("RunCompareClient",          &m_LocalCoreStartupParameter.bRunCompareClient, false);
 	core->Get("MMU",                       &m_LocalCoreStartupParameter.bMMU,              false);
+	core->Get("MMUFastmem",                &m_LocalCoreStartupParameter.bMMUFastmem,       false);
 	core->Get("BBDumpPort",                &m_LocalCoreStartupParameter.iBBDumpPort,       -1);
 	core->Get("SyncGPU",                   &m_LocalCoreStartupParameter.bSyncGPU,          false);
 	core->Get("FastDiscSpeed",             &m_LocalCoreStartupParameter.bFastDiscSpeed,    false);
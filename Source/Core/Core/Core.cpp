@@ -52,6 +52,7 @@
 #include "Core/IPC_HLE/WII_Socket.h"
 #include "Core/PowerPC/JitInterface.h"
 #include "Core/PowerPC/PowerPC.h"
+#include "Core/PowerPC/Profiler.h"
 
 #ifdef USE_GDBSTUB
 #include "Core/PowerPC/GDBStub.h"
@@ -92,6 +93,10 @@ void Callback_WiimoteInterruptChannel(int _number, u16 _channelID, const void* _
 // Function declarations
 void EmuThread();
 
+// Samples per second taken by the sampling profiler; not a round number, so
+// it doesn't run in lockstep with the emulator's own timers.
+static const int SAMPLE_RATE = 997;
+
 static bool s_is_stopping = false;
 static bool s_hardware_initialized = false;
 static bool s_is_started = false;
@@ -342,9 +347,22 @@ static void CpuThread()
 	}
 	#endif
 
+	if (!_CoreParameter.m_sampleProfileFile.empty())
+		Profiler::StartSampling(SAMPLE_RATE);
+
+	Profiler::g_ExecutionStats = !_CoreParameter.m_executionStatsFile.empty();
+	if (Profiler::g_ExecutionStats)
+		Profiler::ResetExecutionStats();
+
 	// Enter CPU run loop. When we leave it - we are done.
 	CCPU::Run();
 
+	if (!_CoreParameter.m_sampleProfileFile.empty())
+		Profiler::StopSampling(_CoreParameter.m_sampleProfileFile);
+
+	if (Profiler::g_ExecutionStats)
+		Profiler::WriteExecutionStats(_CoreParameter.m_executionStatsFile);
+
 	s_is_started = false;
 
 	if (!_CoreParameter.bCPUThread)
@@ -33,6 +33,11 @@ SCoreStartupParameter::SCoreStartupParameter()
   bJITPairedOff(false), bJITSystemRegistersOff(false),
   bJITBranchOff(false),
   bJITILTimeProfiling(false), bJITILOutputIR(false),
+  bJITPersistentCache(false), iJITTierThreshold(0),
+  bJITBackgroundCompile(false), bJITFollowBranch(false),
+  bJITCodeGC(true), bJITLockstep(false),
+  bHLEFastPaths(false), bHLEVerifyFastPaths(false),
+  bInterpreterBlockCache(true),
   bFPRF(false),
   bCPUThread(true), bDSPThread(false), bDSPHLE(true),
   bSkipIdle(true), bSyncGPUOnSkipIdleHack(true), bNTSC(false), bForceNTSCJ(false),
@@ -40,7 +45,7 @@ SCoreStartupParameter::SCoreStartupParameter()
   bEnableMemcardSaving(true),
   bDPL2Decoder(false), iLatency(14),
   bRunCompareServer(false), bRunCompareClient(false),
-  bMMU(false), bDCBZOFF(false),
+  bMMU(false), bMMUFastmem(false), bDCBZOFF(false),
   iBBDumpPort(0),
   bSyncGPU(false), bFastDiscSpeed(false),
   SelectedLanguage(0), bWii(false),
@@ -79,6 +84,7 @@ void SCoreStartupParameter::LoadDefaults()
 	bFastmem = true;
 	bFPRF = false;
 	bMMU = false;
+	bMMUFastmem = false;
 	bDCBZOFF = false;
 	iBBDumpPort = -1;
 	bSyncGPU = false;
@@ -158,6 +158,15 @@ struct SCoreStartupParameter
 	bool bJITBranchOff;
 	bool bJITILTimeProfiling;
 	bool bJITILOutputIR;
+	bool bJITPersistentCache;
+	int iJITTierThreshold;
+	bool bJITBackgroundCompile;
+	bool bJITFollowBranch;
+	bool bJITCodeGC;
+	bool bJITLockstep;
+	bool bHLEFastPaths;
+	bool bHLEVerifyFastPaths;
+	bool bInterpreterBlockCache;
 
 	bool bFastmem;
 	bool bFPRF;
@@ -180,6 +189,8 @@ struct SCoreStartupParameter
 	bool bRunCompareClient;
 
 	bool bMMU;
+	// Mirror the guest page table into the fastmem arena.
+	bool bMMUFastmem;
 	bool bDCBZOFF;
 	int iBBDumpPort;
 	bool bSyncGPU;
@@ -247,6 +258,10 @@ struct SCoreStartupParameter
 	int m_revision;
 
 	std::string m_perfDir;
+	// Where the sampling profiler writes the CPU thread's samples, empty if it's off.
+	std::string m_sampleProfileFile;
+	// Where the execution statistics are written at shutdown, empty if they're off.
+	std::string m_executionStatsFile;
 
 	// Constructor just calls LoadDefaults
 	SCoreStartupParameter();
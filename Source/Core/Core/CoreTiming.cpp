@@ -7,13 +7,15 @@
 #include <vector>
 
 #include "Common/ChunkFile.h"
-#include "Common/FifoQueue.h"
+#include "Common/Flag.h"
+#include "Common/MPSCQueue.h"
 #include "Common/StringUtil.h"
 #include "Common/Thread.h"
 
 #include "Core/ConfigManager.h"
 #include "Core/Core.h"
 #include "Core/CoreTiming.h"
+#include "Core/CoreTimingQueue.h"
 #include "Core/PowerPC/PowerPC.h"
 
 #include "VideoCommon/VideoBackendBase.h"
@@ -31,22 +33,16 @@ struct EventType
 
 static std::vector<EventType> event_types;
 
-struct BaseEvent
-{
-	s64 time;
-	u64 userdata;
-	int type;
-};
-
-typedef LinkedListItem<BaseEvent> Event;
-
 // STATE_TO_SAVE
-static Event *first;
+static EventQueue eventQueue;
+// Events from other threads, waiting for the CPU thread to pick them up.
+static Common::MPSCQueue<BaseEvent, 256> tsQueue;
+// Where events go if tsQueue fills up. Once anything is in here, producers
+// keep using it until the CPU thread has drained it, so events from the same
+// thread stay in order.
 static std::mutex tsWriteLock;
-static Common::FifoQueue<BaseEvent, false> tsQueue;
-
-// event pools
-static Event *eventPool = nullptr;
+static std::vector<BaseEvent> tsOverflow;
+static Common::Flag tsOverflowing;
 
 static float lastOCFactor;
 int slicelength;
@@ -65,22 +61,6 @@ static int ev_lost;
 
 static void (*advanceCallback)(int cyclesExecuted) = nullptr;
 
-static Event* GetNewEvent()
-{
-	if (!eventPool)
-		return new Event;
-
-	Event* ev = eventPool;
-	eventPool = ev->next;
-	return ev;
-}
-
-static void FreeEvent(Event* ev)
-{
-	ev->next = eventPool;
-	eventPool = ev;
-}
-
 static void EmptyTimedCallback(u64 userdata, int cyclesLate) {}
 
 // Changing the CPU speed in Dolphin isn't actually done by changing the physical clock rate,
@@ -126,7 +106,7 @@ int RegisterEvent(const std::string& name, TimedCallback callback)
 
 void UnregisterAllEvents()
 {
-	if (first)
+	if (!eventQueue.Empty())
 		PanicAlertT("Cannot unregister events with events pending");
 	event_types.clear();
 }
@@ -142,19 +122,39 @@ void Init()
 	ev_lost = RegisterEvent("_lost_event", &EmptyTimedCallback);
 }
 
+// Drops whatever other threads have posted. Needs tsWriteLock.
+static void DiscardThreadsafeEvents()
+{
+	BaseEvent ev;
+	while (tsQueue.Pop(ev))
+		;
+	tsOverflow.clear();
+	tsOverflowing.Clear();
+}
+
+// Moves the overflow in behind what's left in tsQueue. Needs tsWriteLock.
+static void MoveOverflowEvents()
+{
+	// Whatever a thread queued before it overflowed has to come out first,
+	// so leave the overflow alone while a push is still being written.
+	BaseEvent ev;
+	while (tsQueue.Pop(ev))
+		eventQueue.Push(ev);
+	if (tsQueue.Empty())
+	{
+		for (const BaseEvent& overflowed : tsOverflow)
+			eventQueue.Push(overflowed);
+		tsOverflow.clear();
+		tsOverflowing.Clear();
+	}
+}
+
 void Shutdown()
 {
 	std::lock_guard<std::mutex> lk(tsWriteLock);
-	MoveEvents();
+	DiscardThreadsafeEvents();
 	ClearPendingEvents();
 	UnregisterAllEvents();
-
-	while (eventPool)
-	{
-		Event *ev = eventPool;
-		eventPool = ev->next;
-		delete ev;
-	}
 }
 
 static void EventDoState(PointerWrap &p, BaseEvent* ev)
@@ -204,9 +204,37 @@ void DoState(PointerWrap &p)
 	p.Do(lastOCFactor);
 	p.DoMarker("CoreTimingData");
 
-	MoveEvents();
-
-	p.DoLinkedList<BaseEvent, GetNewEvent, FreeEvent, EventDoState>(first);
+	// Same layout as the linked list the events used to be kept in: each
+	// event preceded by a 1, then a 0.
+	if (p.GetMode() == PointerWrap::MODE_READ)
+	{
+		// Events posted against the state being replaced don't belong in the
+		// loaded one.
+		DiscardThreadsafeEvents();
+		ClearPendingEvents();
+		for (;;)
+		{
+			u8 more = 0;
+			p.Do(more);
+			if (!more)
+				break;
+			BaseEvent ev;
+			EventDoState(p, &ev);
+			eventQueue.Push(ev);
+		}
+	}
+	else
+	{
+		MoveOverflowEvents();
+		for (BaseEvent ev : eventQueue.GetSorted())
+		{
+			u8 more = 1;
+			p.Do(more);
+			EventDoState(p, &ev);
+		}
+		u8 end = 0;
+		p.Do(end);
+	}
 	p.DoMarker("CoreTimingEvents");
 }
 
@@ -225,12 +253,16 @@ u64 GetIdleTicks()
 void ScheduleEvent_Threadsafe(int cyclesIntoFuture, int event_type, u64 userdata)
 {
 	_assert_msg_(POWERPC, !Core::IsCPUThread(), "ScheduleEvent_Threadsafe from wrong thread");
-	std::lock_guard<std::mutex> lk(tsWriteLock);
-	Event ne;
+	BaseEvent ne;
 	ne.time = globalTimer + cyclesIntoFuture;
 	ne.type = event_type;
 	ne.userdata = userdata;
-	tsQueue.Push(ne);
+	if (!tsOverflowing.IsSet() && tsQueue.TryPush(ne))
+		return;
+
+	std::lock_guard<std::mutex> lk(tsWriteLock);
+	tsOverflowing.Set();
+	tsOverflow.push_back(ne);
 }
 
 // Executes an event immediately, then returns.
@@ -255,30 +287,7 @@ void ScheduleEvent_Threadsafe_Immediate(int event_type, u64 userdata)
 
 void ClearPendingEvents()
 {
-	while (first)
-	{
-		Event *e = first->next;
-		FreeEvent(first);
-		first = e;
-	}
-}
-
-static void AddEventToQueue(Event* ne)
-{
-	Event* prev = nullptr;
-	Event** pNext = &first;
-	for (;;)
-	{
-		Event*& next = *pNext;
-		if (!next || ne->time < next->time)
-		{
-			ne->next = next;
-			next = ne;
-			break;
-		}
-		prev = next;
-		pNext = &prev->next;
-	}
+	eventQueue.Clear();
 }
 
 // This must be run ONLY from within the CPU thread
@@ -288,11 +297,11 @@ void ScheduleEvent(int cyclesIntoFuture, int event_type, u64 userdata)
 {
 	_assert_msg_(POWERPC, Core::IsCPUThread() || Core::GetState() == Core::CORE_PAUSE,
 				 "ScheduleEvent from wrong thread");
-	Event *ne = GetNewEvent();
-	ne->userdata = userdata;
-	ne->type = event_type;
-	ne->time = globalTimer + cyclesIntoFuture;
-	AddEventToQueue(ne);
+	BaseEvent ne;
+	ne.userdata = userdata;
+	ne.type = event_type;
+	ne.time = globalTimer + cyclesIntoFuture;
+	eventQueue.Push(ne);
 }
 
 void RegisterAdvanceCallback(void (*callback)(int cyclesExecuted))
@@ -302,56 +311,12 @@ void RegisterAdvanceCallback(void (*callback)(int cyclesExecuted))
 
 bool IsScheduled(int event_type)
 {
-	if (!first)
-		return false;
-	Event *e = first;
-	while (e)
-	{
-		if (e->type == event_type)
-			return true;
-		e = e->next;
-	}
-	return false;
+	return eventQueue.IsScheduled(event_type);
 }
 
 void RemoveEvent(int event_type)
 {
-	if (!first)
-		return;
-
-	while (first)
-	{
-		if (first->type == event_type)
-		{
-			Event *next = first->next;
-			FreeEvent(first);
-			first = next;
-		}
-		else
-		{
-			break;
-		}
-	}
-
-	if (!first)
-		return;
-
-	Event *prev = first;
-	Event *ptr = prev->next;
-	while (ptr)
-	{
-		if (ptr->type == event_type)
-		{
-			prev->next = ptr->next;
-			FreeEvent(ptr);
-			ptr = prev->next;
-		}
-		else
-		{
-			prev = ptr;
-			ptr = ptr->next;
-		}
-	}
+	eventQueue.Remove(event_type);
 }
 
 void RemoveAllEvents(int event_type)
@@ -385,35 +350,21 @@ void ProcessFifoWaitEvents()
 {
 	MoveEvents();
 
-	if (!first)
-		return;
-
-	while (first)
-	{
-		if (first->time <= globalTimer)
-		{
-			Event* evt = first;
-			first = first->next;
-			event_types[evt->type].callback(evt->userdata, (int)(globalTimer - evt->time));
-			FreeEvent(evt);
-		}
-		else
-		{
-			break;
-		}
-	}
+	BaseEvent evt;
+	while (eventQueue.PopDue(globalTimer, &evt))
+		event_types[evt.type].callback(evt.userdata, (int)(globalTimer - evt.time));
 }
 
 void MoveEvents()
 {
-	BaseEvent sevt;
-	while (tsQueue.Pop(sevt))
+	BaseEvent ev;
+	while (tsQueue.Pop(ev))
+		eventQueue.Push(ev);
+
+	if (tsOverflowing.IsSet())
 	{
-		Event *evt = GetNewEvent();
-		evt->time = sevt.time;
-		evt->userdata = sevt.userdata;
-		evt->type = sevt.type;
-		AddEventToQueue(evt);
+		std::lock_guard<std::mutex> lk(tsWriteLock);
+		MoveOverflowEvents();
 	}
 }
 
@@ -426,31 +377,23 @@ void Advance()
 	lastOCFactor = SConfig::GetInstance().m_OCEnable ? SConfig::GetInstance().m_OCFactor : 1.0f;
 	PowerPC::ppcState.downcount = CyclesToDowncount(slicelength);
 
-	while (first)
+	BaseEvent evt;
+	while (eventQueue.PopDue(globalTimer, &evt))
 	{
-		if (first->time <= globalTimer)
-		{
-			//LOG(POWERPC, "[Scheduler] %s     (%lld, %lld) ",
-			//             event_types[first->type].name ? event_types[first->type].name : "?", (u64)globalTimer, (u64)first->time);
-			Event* evt = first;
-			first = first->next;
-			event_types[evt->type].callback(evt->userdata, (int)(globalTimer - evt->time));
-			FreeEvent(evt);
-		}
-		else
-		{
-			break;
-		}
+		//LOG(POWERPC, "[Scheduler] %s     (%lld, %lld) ",
+		//             event_types[evt.type].name ? event_types[evt.type].name : "?", (u64)globalTimer, (u64)evt.time);
+		event_types[evt.type].callback(evt.userdata, (int)(globalTimer - evt.time));
 	}
 
-	if (!first)
+	s64 next_time;
+	if (!eventQueue.GetNextTime(&next_time))
 	{
 		WARN_LOG(POWERPC, "WARNING - no events in queue. Setting downcount to 10000");
 		PowerPC::ppcState.downcount += CyclesToDowncount(10000);
 	}
 	else
 	{
-		slicelength = (int)(first->time - globalTimer);
+		slicelength = (int)(next_time - globalTimer);
 		if (slicelength > maxSliceLength)
 			slicelength = maxSliceLength;
 		PowerPC::ppcState.downcount = CyclesToDowncount(slicelength);
@@ -462,15 +405,11 @@ void Advance()
 
 void LogPendingEvents()
 {
-	Event *ptr = first;
-	while (ptr)
-	{
-		INFO_LOG(POWERPC, "PENDING: Now: %" PRId64 " Pending: %" PRId64 " Type: %d", globalTimer, ptr->time, ptr->type);
-		ptr = ptr->next;
-	}
+	for (const BaseEvent& ev : eventQueue.GetSorted())
+		INFO_LOG(POWERPC, "PENDING: Now: %" PRId64 " Pending: %" PRId64 " Type: %d", globalTimer, ev.time, ev.type);
 }
 
-void Idle()
+int Idle()
 {
 	//DEBUG_LOG(POWERPC, "Idle");
 
@@ -483,25 +422,25 @@ void Idle()
 		g_video_backend->Video_Sync();
 	}
 
-	idledCycles += DowncountToCycles(PowerPC::ppcState.downcount);
+	int cycles = DowncountToCycles(PowerPC::ppcState.downcount);
+	idledCycles += cycles;
 	PowerPC::ppcState.downcount = 0;
+	return cycles;
 }
 
 std::string GetScheduledEventsSummary()
 {
-	Event *ptr = first;
 	std::string text = "Scheduled events\n";
 	text.reserve(1000);
-	while (ptr)
+	for (const BaseEvent& ev : eventQueue.GetSorted())
 	{
-		unsigned int t = ptr->type;
+		unsigned int t = ev.type;
 		if (t >= event_types.size())
 			PanicAlertT("Invalid event type %i", t);
 
-		const std::string& name = event_types[ptr->type].name;
+		const std::string& name = event_types[ev.type].name;
 
-		text += StringFromFormat("%s : %" PRIi64 " %016" PRIx64 "\n", name.c_str(), ptr->time, ptr->userdata);
-		ptr = ptr->next;
+		text += StringFromFormat("%s : %" PRIi64 " %016" PRIx64 "\n", name.c_str(), ev.time, ev.userdata);
 	}
 	return text;
 }
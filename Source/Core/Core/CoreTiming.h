@@ -58,7 +58,8 @@ void MoveEvents();
 void ProcessFifoWaitEvents();
 
 // Pretend that the main CPU has executed enough cycles to reach the next event.
-void Idle();
+// Returns the number of cycles skipped.
+int Idle();
 
 // Clear all pending events. This should ONLY be done on exit or state load.
 void ClearPendingEvents();
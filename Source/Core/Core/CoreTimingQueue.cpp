@@ -0,0 +1,188 @@
+// Copyright 2015 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <algorithm>
+
+#include "Core/CoreTimingQueue.h"
+
+namespace CoreTiming
+{
+
+EventQueue::EventQueue()
+	: m_dead(0), m_next_order(0)
+{
+}
+
+bool EventQueue::Later::operator()(const Entry& a, const Entry& b) const
+{
+	return a.time > b.time || (a.time == b.time && a.order > b.order);
+}
+
+bool EventQueue::IsLive(const Entry& entry) const
+{
+	return entry.generation == m_generation[entry.type];
+}
+
+void EventQueue::Push(const BaseEvent& event)
+{
+	if ((size_t)event.type >= m_generation.size())
+	{
+		m_generation.resize(event.type + 1);
+		m_pending.resize(event.type + 1);
+	}
+
+	Entry entry;
+	entry.time = event.time;
+	entry.userdata = event.userdata;
+	entry.type = event.type;
+	entry.order = m_next_order++;
+	entry.generation = m_generation[event.type];
+	m_pending[event.type]++;
+
+	if (!m_heap.empty() && !Later()(m_heap.front(), entry))
+	{
+		m_heap.push_back(entry);
+		std::push_heap(m_heap.begin(), m_heap.end(), Later());
+		return;
+	}
+
+	// Due before everything in the heap. Keep m_front sorted, and when it's
+	// full hand its latest event, which is still before the heap's top, over.
+	auto it = m_front.end();
+	while (it != m_front.begin() && Later()(entry, *(it - 1)))
+		--it;
+	m_front.insert(it, entry);
+	if (m_front.size() > MAX_FRONT)
+	{
+		m_heap.push_back(m_front.front());
+		std::push_heap(m_heap.begin(), m_heap.end(), Later());
+		m_front.erase(m_front.begin());
+	}
+}
+
+void EventQueue::PopTop()
+{
+	if (!m_front.empty())
+	{
+		m_front.pop_back();
+		return;
+	}
+	std::pop_heap(m_heap.begin(), m_heap.end(), Later());
+	m_heap.pop_back();
+}
+
+const EventQueue::Entry* EventQueue::Top() const
+{
+	if (!m_front.empty())
+		return &m_front.back();
+	if (!m_heap.empty())
+		return &m_heap.front();
+	return nullptr;
+}
+
+void EventQueue::DropDead()
+{
+	const Entry* top;
+	while ((top = Top()) && !IsLive(*top))
+	{
+		PopTop();
+		m_dead--;
+	}
+}
+
+bool EventQueue::GetNextTime(s64* time)
+{
+	DropDead();
+	const Entry* top = Top();
+	if (!top)
+		return false;
+	*time = top->time;
+	return true;
+}
+
+bool EventQueue::PopDue(s64 time, BaseEvent* event)
+{
+	DropDead();
+	const Entry* top = Top();
+	if (!top || top->time > time)
+		return false;
+
+	event->time = top->time;
+	event->userdata = top->userdata;
+	event->type = top->type;
+	m_pending[top->type]--;
+	PopTop();
+	return true;
+}
+
+void EventQueue::Remove(int type)
+{
+	if ((size_t)type >= m_pending.size() || !m_pending[type])
+		return;
+
+	m_generation[type]++;
+	m_dead += m_pending[type];
+	m_pending[type] = 0;
+
+	// Don't let dead events pile up if something keeps rescheduling far
+	// into the future and removing.
+	if (m_dead > 16 && m_dead > (m_front.size() + m_heap.size()) / 2)
+		Compact();
+}
+
+void EventQueue::Compact()
+{
+	m_front.erase(std::remove_if(m_front.begin(), m_front.end(),
+	                             [this](const Entry& entry) { return !IsLive(entry); }),
+	              m_front.end());
+	m_heap.erase(std::remove_if(m_heap.begin(), m_heap.end(),
+	                            [this](const Entry& entry) { return !IsLive(entry); }),
+	             m_heap.end());
+	std::make_heap(m_heap.begin(), m_heap.end(), Later());
+	m_dead = 0;
+}
+
+bool EventQueue::IsScheduled(int type) const
+{
+	return (size_t)type < m_pending.size() && m_pending[type] != 0;
+}
+
+void EventQueue::Clear()
+{
+	m_front.clear();
+	m_heap.clear();
+	std::fill(m_pending.begin(), m_pending.end(), 0);
+	m_dead = 0;
+}
+
+std::vector<BaseEvent> EventQueue::GetSorted() const
+{
+	std::vector<Entry> entries;
+	entries.reserve(m_front.size() + m_heap.size() - m_dead);
+	for (const Entry& entry : m_front)
+	{
+		if (IsLive(entry))
+			entries.push_back(entry);
+	}
+	for (const Entry& entry : m_heap)
+	{
+		if (IsLive(entry))
+			entries.push_back(entry);
+	}
+	std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) { return Later()(b, a); });
+
+	std::vector<BaseEvent> events;
+	events.reserve(entries.size());
+	for (const Entry& entry : entries)
+	{
+		BaseEvent event;
+		event.time = entry.time;
+		event.userdata = entry.userdata;
+		event.type = entry.type;
+		events.push_back(event);
+	}
+	return events;
+}
+
+}
@@ -0,0 +1,85 @@
+// Copyright 2015 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <vector>
+
+#include "Common/CommonTypes.h"
+
+namespace CoreTiming
+{
+
+struct BaseEvent
+{
+	s64 time;
+	u64 userdata;
+	int type;
+};
+
+// The pending events, in a binary min-heap ordered by time and then by the
+// order they were scheduled in, so events due at the same time run first come,
+// first served. Removing every event of a type is O(1): they're marked dead
+// through a per-type generation number and dropped when they reach the top.
+//
+// A game usually only has a couple dozen events pending, most of them due
+// soon, so the earliest ones are kept in a small sorted array in front of the
+// heap. Popping from it is free and inserting into it is a short memmove,
+// both cheaper than sifting through the heap.
+class EventQueue
+{
+public:
+	EventQueue();
+
+	void Push(const BaseEvent& event);
+	// The time the next live event is due at, if there is one.
+	bool GetNextTime(s64* time);
+	// Pops the next live event if it's due by the given time.
+	bool PopDue(s64 time, BaseEvent* event);
+
+	void Remove(int type);
+	bool IsScheduled(int type) const;
+	bool Empty() const { return m_front.size() + m_heap.size() == m_dead; }
+	void Clear();
+
+	// The live events, in the order they'll run.
+	std::vector<BaseEvent> GetSorted() const;
+
+private:
+	// Laid out flat so it packs into 32 bytes.
+	struct Entry
+	{
+		s64 time;
+		u64 order;
+		u64 userdata;
+		int type;
+		u32 generation;
+	};
+
+	struct Later
+	{
+		bool operator()(const Entry& a, const Entry& b) const;
+	};
+	enum
+	{
+		MAX_FRONT = 32
+	};
+
+	bool IsLive(const Entry& entry) const;
+	const Entry* Top() const;
+	void DropDead();
+	void PopTop();
+	void Compact();
+
+	// Events that are due before everything in m_heap, latest first.
+	std::vector<Entry> m_front;
+	std::vector<Entry> m_heap;
+	// Per event type.
+	std::vector<u32> m_generation;
+	std::vector<u32> m_pending;
+	size_t m_dead;
+	u64 m_next_order;
+};
+
+}
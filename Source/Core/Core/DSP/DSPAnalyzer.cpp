@@ -62,11 +62,101 @@ const u16 idle_skip_sigs[NUM_IDLE_SIGS][MAX_IDLE_SIG_SIZE + 1] =
 	  0, 0 }
 };
 
+// Loop bodies longer than this aren't worth analyzing for the JIT.
+#define MAX_SIMPLE_LOOP_SIZE 64
+
 static void Reset()
 {
 	code_flags.fill(0);
 }
 
+// The only exception raised while the DSP runs comes from reading the
+// accelerator, so only loads from the hardware registers can raise one. Loads
+// through a register or from $cr's page may read anything.
+static bool MayRaiseException(int addr, UDSPInstruction inst, const DSPOPCTemplate *opcode)
+{
+	if (opcode->extended)
+	{
+		// DR, IR, NR, MV, S and SN don't load.
+		u16 ext = (inst >> 12) == 0x3 ? (inst & 0x7f) : (inst & 0xff);
+		if (ext & 0xc0)
+			return true;
+	}
+
+	switch (opcode->opcode)
+	{
+	case 0x00c0: // LR
+		return dsp_imem_read(addr + 1) >= 0xf000;
+	case 0x1800: // LRR
+	case 0x1880: // LRRD
+	case 0x1900: // LRRI
+	case 0x1980: // LRRN
+	case 0x2000: // LRS
+		return true;
+	default:
+		return false;
+	}
+}
+
+// Whether the instruction names one of the stack registers, which would
+// change the loop stacks under the loop.
+static bool UsesLoopStack(UDSPInstruction inst, const DSPOPCTemplate *opcode)
+{
+	for (int i = 0; i < opcode->param_count; i++)
+	{
+		const param2_t &param = opcode->params[i];
+		if (!(param.type & P_REG) || param.loc != 0)
+			continue;
+
+		u16 reg = (inst & param.mask) >> param.lshift;
+		reg |= (param.type & P_REGS_MASK) >> 8;
+		if (reg >= DSP_REG_ST0 && reg <= DSP_REG_ST3)
+			return true;
+	}
+	return false;
+}
+
+static void FindSimpleLoops(int start_addr, int end_addr)
+{
+	for (int addr = start_addr; addr < end_addr; addr++)
+	{
+		if (!(code_flags[addr] & CODE_LOOP_START))
+			continue;
+
+		const DSPOPCTemplate *loop = GetOpTemplate(dsp_imem_read(addr));
+		int body_start = addr + loop->size;
+		// LOOP and LOOPI repeat the next instruction.
+		int loop_end = loop->size == 2 ? dsp_imem_read(addr + 1) : body_start;
+		if (loop_end < body_start || loop_end - body_start >= MAX_SIMPLE_LOOP_SIZE)
+			continue;
+
+		bool no_int = true;
+		int pc = body_start;
+		while (pc <= loop_end)
+		{
+			if (!(code_flags[pc] & CODE_START_OF_INST) || (code_flags[pc] & CODE_IDLE_SKIP))
+				break;
+			UDSPInstruction inst = dsp_imem_read(pc);
+			const DSPOPCTemplate *opcode = GetOpTemplate(inst);
+			if (opcode->branch || UsesLoopStack(inst, opcode))
+				break;
+			if (MayRaiseException(pc, inst, opcode))
+				no_int = false;
+			pc += opcode->size;
+			if (pc <= loop_end && (code_flags[pc - 1] & CODE_LOOP_END))
+				break;
+		}
+
+		// The body must end with the instruction at the loop end.
+		if (pc == loop_end + 1)
+		{
+			code_flags[body_start] |= CODE_SIMPLE_LOOP;
+			if (no_int)
+				code_flags[body_start] |= CODE_LOOP_NO_INT;
+		}
+	}
+}
+
 static void AnalyzeRange(int start_addr, int end_addr)
 {
 	// First we run an extremely simplified version of a disassembler to find
@@ -114,15 +204,8 @@ static void AnalyzeRange(int start_addr, int end_addr)
 
 		// If an instruction potentially raises exceptions, mark the following
 		// instruction as needing to check for exceptions
-		if (opcode->opcode == 0x00c0 ||
-			opcode->opcode == 0x1800 ||
-			opcode->opcode == 0x1880 ||
-			opcode->opcode == 0x1900 ||
-			opcode->opcode == 0x1980 ||
-			opcode->opcode == 0x2000 ||
-			opcode->extended
-			)
-		code_flags[addr + opcode->size] |= CODE_CHECK_INT;
+		if (MayRaiseException(addr, inst, opcode))
+			code_flags[addr + opcode->size] |= CODE_CHECK_INT;
 
 		addr += opcode->size;
 	}
@@ -149,6 +232,8 @@ static void AnalyzeRange(int start_addr, int end_addr)
 			}
 		}
 	}
+
+	FindSimpleLoops(start_addr, end_addr);
 	INFO_LOG(DSPLLE, "Finished analysis.");
 }
 
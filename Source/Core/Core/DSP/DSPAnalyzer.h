@@ -23,6 +23,13 @@ enum
 	CODE_LOOP_END      = 8,
 	CODE_UPDATE_SR     = 16,
 	CODE_CHECK_INT     = 32,
+	// On the first instruction of a loop body the JIT can loop over without
+	// leaving the block: straight-line code with no other loop ends and no
+	// loop stack accesses. The loop ends at the next CODE_LOOP_END.
+	CODE_SIMPLE_LOOP   = 64,
+	// Along with CODE_SIMPLE_LOOP: nothing in the body can raise an exception,
+	// so the body can be unrolled.
+	CODE_LOOP_NO_INT   = 128,
 };
 
 // Easy to query array covering the whole of instruction memory.
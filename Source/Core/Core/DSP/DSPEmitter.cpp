@@ -223,14 +223,44 @@ void DSPEmitter::Compile(u16 start_addr)
 	bool fixup_pc = false;
 	blockSize[start_addr] = 0;
 
+	// The body of a simple loop being compiled, which its end jumps back to
+	const u8 *loop_entry = nullptr;
+	u16 loop_start = 0;
+	u16 loop_end = 0;
+	u16 loop_entry_size = 0;
+	DSPJitRegCache loop_regs(gpr);
+
 	while (compilePC < start_addr + MAX_BLOCK_SIZE)
 	{
+		// Idle skip blocks have to return to the dispatcher for every iteration
+		if (DSPAnalyzer::code_flags[compilePC] & DSPAnalyzer::CODE_SIMPLE_LOOP &&
+		    !(DSPAnalyzer::code_flags[start_addr] & DSPAnalyzer::CODE_IDLE_SKIP))
+		{
+			gpr.markRegsDirty();
+			loop_entry = GetCodePtr();
+			loop_regs = gpr;
+			loop_start = compilePC;
+			loop_entry_size = blockSize[start_addr];
+			loop_end = compilePC;
+			while (!(DSPAnalyzer::code_flags[loop_end] & DSPAnalyzer::CODE_LOOP_END))
+				loop_end++;
+		}
+
 		if (DSPAnalyzer::code_flags[compilePC] & DSPAnalyzer::CODE_CHECK_INT)
 			checkExceptions(blockSize[start_addr]);
 
 		UDSPInstruction inst = dsp_imem_read(compilePC);
 		const DSPOPCTemplate *opcode = GetOpTemplate(inst);
 
+		if (UnrollLoop(inst))
+		{
+			// The copies already went past the loop end
+			fixup_pc = true;
+			if (DSPAnalyzer::code_flags[compilePC] & DSPAnalyzer::CODE_IDLE_SKIP)
+				break;
+			continue;
+		}
+
 		EmitInstruction(inst);
 
 		blockSize[start_addr]++;
@@ -245,6 +275,12 @@ void DSPEmitter::Compile(u16 start_addr)
 		// by the analyzer.
 		if (DSPAnalyzer::code_flags[compilePC-1] & DSPAnalyzer::CODE_LOOP_END)
 		{
+			FixupBranch loopHandled;
+			bool simple_loop = loop_entry && compilePC - 1 == loop_end;
+			if (simple_loop)
+				loopHandled = HandleSimpleLoop(loop_start, loop_entry, loop_regs, blockSize[start_addr] - loop_entry_size);
+			loop_entry = nullptr;
+
 			MOVZX(32, 16, EAX, M(&(g_dsp.r.st[2])));
 			TEST(32, R(EAX), R(EAX));
 			FixupBranch rLoopAddressExit = J_CC(CC_LE, true);
@@ -278,6 +314,8 @@ void DSPEmitter::Compile(u16 start_addr)
 
 			SetJumpTarget(rLoopAddressExit);
 			SetJumpTarget(rLoopCounterExit);
+			if (simple_loop)
+				SetJumpTarget(loopHandled);
 		}
 
 		if (opcode->branch)
@@ -321,6 +359,8 @@ void DSPEmitter::Compile(u16 start_addr)
 		}
 	}
 
+	loop_regs.drop();
+
 	if (fixup_pc)
 	{
 		MOV(16, M(&(g_dsp.pc)), Imm16(compilePC));
@@ -14,6 +14,8 @@
 
 #define COMPILED_CODE_SIZE 2097152
 #define MAX_BLOCKS         0x10000
+// Most instructions a loop is unrolled into
+#define MAX_UNROLLED_SIZE  32
 
 typedef u32 (*DSPCompiledCode)();
 typedef const u8 *Block;
@@ -122,6 +124,8 @@ public:
 
 	// Branch
 	void HandleLoop();
+	Gen::FixupBranch HandleSimpleLoop(u16 loop_start, const u8 *loop_entry, DSPJitRegCache &loop_regs, u16 body_size);
+	bool UnrollLoop(UDSPInstruction inst);
 	void jcc(const UDSPInstruction opc);
 	void jmprcc(const UDSPInstruction opc);
 	void call(const UDSPInstruction opc);
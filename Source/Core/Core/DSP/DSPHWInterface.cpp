@@ -4,8 +4,7 @@
 // Refer to the license.txt file included.
 
 #include "Common/Atomic.h"
-#include "Common/CPUDetect.h"
-#include "Common/Intrinsics.h"
+#include "Common/BulkCopy.h"
 #include "Common/MemoryUtil.h"
 #include "Common/Thread.h"
 
@@ -226,10 +225,7 @@ static const u8* gdsp_idma_in(u16 dsp_addr, u32 addr, u32 size)
 	UnWriteProtectMemory(g_dsp.iram, DSP_IRAM_BYTE_SIZE, false);
 
 	u8* dst = ((u8*)g_dsp.iram);
-	for (u32 i = 0; i < size; i += 2)
-	{
-		*(u16*)&dst[dsp_addr + i] = Common::swap16(*(const u16*)&g_dsp.cpu_ram[(addr + i) & 0x0fffffff]);
-	}
+	Common::CopySwap16(&dst[dsp_addr], &g_dsp.cpu_ram[addr & 0x0fffffff], size / 2);
 	WriteProtectMemory(g_dsp.iram, DSP_IRAM_BYTE_SIZE, false);
 
 	DSPHost::CodeLoaded((const u8*)g_dsp.iram + dsp_addr, size);
@@ -246,31 +242,11 @@ static const u8* gdsp_idma_out(u16 dsp_addr, u32 addr, u32 size)
 	return nullptr;
 }
 
-#if _M_SSE >= 0x301
-static const __m128i s_mask = _mm_set_epi32(0x0E0F0C0DL, 0x0A0B0809L, 0x06070405L, 0x02030001L);
-#endif
-
 // TODO: These should eat clock cycles.
 static const u8* gdsp_ddma_in(u16 dsp_addr, u32 addr, u32 size)
 {
 	u8* dst = ((u8*)g_dsp.dram);
-
-#if _M_SSE >= 0x301
-	if (cpu_info.bSSSE3 && !(size % 16))
-	{
-		for (u32 i = 0; i < size; i += 16)
-		{
-			_mm_storeu_si128((__m128i *)&dst[dsp_addr + i], _mm_shuffle_epi8(_mm_loadu_si128((__m128i *)&g_dsp.cpu_ram[(addr + i) & 0x7FFFFFFF]), s_mask));
-		}
-	}
-	else
-#endif
-	{
-		for (u32 i = 0; i < size; i += 2)
-		{
-			*(u16*)&dst[dsp_addr + i] = Common::swap16(*(const u16*)&g_dsp.cpu_ram[(addr + i) & 0x7FFFFFFF]);
-		}
-	}
+	Common::CopySwap16(&dst[dsp_addr], &g_dsp.cpu_ram[addr & 0x7FFFFFFF], size / 2);
 	INFO_LOG(DSPLLE, "*** ddma_in RAM (0x%08x) -> DRAM_DSP (0x%04x) : size (0x%08x)", addr, dsp_addr / 2, size);
 
 	return dst + dsp_addr;
@@ -279,24 +255,7 @@ static const u8* gdsp_ddma_in(u16 dsp_addr, u32 addr, u32 size)
 static const u8* gdsp_ddma_out(u16 dsp_addr, u32 addr, u32 size)
 {
 	const u8* src = ((const u8*)g_dsp.dram);
-
-#if _M_SSE >= 0x301
-	if (cpu_info.bSSSE3 && !(size % 16))
-	{
-		for (u32 i = 0; i < size; i += 16)
-		{
-			_mm_storeu_si128((__m128i *)&g_dsp.cpu_ram[(addr + i) & 0x7FFFFFFF], _mm_shuffle_epi8(_mm_loadu_si128((__m128i *)&src[dsp_addr + i]), s_mask));
-		}
-	}
-	else
-#endif
-	{
-		for (u32 i = 0; i < size; i += 2)
-		{
-			*(u16*)&g_dsp.cpu_ram[(addr + i) & 0x7FFFFFFF] = Common::swap16(*(const u16*)&src[dsp_addr + i]);
-		}
-	}
-
+	Common::CopySwap16(&g_dsp.cpu_ram[addr & 0x7FFFFFFF], &src[dsp_addr], size / 2);
 	INFO_LOG(DSPLLE, "*** ddma_out DRAM_DSP (0x%04x) -> RAM (0x%08x) : size (0x%08x)", dsp_addr / 2, addr, size);
 
 	return src + dsp_addr;
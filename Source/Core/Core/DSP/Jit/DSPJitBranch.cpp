@@ -2,6 +2,8 @@
 // Licensed under GPLv2+
 // Refer to the license.txt file included.
 
+#include <vector>
+
 #include "Core/DSP/DSPAnalyzer.h"
 #include "Core/DSP/DSPEmitter.h"
 #include "Core/DSP/DSPMemoryMap.h"
@@ -307,6 +309,91 @@ void DSPEmitter::HandleLoop()
 	SetJumpTarget(rLoopCntG);
 }
 
+// Loop end of a body the analyzer flagged CODE_SIMPLE_LOOP, compiled in the
+// same block from loop_entry on. While the loop stacks say this loop is the
+// innermost one, takes the next iteration with a jump back to loop_entry,
+// keeping guest registers in host registers, or pops the stacks after the last
+// one and carries on in the block. Like a block link, it only jumps back while
+// cyclesLeft covers the body. Falls through to the generic loop handling in
+// any other case; the returned branch is taken when the loop was handled.
+FixupBranch DSPEmitter::HandleSimpleLoop(u16 loop_start, const u8 *loop_entry, DSPJitRegCache &loop_regs, u16 body_size)
+{
+	CMP(16, M(&g_dsp.r.st[2]), Imm16(compilePC - 1));
+	FixupBranch notThisLoop = J_CC(CC_NE, true);
+	CMP(16, M(&g_dsp.r.st[0]), Imm16(loop_start));
+	FixupBranch notThisStart = J_CC(CC_NE, true);
+	MOVZX(32, 16, EAX, M(&g_dsp.r.st[3]));
+	CMP(32, R(EAX), Imm32(1));
+	FixupBranch moreIterations = J_CC(CC_A, true);
+	FixupBranch noIterations = J_CC(CC_B, true);
+
+	// Last iteration
+	DSPJitRegCache c(gpr);
+	dsp_reg_load_stack(0);
+	dsp_reg_load_stack(2);
+	dsp_reg_load_stack(3);
+	gpr.flushRegs(c);
+	FixupBranch finished = J(true);
+
+	SetJumpTarget(moreIterations);
+	MOVZX(32, 16, ECX, M(&cyclesLeft));
+	CMP(32, R(ECX), Imm32(blockSize[startAddr] + body_size));
+	FixupBranch notEnoughCycles = J_CC(CC_BE, true);
+	SUB(16, M(&g_dsp.r.st[3]), Imm16(1));
+	SUB(16, M(&cyclesLeft), Imm16(body_size));
+	DSPJitRegCache c2(gpr);
+	gpr.markRegsDirty();
+	gpr.flushRegs(loop_regs);
+	JMP(loop_entry, true);
+	gpr.flushRegs(c2, false);
+
+	SetJumpTarget(notThisLoop);
+	SetJumpTarget(notThisStart);
+	SetJumpTarget(noIterations);
+	SetJumpTarget(notEnoughCycles);
+	return finished;
+}
+
+// Compiles a LOOPI or BLOOPI whose body the analyzer flagged CODE_SIMPLE_LOOP
+// and CODE_LOOP_NO_INT as that many copies of the body, without touching the
+// loop stacks. Returns false, emitting nothing, for any other instruction or
+// when the copies would be more than MAX_UNROLLED_SIZE instructions.
+bool DSPEmitter::UnrollLoop(UDSPInstruction inst)
+{
+	// LOOPI and BLOOPI
+	if ((inst & 0xfe00) != 0x1000)
+		return false;
+
+	u16 loop_start = compilePC + GetOpTemplate(inst)->size;
+	if (!(DSPAnalyzer::code_flags[loop_start] & DSPAnalyzer::CODE_LOOP_NO_INT))
+		return false;
+
+	std::vector<u16> body;
+	u16 pc = loop_start;
+	do
+	{
+		body.push_back(pc);
+		pc += GetOpTemplate(dsp_imem_read(pc))->size;
+	} while (!(DSPAnalyzer::code_flags[pc - 1] & DSPAnalyzer::CODE_LOOP_END));
+
+	u16 count = inst & 0xff;
+	if (count == 0 || count * body.size() > MAX_UNROLLED_SIZE)
+		return false;
+
+	blockSize[startAddr]++;
+	for (u16 i = 0; i < count; i++)
+	{
+		for (u16 addr : body)
+		{
+			compilePC = addr;
+			EmitInstruction(dsp_imem_read(addr));
+			blockSize[startAddr]++;
+		}
+	}
+	compilePC = pc;
+	return true;
+}
+
 // LOOP $R
 // 0000 0000 010r rrrr
 // Repeatedly execute following opcode until counter specified by value
@@ -403,6 +403,15 @@ void DSPJitRegCache::flushRegs()
 	use_ctr = 0;
 }
 
+void DSPJitRegCache::markRegsDirty()
+{
+	for (DynamicReg& reg : regs)
+	{
+		if (reg.parentReg == DSP_REG_NONE && reg.loc.IsSimpleReg())
+			reg.dirty = true;
+	}
+}
+
 static u64 ebp_store;
 
 void DSPJitRegCache::loadRegs(bool emit)
@@ -149,6 +149,11 @@ public:
 	//prepare state so that another flushed DSPJitRegCache can take over
 	void flushRegs();
 
+	//mark the guest regs held in host regs as dirty. Taken at a loop entry,
+	//this makes the code after it write back whatever the body leaves dirty
+	//when jumping back there.
+	void markRegsDirty();
+
 	void loadRegs(bool emit=true);//load statically allocated regs from memory
 	void saveRegs();//save statically allocated regs to memory
 
@@ -10,6 +10,7 @@
 #include "Core/HLE/HLE.h"
 #include "Core/HLE/HLE_Misc.h"
 #include "Core/HLE/HLE_OS.h"
+#include "Core/HLE/HLE_SDK.h"
 #include "Core/HW/Memmap.h"
 #include "Core/IPC_HLE/WII_IPC_HLE_Device_es.h"
 #include "Core/PowerPC/PowerPC.h"
@@ -21,8 +22,6 @@ namespace HLE
 
 using namespace PowerPC;
 
-typedef void (*TPatchFunction)();
-
 enum
 {
 	HLE_RETURNTYPE_BLR = 0,
@@ -59,6 +58,17 @@ static const SPatch OSPatches[] =
 	{ "___blank",             HLE_OS::HLE_GeneralDebugPrint,   HLE_HOOK_REPLACE, HLE_TYPE_DEBUG },
 	{ "__write_console",      HLE_OS::HLE_write_console,       HLE_HOOK_REPLACE, HLE_TYPE_DEBUG }, // used by sysmenu (+more?)
 	{ "GeckoCodehandler",     HLE_Misc::HLEGeckoCodehandler,   HLE_HOOK_START,   HLE_TYPE_GENERIC },
+
+	// C library and SDK routines
+	{ "memcpy",               HLE_SDK::HLE_memcpy,             HLE_HOOK_REPLACE, HLE_TYPE_FAST },
+	{ "memset",               HLE_SDK::HLE_memset,             HLE_HOOK_REPLACE, HLE_TYPE_FAST },
+	{ "__fill_mem",           HLE_SDK::HLE_fill_mem,           HLE_HOOK_REPLACE, HLE_TYPE_FAST },
+	{ "sin",                  HLE_SDK::HLE_sin,                HLE_HOOK_REPLACE, HLE_TYPE_FAST_HOST_MATH },
+	{ "cos",                  HLE_SDK::HLE_cos,                HLE_HOOK_REPLACE, HLE_TYPE_FAST_HOST_MATH },
+	{ "PSMTXIdentity",        HLE_SDK::HLE_PSMTXIdentity,      HLE_HOOK_REPLACE, HLE_TYPE_FAST },
+	{ "PSMTXCopy",            HLE_SDK::HLE_PSMTXCopy,          HLE_HOOK_REPLACE, HLE_TYPE_FAST },
+	{ "PSMTXConcat",          HLE_SDK::HLE_PSMTXConcat,        HLE_HOOK_REPLACE, HLE_TYPE_FAST },
+	{ "PSMTXMultVec",         HLE_SDK::HLE_PSMTXMultVec,       HLE_HOOK_REPLACE, HLE_TYPE_FAST },
 };
 
 static const SPatch OSBreakPoints[] =
@@ -115,6 +125,7 @@ void Execute(u32 _CurrentPC, u32 _Instruction)
 	unsigned int FunctionIndex = _Instruction & 0xFFFFF;
 	if ((FunctionIndex > 0) && (FunctionIndex < (sizeof(OSPatches) / sizeof(SPatch))))
 	{
+		PC = _CurrentPC;
 		OSPatches[FunctionIndex].PatchFunction();
 	}
 	else
@@ -131,6 +142,16 @@ u32 GetFunctionIndex(u32 addr)
 	return (iter != orig_instruction.end()) ?  iter->second : 0;
 }
 
+TPatchFunction GetFunctionPointer(u32 index)
+{
+	index &= 0xFFFFF;
+	_assert_msg_(OSHLE, index > 0 && index < ArraySize(OSPatches),
+	             "HLE system tried to call an undefined HLE function %u.", index);
+	if (index == 0 || index >= ArraySize(OSPatches))
+		return OSPatches[0].PatchFunction;
+	return OSPatches[index].PatchFunction;
+}
+
 int GetFunctionTypeByIndex(u32 index)
 {
 	return OSPatches[index].type;
@@ -145,6 +166,12 @@ bool IsEnabled(int flags)
 {
 	if (flags == HLE::HLE_TYPE_DEBUG && !SConfig::GetInstance().m_LocalCoreStartupParameter.bEnableDebugging && PowerPC::GetMode() != MODE_INTERPRETER)
 		return false;
+	if (flags == HLE::HLE_TYPE_FAST)
+		return HLE_SDK::IsEnabled();
+	// Other hosts may round differently, which would desync movies and netplay.
+	// The JIT cache is cleared when g_want_determinism changes.
+	if (flags == HLE::HLE_TYPE_FAST_HOST_MATH)
+		return HLE_SDK::IsEnabled() && !Core::g_want_determinism;
 
 	return true;
 }
@@ -22,13 +22,19 @@ namespace HLE
 	{
 		HLE_TYPE_GENERIC = 0,    // Miscellaneous function
 		HLE_TYPE_DEBUG   = 1,    // Debug output function
+		HLE_TYPE_FAST    = 2,    // Native version of a hot library routine
+		HLE_TYPE_FAST_HOST_MATH = 3, // Same, but its results depend on the host's libm
 	};
 
+	typedef void (*TPatchFunction)();
+
 	void PatchFunctions();
 
 	void Patch(u32 pc, const char *func_name);
 	u32 UnPatch(const std::string& patchName);
 	void Execute(u32 _CurrentPC, u32 _Instruction);
+	// For the JITs to call the function directly; PC must be set first.
+	TPatchFunction GetFunctionPointer(u32 index);
 
 	u32 GetFunctionIndex(u32 em_address);
 	int GetFunctionTypeByIndex(u32 index);
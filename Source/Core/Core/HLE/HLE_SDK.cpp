@@ -0,0 +1,376 @@
+// Copyright 2015 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <cinttypes>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+#include "Common/CommonTypes.h"
+#include "Common/Intrinsics.h"
+#include "Common/Logging/Log.h"
+
+#include "Core/ConfigManager.h"
+#include "Core/HLE/HLE_SDK.h"
+#include "Core/HW/Memmap.h"
+#include "Core/PowerPC/PowerPC.h"
+#include "Core/PowerPC/Interpreter/Interpreter.h"
+
+namespace HLE_SDK
+{
+
+// The guest memory a fast path writes, worked out from its arguments.
+struct Output
+{
+	u32 address;
+	u32 size;
+};
+
+struct FastPath
+{
+	const char* name;
+	void (*run)();
+	Output (*output)();
+	bool returns_gpr;
+	bool returns_fpr;
+};
+
+// The guest code runs without CoreTiming advancing, so only calls that finish
+// within a few timeslices' worth of instructions are verified. Longer ones
+// just take the fast path.
+static const u32 MAX_VERIFY_SIZE = 16 * 1024;
+static const u32 MAX_VERIFY_STEPS = 1 << 18;
+
+static bool s_verifying;
+static VerifyStats s_verify_stats;
+
+// The host copy of a range of guest RAM, or nullptr if the range isn't all in
+// one bank of RAM.
+static u8* GetRAMPointer(u32 address, u32 size)
+{
+	u32 last = address + size - 1;
+	if (size == 0 || last < address || (address >> 28) != (last >> 28) || (address >> 28) == 0xE)
+		return nullptr;
+	if (!PowerPC::IsOptimizableRAMAddress(address) || !PowerPC::IsOptimizableRAMAddress(last))
+		return nullptr;
+	return Memory::GetPointer(address);
+}
+
+static void Memcpy(u32 dst, u32 src, u32 size)
+{
+	u8* host_dst = GetRAMPointer(dst, size);
+	const u8* host_src = GetRAMPointer(src, size);
+	if (host_dst && host_src)
+	{
+		// Overlapping copies behave like memmove, as the SDK's memcpy does.
+		memmove(host_dst, host_src, size);
+	}
+	else if (dst <= src)
+	{
+		for (u32 i = 0; i < size; i++)
+			PowerPC::Write_U8(PowerPC::Read_U8(src + i), dst + i);
+	}
+	else
+	{
+		for (u32 i = size; i > 0; i--)
+			PowerPC::Write_U8(PowerPC::Read_U8(src + i - 1), dst + i - 1);
+	}
+}
+
+static void Memset(u32 dst, u8 value, u32 size)
+{
+	u8* host_dst = GetRAMPointer(dst, size);
+	if (host_dst)
+	{
+		memset(host_dst, value, size);
+	}
+	else
+	{
+		for (u32 i = 0; i < size; i++)
+			PowerPC::Write_U8(value, dst + i);
+	}
+}
+
+// Paired-single arithmetic: both halves at once, rounded to single precision
+// after every operation like the PS instructions do.
+#ifdef _M_X86
+typedef __m128d Pair;
+static Pair MakePair(double lo, double hi) { return _mm_set_pd(hi, lo); }
+static Pair Splat(double value) { return _mm_set1_pd(value); }
+static Pair Round(Pair v) { return _mm_cvtps_pd(_mm_cvtpd_ps(v)); }
+static Pair Mul(Pair a, Pair b) { return Round(_mm_mul_pd(a, b)); }
+static Pair Madd(Pair a, Pair b, Pair c) { return Round(_mm_add_pd(_mm_mul_pd(a, b), c)); }
+static double Lo(Pair v) { return _mm_cvtsd_f64(v); }
+static double Hi(Pair v) { return _mm_cvtsd_f64(_mm_unpackhi_pd(v, v)); }
+#else
+struct Pair
+{
+	double lo, hi;
+};
+static Pair MakePair(double lo, double hi) { return { lo, hi }; }
+static Pair Splat(double value) { return { value, value }; }
+static Pair Mul(Pair a, Pair b) { return { (float)(a.lo * b.lo), (float)(a.hi * b.hi) }; }
+static Pair Madd(Pair a, Pair b, Pair c) { return { (float)(a.lo * b.lo + c.lo), (float)(a.hi * b.hi + c.hi) }; }
+static double Lo(Pair v) { return v.lo; }
+static double Hi(Pair v) { return v.hi; }
+#endif
+
+static void WriteFloat(double value, u32 address)
+{
+	float f = (float)value;
+	u32 hex;
+	memcpy(&hex, &f, sizeof(hex));
+	PowerPC::Write_U32(hex, address);
+}
+
+// The SDK's Mtx: 3x4 floats, row-major.
+static void LoadMtx(u32 address, double m[3][4])
+{
+	for (int i = 0; i < 3; i++)
+		for (int j = 0; j < 4; j++)
+			m[i][j] = PowerPC::Read_F32(address + (i * 4 + j) * 4);
+}
+
+static void StoreMtx(u32 address, const double m[3][4])
+{
+	for (int i = 0; i < 3; i++)
+		for (int j = 0; j < 4; j++)
+			WriteFloat(m[i][j], address + (i * 4 + j) * 4);
+}
+
+static void Memcpy() { Memcpy(GPR(3), GPR(4), GPR(5)); }
+static void Memset() { Memset(GPR(3), (u8)GPR(4), GPR(5)); }
+static void Sin() { rPS0(1) = sin(rPS0(1)); }
+static void Cos() { rPS0(1) = cos(rPS0(1)); }
+
+static void PSMTXIdentity()
+{
+	for (int i = 0; i < 3; i++)
+		for (int j = 0; j < 4; j++)
+			WriteFloat(i == j ? 1.0 : 0.0, GPR(3) + (i * 4 + j) * 4);
+}
+
+static void PSMTXCopy()
+{
+	for (u32 i = 0; i < 48; i += 4)
+		PowerPC::Write_U32(PowerPC::Read_U32(GPR(3) + i), GPR(4) + i);
+}
+
+static void PSMTXConcat()
+{
+	// ab may be a or b, so both are read first.
+	double a[3][4], b[3][4], ab[3][4];
+	LoadMtx(GPR(3), a);
+	LoadMtx(GPR(4), b);
+	for (int i = 0; i < 3; i++)
+	{
+		for (int j = 0; j < 4; j += 2)
+		{
+			// Same order of operations as the SDK: ps_muls0, ps_madds1, ps_madds0,
+			// and a ps_madds1 with the pair (0, 1) for the translation column.
+			Pair t = Mul(Splat(a[i][0]), MakePair(b[0][j], b[0][j + 1]));
+			t = Madd(Splat(a[i][1]), MakePair(b[1][j], b[1][j + 1]), t);
+			t = Madd(Splat(a[i][2]), MakePair(b[2][j], b[2][j + 1]), t);
+			if (j == 2)
+				t = Madd(Splat(a[i][3]), MakePair(0.0, 1.0), t);
+			ab[i][j] = Lo(t);
+			ab[i][j + 1] = Hi(t);
+		}
+	}
+	StoreMtx(GPR(5), ab);
+}
+
+static void PSMTXMultVec()
+{
+	double m[3][4];
+	LoadMtx(GPR(3), m);
+	double x = PowerPC::Read_F32(GPR(4));
+	double y = PowerPC::Read_F32(GPR(4) + 4);
+	double z = PowerPC::Read_F32(GPR(4) + 8);
+	double v[3];
+	for (int i = 0; i < 3; i++)
+	{
+		// ps_mul, ps_madd with (z, 1), then ps_sum0.
+		Pair t = Mul(MakePair(m[i][0], m[i][1]), MakePair(x, y));
+		t = Madd(MakePair(m[i][2], m[i][3]), MakePair(z, 1.0), t);
+		v[i] = (float)(Lo(t) + Hi(t));
+	}
+	for (int i = 0; i < 3; i++)
+		WriteFloat(v[i], GPR(5) + i * 4);
+}
+
+static Output NoOutput() { return { 0, 0 }; }
+static Output R3R5Output() { return { GPR(3), GPR(5) }; }
+static Output MtxR3Output() { return { GPR(3), 48 }; }
+static Output MtxR4Output() { return { GPR(4), 48 }; }
+static Output MtxR5Output() { return { GPR(5), 48 }; }
+static Output VecR5Output() { return { GPR(5), 12 }; }
+
+static const FastPath s_memcpy = { "memcpy", Memcpy, R3R5Output, true, false };
+static const FastPath s_memset = { "memset", Memset, R3R5Output, true, false };
+static const FastPath s_fill_mem = { "__fill_mem", Memset, R3R5Output, false, false };
+static const FastPath s_sin = { "sin", Sin, NoOutput, false, true };
+static const FastPath s_cos = { "cos", Cos, NoOutput, false, true };
+static const FastPath s_mtx_identity = { "PSMTXIdentity", PSMTXIdentity, MtxR3Output, false, false };
+static const FastPath s_mtx_copy = { "PSMTXCopy", PSMTXCopy, MtxR4Output, false, false };
+static const FastPath s_mtx_concat = { "PSMTXConcat", PSMTXConcat, MtxR5Output, false, false };
+static const FastPath s_mtx_mult_vec = { "PSMTXMultVec", PSMTXMultVec, VecR5Output, false, false };
+
+// What the ABI lets the caller see, apart from memory.
+struct GuestState
+{
+	u32 gpr[32];
+	u64 cr_val[8];
+	u64 ps[32][2];
+	u32 pc, npc, msr, fpscr, lr, ctr;
+	u8 xer_ca, xer_so_ov;
+};
+
+static void SaveState(GuestState* state)
+{
+	memcpy(state->gpr, PowerPC::ppcState.gpr, sizeof(state->gpr));
+	memcpy(state->cr_val, PowerPC::ppcState.cr_val, sizeof(state->cr_val));
+	memcpy(state->ps, PowerPC::ppcState.ps, sizeof(state->ps));
+	state->pc = PC;
+	state->npc = NPC;
+	state->msr = MSR;
+	state->fpscr = PowerPC::ppcState.fpscr;
+	state->lr = LR;
+	state->ctr = CTR;
+	state->xer_ca = PowerPC::ppcState.xer_ca;
+	state->xer_so_ov = PowerPC::ppcState.xer_so_ov;
+}
+
+static void RestoreState(const GuestState& state)
+{
+	memcpy(PowerPC::ppcState.gpr, state.gpr, sizeof(state.gpr));
+	memcpy(PowerPC::ppcState.cr_val, state.cr_val, sizeof(state.cr_val));
+	memcpy(PowerPC::ppcState.ps, state.ps, sizeof(state.ps));
+	PC = state.pc;
+	NPC = state.npc;
+	MSR = state.msr;
+	PowerPC::ppcState.fpscr = state.fpscr;
+	LR = state.lr;
+	CTR = state.ctr;
+	PowerPC::ppcState.xer_ca = state.xer_ca;
+	PowerPC::ppcState.xer_so_ov = state.xer_so_ov;
+}
+
+// Runs the fast path, then the original guest code from the same state, and
+// compares what the caller can see. The guest code's results are the ones
+// that stay.
+static void Verify(const FastPath& path)
+{
+	s_verify_stats.calls++;
+	u32 address = PC;
+	u32 return_address = LR;
+	Output output = path.output();
+	u8* memory = GetRAMPointer(output.address, output.size);
+	if (output.size > MAX_VERIFY_SIZE || (output.size && !memory))
+	{
+		s_verify_stats.skipped++;
+		path.run();
+		NPC = LR;
+		return;
+	}
+
+	GuestState state;
+	SaveState(&state);
+	std::vector<u8> before(memory, memory + output.size);
+	path.run();
+	u32 native_r3 = GPR(3);
+	u64 native_f1 = riPS0(1);
+	std::vector<u8> native(memory, memory + output.size);
+	RestoreState(state);
+	std::copy(before.begin(), before.end(), memory);
+
+	// The hook at the entry point mustn't fire again.
+	s_verifying = true;
+	bool returned = false;
+	for (u32 steps = 0; steps < MAX_VERIFY_STEPS && !returned; steps++)
+	{
+		Interpreter::getInstance()->SingleStepInner();
+		returned = PC == return_address;
+	}
+	s_verifying = false;
+
+	if (!returned)
+	{
+		WARN_LOG(OSHLE, "HLE %s at %08x: the guest code didn't return within %u instructions, not verified",
+		         path.name, address, MAX_VERIFY_STEPS);
+		s_verify_stats.skipped++;
+		RestoreState(state);
+		std::copy(before.begin(), before.end(), memory);
+		path.run();
+		NPC = LR;
+		return;
+	}
+	NPC = PC;
+
+	bool mismatch = false;
+	for (u32 i = 0; i < output.size; i++)
+	{
+		if (memory[i] != native[i])
+		{
+			ERROR_LOG(OSHLE, "HLE %s at %08x: wrote %02x to %08x, the guest code %02x", path.name, address,
+			          native[i], output.address + i, memory[i]);
+			mismatch = true;
+			break;
+		}
+	}
+	if (path.returns_gpr && GPR(3) != native_r3)
+	{
+		ERROR_LOG(OSHLE, "HLE %s at %08x: returned %08x, the guest code %08x", path.name, address,
+		          native_r3, GPR(3));
+		mismatch = true;
+	}
+	if (path.returns_fpr && riPS0(1) != native_f1)
+	{
+		ERROR_LOG(OSHLE, "HLE %s at %08x: returned %016" PRIx64 ", the guest code %016" PRIx64, path.name, address,
+		          native_f1, riPS0(1));
+		mismatch = true;
+	}
+	if (mismatch)
+		s_verify_stats.mismatches++;
+}
+
+static void Call(const FastPath& path)
+{
+	if (SConfig::GetInstance().m_LocalCoreStartupParameter.bHLEVerifyFastPaths)
+	{
+		Verify(path);
+		return;
+	}
+	path.run();
+	NPC = LR;
+}
+
+void HLE_memcpy() { Call(s_memcpy); }
+void HLE_memset() { Call(s_memset); }
+void HLE_fill_mem() { Call(s_fill_mem); }
+void HLE_sin() { Call(s_sin); }
+void HLE_cos() { Call(s_cos); }
+void HLE_PSMTXIdentity() { Call(s_mtx_identity); }
+void HLE_PSMTXCopy() { Call(s_mtx_copy); }
+void HLE_PSMTXConcat() { Call(s_mtx_concat); }
+void HLE_PSMTXMultVec() { Call(s_mtx_mult_vec); }
+
+bool IsEnabled()
+{
+	const SCoreStartupParameter& param = SConfig::GetInstance().m_LocalCoreStartupParameter;
+	return param.bHLEFastPaths && !param.bMMU && !s_verifying;
+}
+
+const VerifyStats& GetVerifyStats()
+{
+	return s_verify_stats;
+}
+
+void ResetVerifyStats()
+{
+	s_verify_stats = {};
+}
+
+}
@@ -0,0 +1,37 @@
+// Copyright 2015 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include "Common/CommonTypes.h"
+
+namespace HLE_SDK
+{
+	// Native versions of hot C library and SDK routines. They follow the PPC
+	// ABI: arguments in r3-r5 and f1, results in r3 and f1, return to LR.
+	void HLE_memcpy();
+	void HLE_memset();
+	void HLE_fill_mem();
+	void HLE_sin();
+	void HLE_cos();
+	void HLE_PSMTXIdentity();
+	void HLE_PSMTXCopy();
+	void HLE_PSMTXConcat();
+	void HLE_PSMTXMultVec();
+
+	// Whether the fast paths are on. They're off under the MMU, and while the
+	// verification mode runs the original guest code.
+	bool IsEnabled();
+
+	struct VerifyStats
+	{
+		u64 calls;
+		u64 mismatches;
+		// Calls whose output isn't plain RAM or is too large, and calls whose
+		// guest code didn't return in time. These just run the fast path.
+		u64 skipped;
+	};
+	const VerifyStats& GetVerifyStats();
+	void ResetVerifyStats();
+}
@@ -524,6 +524,13 @@ void UpdateAudioDMA()
 	}
 }
 
+static void AdvanceARAMDMA(u32 count)
+{
+	g_arDMA.MMAddr += count;
+	g_arDMA.ARAddr += count;
+	g_arDMA.Cnt.count -= count;
+}
+
 static void Do_ARAM_DMA()
 {
 	g_dspState.DMAState = 1;
@@ -555,6 +562,16 @@ static void Do_ARAM_DMA()
 
 		if (g_arDMA.ARAddr < g_ARAM.size)
 		{
+			// The memory map modes don't change reads, so a transfer that doesn't
+			// wrap around either memory is one copy.
+			u32 count = g_arDMA.Cnt.count;
+			u8* mram = Memory::GetPointerForRange(g_arDMA.MMAddr, count);
+			if (mram && g_arDMA.ARAddr + count <= g_ARAM.size)
+			{
+				memcpy(mram, &g_ARAM.ptr[g_arDMA.ARAddr], count);
+				AdvanceARAMDMA(count);
+			}
+
 			while (g_arDMA.Cnt.count)
 			{
 				// These are logically separated in code to show that a memory map has been set up
@@ -580,6 +597,14 @@ static void Do_ARAM_DMA()
 		else
 		{
 			// Assuming no external ARAM installed; returns zeros on out of bounds reads (verified on real HW)
+			u32 count = g_arDMA.Cnt.count;
+			u8* mram = Memory::GetPointerForRange(g_arDMA.MMAddr, count);
+			if (mram)
+			{
+				memset(mram, 0, count);
+				AdvanceARAMDMA(count);
+			}
+
 			while (g_arDMA.Cnt.count)
 			{
 				Memory::Write_U64(0, g_arDMA.MMAddr);
@@ -601,6 +626,20 @@ static void Do_ARAM_DMA()
 
 		if (g_arDMA.ARAddr < g_ARAM.size)
 		{
+			// In memory map mode 4, writes below 4MB are mirrored 4MB up. Only
+			// transfers that stay on one side of that are done in one go.
+			u32 count = g_arDMA.Cnt.count;
+			const u8* mram = Memory::GetPointerForRange(g_arDMA.MMAddr, count);
+			bool mirror = (g_ARAM_Info.Hex & 0xf) == 4 && g_arDMA.ARAddr < 0x400000;
+			if (mram && g_arDMA.ARAddr + count <= g_ARAM.size &&
+			    (!mirror || g_arDMA.ARAddr + count <= 0x400000))
+			{
+				if (mirror)
+					memcpy(&g_ARAM.ptr[(g_arDMA.ARAddr + 0x400000) & g_ARAM.mask], mram, count);
+				memcpy(&g_ARAM.ptr[g_arDMA.ARAddr], mram, count);
+				AdvanceARAMDMA(count);
+			}
+
 			while (g_arDMA.Cnt.count)
 			{
 				if ((g_ARAM_Info.Hex & 0xf) == 3)
@@ -2,6 +2,7 @@
 // Licensed under GPLv2+
 // Refer to the license.txt file included.
 
+#include "Common/BulkCopy.h"
 #include "Common/FileUtil.h"
 #include "Common/MathUtil.h"
 
@@ -450,8 +451,10 @@ void AXUCode::MixAUXSamples(int aux_id, u32 write_addr, u32 read_addr)
 	{
 		int* ptr = (int*)HLEMemory_Get_Pointer(write_addr);
 		for (auto& buffer : buffers)
-			for (u32 j = 0; j < 5 * 32; ++j)
-				*ptr++ = Common::swap32(buffer[j]);
+		{
+			Common::CopySwap32(ptr, buffer, 5 * 32);
+			ptr += 5 * 32;
+		}
 	}
 
 	// Then, we read the new temp from the CPU and add to our current
@@ -467,15 +470,10 @@ void AXUCode::MixAUXSamples(int aux_id, u32 write_addr, u32 read_addr)
 
 void AXUCode::UploadLRS(u32 dst_addr)
 {
-	int buffers[3][5 * 32];
-
-	for (u32 i = 0; i < 5 * 32; ++i)
-	{
-		buffers[0][i] = Common::swap32(m_samples_left[i]);
-		buffers[1][i] = Common::swap32(m_samples_right[i]);
-		buffers[2][i] = Common::swap32(m_samples_surround[i]);
-	}
-	memcpy(HLEMemory_Get_Pointer(dst_addr), buffers, sizeof (buffers));
+	int* ptr = (int*)HLEMemory_Get_Pointer(dst_addr);
+	Common::CopySwap32(ptr, m_samples_left, 5 * 32);
+	Common::CopySwap32(ptr + 5 * 32, m_samples_right, 5 * 32);
+	Common::CopySwap32(ptr + 2 * 5 * 32, m_samples_surround, 5 * 32);
 }
 
 void AXUCode::SetMainLR(u32 src_addr)
@@ -567,8 +565,10 @@ void AXUCode::SendAUXAndMix(u32 main_auxa_up, u32 auxb_s_up, u32 main_l_dl,
 	// Upload AUXA LRS
 	int* ptr = (int*)HLEMemory_Get_Pointer(main_auxa_up);
 	for (auto& up_buffer : up_buffers)
-		for (u32 j = 0; j < 32 * 5; ++j)
-			*ptr++ = Common::swap32(up_buffer[j]);
+	{
+		Common::CopySwap32(ptr, up_buffer, 32 * 5);
+		ptr += 32 * 5;
+	}
 
 	// Upload AUXB S
 	ptr = (int*)HLEMemory_Get_Pointer(auxb_s_up);
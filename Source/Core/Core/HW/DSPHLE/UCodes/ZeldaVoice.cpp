@@ -4,6 +4,7 @@
 
 #include <sstream>
 
+#include "Common/BulkCopy.h"
 #include "Common/CommonFuncs.h"
 #include "Common/MathUtil.h"
 
@@ -17,8 +18,7 @@ void ZeldaUCode::ReadVoicePB(u32 _Addr, ZeldaVoicePB& PB)
 	u16 *memory = (u16*)Memory::GetPointer(_Addr);
 
 	// Perform byteswap
-	for (int i = 0; i < (0x180 / 2); i++)
-		((u16*)&PB)[i] = Common::swap16(memory[i]);
+	Common::CopySwap16(&PB, memory, 0x180 / 2);
 
 	// Word swap all 32-bit variables.
 	PB.RestartPos = (PB.RestartPos << 16) | (PB.RestartPos >> 16);
@@ -42,8 +42,7 @@ void ZeldaUCode::WritebackVoicePB(u32 _Addr, ZeldaVoicePB& PB)
 
 	// Perform byteswap
 	// Only the first 0x100 bytes are written back
-	for (int i = 0; i < (0x100 / 2); i++)
-		memory[i] = Common::swap16(((u16*)&PB)[i]);
+	Common::CopySwap16(memory, &PB, 0x100 / 2);
 }
 
 int ZeldaUCode::ConvertRatio(int pb_ratio)
@@ -136,14 +135,13 @@ clear_buffer:
 	if (PB.RemLength < (u32)rem_samples)
 	{
 		// finish-up loop
-		for (u32 i = 0; i < PB.RemLength; i++)
-			*_Buffer++ = Common::swap16(*read_ptr++);
+		Common::CopySwap16(_Buffer, read_ptr, PB.RemLength);
+		_Buffer += PB.RemLength;
 		rem_samples -= PB.RemLength;
 		goto reached_end;
 	}
 	// main render loop
-	for (u32 i = 0; i < rem_samples; i++)
-		*_Buffer++ = Common::swap16(*read_ptr++);
+	Common::CopySwap16(_Buffer, read_ptr, rem_samples);
 
 	PB.RemLength -= rem_samples;
 	if (PB.RemLength == 0)
@@ -463,10 +461,7 @@ void Decoder21_ReadAudio(ZeldaVoicePB &PB, int size, s16* _Buffer)
 
 	const u16* src = (u16*)Memory::GetPointer(ACC0 & Memory::RAM_MASK);
 
-	for (u32 i = 0; i < (ACC1 >> 16); i++)
-	{
-		_Buffer[i] = Common::swap16(src[i]);
-	}
+	Common::CopySwap16(_Buffer, src, ACC1 >> 16);
 
 	PB.raw[0x34 ^ 1] += size;
 }
@@ -9,6 +9,7 @@
 
 #include "AudioCommon/AudioCommon.h"
 
+#include "Common/BulkCopy.h"
 #include "Common/ChunkFile.h"
 #include "Common/CommonTypes.h"
 
@@ -384,11 +385,8 @@ static u32 ProcessDTKSamples(short *tempPCM, u32 num_samples)
 		NGCADPCM::DecodeBlock(tempPCM + samples_processed * 2, tempADPCM);
 		samples_processed += NGCADPCM::SAMPLES_PER_BLOCK;
 	} while (samples_processed < num_samples);
-	for (unsigned i = 0; i < samples_processed * 2; ++i)
-	{
-		// TODO: Fix the mixer so it can accept non-byte-swapped samples.
-		tempPCM[i] = Common::swap16(tempPCM[i]);
-	}
+	// TODO: Fix the mixer so it can accept non-byte-swapped samples.
+	Common::CopySwap16(tempPCM, tempPCM, samples_processed * 2);
 	return samples_processed;
 }
 
@@ -8,6 +8,9 @@
 // However, if a JITed instruction (for example lwz) wants to access a bad memory area that call
 // may be redirected here (for example to Read_U32()).
 
+#include <cinttypes>
+#include <map>
+
 #include "Common/ChunkFile.h"
 #include "Common/CommonTypes.h"
 #include "Common/MemArena.h"
@@ -165,6 +168,14 @@ static MemoryView views[] =
 };
 static const int num_views = sizeof(views) / sizeof(MemoryView);
 
+// Pages of the logical view mirrored from the guest page table, mapping the
+// page's logical address to whether it was mapped writable. See
+// PowerPC::MapLogicalPage.
+static const u32 LOGICAL_PAGE_SIZE = 0x1000;
+static std::map<u32, bool> s_logical_pages;
+static u64 s_logical_pages_mapped;
+static u64 s_logical_pages_unmapped;
+
 void Init()
 {
 	bool wii = SConfig::GetInstance().m_LocalCoreStartupParameter.bWii;
@@ -191,6 +202,9 @@ void Init()
 	else
 		InitMMIO(mmio_mapping);
 
+	s_logical_pages_mapped = 0;
+	s_logical_pages_unmapped = 0;
+
 	INFO_LOG(MEMMAP, "Memory system initialized. RAM at %p", m_pRAM);
 	m_IsInitialized = true;
 }
@@ -207,11 +221,86 @@ void DoState(PointerWrap &p)
 	if (wii)
 		p.DoArray(m_pEXRAM, EXRAM_SIZE);
 	p.DoMarker("Memory EXRAM");
+
+	if (p.GetMode() == PointerWrap::MODE_READ)
+		UnmapLogicalPages();
+}
+
+// Finds the offset into the shared memory segment backing a physical address,
+// if it is RAM.
+static bool GetSHMPosition(u32 physical_address, u32* position)
+{
+	for (const MemoryView& view : views)
+	{
+		if (!view.out_ptr || !view.mapped_ptr || view.virtual_address >= 0x100000000)
+			continue;
+		u32 offset = physical_address - (u32)view.virtual_address;
+		if (physical_address >= view.virtual_address && offset < view.size)
+		{
+			*position = view.shm_position + offset;
+			return true;
+		}
+	}
+	return false;
+}
+
+bool MapLogicalPage(u32 logical_address, u32 physical_address, bool writable)
+{
+#if defined(_WIN32) || defined(_ARCH_32)
+	// Windows can only map views at 64KB granularity, and there's no logical
+	// view on 32-bit targets.
+	return false;
+#else
+	u32 position;
+	if (!logical_base || !GetSHMPosition(physical_address & ~(LOGICAL_PAGE_SIZE - 1), &position))
+		return false;
+
+	u32 page = logical_address & ~(LOGICAL_PAGE_SIZE - 1);
+	u8* ptr = logical_base + page;
+	// This replaces the existing mapping, if any.
+	if (g_arena.CreateView(position, LOGICAL_PAGE_SIZE, ptr) != ptr)
+		return false;
+	if (!writable)
+		WriteProtectMemory(ptr, LOGICAL_PAGE_SIZE, false);
+
+	s_logical_pages[page] = writable;
+	s_logical_pages_mapped++;
+	return true;
+#endif
+}
+
+void UnmapLogicalPages(u32 logical_address, u32 mask)
+{
+	for (auto it = s_logical_pages.begin(); it != s_logical_pages.end();)
+	{
+		if ((it->first ^ logical_address) & mask)
+		{
+			++it;
+			continue;
+		}
+		g_arena.ReleaseView(logical_base + it->first, LOGICAL_PAGE_SIZE);
+		it = s_logical_pages.erase(it);
+		s_logical_pages_unmapped++;
+	}
+}
+
+void UnmapLogicalPages()
+{
+	for (const auto& page : s_logical_pages)
+		g_arena.ReleaseView(logical_base + page.first, LOGICAL_PAGE_SIZE);
+	s_logical_pages_unmapped += s_logical_pages.size();
+	s_logical_pages.clear();
 }
 
 void Shutdown()
 {
 	m_IsInitialized = false;
+	UnmapLogicalPages();
+	if (s_logical_pages_mapped)
+	{
+		NOTICE_LOG(MEMMAP, "Mapped %" PRIu64 " pages from the guest page table, unmapped %" PRIu64,
+		           s_logical_pages_mapped, s_logical_pages_unmapped);
+	}
 	u32 flags = 0;
 	if (SConfig::GetInstance().m_LocalCoreStartupParameter.bWii) flags |= MV_WII_ONLY;
 	if (bFakeVMEM) flags |= MV_FAKE_VMEM;
@@ -242,40 +331,39 @@ bool AreMemoryBreakpointsActivated()
 #endif
 }
 
-static inline bool ValidCopyRange(u32 address, size_t size)
-{
-	return (GetPointer(address) != nullptr &&
-	        GetPointer(address + u32(size)) != nullptr &&
-	        size < EXRAM_SIZE); // Make sure we don't have a range spanning seperate 2 banks
-}
-
 void CopyFromEmu(void* data, u32 address, size_t size)
 {
-	if (!ValidCopyRange(address, size))
+	const u8* ptr = GetPointerForRange(address, size);
+	if (!ptr)
 	{
 		PanicAlert("Invalid range in CopyFromEmu. %lx bytes from 0x%08x", (unsigned long)size, address);
 		return;
 	}
-	memcpy(data, GetPointer(address), size);
+	memcpy(data, ptr, size);
 }
 
 void CopyToEmu(u32 address, const void* data, size_t size)
 {
-	if (!ValidCopyRange(address, size))
+	u8* ptr = GetPointerForRange(address, size);
+	if (!ptr)
 	{
 		PanicAlert("Invalid range in CopyToEmu. %lx bytes to 0x%08x", (unsigned long)size, address);
 		return;
 	}
-	memcpy(GetPointer(address), data, size);
+	memcpy(ptr, data, size);
 }
 
 void Memset(const u32 _Address, const u8 _iValue, const u32 _iLength)
 {
-	u8* ptr = GetPointer(_Address);
-	if (ptr != nullptr)
+	// The IPC_HLE devices clear buffers the guest hands them, so a bad range
+	// is the guest's mistake: log it and leave memory alone, as before.
+	u8* ptr = GetPointerForRange(_Address, _iLength);
+	if (!ptr)
 	{
-		memset(ptr,_iValue,_iLength);
+		ERROR_LOG(MEMMAP, "Invalid range in Memset. %x bytes at 0x%08x", _iLength, _Address);
+		return;
 	}
+	memset(ptr, _iValue, _iLength);
 }
 
 std::string GetString(u32 em_address, size_t size)
@@ -314,6 +402,22 @@ u8* GetPointer(u32 address)
 	return nullptr;
 }
 
+u8* GetPointerForRange(u32 address, size_t size)
+{
+	address &= 0x3FFFFFFF;
+	if (address < REALRAM_SIZE)
+		return size <= REALRAM_SIZE - address ? m_pRAM + address : nullptr;
+
+	if (SConfig::GetInstance().m_LocalCoreStartupParameter.bWii && (address >> 28) == 0x1)
+	{
+		u32 offset = address & 0x0fffffff;
+		if (offset < EXRAM_SIZE && size <= EXRAM_SIZE - offset)
+			return m_pEXRAM + offset;
+	}
+
+	return nullptr;
+}
+
 u8 Read_U8(u32 address)
 {
 	return *GetPointer(address);
@@ -74,10 +74,22 @@ void DoState(PointerWrap &p);
 void Clear();
 bool AreMemoryBreakpointsActivated();
 
+// Mirror pages of the guest page table into the logical view, so the JIT's
+// fastmem accesses can reach them with the MMU on. A page mapped read-only
+// faults again on the first write.
+bool MapLogicalPage(u32 logical_address, u32 physical_address, bool writable);
+// Unmaps the pages whose logical address matches logical_address in the bits
+// of mask, or every page.
+void UnmapLogicalPages(u32 logical_address, u32 mask);
+void UnmapLogicalPages();
+
 // Routines to access physically addressed memory, designed for use by
 // emulated hardware outside the CPU. Use "Device_" prefix.
 std::string GetString(u32 em_address, size_t size = 0);
 u8* GetPointer(const u32 address);
+// The host copy of [address, address + size), or nullptr if the range isn't
+// all in one bank of RAM. Doesn't complain about invalid ranges.
+u8* GetPointerForRange(u32 address, size_t size);
 void CopyFromEmu(void* data, u32 address, size_t size);
 void CopyToEmu(u32 address, const void* data, size_t size);
 void Memset(const u32 address, const u8 var, const u32 length);
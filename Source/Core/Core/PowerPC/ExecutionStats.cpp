@@ -0,0 +1,146 @@
+// Copyright 2015 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "Common/CommonTypes.h"
+#include "Common/FileUtil.h"
+#include "Common/StringUtil.h"
+#include "Common/Logging/Log.h"
+#include "Core/PowerPC/PPCSymbolDB.h"
+#include "Core/PowerPC/PPCTables.h"
+#include "Core/PowerPC/Profiler.h"
+
+namespace Profiler
+{
+
+bool g_ExecutionStats;
+
+// Values never move once inserted, which compiled code relies on.
+static std::unordered_map<u32, BlockExecutionStats> s_blocks;
+
+BlockExecutionStats* GetBlockExecutionStats(u32 address)
+{
+	return &s_blocks[address];
+}
+
+void CountBlockRun(u32 address, int cycles)
+{
+	BlockExecutionStats& block = s_blocks[address];
+	block.runs++;
+	block.cycles += cycles;
+}
+
+void ResetExecutionStats()
+{
+	s_blocks.clear();
+	for (int i = 0; i < m_numInstructions; i++)
+	{
+		m_allInstructions[i]->runCount = 0;
+		m_allInstructions[i]->fallbackCount = 0;
+	}
+}
+
+static std::string QuoteCSV(const std::string& str)
+{
+	if (str.find_first_of(",\"\n") == std::string::npos)
+		return str;
+	std::string quoted = "\"";
+	for (char c : str)
+	{
+		if (c == '"')
+			quoted += '"';
+		quoted += c;
+	}
+	return quoted + '"';
+}
+
+static std::string QuoteJSON(const std::string& str)
+{
+	std::string quoted = "\"";
+	for (char c : str)
+	{
+		if (c == '"' || c == '\\')
+			quoted += StringFromFormat("\\%c", c);
+		else if ((u8)c < 0x20)
+			quoted += StringFromFormat("\\u%04x", c);
+		else
+			quoted += c;
+	}
+	return quoted + '"';
+}
+
+void WriteExecutionStats(const std::string& filename)
+{
+	std::vector<const GekkoOPInfo*> opcodes;
+	for (int i = 0; i < m_numInstructions; i++)
+	{
+		const GekkoOPInfo* info = m_allInstructions[i];
+		if (info->runCount || info->fallbackCount)
+			opcodes.push_back(info);
+	}
+	std::sort(opcodes.begin(), opcodes.end(), [](const GekkoOPInfo* a, const GekkoOPInfo* b) {
+		return a->runCount > b->runCount;
+	});
+
+	typedef std::pair<u32, BlockExecutionStats> Block;
+	std::vector<Block> blocks;
+	for (const auto& entry : s_blocks)
+	{
+		if (entry.second.runs)
+			blocks.push_back(entry);
+	}
+	std::sort(blocks.begin(), blocks.end(), [](const Block& a, const Block& b) {
+		return a.second.cycles > b.second.cycles;
+	});
+
+	File::IOFile f(filename, "w");
+	if (!f)
+	{
+		ERROR_LOG(POWERPC, "Failed to open %s for the execution statistics", filename.c_str());
+		return;
+	}
+	FILE* file = f.GetHandle();
+
+	std::string extension;
+	SplitPath(filename, nullptr, nullptr, &extension);
+	if (extension == ".json")
+	{
+		fprintf(file, "{\n\t\"opcodes\": [");
+		for (size_t i = 0; i < opcodes.size(); i++)
+		{
+			fprintf(file, "%s\n\t\t{\"name\": %s, \"runs\": %" PRIu64 ", \"fallbacks\": %" PRIu64 "}",
+			        i ? "," : "", QuoteJSON(opcodes[i]->opname).c_str(),
+			        opcodes[i]->runCount, opcodes[i]->fallbackCount);
+		}
+		fprintf(file, "\n\t],\n\t\"blocks\": [");
+		for (size_t i = 0; i < blocks.size(); i++)
+		{
+			fprintf(file, "%s\n\t\t{\"address\": \"%08x\", \"symbol\": %s, \"runs\": %" PRIu64 ", \"cycles\": %" PRIu64 "}",
+			        i ? "," : "", blocks[i].first, QuoteJSON(g_symbolDB.GetDescription(blocks[i].first)).c_str(),
+			        blocks[i].second.runs, blocks[i].second.cycles);
+		}
+		fprintf(file, "\n\t]\n}\n");
+	}
+	else
+	{
+		// Two tables, one after the other.
+		fprintf(file, "opcode,runs,fallbacks\n");
+		for (const GekkoOPInfo* info : opcodes)
+			fprintf(file, "%s,%" PRIu64 ",%" PRIu64 "\n", QuoteCSV(info->opname).c_str(), info->runCount, info->fallbackCount);
+		fprintf(file, "\nblock,symbol,runs,cycles\n");
+		for (const Block& block : blocks)
+		{
+			fprintf(file, "%08x,%s,%" PRIu64 ",%" PRIu64 "\n", block.first,
+			        QuoteCSV(g_symbolDB.GetDescription(block.first)).c_str(), block.second.runs, block.second.cycles);
+		}
+	}
+}
+
+}  // namespace
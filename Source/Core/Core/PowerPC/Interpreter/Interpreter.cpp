@@ -11,7 +11,9 @@
 #include "Core/Debugger/Debugger_SymbolMap.h"
 #include "Core/IPC_HLE/WII_IPC_HLE.h"
 #include "Core/PowerPC/PPCTables.h"
+#include "Core/PowerPC/Profiler.h"
 #include "Core/PowerPC/Interpreter/Interpreter.h"
+#include "Core/PowerPC/Interpreter/Interpreter_BlockCache.h"
 
 #ifdef USE_GDBSTUB
 #include "Core/PowerPC/GDBStub.h"
@@ -20,6 +22,7 @@
 namespace
 {
 	u32 last_pc;
+	InterpreterBlockCache block_cache;
 }
 
 bool Interpreter::m_EndBlock;
@@ -40,7 +43,6 @@ void Interpreter::RunTable63(UGeckoInstruction _inst) { m_opTable63[_inst.SUBOP1
 
 void Interpreter::Init()
 {
-	g_bReserve = false;
 	m_EndBlock = false;
 }
 
@@ -163,9 +165,76 @@ int Interpreter::SingleStepInner()
 	PC = NPC;
 
 	GekkoOPInfo *opinfo = GetOpInfo(instCode);
+	if (Profiler::g_ExecutionStats && function == 0 && instCode.hex != 0)
+		opinfo->runCount++;
 	return opinfo->numCycles;
 }
 
+// Same as calling SingleStepInner for each instruction, minus the fetch and
+// decode.
+static int RunDecodedBlock(const InterpreterBlockCache::Block& block)
+{
+	// Stop if the block gets invalidated under us (icbi, an icache flush, or
+	// a store that started a DMA), since it may have been freed.
+	u32 invalidations = block_cache.GetInvalidationCount();
+	bool count = Profiler::g_ExecutionStats;
+	UReg_MSR& msr = (UReg_MSR&)MSR;
+	int cycles = 0;
+	const InterpreterBlockCache::Instruction* op = block.instructions.data();
+	const InterpreterBlockCache::Instruction* end = op + block.instructions.size();
+	for (; op != end; ++op)
+	{
+		NPC = PC + sizeof(UGeckoInstruction);
+		if (op->uses_fpu && !msr.FP)
+		{
+			PowerPC::ppcState.Exceptions |= EXCEPTION_FPU_UNAVAILABLE;
+			PowerPC::CheckExceptions();
+			Interpreter::m_EndBlock = true;
+		}
+		else
+		{
+			op->func(op->inst);
+			if (PowerPC::ppcState.Exceptions & EXCEPTION_DSI)
+			{
+				PowerPC::CheckExceptions();
+				Interpreter::m_EndBlock = true;
+			}
+		}
+		last_pc = PC;
+		PC = NPC;
+		cycles += op->cycles;
+		if (count)
+			op->info->runCount++;
+
+		if (Interpreter::m_EndBlock || block_cache.GetInvalidationCount() != invalidations)
+			break;
+	}
+	return cycles;
+}
+
+int Interpreter::RunBlock()
+{
+	m_EndBlock = false;
+	bool use_cache = SConfig::GetInstance().m_LocalCoreStartupParameter.bInterpreterBlockCache;
+#ifdef USE_GDBSTUB
+	use_cache = use_cache && !gdb_active();
+#endif
+
+	u32 start = PC;
+	int cycles = 0;
+	while (!m_EndBlock)
+	{
+		const InterpreterBlockCache::Block* block = use_cache ? block_cache.Lookup(PC) : nullptr;
+		if (block)
+			cycles += RunDecodedBlock(*block);
+		else
+			cycles += SingleStepInner();
+	}
+	if (Profiler::g_ExecutionStats)
+		Profiler::CountBlockRun(start, cycles);
+	return cycles;
+}
+
 void Interpreter::SingleStep()
 {
 	SingleStepInner();
@@ -255,18 +324,9 @@ void Interpreter::Run()
 		}
 		else
 		{
-			// "fast" version of inner loop. well, it's not so fast.
+			// "fast" version of inner loop.
 			while (PowerPC::ppcState.downcount > 0)
-			{
-				m_EndBlock = false;
-
-				int cycles = 0;
-				while (!m_EndBlock)
-				{
-					cycles += SingleStepInner();
-				}
-				PowerPC::ppcState.downcount -= cycles;
-			}
+				PowerPC::ppcState.downcount -= RunBlock();
 		}
 
 		CoreTiming::Advance();
@@ -289,7 +349,17 @@ void Interpreter::unknown_instruction(UGeckoInstruction _inst)
 
 void Interpreter::ClearCache()
 {
-	// Do nothing.
+	block_cache.Clear();
+}
+
+void Interpreter::InvalidateICache(u32 address, u32 length)
+{
+	block_cache.Invalidate(address, length);
+}
+
+InterpreterBlockCache& Interpreter::GetBlockCache()
+{
+	return block_cache;
 }
 
 const char *Interpreter::GetName()
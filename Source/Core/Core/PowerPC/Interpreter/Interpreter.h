@@ -15,6 +15,8 @@
 #include "Core/PowerPC/Gekko.h"
 #include "Core/PowerPC/PowerPC.h"
 
+class InterpreterBlockCache;
+
 class Interpreter : public CPUCoreBase
 {
 public:
@@ -23,9 +25,14 @@ public:
 	void Reset();
 	void SingleStep() override;
 	int SingleStepInner();
+	// Runs until a branch or an exception ends the block, from the decoded
+	// block cache if it's enabled. Returns the cycles taken.
+	int RunBlock();
 
 	void Run() override;
 	void ClearCache() override;
+	void InvalidateICache(u32 address, u32 length);
+	static InterpreterBlockCache& GetBlockCache();
 	const char *GetName() override;
 
 	typedef void (*_interpreterInstruction)(UGeckoInstruction instCode);
@@ -297,6 +304,8 @@ public:
 	static void RunTable63(UGeckoInstruction _instCode);
 
 	static u32 Helper_Carry(u32 _uValue1, u32 _uValue2);
+	// dcbi's effects, which Jit64 calls too.
+	static void Helper_dcbi(u32 address);
 
 private:
 	// flag helper
@@ -319,9 +328,4 @@ private:
 
 	static void Helper_FloatCompareOrdered(UGeckoInstruction _inst, double a, double b);
 	static void Helper_FloatCompareUnordered(UGeckoInstruction _inst, double a, double b);
-
-	// TODO: These should really be in the save state, although it's unlikely to matter much.
-	// They are for lwarx and its friend stwcxd.
-	static bool g_bReserve;
-	static u32  g_reserveAddr;
 };
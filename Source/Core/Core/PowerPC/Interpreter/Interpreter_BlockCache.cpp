@@ -0,0 +1,148 @@
+// Copyright 2015 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <cstring>
+
+#include "Core/HLE/HLE.h"
+#include "Core/PowerPC/PowerPC.h"
+#include "Core/PowerPC/PPCTables.h"
+#include "Core/PowerPC/Interpreter/Interpreter_BlockCache.h"
+
+InterpreterBlockCache::InterpreterBlockCache()
+	: m_invalidations(0)
+{
+	memset(m_fast_lookup, 0, sizeof(m_fast_lookup));
+}
+
+bool InterpreterBlockCache::Decode(u32 address, Block* block)
+{
+	block->address = address;
+	for (u32 i = 0; i < MAX_BLOCK_SIZE; i++)
+	{
+		u32 pc = address + i * 4;
+
+		// HLE hooks, fetch exceptions and unknown instructions are left to
+		// SingleStepInner.
+		if (HLE::GetFunctionIndex(pc))
+			break;
+		PowerPC::TryReadInstResult read = PowerPC::TryReadInstruction(pc);
+		if (!read.valid || read.hex == 0)
+			break;
+		UGeckoInstruction inst(read.hex);
+		GekkoOPInfo* info = GetOpInfo(inst);
+		if (info->type == OPTYPE_UNKNOWN)
+			break;
+
+		Instruction decoded;
+		decoded.func = GetInterpreterOp(inst);
+		decoded.inst = inst;
+		decoded.cycles = info->numCycles;
+		decoded.uses_fpu = (info->flags & FL_USE_FPU) != 0;
+		decoded.info = info;
+		block->instructions.push_back(decoded);
+
+		// Don't fetch ahead into the next page; it might not be mapped.
+		if ((info->flags & FL_ENDBLOCK) || ((pc + 4) & 0xfff) == 0)
+			break;
+	}
+	return !block->instructions.empty();
+}
+
+// Blocks are tracked by physical address the same way the JIT's are.
+u32 InterpreterBlockCache::GetFirstLine(const Block& block)
+{
+	return (block.address & 0x1FFFFFFF) / 32;
+}
+
+u32 InterpreterBlockCache::GetLastLine(const Block& block)
+{
+	return ((block.address & 0x1FFFFFFF) + (u32)block.instructions.size() * 4 - 1) / 32;
+}
+
+const InterpreterBlockCache::Block* InterpreterBlockCache::Lookup(u32 address)
+{
+	Block*& fast = m_fast_lookup[(address >> 2) & (FAST_LOOKUP_SIZE - 1)];
+	if (fast && fast->address == address)
+		return fast;
+
+	auto it = m_blocks.find(address);
+	if (it == m_blocks.end())
+	{
+		Block block;
+		if (!Decode(address, &block))
+			return nullptr;
+		it = m_blocks.emplace(address, std::move(block)).first;
+		for (u32 line = GetFirstLine(it->second); line <= GetLastLine(it->second); line++)
+			m_lines[line].push_back(address);
+	}
+	fast = &it->second;
+	return fast;
+}
+
+void InterpreterBlockCache::Erase(u32 address)
+{
+	auto it = m_blocks.find(address);
+	if (it == m_blocks.end())
+		return;
+
+	for (u32 line = GetFirstLine(it->second); line <= GetLastLine(it->second); line++)
+	{
+		auto line_it = m_lines.find(line);
+		std::vector<u32>& starts = line_it->second;
+		starts.erase(std::remove(starts.begin(), starts.end(), address), starts.end());
+		if (starts.empty())
+			m_lines.erase(line_it);
+	}
+
+	Block*& fast = m_fast_lookup[(address >> 2) & (FAST_LOOKUP_SIZE - 1)];
+	if (fast == &it->second)
+		fast = nullptr;
+	m_blocks.erase(it);
+}
+
+void InterpreterBlockCache::Invalidate(u32 address, u32 length)
+{
+	if (m_blocks.empty() || length == 0)
+		return;
+
+	u32 first_line = (address & 0x1FFFFFFF) / 32;
+	u32 last_line = (u32)(((u64)(address & 0x1FFFFFFF) + length - 1) / 32);
+
+	std::vector<u32> erase;
+	if (last_line - first_line >= m_blocks.size())
+	{
+		// Huge ranges are cheaper to check block by block.
+		for (const auto& entry : m_blocks)
+		{
+			if (GetFirstLine(entry.second) <= last_line && GetLastLine(entry.second) >= first_line)
+				erase.push_back(entry.first);
+		}
+	}
+	else
+	{
+		for (u32 line = first_line; line <= last_line; line++)
+		{
+			auto line_it = m_lines.find(line);
+			if (line_it != m_lines.end())
+				erase.insert(erase.end(), line_it->second.begin(), line_it->second.end());
+		}
+	}
+
+	if (erase.empty())
+		return;
+	for (u32 start : erase)
+		Erase(start);
+	m_invalidations++;
+}
+
+void InterpreterBlockCache::Clear()
+{
+	if (m_blocks.empty())
+		return;
+	m_blocks.clear();
+	m_lines.clear();
+	memset(m_fast_lookup, 0, sizeof(m_fast_lookup));
+	m_invalidations++;
+}
@@ -0,0 +1,68 @@
+// Copyright 2015 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <unordered_map>
+#include <vector>
+
+#include "Common/CommonTypes.h"
+#include "Core/PowerPC/Gekko.h"
+#include "Core/PowerPC/PPCTables.h"
+#include "Core/PowerPC/Interpreter/Interpreter.h"
+
+// Runs of instructions the interpreter has already fetched and decoded, each
+// with the handler the opcode tables resolve it to, so running them again
+// skips the fetch and the table walk. Blocks are dropped through the same
+// icache invalidation as the JIT's blocks.
+class InterpreterBlockCache
+{
+public:
+	struct Instruction
+	{
+		Interpreter::_interpreterInstruction func;
+		UGeckoInstruction inst;
+		int cycles;
+		bool uses_fpu;
+		GekkoOPInfo* info;
+	};
+
+	struct Block
+	{
+		u32 address;
+		std::vector<Instruction> instructions;
+	};
+
+	InterpreterBlockCache();
+
+	// The block starting at the address, decoded now if it isn't cached yet.
+	// nullptr if the instruction there has to go through SingleStepInner.
+	const Block* Lookup(u32 address);
+
+	void Invalidate(u32 address, u32 length);
+	void Clear();
+
+	// Bumped whenever blocks are dropped, so a running block can tell it may
+	// have been freed under it.
+	u32 GetInvalidationCount() const { return m_invalidations; }
+	size_t GetBlockCount() const { return m_blocks.size(); }
+
+private:
+	enum
+	{
+		MAX_BLOCK_SIZE = 64,
+		FAST_LOOKUP_SIZE = 0x1000,
+	};
+
+	static bool Decode(u32 address, Block* block);
+	static u32 GetFirstLine(const Block& block);
+	static u32 GetLastLine(const Block& block);
+	void Erase(u32 address);
+
+	std::unordered_map<u32, Block> m_blocks;
+	// Physical 32-byte line -> start addresses of the blocks covering it.
+	std::unordered_map<u32, std::vector<u32>> m_lines;
+	Block* m_fast_lookup[FAST_LOOKUP_SIZE];
+	u32 m_invalidations;
+};
@@ -10,10 +10,6 @@
 #include "Core/PowerPC/Interpreter/Interpreter.h"
 #include "Core/PowerPC/Interpreter/Interpreter_FPUtils.h"
 
-
-bool Interpreter::g_bReserve;
-u32  Interpreter::g_reserveAddr;
-
 u32 Interpreter::Helper_Get_EA(const UGeckoInstruction _inst)
 {
 	return _inst.RA ? (rGPR[_inst.RA] + _inst.SIMM_16) : (u32)_inst.SIMM_16;
@@ -331,10 +327,14 @@ void Interpreter::dcbf(UGeckoInstruction _inst)
 }
 
 void Interpreter::dcbi(UGeckoInstruction _inst)
+{
+	Helper_dcbi(Helper_Get_EA_X(_inst));
+}
+
+void Interpreter::Helper_dcbi(u32 address)
 {
 	// Removes a block from data cache. Since we don't emulate the data cache, we don't need to do anything to the data cache
 	// However, we invalidate the jit block cache on dcbi
-	u32 address = Helper_Get_EA_X(_inst);
 	JitInterface::InvalidateICache(address & ~0x1f, 32, false);
 
 	// The following detects a situation where the game is writing to the dcache at the address being DMA'd. As we do not
@@ -767,8 +767,8 @@ void Interpreter::lwarx(UGeckoInstruction _inst)
 	if (!(PowerPC::ppcState.Exceptions & EXCEPTION_DSI))
 	{
 		rGPR[_inst.RD] = temp;
-		g_bReserve = true;
-		g_reserveAddr = uAddress;
+		PowerPC::ppcState.reserve = true;
+		PowerPC::ppcState.reserve_address = uAddress;
 	}
 }
 
@@ -776,16 +776,16 @@ void Interpreter::stwcxd(UGeckoInstruction _inst)
 {
 	// Stores Word Conditional indeXed
 	u32 uAddress;
-	if (g_bReserve)
+	if (PowerPC::ppcState.reserve)
 	{
 		uAddress = Helper_Get_EA_X(_inst);
 
-		if (uAddress == g_reserveAddr)
+		if (uAddress == PowerPC::ppcState.reserve_address)
 		{
 			PowerPC::Write_U32(rGPR[_inst.RS], uAddress);
 			if (!(PowerPC::ppcState.Exceptions & EXCEPTION_DSI))
 			{
-				g_bReserve = false;
+				PowerPC::ppcState.reserve = false;
 				SetCRField(0, 2 | GetXER_SO());
 				return;
 			}
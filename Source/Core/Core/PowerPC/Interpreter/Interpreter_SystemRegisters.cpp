@@ -3,7 +3,6 @@
 // Refer to the license.txt file included.
 
 #include "Common/CPUDetect.h"
-#include "Common/FPURoundMode.h"
 #include "Core/HW/GPFifo.h"
 #include "Core/HW/SystemTimers.h"
 #include "Core/PowerPC/Interpreter/Interpreter.h"
@@ -24,21 +23,6 @@ mffsx: 80036650 (huh?)
 // That is, set rounding mode etc when entering jit code or the interpreter loop
 // Restore rounding mode when calling anything external
 
-static void FPSCRtoFPUSettings(UReg_FPSCR fp)
-{
-	FPURoundMode::SetRoundMode(fp.RN);
-
-	if (fp.VE || fp.OE || fp.UE || fp.ZE || fp.XE)
-	{
-		//PanicAlert("FPSCR - exceptions enabled. Please report. VE=%i OE=%i UE=%i ZE=%i XE=%i",
-		//	fp.VE, fp.OE, fp.UE, fp.ZE, fp.XE);
-		// Pokemon Colosseum does this. Gah.
-	}
-
-	// Set SSE rounding mode and denormal handling
-	FPURoundMode::SetSIMDMode(fp.RN, fp.NI);
-}
-
 void Interpreter::mtfsb0x(UGeckoInstruction _inst)
 {
 	u32 b = 0x80000000 >> _inst.CRBD;
@@ -47,7 +31,7 @@ void Interpreter::mtfsb0x(UGeckoInstruction _inst)
 		PanicAlert("mtfsb0 clears bit %d, PC=%x", _inst.CRBD, PC);*/
 
 	FPSCR.Hex &= ~b;
-	FPSCRtoFPUSettings(FPSCR);
+	PowerPC::RoundingModeUpdated();
 
 	if (_inst.Rc)
 		PanicAlert("mtfsb0x: inst_.Rc");
@@ -61,7 +45,7 @@ void Interpreter::mtfsb1x(UGeckoInstruction _inst)
 		SetFPException(b);
 	else
 		FPSCR.Hex |= b;
-	FPSCRtoFPUSettings(FPSCR);
+	PowerPC::RoundingModeUpdated();
 
 	if (_inst.Rc)
 		PanicAlert("mtfsb1x: inst_.Rc");
@@ -78,7 +62,7 @@ void Interpreter::mtfsfix(UGeckoInstruction _inst)
 
 	FPSCR.Hex = (FPSCR.Hex & ~mask) | (imm >> (4 * _inst.CRFD));
 
-	FPSCRtoFPUSettings(FPSCR);
+	PowerPC::RoundingModeUpdated();
 
 	if (_inst.Rc)
 		PanicAlert("mtfsfix: inst_.Rc");
@@ -99,7 +83,7 @@ void Interpreter::mtfsfx(UGeckoInstruction _inst)
 		PanicAlert("mtfsf clears %08x, PC=%x", cleared, PC);*/
 
 	FPSCR.Hex = (FPSCR.Hex & ~m) | ((u32)(riPS0(_inst.FB)) & m);
-	FPSCRtoFPUSettings(FPSCR);
+	PowerPC::RoundingModeUpdated();
 
 	if (_inst.Rc)
 		PanicAlert("mtfsfx: inst_.Rc");
@@ -170,6 +154,7 @@ static void SetSR(int index, u32 value)
 {
 	DEBUG_LOG(POWERPC, "%08x: MMU: Segment register %i set to %08x", PowerPC::ppcState.pc, index, value);
 	PowerPC::ppcState.sr[index] = value;
+	PowerPC::SRUpdated();
 }
 
 void Interpreter::mtsr(UGeckoInstruction _inst)
@@ -349,6 +334,17 @@ void Interpreter::mtspr(UGeckoInstruction _inst)
 		PowerPC::SDRUpdated();
 		break;
 
+	case SPR_DBAT0U: case SPR_DBAT0L:
+	case SPR_DBAT1U: case SPR_DBAT1L:
+	case SPR_DBAT2U: case SPR_DBAT2L:
+	case SPR_DBAT3U: case SPR_DBAT3L:
+	case SPR_DBAT4U: case SPR_DBAT4L:
+	case SPR_DBAT5U: case SPR_DBAT5L:
+	case SPR_DBAT6U: case SPR_DBAT6L:
+	case SPR_DBAT7U: case SPR_DBAT7L:
+		PowerPC::DBATUpdated();
+		break;
+
 	case SPR_XER:
 		SetXER(rSPR(iIndex));
 		break;
@@ -2,6 +2,8 @@
 // Licensed under GPLv2+
 // Refer to the license.txt file included.
 
+#include <algorithm>
+#include <cinttypes>
 #include <map>
 #include <string>
 
@@ -12,6 +14,10 @@
 
 #include "Common/CommonTypes.h"
 #include "Common/StringUtil.h"
+#include "Common/Thread.h"
+#include "Common/Timer.h"
+#include "Core/Movie.h"
+#include "Core/NetPlayProto.h"
 #include "Core/PatchEngine.h"
 #include "Core/HLE/HLE.h"
 #include "Core/HW/ProcessorInterface.h"
@@ -21,6 +27,7 @@
 #include "Core/PowerPC/Jit64/Jit64_Tables.h"
 #include "Core/PowerPC/Jit64/JitAsm.h"
 #include "Core/PowerPC/Jit64/JitRegCache.h"
+#include "Core/PowerPC/JitCommon/JitLockstep.h"
 #if defined(_DEBUG) || defined(DEBUGFAST)
 #include "Common/GekkoDisassembler.h"
 #endif
@@ -174,11 +181,33 @@ bool Jit64::HandleFault(uintptr_t access_address, SContext* ctx)
 
 void Jit64::Init()
 {
+	jo.lockstep = SConfig::GetInstance().m_LocalCoreStartupParameter.bJITLockstep;
 	EnableBlockLink();
 
 	jo.optimizeGatherPipe = true;
 	jo.accurateSinglePrecision = true;
+	// Every block has to be compiled for lockstep to compare it.
+	jo.tierThreshold = jo.lockstep ? 0 : SConfig::GetInstance().m_LocalCoreStartupParameter.iJITTierThreshold;
 	UpdateMemoryOptions();
+	m_cold_block_counts.clear();
+	m_interpreted_blocks = 0;
+	m_branch_profile.clear();
+	m_trace_blocks = 0;
+	m_trace_instructions = 0;
+	m_trace_followed_branches = 0;
+	m_reg_entry_loads_avoided = 0;
+	m_block_stats = nullptr;
+	m_dead_cr_removed = 0;
+	m_dead_ca_removed = 0;
+	m_dead_ov_removed = 0;
+	m_dead_instructions_removed = 0;
+	m_constants_folded = 0;
+	m_constant_addresses = 0;
+	m_code_gc = SConfig::GetInstance().m_LocalCoreStartupParameter.bJITCodeGC;
+	m_count_block_runs = false;
+	if (jo.lockstep)
+		JitLockstep::Reset();
+	analyzer.SetBranchProfile(&m_branch_profile);
 	js.fastmemLoadStore = nullptr;
 	js.compilerPC = 0;
 
@@ -203,11 +232,20 @@ void Jit64::Init()
 	// important: do this *after* generating the global asm routines, because we can't use farcode in them.
 	// it'll crash because the farcode functions get cleared on JIT clears.
 	farcode.Init(jo.memcheck ? FARCODE_SIZE_MMU : FARCODE_SIZE);
+	m_far_code_start = farcode.GetWritableCodePtr();
+	m_far_chunk_size = (jo.memcheck ? FARCODE_SIZE_MMU : FARCODE_SIZE) / CODE_CHUNKS;
+	ResetCodeChunks();
 
 	code_block.m_stats = &js.st;
 	code_block.m_gpa = &js.gpa;
 	code_block.m_fpa = &js.fpa;
 	EnableOptimization();
+
+	m_compile_pending.Clear();
+	m_compile_thread_exit.Clear();
+	m_background_compiles = 0;
+	if (SConfig::GetInstance().m_LocalCoreStartupParameter.bJITBackgroundCompile)
+		m_compile_thread = std::thread(&Jit64::CompileThread, this);
 }
 
 void Jit64::ClearCache()
@@ -216,12 +254,207 @@ void Jit64::ClearCache()
 	trampolines.ClearCodeSpace();
 	farcode.ClearCodeSpace();
 	ClearCodeSpace();
+	ResetCodeChunks();
 	UpdateMemoryOptions();
 	m_clear_cache_asap = false;
 }
 
+u8* Jit64::GetNearChunk(int chunk)
+{
+	return region + EXIT_STUB_SPACE + chunk * ((CODE_SIZE - EXIT_STUB_SPACE) / CODE_CHUNKS);
+}
+
+u8* Jit64::GetFarChunk(int chunk)
+{
+	return m_far_code_start + chunk * m_far_chunk_size;
+}
+
+void Jit64::ResetCodeChunks()
+{
+	m_exit_stubs = region;
+	m_exit_stub_map.clear();
+	m_code_chunk_order.clear();
+	m_code_chunk = -1;
+	if (m_code_gc)
+		SwitchCodeChunk();
+}
+
+// Invalidated blocks still count until their chunk is evicted, so a chunk's
+// count never drops below the one taken at the last switch.
+void Jit64::CountChunkRuns(std::array<s64, CODE_CHUNKS>* runs)
+{
+	runs->fill(0);
+	for (int i = 0; i < blocks.GetNumBlocks(); i++)
+	{
+		const JitBlock* b = blocks.GetBlock(i);
+		if (b->checkedEntry)
+			(*runs)[(b->checkedEntry - GetNearChunk(0)) / (GetNearChunk(1) - GetNearChunk(0))] += (s64)b->runCount;
+	}
+}
+
+void Jit64::SwitchCodeChunk()
+{
+	std::array<s64, CODE_CHUNKS> runs;
+	CountChunkRuns(&runs);
+
+	int chunk = -1;
+	if (m_code_chunk_order.size() < CODE_CHUNKS)
+	{
+		for (chunk = 0; std::find(m_code_chunk_order.begin(), m_code_chunk_order.end(), chunk) != m_code_chunk_order.end(); chunk++)
+		{
+		}
+	}
+	else if (!m_count_block_runs)
+	{
+		// Nothing has counted its runs yet, so there is no telling which chunk
+		// is cold. Start over, counting from now on.
+		m_count_block_runs = true;
+		ClearCache();
+		return;
+	}
+	else
+	{
+		// Evict the chunk whose blocks ran least since the last switch, the
+		// least recently filled one on a tie. Never the one we're leaving, its
+		// blocks haven't had a chance to run yet.
+		s64 coldest = 0;
+		for (int c : m_code_chunk_order)
+		{
+			s64 recent = runs[c] - m_code_chunk_runs[c];
+			if (c != m_code_chunk && (chunk < 0 || recent < coldest))
+			{
+				chunk = c;
+				coldest = recent;
+			}
+		}
+		if (!EvictCodeChunk(chunk))
+		{
+			ClearCache();
+			return;
+		}
+		m_code_chunk_order.erase(std::find(m_code_chunk_order.begin(), m_code_chunk_order.end(), chunk));
+		runs[chunk] = 0;
+	}
+
+	m_code_chunk_order.push_back(chunk);
+	m_code_chunk = chunk;
+	m_code_chunk_runs = runs;
+	SetCodePtr(GetNearChunk(chunk));
+	farcode.SetCodePtr(GetFarChunk(chunk));
+}
+
+template <typename T>
+static void EraseCodeRange(std::unordered_map<u8*, T>* map, const u8* start, const u8* end)
+{
+	for (auto it = map->begin(); it != map->end();)
+	{
+		if (it->first >= start && it->first < end)
+			it = map->erase(it);
+		else
+			++it;
+	}
+}
+
+bool Jit64::EvictCodeChunk(int chunk)
+{
+	JitBaseBlockCache::CodeRanges ranges = {
+		std::make_pair(GetNearChunk(chunk), GetNearChunk(chunk + 1)),
+		std::make_pair(GetFarChunk(chunk), GetFarChunk(chunk + 1)),
+	};
+
+	// Every block in the chunk, evicted now or destroyed earlier, may need an
+	// exit stub.
+	size_t stubs = 0;
+	for (int i = 0; i < blocks.GetNumBlocks(); i++)
+	{
+		const u8* entry = blocks.GetBlock(i)->checkedEntry;
+		if (entry >= ranges[0].first && entry < ranges[0].second)
+			stubs++;
+	}
+	if (m_exit_stubs + stubs * EXIT_STUB_SIZE > region + EXIT_STUB_SPACE)
+		return false;
+
+	blocks.EvictBlocks(ranges, [this](u32 address) { return GetExitStub(address); });
+	for (const auto& range : ranges)
+	{
+		trampolines.ForgetSites(range.first, range.second);
+		EraseCodeRange(&registersInUseAtLoc, range.first, range.second);
+		EraseCodeRange(&pcAtLoc, range.first, range.second);
+		EraseCodeRange(&exceptionHandlerAtLoc, range.first, range.second);
+	}
+	return true;
+}
+
+const u8* Jit64::GetExitStub(u32 address)
+{
+	auto it = m_exit_stub_map.find(address);
+	if (it != m_exit_stub_map.end())
+		return it->second;
+
+	u8* near_code = GetWritableCodePtr();
+	SetCodePtr(m_exit_stubs);
+	const u8* stub = GetCodePtr();
+	MOV(32, PPCSTATE(pc), Imm32(address));
+	JMP(asm_routines.dispatcher, true);
+	_assert_msg_(DYNA_REC, GetCodePtr() - stub <= EXIT_STUB_SIZE, "Exit stub too large");
+	m_exit_stubs = GetWritableCodePtr();
+	SetCodePtr(near_code);
+
+	m_exit_stub_map[address] = stub;
+	return stub;
+}
+
 void Jit64::Shutdown()
 {
+	if (m_compile_thread.joinable())
+	{
+		WaitForBackgroundCompile();
+		m_compile_thread_exit.Set();
+		m_compile_request.Set();
+		m_compile_thread.join();
+		NOTICE_LOG(DYNA_REC, "Background compilation: %" PRIu64 " blocks compiled off the CPU thread", m_background_compiles);
+	}
+
+	if (jo.tierThreshold)
+	{
+		NOTICE_LOG(DYNA_REC, "Tiered compilation: %" PRIu64 " block executions interpreted, %u block starts never compiled",
+		           m_interpreted_blocks, (u32)m_cold_block_counts.size());
+	}
+	LogTraceStats();
+	if (blocks.GetRegEntryLinks())
+	{
+		NOTICE_LOG(DYNA_REC, "Register entry conventions: %" PRIu64 " exits linked to register entries, skipping "
+		           "%" PRIu64 " register loads per traversal; %" PRIu64 " loads skipped at runtime (block profiling only)",
+		           blocks.GetRegEntryLinks(), blocks.GetRegEntryLoadsAvoided(), m_reg_entry_loads_avoided);
+	}
+	if (m_dead_cr_removed || m_dead_ca_removed || m_dead_ov_removed || m_dead_instructions_removed)
+	{
+		NOTICE_LOG(DYNA_REC, "Dead code elimination for %s: %" PRIu64 " CR, %" PRIu64 " CA and %" PRIu64 " OV "
+		           "computations removed, %" PRIu64 " instructions skipped",
+		           SConfig::GetInstance().m_LocalCoreStartupParameter.GetUniqueID().c_str(),
+		           m_dead_cr_removed, m_dead_ca_removed, m_dead_ov_removed, m_dead_instructions_removed);
+	}
+	if (m_constants_folded || m_constant_addresses)
+	{
+		NOTICE_LOG(DYNA_REC, "Constant propagation: %" PRIu64 " instructions folded, %" PRIu64 " load/store addresses "
+		           "known at compile time", m_constants_folded, m_constant_addresses);
+	}
+	if (trampolines.GetNumSites())
+	{
+		NOTICE_LOG(DYNA_REC, "Trampolines: %" PRIu64 " sites backpatched, %" PRIu64 " shared an existing body (%.1f%%); "
+		           "%" PRIu64 " compactions reclaimed %" PRIu64 " bytes",
+		           trampolines.GetNumSites(), trampolines.GetNumBodiesReused(),
+		           100.0 * (double)trampolines.GetNumBodiesReused() / (double)trampolines.GetNumSites(),
+		           trampolines.GetNumCompactions(), trampolines.GetBytesReclaimed());
+	}
+	const JitEvictionStats& evictions = blocks.GetEvictionStats();
+	if (evictions.evictions)
+	{
+		NOTICE_LOG(DYNA_REC, "Code space reclamation: %" PRIu64 " chunk evictions dropped %" PRIu64 " blocks; "
+		           "%" PRIu64 " of them were recompiled in %" PRIu64 " us",
+		           evictions.evictions, evictions.blocks_evicted, evictions.recompiles, evictions.recompile_us);
+	}
+
 	FreeStack();
 	FreeCodeSpace();
 
@@ -241,6 +474,11 @@ void Jit64::WriteCallInterpreter(UGeckoInstruction inst)
 		MOV(32, PPCSTATE(pc), Imm32(js.compilerPC));
 		MOV(32, PPCSTATE(npc), Imm32(js.compilerPC + 4));
 	}
+	if (Profiler::g_ExecutionStats)
+	{
+		MOV(64, R(RSCRATCH), Imm64((u64)&GetOpInfo(inst)->fallbackCount));
+		ADD(64, MatR(RSCRATCH), Imm8(1));
+	}
 	Interpreter::_interpreterInstruction instr = GetInterpreterOp(inst);
 	ABI_PushRegistersAndAdjustStack({}, 0);
 	ABI_CallFunctionC((void*)instr, inst.hex);
@@ -256,8 +494,11 @@ void Jit64::HLEFunction(UGeckoInstruction _inst)
 {
 	gpr.Flush();
 	fpr.Flush();
+	// The index is known at compile time, so call the function directly rather
+	// than looking it up in HLE::Execute.
+	MOV(32, PPCSTATE(pc), Imm32(js.compilerPC));
 	ABI_PushRegistersAndAdjustStack({}, 0);
-	ABI_CallFunctionCC((void*)&HLE::Execute, js.compilerPC, _inst.hex);
+	ABI_CallFunction((void*)HLE::GetFunctionPointer(_inst.hex));
 	ABI_PopRegistersAndAdjustStack({}, 0);
 }
 
@@ -294,6 +535,13 @@ bool Jit64::Cleanup()
 {
 	bool did_something = false;
 
+	// Doesn't disturb RSCRATCH or any register the caller cares about.
+	if (m_block_stats)
+	{
+		MOV(64, R(RSCRATCH2), Imm64((u64)&m_block_stats->cycles));
+		ADD(64, MatR(RSCRATCH2), Imm32(js.downcountAmount));
+	}
+
 	if (jo.optimizeGatherPipe && js.fifoBytesThisBlock > 0)
 	{
 		ABI_PushRegistersAndAdjustStack({}, 0);
@@ -319,7 +567,19 @@ void Jit64::WriteExit(u32 destination, bool bl, u32 after)
 	if (!m_enable_blr_optimization)
 		bl = false;
 
-	Cleanup();
+	// If the exit comes straight after flushing both register caches, the
+	// flushed registers are still in their host registers and a linked block
+	// can take them from there.
+	JitRegMap regs;
+	bool have_regs = gpr.GetFlushEnd() == fpr.GetFlushStart() && fpr.GetFlushEnd() == GetCodePtr();
+	if (have_regs)
+	{
+		regs.gpr = gpr.GetFlushedRegs();
+		regs.fpr = fpr.GetFlushedRegs();
+	}
+
+	if (Cleanup())
+		have_regs = false;
 
 	if (bl)
 	{
@@ -329,16 +589,18 @@ void Jit64::WriteExit(u32 destination, bool bl, u32 after)
 
 	SUB(32, PPCSTATE(downcount), Imm32(js.downcountAmount));
 
-	JustWriteExit(destination, bl, after);
+	JustWriteExit(destination, bl, after, have_regs ? &regs : nullptr);
 }
 
-void Jit64::JustWriteExit(u32 destination, bool bl, u32 after)
+void Jit64::JustWriteExit(u32 destination, bool bl, u32 after, const JitRegMap* regs)
 {
 	//If nobody has taken care of this yet (this can be removed when all branches are done)
 	JitBlock *b = js.curBlock;
 	JitBlock::LinkData linkData;
 	linkData.exitAddress = destination;
 	linkData.linkStatus = false;
+	if (regs)
+		linkData.exitRegs = *regs;
 
 	// Link opportunity!
 	int block;
@@ -346,7 +608,7 @@ void Jit64::JustWriteExit(u32 destination, bool bl, u32 after)
 	{
 		// It exists! Joy of joy!
 		JitBlock* jb = blocks.GetBlock(block);
-		const u8* addr = jb->checkedEntry;
+		const u8* addr = blocks.GetLinkTarget(linkData, *jb);
 		linkData.exitPtrs = GetWritableCodePtr();
 		if (bl)
 			CALL(addr);
@@ -356,6 +618,8 @@ void Jit64::JustWriteExit(u32 destination, bool bl, u32 after)
 	}
 	else
 	{
+		if (regs && jo.enableBlocklink)
+			blocks.SetEntryHint(destination, *regs);
 		MOV(32, PPCSTATE(pc), Imm32(destination));
 		linkData.exitPtrs = GetWritableCodePtr();
 		if (bl)
@@ -453,8 +717,25 @@ void Jit64::WriteExternalExceptionExit()
 	JMP(asm_routines.dispatcher, true);
 }
 
+// For branches the analyzer marked as closing an idle loop. The registers have
+// to be flushed already.
+void Jit64::WriteIdleExit(u32 destination)
+{
+	ABI_PushRegistersAndAdjustStack({}, 0);
+	ABI_CallFunctionC((void *)&PowerPC::OnIdleLoop, destination);
+	ABI_PopRegistersAndAdjustStack({}, 0);
+	MOV(32, PPCSTATE(pc), Imm32(destination));
+	WriteExceptionExit();
+}
+
 void Jit64::Run()
 {
+	if (jo.lockstep)
+	{
+		JitLockstep::Run();
+		return;
+	}
+
 	CompiledCode pExecAddr = (CompiledCode)asm_routines.enterCode;
 	pExecAddr();
 }
@@ -490,9 +771,16 @@ void Jit64::Trace()
 
 void Jit64::Jit(u32 em_address)
 {
+	if (m_code_gc && !blocks.IsFull() && !m_clear_cache_asap &&
+	    (GetNearChunk(m_code_chunk + 1) - GetCodePtr() < 0x10000 ||
+	     GetFarChunk(m_code_chunk + 1) - farcode.GetCodePtr() < 0x10000))
+	{
+		SwitchCodeChunk();
+	}
+
 	if (GetSpaceLeft() < 0x10000 ||
 	    farcode.GetSpaceLeft() < 0x10000 ||
-	    trampolines.GetSpaceLeft() < 0x10000 ||
+	    (trampolines.GetSpaceLeft() < 0x10000 && !CompactTrampolines()) ||
 	    blocks.IsFull() ||
 	    SConfig::GetInstance().m_LocalCoreStartupParameter.bJITNoBlockCache ||
 	    m_clear_cache_asap)
@@ -500,6 +788,9 @@ void Jit64::Jit(u32 em_address)
 		ClearCache();
 	}
 
+	if (InterpretColdBlock(em_address))
+		return;
+
 	int blockSize = code_buffer.GetSize();
 
 	if (SConfig::GetInstance().m_LocalCoreStartupParameter.bEnableDebugging)
@@ -521,6 +812,10 @@ void Jit64::Jit(u32 em_address)
 				analyzer.ClearOption(PPCAnalyst::PPCAnalyzer::OPTION_BRANCH_MERGE);
 				analyzer.ClearOption(PPCAnalyst::PPCAnalyzer::OPTION_CROR_MERGE);
 				analyzer.ClearOption(PPCAnalyst::PPCAnalyzer::OPTION_CARRY_MERGE);
+				analyzer.ClearOption(PPCAnalyst::PPCAnalyzer::OPTION_BRANCH_FOLLOW);
+				analyzer.ClearOption(PPCAnalyst::PPCAnalyzer::OPTION_DEAD_CODE_ELIM);
+				analyzer.ClearOption(PPCAnalyst::PPCAnalyzer::OPTION_CONSTANT_PROPAGATION);
+				analyzer.ClearOption(PPCAnalyst::PPCAnalyzer::OPTION_IDLE_LOOP_DETECTION);
 			}
 			Trace();
 		}
@@ -528,6 +823,8 @@ void Jit64::Jit(u32 em_address)
 
 	// Analyze the block, collect all instructions it is made of (including inlining,
 	// if that is enabled), reorder instructions for optimal performance, and join joinable instructions.
+	if (jo.lockstep)
+		blockSize = std::min(blockSize, JitLockstep::GetMaxBlockSize());
 	u32 nextPC = analyzer.Analyze(em_address, &code_block, &code_buffer, blockSize);
 
 	if (code_block.m_memory_exception)
@@ -540,23 +837,100 @@ void Jit64::Jit(u32 em_address)
 		return;
 	}
 
+	if (jo.lockstep)
+	{
+		m_last_block_path.clear();
+		for (u32 i = 0; i < code_block.m_num_instructions; i++)
+			m_last_block_path.push_back(code_buffer.codebuffer[i].address);
+	}
+
 	int block_num = blocks.AllocateBlock(em_address);
+
+	if (m_compile_thread.joinable() && CanCompileInBackground())
+	{
+		m_compile_block_num = block_num;
+		m_compile_next_pc = nextPC;
+		m_compile_done.Reset();
+		m_compile_pending.Set();
+		m_compile_request.Set();
+		InterpretWhileCompiling();
+		return;
+	}
+
 	JitBlock *b = blocks.GetBlock(block_num);
 	blocks.FinalizeBlock(block_num, jo.enableBlocklink, DoJit(em_address, &code_buffer, b, nextPC));
 }
 
+bool Jit64::CanCompileInBackground() const
+{
+	// Which blocks end up interpreted depends on host timing, and the JIT and
+	// the interpreter are not bit-identical for every instruction, so anything
+	// that needs to be reproducible compiles synchronously.
+	return !Movie::IsMovieActive() &&
+	       !NetPlay::IsNetPlayRunning() &&
+	       !SConfig::GetInstance().m_LocalCoreStartupParameter.bEnableDebugging &&
+	       !jo.lockstep &&
+	       !Profiler::g_ExecutionStats;
+}
+
+void Jit64::CompileThread()
+{
+	Common::SetCurrentThreadName("JIT compiler");
+
+	while (true)
+	{
+		m_compile_request.Wait();
+		if (m_compile_thread_exit.IsSet())
+			break;
+
+		// The CPU thread doesn't run JIT code, emit code or touch the block cache
+		// until m_compile_pending is cleared, so the emitters and the JIT state are
+		// ours until then.
+		JitBlock *b = blocks.GetBlock(m_compile_block_num);
+		blocks.FinalizeBlock(m_compile_block_num, jo.enableBlocklink, DoJit(b->originalAddress, &code_buffer, b, m_compile_next_pc));
+		m_background_compiles++;
+
+		m_compile_pending.Clear();
+		m_compile_done.Set();
+	}
+}
+
+void Jit64::InterpretWhileCompiling()
+{
+	// Keep the guest running in the interpreter, a block at a time, until the
+	// block is ready or the timeslice is used up. The dispatcher checks the
+	// downcount when we return.
+	while (m_compile_pending.IsSet() && PowerPC::ppcState.downcount > 0)
+		InterpretBlock();
+
+	WaitForBackgroundCompile();
+}
+
+void Jit64::WaitForBackgroundCompile()
+{
+	// m_compile_done is reset before every request and set after
+	// m_compile_pending is cleared, so this can't miss the wakeup.
+	if (m_compile_pending.IsSet())
+		m_compile_done.Wait();
+}
+
 const u8* Jit64::DoJit(u32 em_address, PPCAnalyst::CodeBuffer *code_buf, JitBlock *b, u32 nextPC)
 {
 	js.firstFPInstructionFound = false;
 	js.isLastInstruction = false;
 	js.blockStart = em_address;
 	js.fifoBytesThisBlock = 0;
+	js.pairedSplatEnd = nullptr;
 	js.curBlock = b;
 	jit->js.numLoadStoreInst = 0;
 	jit->js.numFloatingPointInst = 0;
 
 	PPCAnalyst::CodeOp *ops = code_buf->codebuffer;
 
+	// Time recompiles of evicted blocks for the profiler.
+	bool recompile = blocks.TakeEvicted(em_address);
+	u64 compile_start = recompile ? Common::Timer::GetTimeUs() : 0;
+
 	const u8 *start = AlignCode4(); // TODO: Test if this or AlignCode16 make a difference from GetCodePtr
 	b->checkedEntry = start;
 	b->runCount = 0;
@@ -577,11 +951,24 @@ const u8* Jit64::DoJit(u32 em_address, PPCAnalyst::CodeBuffer *code_buf, JitBloc
 		ABI_PopRegistersAndAdjustStack({}, 0);
 	}
 
+	// Execution counts are used by the profiler and to find cold code to evict.
+	if (Profiler::g_ProfileBlocks || m_count_block_runs)
+	{
+		MOV(64, R(RSCRATCH), Imm64((u64)&b->runCount));
+		ADD(64, MatR(RSCRATCH), Imm8(1));
+	}
+
+	// Exits add the cycles they charge in Cleanup.
+	m_block_stats = Profiler::g_ExecutionStats ? Profiler::GetBlockExecutionStats(js.blockStart) : nullptr;
+	if (m_block_stats)
+	{
+		MOV(64, R(RSCRATCH), Imm64((u64)&m_block_stats->runs));
+		ADD(64, MatR(RSCRATCH), Imm8(1));
+	}
+
 	// Conditionally add profiling code.
 	if (Profiler::g_ProfileBlocks)
 	{
-		MOV(64, R(RSCRATCH), Imm64((u64)&b->runCount));
-		ADD(32, MatR(RSCRATCH), Imm8(1));
 		b->ticCounter = 0;
 		b->ticStart = 0;
 		b->ticStop = 0;
@@ -598,6 +985,62 @@ const u8* Jit64::DoJit(u32 em_address, PPCAnalyst::CodeBuffer *code_buf, JitBloc
 	gpr.Start();
 	fpr.Start();
 
+	// If a predecessor exits here with guest registers still in host registers,
+	// adopt its allocation for the ones this block reads first. Entering through
+	// normalEntry loads them; linked predecessors that hold them already enter
+	// through regEntry and skip the loads.
+	JitRegMap hint;
+	if (jo.enableBlocklink && blocks.GetEntryHint(js.blockStart, &hint))
+	{
+		for (int reg : ops[0].regsIn | ops[0].gprInReg)
+		{
+			if (hint.gpr[reg] >= 0)
+			{
+				gpr.BindToRegisterAt(reg, (X64Reg)hint.gpr[reg]);
+				b->entryRegs.gpr[reg] = hint.gpr[reg];
+			}
+		}
+		for (int reg : ops[0].fregsIn | ops[0].fprInXmm)
+		{
+			if (hint.fpr[reg] >= 0)
+			{
+				fpr.BindToRegisterAt(reg, (X64Reg)hint.fpr[reg]);
+				b->entryRegs.fpr[reg] = hint.fpr[reg];
+			}
+		}
+
+		int loads = b->entryRegs.Count();
+		if (loads)
+		{
+			const u8* body = GetCodePtr();
+			SwitchToFarCode();
+				// Same downcount check as checkedEntry. At least as large as the
+				// code WriteDestroyBlock puts here.
+				b->regEntry = GetCodePtr();
+				FixupBranch timeout = J_CC(CC_BE);
+				if (Profiler::g_ProfileBlocks || m_count_block_runs)
+				{
+					MOV(64, R(RSCRATCH), Imm64((u64)&b->runCount));
+					ADD(64, MatR(RSCRATCH), Imm8(1));
+				}
+				if (m_block_stats)
+				{
+					MOV(64, R(RSCRATCH), Imm64((u64)&m_block_stats->runs));
+					ADD(64, MatR(RSCRATCH), Imm8(1));
+				}
+				if (Profiler::g_ProfileBlocks)
+				{
+					MOV(64, R(RSCRATCH), Imm64((u64)&m_reg_entry_loads_avoided));
+					ADD(64, MatR(RSCRATCH), Imm8(loads));
+				}
+				JMP(body, true);
+				SetJumpTarget(timeout);
+				MOV(32, PPCSTATE(pc), Imm32(js.blockStart));
+				JMP(asm_routines.doTiming, true);
+			SwitchToNearCode();
+		}
+	}
+
 	js.downcountAmount = 0;
 	if (!SConfig::GetInstance().m_LocalCoreStartupParameter.bEnableDebugging)
 		js.downcountAmount += PatchEngine::GetSpeedhackCycles(code_block.m_address);
@@ -706,6 +1149,14 @@ const u8* Jit64::DoJit(u32 em_address, PPCAnalyst::CodeBuffer *code_buf, JitBloc
 			SetJumpTarget(noExtIntEnable);
 		}
 
+		// Nothing keeps flags from one instruction to the next while this is
+		// on; see MergeAllowedNextInstructions.
+		if (m_block_stats)
+		{
+			MOV(64, R(RSCRATCH), Imm64((u64)&opinfo->runCount));
+			ADD(64, MatR(RSCRATCH), Imm8(1));
+		}
+
 		u32 function = HLE::GetFunctionIndex(ops[i].address);
 		if (function != 0)
 		{
@@ -769,6 +1220,14 @@ const u8* Jit64::DoJit(u32 em_address, PPCAnalyst::CodeBuffer *code_buf, JitBloc
 				SetJumpTarget(noBreakpoint);
 			}
 
+			// Anything emitted since the previous instruction (gather pipe checks, HLE
+			// hooks, breakpoints) may have clobbered a splat kept in XMM1. The preloads
+			// below only touch allocatable registers.
+			if (GetCodePtr() != js.pairedSplatEnd)
+				js.pairedSplatEnd = nullptr;
+
+			bool folded = UseKnownValues(ops[i]);
+
 			// If we have an input register that is going to be used again, load it pre-emptively,
 			// even if the instruction doesn't strictly need it in a register, to avoid redundant
 			// loads later. Of course, don't do this if we're already out of registers.
@@ -778,7 +1237,7 @@ const u8* Jit64::DoJit(u32 em_address, PPCAnalyst::CodeBuffer *code_buf, JitBloc
 			// prioritize the more important registers.
 			for (int reg : ops[i].regsIn)
 			{
-				if (gpr.NumFreeRegisters() < 2)
+				if (folded || gpr.NumFreeRegisters() < 2)
 					break;
 				if (ops[i].gprInReg[reg] && !gpr.R(reg).IsImm())
 					gpr.BindToRegister(reg, true, false);
@@ -791,7 +1250,8 @@ const u8* Jit64::DoJit(u32 em_address, PPCAnalyst::CodeBuffer *code_buf, JitBloc
 					fpr.BindToRegister(reg, true, false);
 			}
 
-			Jit64Tables::CompileInstruction(ops[i]);
+			if (!folded)
+				Jit64Tables::CompileInstruction(ops[i]);
 
 			if (jo.memcheck && (opinfo->flags & FL_LOADSTORE))
 			{
@@ -866,13 +1326,61 @@ const u8* Jit64::DoJit(u32 em_address, PPCAnalyst::CodeBuffer *code_buf, JitBloc
 	b->codeSize = (u32)(GetCodePtr() - normalEntry);
 	b->originalSize = code_block.m_num_instructions;
 
+	if (code_block.m_num_followed_branches)
+	{
+		// The block isn't one contiguous run of guest code, so tell the block
+		// cache where all of it lives for invalidation.
+		for (u32 i = 0; i < code_block.m_num_instructions; i++)
+		{
+			u32 pAddr = ops[i].address & 0x1FFFFFFF;
+			if (!b->physicalRanges.empty() && b->physicalRanges.back().second == pAddr)
+				b->physicalRanges.back().second += 4;
+			else
+				b->physicalRanges.emplace_back(pAddr, pAddr + 4);
+		}
+	}
+	m_trace_blocks++;
+	m_trace_instructions += code_block.m_num_instructions;
+	m_trace_followed_branches += code_block.m_num_followed_branches;
+	m_dead_instructions_removed += code_block.m_num_dead_instructions;
+
 #ifdef JIT_LOG_X86
 	LogGeneratedX86(code_block.m_num_instructions, code_buf, normalEntry, b);
 #endif
 
+	if (recompile)
+		blocks.AddRecompileTime(Common::Timer::GetTimeUs() - compile_start);
+
 	return normalEntry;
 }
 
+bool Jit64::UseKnownValues(const PPCAnalyst::CodeOp& op)
+{
+	if (op.knownOut && op.opinfo->type == OPTYPE_INTEGER && !op.outputCR0 && !op.outputCA && !op.outputOV &&
+	    !SConfig::GetInstance().m_LocalCoreStartupParameter.bJITIntegerOff)
+	{
+		gpr.SetImmediate32(*op.regsOut.begin(), op.valueOut);
+		m_constants_folded++;
+		return true;
+	}
+
+	// Hand the address registers to the load/store as immediates, so it can access
+	// RAM directly or inline the MMIO handler.
+	if (op.opinfo->flags & FL_LOADSTORE)
+	{
+		u32 a = op.inst.RA, b = op.inst.RB;
+		if (op.knownA && op.regsIn[a] && !gpr.R(a).IsImm())
+			gpr.SetImmediate32(a, op.valueA);
+		if (op.knownB && op.regsIn[b] && !gpr.R(b).IsImm())
+			gpr.SetImmediate32(b, op.valueB);
+
+		bool indexed = op.inst.OPCD == 31 || op.inst.OPCD == 4;
+		if ((!a || gpr.R(a).IsImm()) && (!indexed || gpr.R(b).IsImm()))
+			m_constant_addresses++;
+	}
+	return false;
+}
+
 BitSet32 Jit64::CallerSavedRegistersInUse()
 {
 	BitSet32 result;
@@ -889,7 +1397,7 @@ BitSet32 Jit64::CallerSavedRegistersInUse()
 void Jit64::EnableBlockLink()
 {
 	jo.enableBlocklink = true;
-	if (SConfig::GetInstance().m_LocalCoreStartupParameter.bJITNoBlockLinking)
+	if (SConfig::GetInstance().m_LocalCoreStartupParameter.bJITNoBlockLinking || jo.lockstep)
 		jo.enableBlocklink = false;
 }
 
@@ -899,4 +1407,11 @@ void Jit64::EnableOptimization()
 	analyzer.SetOption(PPCAnalyst::PPCAnalyzer::OPTION_BRANCH_MERGE);
 	analyzer.SetOption(PPCAnalyst::PPCAnalyzer::OPTION_CROR_MERGE);
 	analyzer.SetOption(PPCAnalyst::PPCAnalyzer::OPTION_CARRY_MERGE);
+	analyzer.SetOption(PPCAnalyst::PPCAnalyzer::OPTION_PAIRED_FUSION);
+	analyzer.SetOption(PPCAnalyst::PPCAnalyzer::OPTION_DEAD_CODE_ELIM);
+	analyzer.SetOption(PPCAnalyst::PPCAnalyzer::OPTION_CONSTANT_PROPAGATION);
+	if (SConfig::GetInstance().m_LocalCoreStartupParameter.bSkipIdle)
+		analyzer.SetOption(PPCAnalyst::PPCAnalyzer::OPTION_IDLE_LOOP_DETECTION);
+	if (SConfig::GetInstance().m_LocalCoreStartupParameter.bJITFollowBranch)
+		analyzer.SetOption(PPCAnalyst::PPCAnalyzer::OPTION_BRANCH_FOLLOW);
 }
@@ -18,6 +18,13 @@
 // ----------
 #pragma once
 
+#include <array>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "Common/Event.h"
+#include "Common/Flag.h"
 #include "Common/x64ABI.h"
 #include "Common/x64Analyzer.h"
 #include "Common/x64Emitter.h"
@@ -30,6 +37,7 @@
 #include "Core/PowerPC/PowerPC.h"
 #include "Core/PowerPC/PPCAnalyst.h"
 #include "Core/PowerPC/PPCTables.h"
+#include "Core/PowerPC/Profiler.h"
 #include "Core/PowerPC/Jit64/JitAsm.h"
 #include "Core/PowerPC/Jit64/JitRegCache.h"
 #include "Core/PowerPC/JitCommon/Jit_Util.h"
@@ -54,6 +62,63 @@ private:
 	bool m_clear_cache_asap;
 	u8* m_stack;
 
+	// Background compilation: the CPU thread analyzes and allocates a block,
+	// then interprets while the compile thread emits and finalizes it.
+	std::thread m_compile_thread;
+	Common::Event m_compile_request;
+	Common::Event m_compile_done;
+	Common::Flag m_compile_pending;
+	Common::Flag m_compile_thread_exit;
+	int m_compile_block_num;
+	u32 m_compile_next_pc;
+	u64 m_background_compiles;
+
+	// Incremented by register entries when block profiling is on.
+	u64 m_reg_entry_loads_avoided;
+
+	// Where the block being compiled counts its runs and cycles, while
+	// Profiler::g_ExecutionStats is set.
+	Profiler::BlockExecutionStats* m_block_stats;
+
+	// Flag and register computations dropped because nothing could observe them.
+	u64 m_dead_cr_removed;
+	u64 m_dead_ca_removed;
+	u64 m_dead_ov_removed;
+	u64 m_dead_instructions_removed;
+
+	// Instructions replaced by constants from the analyzer, and loads/stores whose
+	// address it knew.
+	u64 m_constants_folded;
+	u64 m_constant_addresses;
+
+	// Incremental code space reclamation (SCoreStartupParameter::bJITCodeGC).
+	// Near and far code are split into CODE_CHUNKS chunks each, behind the exit
+	// stubs in near code. Blocks are emitted into the current pair of chunks;
+	// once every pair has been used, the one whose blocks ran least since the
+	// last switch is evicted and reused instead of clearing the whole cache.
+	// Blocks only count their runs once that is needed: the first time the
+	// code space fills up, it is cleared as without the GC and counting
+	// starts. Most games never get there.
+	bool m_code_gc;
+	bool m_count_block_runs;
+	int m_code_chunk;
+	std::vector<int> m_code_chunk_order; // chunks in use, least recently filled first
+	std::array<s64, CODE_CHUNKS> m_code_chunk_runs; // block runs counted at the last switch
+	u8* m_far_code_start;
+	size_t m_far_chunk_size;
+	u8* m_exit_stubs;
+	std::unordered_map<u32, const u8*> m_exit_stub_map;
+
+	u8* GetNearChunk(int chunk);
+	u8* GetFarChunk(int chunk);
+	void CountChunkRuns(std::array<s64, CODE_CHUNKS>* runs);
+	bool EvictCodeChunk(int chunk);
+	const u8* GetExitStub(u32 address);
+	void ResetCodeChunks();
+
+	void CompileThread();
+	void InterpretWhileCompiling();
+
 public:
 	Jit64() : code_buffer(32000) {}
 	~Jit64() {}
@@ -71,16 +136,30 @@ public:
 	// Jit!
 
 	void Jit(u32 em_address) override;
+	void WaitForBackgroundCompile() override;
+	// Whether a block miss may be compiled on the compile thread right now.
+	bool CanCompileInBackground() const;
+	u64 GetBackgroundCompiles() const { return m_background_compiles; }
+	u64 GetRegEntryLoadsAvoided() const { return m_reg_entry_loads_avoided; }
 	const u8* DoJit(u32 em_address, PPCAnalyst::CodeBuffer *code_buf, JitBlock *b, u32 nextPC);
 
 	BitSet32 CallerSavedRegistersInUse();
 
+	// Uses the values PPCAnalyst::PropagateConstants found for an instruction. Returns
+	// true if the result is known, in which case there is nothing left to compile.
+	bool UseKnownValues(const PPCAnalyst::CodeOp& op);
+
 	JitBlockCache *GetBlockCache() override { return &blocks; }
 
 	void Trace();
 
 	void ClearCache() override;
 
+	// Moves code emission to an unused pair of chunks, or evicts the coldest
+	// one to make room. Jit() calls this when the current pair is nearly full.
+	void SwitchCodeChunk();
+	int GetCodeChunk() const { return m_code_chunk; }
+
 	const CommonAsmRoutines *GetAsmRoutines() override
 	{
 		return &asm_routines;
@@ -98,11 +177,12 @@ public:
 	// Utilities for use by opcodes
 
 	void WriteExit(u32 destination, bool bl = false, u32 after = 0);
-	void JustWriteExit(u32 destination, bool bl, u32 after);
+	void JustWriteExit(u32 destination, bool bl, u32 after, const JitRegMap* regs = nullptr);
 	void WriteExitDestInRSCRATCH(bool bl = false, u32 after = 0);
 	void WriteBLRExit();
 	void WriteExceptionExit();
 	void WriteExternalExceptionExit();
+	void WriteIdleExit(u32 destination);
 	void WriteRfiExitDestInRSCRATCH();
 	void WriteCallInterpreter(UGeckoInstruction _inst);
 	bool Cleanup();
@@ -134,6 +214,12 @@ public:
 	// is set or not.
 	Gen::FixupBranch JumpIfCRFieldBit(int field, int bit, bool jump_if_set = true);
 	void SetFPRFIfNeeded(Gen::X64Reg xmm);
+	// Calls PowerPC::RoundingModeUpdated after FPSCR's RN or NI bits change.
+	void UpdateRoundingMode();
+	// Brings FPSCR's VX and FEX bits up to date; leaves FPSCR in RSCRATCH.
+	void UpdateFPSCRSummary();
+	// Calls PowerPC::SRUpdated after a segment register changes.
+	void SegmentRegisterUpdated();
 
 	void MultiplyImmediate(u32 imm, int a, int d, bool overflow);
 
@@ -145,6 +231,7 @@ public:
 	void fp_tri_op(int d, int a, int b, bool reversible, bool single, void (Gen::XEmitter::*avxOp)(Gen::X64Reg, Gen::X64Reg, Gen::OpArg),
 	               void (Gen::XEmitter::*sseOp)(Gen::X64Reg, Gen::OpArg), UGeckoInstruction inst, bool packed = false, bool roundRHS = false);
 	void FloatCompare(UGeckoInstruction inst, bool upper = false);
+	void LoadPairedMultiplier(int c, int splat, bool round_input);
 
 	// OPCODES
 	void FallBackToInterpreter(UGeckoInstruction _inst);
@@ -172,6 +259,7 @@ public:
 
 	void sc(UGeckoInstruction _inst);
 	void rfi(UGeckoInstruction _inst);
+	void rfid(UGeckoInstruction inst);
 
 	void bx(UGeckoInstruction inst);
 	void bclrx(UGeckoInstruction _inst);
@@ -187,6 +275,18 @@ public:
 	void mfcr(UGeckoInstruction inst);
 	void mcrf(UGeckoInstruction inst);
 	void mcrxr(UGeckoInstruction inst);
+	void mcrfs(UGeckoInstruction inst);
+	void mffsx(UGeckoInstruction inst);
+	void mtfsb0x(UGeckoInstruction inst);
+	void mtfsb1x(UGeckoInstruction inst);
+	void mtfsfix(UGeckoInstruction inst);
+	void mtfsfx(UGeckoInstruction inst);
+	void mfsr(UGeckoInstruction inst);
+	void mfsrin(UGeckoInstruction inst);
+	void mtsr(UGeckoInstruction inst);
+	void mtsrin(UGeckoInstruction inst);
+	void tlbie(UGeckoInstruction inst);
+	void tlbia(UGeckoInstruction inst);
 
 	void boolX(UGeckoInstruction inst);
 	void crXXX(UGeckoInstruction inst);
@@ -213,6 +313,7 @@ public:
 	void frspx(UGeckoInstruction inst);
 	void frsqrtex(UGeckoInstruction inst);
 	void fresx(UGeckoInstruction inst);
+	void fsqrtx(UGeckoInstruction inst);
 
 	void cmpXX(UGeckoInstruction inst);
 
@@ -236,6 +337,7 @@ public:
 	void srwx(UGeckoInstruction inst);
 	void dcbt(UGeckoInstruction inst);
 	void dcbz(UGeckoInstruction inst);
+	void dcbx(UGeckoInstruction inst);
 
 	void subfic(UGeckoInstruction inst);
 	void subfx(UGeckoInstruction inst);
@@ -248,6 +350,13 @@ public:
 
 	void lmw(UGeckoInstruction inst);
 	void stmw(UGeckoInstruction inst);
+	void lswi(UGeckoInstruction inst);
+	void stswi(UGeckoInstruction inst);
+	void lswx(UGeckoInstruction inst);
+	void stswx(UGeckoInstruction inst);
+	void lwarx(UGeckoInstruction inst);
+	void stwcxd(UGeckoInstruction inst);
+	void ecxwx(UGeckoInstruction inst);
 
 	void icbi(UGeckoInstruction inst);
 };
@@ -113,7 +113,7 @@ static GekkoOPTemplate table4[] =
 	{592,  &Jit64::ps_mergeXX},            // ps_merge10
 	{624,  &Jit64::ps_mergeXX},            // ps_merge11
 
-	{1014, &Jit64::FallBackToInterpreter}, // dcbz_l
+	{1014, &Jit64::dcbz},                  // dcbz_l
 };
 
 static GekkoOPTemplate table4_2[] =
@@ -163,7 +163,7 @@ static GekkoOPTemplate table19[] =
 	{0,   &Jit64::mcrf},                  // mcrf
 
 	{50,  &Jit64::rfi},                   // rfi
-	{18,  &Jit64::FallBackToInterpreter}, // rfid
+	{18,  &Jit64::rfid},                  // rfid
 };
 
 
@@ -218,11 +218,11 @@ static GekkoOPTemplate table31[] =
 	{824, &Jit64::srawix},                 // srawix
 	{24,  &Jit64::slwx},                   // slwx
 
-	{54,   &Jit64::FallBackToInterpreter}, // dcbst
-	{86,   &Jit64::FallBackToInterpreter}, // dcbf
+	{54,   &Jit64::dcbx},                  // dcbst
+	{86,   &Jit64::dcbx},                  // dcbf
 	{246,  &Jit64::dcbt },                 // dcbtst
 	{278,  &Jit64::dcbt },                 // dcbt
-	{470,  &Jit64::FallBackToInterpreter}, // dcbi
+	{470,  &Jit64::dcbx},                  // dcbi
 	{758,  &Jit64::DoNothing},             // dcba
 	{1014, &Jit64::dcbz},                  // dcbz
 
@@ -247,12 +247,12 @@ static GekkoOPTemplate table31[] =
 	{790, &Jit64::lXXx},                   // lhbrx
 
 	// Conditional load/store (Wii SMP)
-	{150, &Jit64::FallBackToInterpreter},  // stwcxd
-	{20,  &Jit64::FallBackToInterpreter},  // lwarx
+	{150, &Jit64::stwcxd},                 // stwcxd
+	{20,  &Jit64::lwarx},                  // lwarx
 
-	//load string (interpret these)
-	{533, &Jit64::FallBackToInterpreter},  // lswx
-	{597, &Jit64::FallBackToInterpreter},  // lswi
+	//load string
+	{533, &Jit64::lswx},                   // lswx
+	{597, &Jit64::lswi},                   // lswi
 
 	//store word
 	{151, &Jit64::stXx},                   // stwx
@@ -270,8 +270,8 @@ static GekkoOPTemplate table31[] =
 	{662, &Jit64::stXx},                   // stwbrx
 	{918, &Jit64::stXx},                   // sthbrx
 
-	{661, &Jit64::FallBackToInterpreter},  // stswx
-	{725, &Jit64::FallBackToInterpreter},  // stswi
+	{661, &Jit64::stswx},                  // stswx
+	{725, &Jit64::stswi},                  // stswi
 
 	// fp load/store
 	{535, &Jit64::lfXXX},                  // lfsx
@@ -289,25 +289,25 @@ static GekkoOPTemplate table31[] =
 	{83,  &Jit64::mfmsr},                  // mfmsr
 	{144, &Jit64::mtcrf},                  // mtcrf
 	{146, &Jit64::mtmsr},                  // mtmsr
-	{210, &Jit64::FallBackToInterpreter},  // mtsr
-	{242, &Jit64::FallBackToInterpreter},  // mtsrin
+	{210, &Jit64::mtsr},                   // mtsr
+	{242, &Jit64::mtsrin},                 // mtsrin
 	{339, &Jit64::mfspr},                  // mfspr
 	{467, &Jit64::mtspr},                  // mtspr
 	{371, &Jit64::mftb},                   // mftb
 	{512, &Jit64::mcrxr},                  // mcrxr
-	{595, &Jit64::FallBackToInterpreter},  // mfsr
-	{659, &Jit64::FallBackToInterpreter},  // mfsrin
+	{595, &Jit64::mfsr},                   // mfsr
+	{659, &Jit64::mfsrin},                 // mfsrin
 
 	{4,   &Jit64::twX},                    // tw
 	{598, &Jit64::DoNothing},              // sync
 	{982, &Jit64::icbi},                   // icbi
 
 	// Unused instructions on GC
-	{310, &Jit64::FallBackToInterpreter},  // eciwx
-	{438, &Jit64::FallBackToInterpreter},  // ecowx
+	{310, &Jit64::ecxwx},                  // eciwx
+	{438, &Jit64::ecxwx},                  // ecowx
 	{854, &Jit64::DoNothing},              // eieio
-	{306, &Jit64::FallBackToInterpreter},  // tlbie
-	{370, &Jit64::FallBackToInterpreter},  // tlbia
+	{306, &Jit64::tlbie},                  // tlbie
+	{370, &Jit64::tlbia},                  // tlbia
 	{566, &Jit64::DoNothing},              // tlbsync
 };
 
@@ -337,12 +337,12 @@ static GekkoOPTemplate table63[] =
 	{40,  &Jit64::fsign},                 // fnegx
 	{12,  &Jit64::frspx},                 // frspx
 
-	{64,  &Jit64::FallBackToInterpreter}, // mcrfs
-	{583, &Jit64::FallBackToInterpreter}, // mffsx
-	{70,  &Jit64::FallBackToInterpreter}, // mtfsb0x
-	{38,  &Jit64::FallBackToInterpreter}, // mtfsb1x
-	{134, &Jit64::FallBackToInterpreter}, // mtfsfix
-	{711, &Jit64::FallBackToInterpreter}, // mtfsfx
+	{64,  &Jit64::mcrfs},                 // mcrfs
+	{583, &Jit64::mffsx},                 // mffsx
+	{70,  &Jit64::mtfsb0x},               // mtfsb0x
+	{38,  &Jit64::mtfsb1x},               // mtfsb1x
+	{134, &Jit64::mtfsfix},               // mtfsfix
+	{711, &Jit64::mtfsfx},                // mtfsfx
 };
 
 static GekkoOPTemplate table63_2[] =
@@ -350,7 +350,7 @@ static GekkoOPTemplate table63_2[] =
 	{18, &Jit64::fp_arith},              // fdivx
 	{20, &Jit64::fp_arith},              // fsubx
 	{21, &Jit64::fp_arith},              // faddx
-	{22, &Jit64::FallBackToInterpreter}, // fsqrtx
+	{22, &Jit64::fsqrtx},                // fsqrtx
 	{23, &Jit64::fselx},                 // fselx
 	{25, &Jit64::fp_arith},              // fmulx
 	{26, &Jit64::frsqrtex},              // frsqrtex
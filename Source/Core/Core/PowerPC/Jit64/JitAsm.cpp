@@ -42,6 +42,14 @@ void Jit64AsmRoutineManager::Generate()
 	//MOV(64, R(RMEM), Imm64((u64)Memory::physical_base));
 	MOV(64, R(RPPCSTATE), Imm64((u64)&PowerPC::ppcState + 0x80));
 
+	// In lockstep mode, JitLockstep does the timing and the exception checks
+	// itself, and every entry runs a single block.
+	bool lockstep = SConfig::GetInstance().m_LocalCoreStartupParameter.bJITLockstep;
+	FixupBranch lockstepEntry;
+	FixupBranch lockstepExit;
+	if (lockstep)
+		lockstepEntry = J(true);
+
 	const u8* outerLoop = GetCodePtr();
 		ABI_PushRegistersAndAdjustStack({}, 0);
 		ABI_CallFunction(reinterpret_cast<void *>(&CoreTiming::Advance));
@@ -66,6 +74,9 @@ void Jit64AsmRoutineManager::Generate()
 			// IMPORTANT - We jump on negative, not carry!!!
 			FixupBranch bail = J_CC(CC_BE, true);
 
+			if (lockstep)
+				lockstepExit = J(true);
+
 			FixupBranch dbg_exit;
 
 			if (SConfig::GetInstance().m_LocalCoreStartupParameter.bEnableDebugging)
@@ -81,6 +92,8 @@ void Jit64AsmRoutineManager::Generate()
 			}
 
 			SetJumpTarget(skipToRealDispatch);
+			if (lockstep)
+				SetJumpTarget(lockstepEntry);
 
 			dispatcherNoCheck = GetCodePtr();
 
@@ -189,11 +202,21 @@ void Jit64AsmRoutineManager::Generate()
 			// Jit might have cleared the code cache
 			ResetStack();
 
+			// In tiered mode, Jit might have run the block in the interpreter
+			// instead, which can use up the rest of the timeslice.
+			CMP(32, PPCSTATE(downcount), Imm8(0));
+			FixupBranch interpretedTimeout = J_CC(CC_LE, true);
+
 			JMP(dispatcherNoCheck, true); // no point in special casing this
 
 		SetJumpTarget(bail);
+		SetJumpTarget(interpretedTimeout);
 		doTiming = GetCodePtr();
 
+		FixupBranch lockstepTimeout;
+		if (lockstep)
+			lockstepTimeout = J(true);
+
 		// Test external exceptions.
 		TEST(32, PPCSTATE(Exceptions), Imm32(EXCEPTION_EXTERNAL_INT | EXCEPTION_PERFORMANCE_MONITOR | EXCEPTION_DECREMENTER));
 		FixupBranch noExtException = J_CC(CC_Z);
@@ -210,6 +233,11 @@ void Jit64AsmRoutineManager::Generate()
 	//Landing pad for drec space
 	if (SConfig::GetInstance().m_LocalCoreStartupParameter.bEnableDebugging)
 		SetJumpTarget(dbg_exit);
+	if (lockstep)
+	{
+		SetJumpTarget(lockstepExit);
+		SetJumpTarget(lockstepTimeout);
+	}
 	ResetStack();
 	if (m_stack_top)
 	{
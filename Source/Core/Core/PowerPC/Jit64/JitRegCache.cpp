@@ -11,7 +11,7 @@
 using namespace Gen;
 using namespace PowerPC;
 
-RegCache::RegCache() : emit(nullptr)
+RegCache::RegCache() : emit(nullptr), flush_start(nullptr), flush_end(nullptr)
 {
 }
 
@@ -30,6 +30,8 @@ void RegCache::Start()
 		regs[i].away = false;
 		regs[i].locked = false;
 	}
+	flush_start = nullptr;
+	flush_end = nullptr;
 
 	// todo: sort to find the most popular regs
 	/*
@@ -310,6 +312,18 @@ void RegCache::BindToRegister(size_t i, bool doLoad, bool makeDirty)
 	}
 }
 
+void RegCache::BindToRegisterAt(size_t i, X64Reg xr)
+{
+	_assert_msg_(DYNA_REC, !regs[i].away && xregs[xr].free && !xregs[xr].locked,
+		"BindToRegisterAt: reg %u or x64 reg %i already in use", (unsigned int)i, xr);
+	xregs[xr].free = false;
+	xregs[xr].ppcReg = i;
+	xregs[xr].dirty = false;
+	LoadRegister(i, xr);
+	regs[i].away = true;
+	regs[i].location = ::Gen::R(xr);
+}
+
 void RegCache::StoreFromRegister(size_t i, FlushMode mode)
 {
 	if (regs[i].away)
@@ -370,6 +384,14 @@ void RegCache::Flush(FlushMode mode, BitSet32 regsToFlush)
 			PanicAlert("Someone forgot to unlock X64 reg %u", i);
 	}
 
+	bool full_flush = regsToFlush == BitSet32::AllTrue(32);
+	if (full_flush)
+	{
+		for (size_t i = 0; i < regs.size(); i++)
+			flushed_regs[i] = IsBound(i) ? (s8)RX(i) : -1;
+		flush_start = emit->GetCodePtr();
+	}
+
 	for (unsigned int i : regsToFlush)
 	{
 		if (regs[i].locked)
@@ -389,6 +411,8 @@ void RegCache::Flush(FlushMode mode, BitSet32 regsToFlush)
 			}
 		}
 	}
+
+	flush_end = full_flush ? emit->GetCodePtr() : nullptr;
 }
 
 int RegCache::NumFreeRegisters()
@@ -49,6 +49,13 @@ protected:
 
 	Gen::XEmitter *emit;
 
+	// Where each register was when the last full flush started, and the code
+	// that flush emitted. The values are still in those host registers right
+	// after the flush.
+	std::array<s8, 32> flushed_regs;
+	const u8* flush_start;
+	const u8* flush_end;
+
 	float ScoreRegister(Gen::X64Reg xreg);
 
 public:
@@ -89,6 +96,8 @@ public:
 	//TODO - instead of doload, use "read", "write"
 	//read only will not set dirty flag
 	void BindToRegister(size_t preg, bool doLoad = true, bool makeDirty = true);
+	// Loads a register into a specific, free host register (block entry conventions).
+	void BindToRegisterAt(size_t preg, Gen::X64Reg xr);
 	void StoreFromRegister(size_t preg, FlushMode mode = FLUSH_ALL);
 	virtual void StoreRegister(size_t preg, Gen::OpArg newLoc) = 0;
 	virtual void LoadRegister(size_t preg, Gen::X64Reg newLoc) = 0;
@@ -154,6 +163,10 @@ public:
 
 	Gen::X64Reg GetFreeXReg();
 	int NumFreeRegisters();
+
+	const std::array<s8, 32>& GetFlushedRegs() const { return flushed_regs; }
+	const u8* GetFlushStart() const { return flush_start; }
+	const u8* GetFlushEnd() const { return flush_end; }
 };
 
 class GPRRegCache : public RegCache
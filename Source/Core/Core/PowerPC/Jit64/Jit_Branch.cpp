@@ -54,6 +54,17 @@ void Jit64::rfi(UGeckoInstruction inst)
 	WriteRfiExitDestInRSCRATCH();
 }
 
+void Jit64::rfid(UGeckoInstruction inst)
+{
+	INSTRUCTION_START
+	JITDISABLE(bJITBranchOff);
+
+	// Not a Gekko instruction; like the interpreter, just end the block.
+	gpr.Flush();
+	fpr.Flush();
+	WriteExit(js.compilerPC + 4);
+}
+
 void Jit64::bx(UGeckoInstruction inst)
 {
 	INSTRUCTION_START
@@ -84,11 +95,13 @@ void Jit64::bx(UGeckoInstruction inst)
 	if (inst.LK)
 		AND(32, PPCSTATE(cr), Imm32(~(0xFF000000)));
 #endif
+	if (js.op->branchIsIdleLoop)
+	{
+		WriteIdleExit(destination);
+		return;
+	}
 	if (destination == js.compilerPC)
 	{
-		//PanicAlert("Idle loop detected at %08x", destination);
-		// CALL(ProtectFunction(&CoreTiming::Idle, 0));
-		// JMP(Asm::testExceptions, true);
 		// make idle loops go faster
 		js.downcountAmount += 8;
 	}
@@ -131,9 +144,31 @@ void Jit64::bcx(UGeckoInstruction inst)
 	else
 		destination = js.compilerPC + SignExt16(inst.BD << 2);
 
+	if (js.op->branchFollowed && !js.isLastInstruction)
+	{
+		// Trace formation: the block continues at the destination, so it's the
+		// not-taken path that leaves the block.
+		if ((inst.BO & BO_DONT_CHECK_CONDITION) && (inst.BO & BO_DONT_DECREMENT_FLAG))
+			return;
+
+		FixupBranch taken = J(true);
+		if ((inst.BO & BO_DONT_CHECK_CONDITION) == 0)
+			SetJumpTarget(pConditionDontBranch);
+		if ((inst.BO & BO_DONT_DECREMENT_FLAG) == 0)
+			SetJumpTarget(pCTRDontBranch);
+		gpr.Flush(FLUSH_MAINTAIN_STATE);
+		fpr.Flush(FLUSH_MAINTAIN_STATE);
+		WriteExit(js.compilerPC + 4);
+		SetJumpTarget(taken);
+		return;
+	}
+
 	gpr.Flush(FLUSH_MAINTAIN_STATE);
 	fpr.Flush(FLUSH_MAINTAIN_STATE);
-	WriteExit(destination, inst.LK, js.compilerPC + 4);
+	if (js.op->branchIsIdleLoop)
+		WriteIdleExit(destination);
+	else
+		WriteExit(destination, inst.LK, js.compilerPC + 4);
 
 	if ((inst.BO & BO_DONT_CHECK_CONDITION) == 0)
 		SetJumpTarget(pConditionDontBranch);
@@ -126,7 +126,64 @@ void Jit64::fmaddXX(UGeckoInstruction inst)
 	// Note that FMA isn't necessarily less correct (it may actually be closer to correct) compared
 	// to what the Gekko does here; in deterministic mode, the important thing is multiple Dolphin
 	// instances on different computers giving identical results.
-	if (cpu_info.bFMA && !Core::g_want_determinism)
+	if (cpu_info.bFMA && !Core::g_want_determinism && d == b)
+	{
+		// FD == FB is the usual accumulator pattern: the 231 forms accumulate straight into d,
+		// so neither b nor the result has to go through XMM0. The scalar forms leave ps1 alone,
+		// like the MOVSD at the end of the generic path.
+		fpr.BindToRegister(d, true, true);
+		X64Reg cx = XMM0;
+		if (single && round_input)
+			Force25BitPrecision(XMM0, fpr.R(c), XMM1);
+		else if (fpr.R(c).IsSimpleReg())
+			cx = fpr.RX(c);
+		else
+			MOVAPD(XMM0, fpr.R(c));
+		switch (inst.SUBOP5)
+		{
+		case 28: //msub
+			if (packed)
+				VFMSUB231PD(fpr.RX(d), cx, fpr.R(a));
+			else
+				VFMSUB231SD(fpr.RX(d), cx, fpr.R(a));
+			break;
+		case 29: //madd
+			if (packed)
+				VFMADD231PD(fpr.RX(d), cx, fpr.R(a));
+			else
+				VFMADD231SD(fpr.RX(d), cx, fpr.R(a));
+			break;
+		// See below for why these are swapped.
+		case 30: //nmsub
+			if (packed)
+				VFNMADD231PD(fpr.RX(d), cx, fpr.R(a));
+			else
+				VFNMADD231SD(fpr.RX(d), cx, fpr.R(a));
+			break;
+		case 31: //nmadd
+			if (packed)
+				VFNMSUB231PD(fpr.RX(d), cx, fpr.R(a));
+			else
+				VFNMSUB231SD(fpr.RX(d), cx, fpr.R(a));
+			break;
+		}
+		if (single)
+		{
+			if (packed)
+			{
+				ForceSinglePrecisionP(fpr.RX(d), fpr.RX(d));
+			}
+			else
+			{
+				ForceSinglePrecisionS(fpr.RX(d), fpr.RX(d));
+				MOVDDUP(fpr.RX(d), fpr.R(d));
+			}
+		}
+		SetFPRFIfNeeded(fpr.RX(d));
+		fpr.UnlockAll();
+		return;
+	}
+	else if (cpu_info.bFMA && !Core::g_want_determinism)
 	{
 		if (single && round_input)
 			Force25BitPrecision(XMM0, fpr.R(c), XMM1);
@@ -171,30 +228,46 @@ void Jit64::fmaddXX(UGeckoInstruction inst)
 	{
 		// nmsub is implemented a little differently ((b - a*c) instead of -(a*c - b)), so handle it separately
 		if (single && round_input)
+		{
 			Force25BitPrecision(XMM1, fpr.R(c), XMM0);
-		else
-			MOVAPD(XMM1, fpr.R(c));
-		MOVAPD(XMM0, fpr.R(b));
-		if (packed)
+			if (packed)
+				MULPD(XMM1, fpr.R(a));
+			else
+				MULSD(XMM1, fpr.R(a));
+		}
+		else if (packed)
 		{
-			MULPD(XMM1, fpr.R(a));
-			SUBPD(XMM0, R(XMM1));
+			avx_op(&XEmitter::VMULPD, &XEmitter::MULPD, XMM1, fpr.R(c), fpr.R(a), true, true);
 		}
 		else
 		{
-			MULSD(XMM1, fpr.R(a));
-			SUBSD(XMM0, R(XMM1));
+			avx_op(&XEmitter::VMULSD, &XEmitter::MULSD, XMM1, fpr.R(c), fpr.R(a), false, true);
 		}
+		if (packed)
+			avx_op(&XEmitter::VSUBPD, &XEmitter::SUBPD, XMM0, fpr.R(b), R(XMM1), true);
+		else
+			avx_op(&XEmitter::VSUBSD, &XEmitter::SUBSD, XMM0, fpr.R(b), R(XMM1), false);
 	}
 	else
 	{
 		if (single && round_input)
+		{
 			Force25BitPrecision(XMM0, fpr.R(c), XMM1);
+			if (packed)
+				MULPD(XMM0, fpr.R(a));
+			else
+				MULSD(XMM0, fpr.R(a));
+		}
+		else if (packed)
+		{
+			avx_op(&XEmitter::VMULPD, &XEmitter::MULPD, XMM0, fpr.R(c), fpr.R(a), true, true);
+		}
 		else
-			MOVAPD(XMM0, fpr.R(c));
+		{
+			avx_op(&XEmitter::VMULSD, &XEmitter::MULSD, XMM0, fpr.R(c), fpr.R(a), false, true);
+		}
 		if (packed)
 		{
-			MULPD(XMM0, fpr.R(a));
 			if (inst.SUBOP5 == 28) //msub
 				SUBPD(XMM0, fpr.R(b));
 			else                   //(n)madd
@@ -202,7 +275,6 @@ void Jit64::fmaddXX(UGeckoInstruction inst)
 		}
 		else
 		{
-			MULSD(XMM0, fpr.R(a));
 			if (inst.SUBOP5 == 28)
 				SUBSD(XMM0, fpr.R(b));
 			else
@@ -501,6 +573,22 @@ void Jit64::frspx(UGeckoInstruction inst)
 	fpr.UnlockAll();
 }
 
+void Jit64::fsqrtx(UGeckoInstruction inst)
+{
+	INSTRUCTION_START
+	JITDISABLE(bJITFloatingPointOff);
+	FALLBACK_IF(inst.Rc);
+	int b = inst.FB;
+	int d = inst.FD;
+
+	fpr.Lock(b, d);
+	fpr.BindToRegister(d);
+	SQRTSD(XMM0, fpr.R(b));
+	MOVSD(fpr.R(d), XMM0);
+	SetFPRFIfNeeded(fpr.RX(d));
+	fpr.UnlockAll();
+}
+
 void Jit64::frsqrtex(UGeckoInstruction inst)
 {
 	INSTRUCTION_START
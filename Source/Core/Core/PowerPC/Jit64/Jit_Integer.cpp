@@ -24,6 +24,11 @@ void Jit64::GenerateConstantOverflow(bool overflow)
 		//XER[OV/SO] = 1
 		MOV(8, PPCSTATE(xer_so_ov), Imm8(XER_OV_MASK | XER_SO_MASK));
 	}
+	else if (!js.op->wantsOV)
+	{
+		// Nothing reads OV before it's overwritten, and SO is sticky, so there's nothing to clear.
+		m_dead_ov_removed++;
+	}
 	else
 	{
 		//XER[OV] = 0
@@ -34,6 +39,15 @@ void Jit64::GenerateConstantOverflow(bool overflow)
 // We could do overflow branchlessly, but unlike carry it seems to be quite a bit rarer.
 void Jit64::GenerateOverflow()
 {
+	if (!js.op->wantsOV)
+	{
+		// OV is dead, so only the sticky SO bit matters; this leaves the host flags alone.
+		m_dead_ov_removed++;
+		FixupBranch jno = J_CC(CC_NO);
+		MOV(8, PPCSTATE(xer_so_ov), Imm8(XER_OV_MASK | XER_SO_MASK));
+		SetJumpTarget(jno);
+		return;
+	}
 	FixupBranch jno = J_CC(CC_NO);
 	//XER[OV/SO] = 1
 	MOV(8, PPCSTATE(xer_so_ov), Imm8(XER_OV_MASK | XER_SO_MASK));
@@ -54,7 +68,11 @@ void Jit64::FinalizeCarry(CCFlags cond)
 {
 	js.carryFlagSet = false;
 	js.carryFlagInverted = false;
-	if (js.op->wantsCA)
+	if (!js.op->wantsCA)
+	{
+		m_dead_ca_removed++;
+	}
+	else
 	{
 		// Not actually merging instructions, but the effect is equivalent (we can't have breakpoints/etc in between).
 		if (MergeAllowedNextInstructions(1) && js.op[1].wantsCAInFlags)
@@ -84,7 +102,11 @@ void Jit64::FinalizeCarry(bool ca)
 {
 	js.carryFlagSet = false;
 	js.carryFlagInverted = false;
-	if (js.op->wantsCA)
+	if (!js.op->wantsCA)
+	{
+		m_dead_ca_removed++;
+	}
+	else
 	{
 		if (MergeAllowedNextInstructions(1) && js.op[1].wantsCAInFlags)
 		{
@@ -108,7 +130,14 @@ void Jit64::FinalizeCarry(bool ca)
 
 void Jit64::FinalizeCarryOverflow(bool oe, bool inv)
 {
-	if (oe)
+	if (oe && !js.op->wantsOV)
+	{
+		m_dead_ov_removed++;
+		FixupBranch jno = J_CC(CC_NO);
+		MOV(8, PPCSTATE(xer_so_ov), Imm8(XER_SO_MASK | XER_OV_MASK));
+		SetJumpTarget(jno);
+	}
+	else if (oe)
 	{
 		// Make sure not to lose the carry flags (not a big deal, this path is rare).
 		PUSHF();
@@ -131,6 +160,12 @@ void Jit64::FinalizeCarryOverflow(bool oe, bool inv)
 void Jit64::ComputeRC(const Gen::OpArg & arg, bool needs_test, bool needs_sext)
 {
 	_assert_msg_(DYNA_REC, arg.IsSimpleReg() || arg.IsImm(), "Invalid ComputeRC operand");
+	if (!js.op->wantsCR0)
+	{
+		// Overwritten before anything reads it; a merged branch would have wanted it.
+		m_dead_cr_removed++;
+		return;
+	}
 	if (arg.IsImm())
 	{
 		MOV(64, PPCSTATE(cr_val[0]), Imm32(arg.SImm32()));
@@ -358,7 +393,10 @@ void Jit64::DoMergedBranch()
 			destination = SignExt16(next.BD << 2);
 		else
 			destination = nextPC + SignExt16(next.BD << 2);
-		WriteExit(destination, next.LK, nextPC + 4);
+		if (js.op[1].branchIsIdleLoop)
+			WriteIdleExit(destination);
+		else
+			WriteExit(destination, next.LK, nextPC + 4);
 	}
 	else if ((next.OPCD == 19) && (next.SUBOP10 == 528)) // bcctrx
 	{
@@ -464,6 +502,12 @@ void Jit64::cmpXX(UGeckoInstruction inst)
 	int crf = inst.CRFD;
 	bool merge_branch = CheckMergedBranch(crf);
 
+	if (!merge_branch && !js.op->crfWanted[crf])
+	{
+		m_dead_cr_removed++;
+		return;
+	}
+
 	OpArg comparand;
 	bool signedCompare;
 	if (inst.OPCD == 31)
@@ -7,6 +7,8 @@
 
 #include "Common/CommonTypes.h"
 
+#include "Core/PowerPC/JitInterface.h"
+#include "Core/PowerPC/Interpreter/Interpreter.h"
 #include "Core/PowerPC/Jit64/Jit.h"
 #include "Core/PowerPC/Jit64/JitAsm.h"
 #include "Core/PowerPC/Jit64/JitRegCache.h"
@@ -310,12 +312,41 @@ void Jit64::dcbt(UGeckoInstruction inst)
 	}
 }
 
-// Zero cache line.
+// dcbst, dcbf and dcbi. Since we don't emulate the data cache, these only
+// drop the JIT blocks compiled from the line, in case new code was stored
+// there.
+void Jit64::dcbx(UGeckoInstruction inst)
+{
+	INSTRUCTION_START
+	JITDISABLE(bJITLoadStoreOff);
+
+	MOV(32, R(RSCRATCH), gpr.R(inst.RB));
+	if (inst.RA)
+		ADD(32, R(RSCRATCH), gpr.R(inst.RA));
+	AND(32, R(RSCRATCH), Imm32(~31));
+
+	BitSet32 registersInUse = CallerSavedRegistersInUse();
+	ABI_PushRegistersAndAdjustStack(registersInUse, 0);
+	if (inst.SUBOP10 == 470)
+	{
+		ABI_CallFunctionR((void *)&Interpreter::Helper_dcbi, RSCRATCH);
+	}
+	else
+	{
+		MOV(32, R(ABI_PARAM2), Imm32(32));
+		XOR(32, R(ABI_PARAM3), R(ABI_PARAM3));
+		ABI_CallFunctionR((void *)&JitInterface::InvalidateICache, RSCRATCH);
+	}
+	ABI_PopRegistersAndAdjustStack(registersInUse, 0);
+}
+
+// Zero cache line. Also dcbz_l, which zeroes the line in the locked cache
+// when the address is there.
 void Jit64::dcbz(UGeckoInstruction inst)
 {
 	INSTRUCTION_START
 	JITDISABLE(bJITLoadStoreOff);
-	if (SConfig::GetInstance().m_LocalCoreStartupParameter.bDCBZOFF)
+	if (inst.OPCD == 31 && SConfig::GetInstance().m_LocalCoreStartupParameter.bDCBZOFF)
 		return;
 
 	int a = inst.RA;
@@ -562,8 +593,213 @@ void Jit64::stmw(UGeckoInstruction inst)
 	gpr.UnlockAllX();
 }
 
+static void InvalidateInstructionCacheLine(u32 address)
+{
+	PowerPC::ppcState.iCache.Invalidate(address);
+}
+
 void Jit64::icbi(UGeckoInstruction inst)
 {
-	FallBackToInterpreter(inst);
+	INSTRUCTION_START
+
+	// The line may hold this block, so leave it right after.
+	MOV(32, R(RSCRATCH), gpr.R(inst.RB));
+	if (inst.RA)
+		ADD(32, R(RSCRATCH), gpr.R(inst.RA));
+	gpr.Flush();
+	fpr.Flush();
+	ABI_PushRegistersAndAdjustStack({}, 0);
+	ABI_CallFunctionR((void *)&InvalidateInstructionCacheLine, RSCRATCH);
+	ABI_PopRegistersAndAdjustStack({}, 0);
 	WriteExit(js.compilerPC + 4);
 }
+
+void Jit64::lwarx(UGeckoInstruction inst)
+{
+	INSTRUCTION_START
+	JITDISABLE(bJITLoadStoreOff);
+
+	int a = inst.RA, b = inst.RB, d = inst.RD;
+	gpr.Lock(a, b, d);
+	MOV(32, R(RSCRATCH2), gpr.R(b));
+	if (a)
+		ADD(32, R(RSCRATCH2), gpr.R(a));
+	SafeLoadToReg(RSCRATCH, R(RSCRATCH2), 32, 0, CallerSavedRegistersInUse() | BitSet32 { RSCRATCH2 }, false);
+	MemoryExceptionCheck();
+	gpr.BindToRegister(d, false, true);
+	MOV(32, gpr.R(d), R(RSCRATCH));
+	MOV(8, PPCSTATE(reserve), Imm8(1));
+	MOV(32, PPCSTATE(reserve_address), R(RSCRATCH2));
+	gpr.UnlockAll();
+}
+
+void Jit64::stwcxd(UGeckoInstruction inst)
+{
+	INSTRUCTION_START
+	JITDISABLE(bJITLoadStoreOff);
+
+	int a = inst.RA, b = inst.RB, s = inst.RS;
+	gpr.Lock(a, b, s);
+	MOV(32, R(RSCRATCH2), gpr.R(b));
+	if (a)
+		ADD(32, R(RSCRATCH2), gpr.R(a));
+
+	CMP(8, PPCSTATE(reserve), Imm8(0));
+	FixupBranch no_reservation = J_CC(CC_E);
+	CMP(32, R(RSCRATCH2), PPCSTATE(reserve_address));
+	FixupBranch other_address = J_CC(CC_NE);
+	MOV(32, R(RSCRATCH), gpr.R(s));
+	SafeWriteRegToReg(RSCRATCH, RSCRATCH2, 32, 0, CallerSavedRegistersInUse());
+	MemoryExceptionCheck();
+	MOV(8, PPCSTATE(reserve), Imm8(0));
+	MOV(32, R(RSCRATCH2), Imm32(2));
+	FixupBranch stored = J();
+	SetJumpTarget(no_reservation);
+	SetJumpTarget(other_address);
+	XOR(32, R(RSCRATCH2), R(RSCRATCH2));
+	SetJumpTarget(stored);
+
+	// CR0 = [0 0 EQ SO], EQ if the store was made
+	MOVZX(32, 8, RSCRATCH, PPCSTATE(xer_so_ov));
+	SHR(32, R(RSCRATCH), Imm8(1));
+	OR(32, R(RSCRATCH), R(RSCRATCH2));
+	MOV(64, R(RSCRATCH), MScaled(RSCRATCH, SCALE_8, (u32)(u64)m_crTable));
+	MOV(64, PPCSTATE(cr_val[0]), R(RSCRATCH));
+	gpr.UnlockAll();
+}
+
+// lswi and stswi know how many bytes they move, so they unroll like lmw and
+// stmw, with the bytes past the last whole word moved one at a time. A DSI
+// has to stop them at the faulting access, which the interpreter does.
+void Jit64::lswi(UGeckoInstruction inst)
+{
+	INSTRUCTION_START
+	JITDISABLE(bJITLoadStoreOff);
+	FALLBACK_IF(jo.memcheck);
+
+	u32 n = inst.NB ? inst.NB : 32;
+	if (inst.RA)
+		MOV(32, R(RSCRATCH2), gpr.R(inst.RA));
+	else
+		XOR(32, R(RSCRATCH2), R(RSCRATCH2));
+	for (u32 offset = 0; offset < n; offset += 4)
+	{
+		int r = (inst.RD + offset / 4) & 31;
+		BitSet32 registersInUse = CallerSavedRegistersInUse() | BitSet32 { RSCRATCH2 };
+		if (n - offset >= 4)
+		{
+			SafeLoadToReg(RSCRATCH, R(RSCRATCH2), 32, offset, registersInUse, false);
+			gpr.BindToRegister(r, false, true);
+			MOV(32, gpr.R(r), R(RSCRATCH));
+			continue;
+		}
+
+		// The bytes fill the register from the top; the rest is cleared.
+		for (u32 i = 0; offset + i < n; i++)
+		{
+			SafeLoadToReg(RSCRATCH, R(RSCRATCH2), 8, offset + i, registersInUse, false);
+			SHL(32, R(RSCRATCH), Imm8(24 - i * 8));
+			if (i == 0)
+			{
+				gpr.BindToRegister(r, false, true);
+				MOV(32, gpr.R(r), R(RSCRATCH));
+				registersInUse = CallerSavedRegistersInUse() | BitSet32 { RSCRATCH2 };
+			}
+			else
+			{
+				OR(32, gpr.R(r), R(RSCRATCH));
+			}
+		}
+	}
+	gpr.UnlockAllX();
+}
+
+void Jit64::stswi(UGeckoInstruction inst)
+{
+	INSTRUCTION_START
+	JITDISABLE(bJITLoadStoreOff);
+	FALLBACK_IF(jo.memcheck);
+
+	u32 n = inst.NB ? inst.NB : 32;
+	for (u32 offset = 0; offset < n; offset++)
+	{
+		int r = (inst.RS + offset / 4) & 31;
+		int accessSize = n - offset >= 4 && offset % 4 == 0 ? 32 : 8;
+		if (inst.RA)
+			MOV(32, R(RSCRATCH), gpr.R(inst.RA));
+		else
+			XOR(32, R(RSCRATCH), R(RSCRATCH));
+		MOV(32, R(RSCRATCH2), gpr.R(r));
+		if (accessSize == 8 && offset % 4 != 3)
+			SHR(32, R(RSCRATCH2), Imm8(24 - (offset % 4) * 8));
+		SafeWriteRegToReg(RSCRATCH2, RSCRATCH, accessSize, offset, CallerSavedRegistersInUse());
+		if (accessSize == 32)
+			offset += 3;
+	}
+	gpr.UnlockAllX();
+}
+
+// How many bytes lswx and stswx move, and so which registers they use, is only
+// known at run time. The GPRs are flushed for the interpreter's loop, but the
+// FPRs stay in registers.
+void Jit64::lswx(UGeckoInstruction inst)
+{
+	INSTRUCTION_START
+	JITDISABLE(bJITLoadStoreOff);
+
+	gpr.Flush();
+	BitSet32 registersInUse = CallerSavedRegistersInUse();
+	ABI_PushRegistersAndAdjustStack(registersInUse, 0);
+	ABI_CallFunctionC((void *)&Interpreter::lswx, inst.hex);
+	ABI_PopRegistersAndAdjustStack(registersInUse, 0);
+	MemoryExceptionCheck();
+}
+
+void Jit64::stswx(UGeckoInstruction inst)
+{
+	INSTRUCTION_START
+	JITDISABLE(bJITLoadStoreOff);
+
+	gpr.Flush();
+	BitSet32 registersInUse = CallerSavedRegistersInUse();
+	ABI_PushRegistersAndAdjustStack(registersInUse, 0);
+	ABI_CallFunctionC((void *)&Interpreter::stswx, inst.hex);
+	ABI_PopRegistersAndAdjustStack(registersInUse, 0);
+	MemoryExceptionCheck();
+}
+
+// eciwx and ecowx. There's no external device; the word is accessed directly,
+// after the same checks the interpreter makes.
+void Jit64::ecxwx(UGeckoInstruction inst)
+{
+	INSTRUCTION_START
+	JITDISABLE(bJITLoadStoreOff);
+
+	int a = inst.RA, b = inst.RB, d = inst.RD;
+	gpr.Lock(a, b, d);
+	MOV(32, R(RSCRATCH2), gpr.R(b));
+	if (a)
+		ADD(32, R(RSCRATCH2), gpr.R(a));
+
+	TEST(32, PPCSTATE(spr[SPR_EAR]), Imm32(0x80000000));
+	FixupBranch enabled = J_CC(CC_NZ);
+	OR(32, PPCSTATE(Exceptions), Imm32(EXCEPTION_DSI));
+	SetJumpTarget(enabled);
+	TEST(32, R(RSCRATCH2), Imm32(3));
+	FixupBranch aligned = J_CC(CC_Z);
+	OR(32, PPCSTATE(Exceptions), Imm32(EXCEPTION_ALIGNMENT));
+	SetJumpTarget(aligned);
+
+	if (inst.SUBOP10 == 310)
+	{
+		SafeLoadToReg(RSCRATCH, R(RSCRATCH2), 32, 0, CallerSavedRegistersInUse(), false);
+		gpr.BindToRegister(d, false, true);
+		MOV(32, gpr.R(d), R(RSCRATCH));
+	}
+	else
+	{
+		MOV(32, R(RSCRATCH), gpr.R(d));
+		SafeWriteRegToReg(RSCRATCH, RSCRATCH2, 32, 0, CallerSavedRegistersInUse());
+	}
+	gpr.UnlockAll();
+}
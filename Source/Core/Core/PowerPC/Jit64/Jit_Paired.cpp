@@ -166,8 +166,10 @@ void Jit64::ps_sum(UGeckoInstruction inst)
 	case 11:
 		MOVDDUP(XMM1, fpr.R(a));  // {a.ps0, a.ps0}
 		ADDPD(XMM1, fpr.R(b));    // {a.ps0 + b.ps0, a.ps0 + b.ps1}
-		MOVAPD(XMM0, fpr.R(c));
-		SHUFPD(XMM0, R(XMM1), 2); // {c.ps0, a.ps0 + b.ps1}
+		if (cpu_info.bSSE4_1)
+			avx_op(&XEmitter::VBLENDPD, &XEmitter::BLENDPD, XMM0, fpr.R(c), R(XMM1), 2); // {c.ps0, a.ps0 + b.ps1}
+		else
+			avx_op(&XEmitter::VSHUFPD, &XEmitter::SHUFPD, XMM0, fpr.R(c), R(XMM1), 2);
 		break;
 	default:
 		PanicAlert("ps_sum WTF!!!");
@@ -178,6 +180,44 @@ void Jit64::ps_sum(UGeckoInstruction inst)
 	fpr.UnlockAll();
 }
 
+// Loads the multiplier of ps_muls0/1, ps_madds0/1 and the ps_madd family into
+// XMM0: FC with half 0 or 1 copied to both halves (or as it is, for splat 2),
+// rounded to 25 bits unless it is known to be a single. Clobbers XMM1, except
+// that when the analyzer found the next instruction uses the same multiplier,
+// it is kept in XMM1 for that instruction instead of being built again.
+void Jit64::LoadPairedMultiplier(int c, int splat, bool round_input)
+{
+	if (js.op->reuseSplat && js.pairedSplatEnd)
+	{
+		MOVAPD(XMM0, R(XMM1));
+		return;
+	}
+
+	X64Reg out = js.op->keepSplat ? XMM1 : XMM0;
+	X64Reg tmp = js.op->keepSplat ? XMM0 : XMM1;
+	switch (splat)
+	{
+	case 0:
+		MOVDDUP(out, fpr.R(c));
+		if (round_input)
+			Force25BitPrecision(out, R(out), tmp);
+		break;
+	case 1:
+		avx_op(&XEmitter::VSHUFPD, &XEmitter::SHUFPD, out, fpr.R(c), fpr.R(c), 3);
+		if (round_input)
+			Force25BitPrecision(out, R(out), tmp);
+		break;
+	default:
+		if (round_input)
+			Force25BitPrecision(out, fpr.R(c), tmp);
+		else
+			MOVAPD(out, fpr.R(c));
+		break;
+	}
+
+	if (js.op->keepSplat)
+		MOVAPD(XMM0, R(XMM1));
+}
 
 void Jit64::ps_muls(UGeckoInstruction inst)
 {
@@ -193,21 +233,21 @@ void Jit64::ps_muls(UGeckoInstruction inst)
 	switch (inst.SUBOP5)
 	{
 	case 12:
-		MOVDDUP(XMM0, fpr.R(c));
+		LoadPairedMultiplier(c, 0, round_input);
 		break;
 	case 13:
-		avx_op(&XEmitter::VSHUFPD, &XEmitter::SHUFPD, XMM0, fpr.R(c), fpr.R(c), 3);
+		LoadPairedMultiplier(c, 1, round_input);
 		break;
 	default:
 		PanicAlert("ps_muls WTF!!!");
 	}
-	if (round_input)
-		Force25BitPrecision(XMM0, R(XMM0), XMM1);
 	MULPD(XMM0, fpr.R(a));
 	fpr.BindToRegister(d, false);
 	ForceSinglePrecisionP(fpr.RX(d), XMM0);
 	SetFPRFIfNeeded(fpr.RX(d));
 	fpr.UnlockAll();
+	if (js.op->keepSplat)
+		js.pairedSplatEnd = GetCodePtr();
 }
 
 
@@ -229,7 +269,11 @@ void Jit64::ps_mergeXX(UGeckoInstruction inst)
 		avx_op(&XEmitter::VUNPCKLPD, &XEmitter::UNPCKLPD, fpr.RX(d), fpr.R(a), fpr.R(b));
 		break; //00
 	case 560:
-		avx_op(&XEmitter::VSHUFPD, &XEmitter::SHUFPD, fpr.RX(d), fpr.R(a), fpr.R(b), 2);
+		// The blend doesn't need the shuffle port.
+		if (cpu_info.bSSE4_1)
+			avx_op(&XEmitter::VBLENDPD, &XEmitter::BLENDPD, fpr.RX(d), fpr.R(a), fpr.R(b), 2);
+		else
+			avx_op(&XEmitter::VSHUFPD, &XEmitter::SHUFPD, fpr.RX(d), fpr.R(a), fpr.R(b), 2);
 		break; //01
 	case 592:
 		avx_op(&XEmitter::VSHUFPD, &XEmitter::SHUFPD, fpr.RX(d), fpr.R(a), fpr.R(b), 1);
@@ -313,29 +357,43 @@ void Jit64::ps_maddXX(UGeckoInstruction inst)
 	fpr.Lock(a, b, c, d);
 
 	if (fma)
-		fpr.BindToRegister(b, true, false);
+		fpr.BindToRegister(b, true, d == b);
 
 	if (inst.SUBOP5 == 14)
-	{
-		MOVDDUP(XMM0, fpr.R(c));
-		if (round_input)
-			Force25BitPrecision(XMM0, R(XMM0), XMM1);
-	}
+		LoadPairedMultiplier(c, 0, round_input);
 	else if (inst.SUBOP5 == 15)
-	{
-		avx_op(&XEmitter::VSHUFPD, &XEmitter::SHUFPD, XMM0, fpr.R(c), fpr.R(c), 3);
-		if (round_input)
-			Force25BitPrecision(XMM0, R(XMM0), XMM1);
-	}
+		LoadPairedMultiplier(c, 1, round_input);
 	else
+		LoadPairedMultiplier(c, 2, round_input);
+
+	if (fma && d == b)
 	{
-		if (round_input)
-			Force25BitPrecision(XMM0, fpr.R(c), XMM1);
-		else
-			MOVAPD(XMM0, fpr.R(c));
+		// Accumulate straight into d; it is already bound since it is also b.
+		switch (inst.SUBOP5)
+		{
+		case 14: //madds0
+		case 15: //madds1
+		case 29: //madd
+			VFMADD231PD(fpr.RX(d), XMM0, fpr.R(a));
+			break;
+		case 28: //msub
+			VFMSUB231PD(fpr.RX(d), XMM0, fpr.R(a));
+			break;
+		case 30: //nmsub
+			VFNMADD231PD(fpr.RX(d), XMM0, fpr.R(a));
+			break;
+		case 31: //nmadd
+			VFNMSUB231PD(fpr.RX(d), XMM0, fpr.R(a));
+			break;
+		}
+		ForceSinglePrecisionP(fpr.RX(d), fpr.RX(d));
+		SetFPRFIfNeeded(fpr.RX(d));
+		fpr.UnlockAll();
+		if (js.op->keepSplat)
+			js.pairedSplatEnd = GetCodePtr();
+		return;
 	}
-
-	if (fma)
+	else if (fma)
 	{
 		switch (inst.SUBOP5)
 		{
@@ -389,6 +447,8 @@ void Jit64::ps_maddXX(UGeckoInstruction inst)
 	ForceSinglePrecisionP(fpr.RX(d), XMM0);
 	SetFPRFIfNeeded(fpr.RX(d));
 	fpr.UnlockAll();
+	if (js.op->keepSplat)
+		js.pairedSplatEnd = GetCodePtr();
 }
 
 void Jit64::ps_cmpXX(UGeckoInstruction inst)
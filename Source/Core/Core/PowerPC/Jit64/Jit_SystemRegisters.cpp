@@ -402,6 +402,99 @@ void Jit64::mftb(UGeckoInstruction inst)
 	mfspr(inst);
 }
 
+// PPCSTATE's displacement of sr, for indexing it by a register.
+static const int SR_OFFSET = (int)((char*)&PowerPC::ppcState.sr - (char*)&PowerPC::ppcState) - 0x80;
+
+void Jit64::mfsr(UGeckoInstruction inst)
+{
+	INSTRUCTION_START
+	JITDISABLE(bJITSystemRegistersOff);
+
+	int d = inst.RD;
+	gpr.Lock(d);
+	gpr.BindToRegister(d, false, true);
+	MOV(32, gpr.R(d), PPCSTATE(sr[inst.SR]));
+	gpr.UnlockAll();
+}
+
+void Jit64::mfsrin(UGeckoInstruction inst)
+{
+	INSTRUCTION_START
+	JITDISABLE(bJITSystemRegistersOff);
+
+	int b = inst.RB, d = inst.RD;
+	gpr.Lock(b, d);
+	MOV(32, R(RSCRATCH), gpr.R(b));
+	SHR(32, R(RSCRATCH), Imm8(28));
+	gpr.BindToRegister(d, false, true);
+	MOV(32, gpr.R(d), MComplex(RPPCSTATE, RSCRATCH, SCALE_4, SR_OFFSET));
+	gpr.UnlockAll();
+}
+
+void Jit64::mtsr(UGeckoInstruction inst)
+{
+	INSTRUCTION_START
+	JITDISABLE(bJITSystemRegistersOff);
+
+	int s = inst.RS;
+	if (gpr.R(s).IsImm())
+	{
+		MOV(32, PPCSTATE(sr[inst.SR]), gpr.R(s));
+	}
+	else
+	{
+		gpr.Lock(s);
+		gpr.BindToRegister(s, true, false);
+		MOV(32, PPCSTATE(sr[inst.SR]), gpr.R(s));
+		gpr.UnlockAll();
+	}
+	SegmentRegisterUpdated();
+}
+
+void Jit64::mtsrin(UGeckoInstruction inst)
+{
+	INSTRUCTION_START
+	JITDISABLE(bJITSystemRegistersOff);
+
+	int b = inst.RB, s = inst.RS;
+	gpr.Lock(b, s);
+	gpr.BindToRegister(s, true, false);
+	MOV(32, R(RSCRATCH), gpr.R(b));
+	SHR(32, R(RSCRATCH), Imm8(28));
+	MOV(32, MComplex(RPPCSTATE, RSCRATCH, SCALE_4, SR_OFFSET), gpr.R(s));
+	gpr.UnlockAll();
+	SegmentRegisterUpdated();
+}
+
+void Jit64::SegmentRegisterUpdated()
+{
+	BitSet32 registersInUse = CallerSavedRegistersInUse();
+	ABI_PushRegistersAndAdjustStack(registersInUse, 0);
+	ABI_CallFunction((void *)&PowerPC::SRUpdated);
+	ABI_PopRegistersAndAdjustStack(registersInUse, 0);
+}
+
+void Jit64::tlbie(UGeckoInstruction inst)
+{
+	INSTRUCTION_START
+	JITDISABLE(bJITSystemRegistersOff);
+
+	MOV(32, R(RSCRATCH), gpr.R(inst.RB));
+	BitSet32 registersInUse = CallerSavedRegistersInUse();
+	ABI_PushRegistersAndAdjustStack(registersInUse, 0);
+	ABI_CallFunctionR((void *)&PowerPC::InvalidateTLBEntry, RSCRATCH);
+	ABI_PopRegistersAndAdjustStack(registersInUse, 0);
+}
+
+void Jit64::tlbia(UGeckoInstruction inst)
+{
+	INSTRUCTION_START
+	JITDISABLE(bJITSystemRegistersOff);
+
+	// Gekko does not support this instruction; the interpreter only reports it.
+	PanicAlert("The GameCube CPU does not support tlbia");
+}
+
 void Jit64::mfcr(UGeckoInstruction inst)
 {
 	INSTRUCTION_START
@@ -501,6 +594,168 @@ void Jit64::mcrxr(UGeckoInstruction inst)
 	MOV(8, PPCSTATE(xer_so_ov), Imm8(0));
 }
 
+// The FPSCR bits the host FPU's settings come from: NI and RN.
+static const u32 FPSCR_HOST_MODE = 0x7;
+
+void Jit64::UpdateRoundingMode()
+{
+	BitSet32 registersInUse = CallerSavedRegistersInUse();
+	ABI_PushRegistersAndAdjustStack(registersInUse, 0);
+	ABI_CallFunction((void *)&PowerPC::RoundingModeUpdated);
+	ABI_PopRegistersAndAdjustStack(registersInUse, 0);
+}
+
+void Jit64::UpdateFPSCRSummary()
+{
+	// VX is set iff any of the VX* bits is; FEX is always clear since we
+	// assume the exception enable bits are.
+	MOV(32, R(RSCRATCH), PPCSTATE(fpscr));
+	AND(32, R(RSCRATCH), Imm32(~(FPSCR_FEX | FPSCR_VX)));
+	TEST(32, R(RSCRATCH), Imm32(FPSCR_VX_ANY));
+	FixupBranch no_vx = J_CC(CC_Z);
+	OR(32, R(RSCRATCH), Imm32(FPSCR_VX));
+	SetJumpTarget(no_vx);
+	MOV(32, PPCSTATE(fpscr), R(RSCRATCH));
+}
+
+void Jit64::mcrfs(UGeckoInstruction inst)
+{
+	INSTRUCTION_START
+	JITDISABLE(bJITSystemRegistersOff);
+
+	UpdateFPSCRSummary();
+	int shift = 4 * (7 - inst.CRFS);
+	if (shift)
+		SHR(32, R(RSCRATCH), Imm8(shift));
+	if (inst.CRFS != 0)
+		AND(32, R(RSCRATCH), Imm8(0xF));
+	MOV(64, R(RSCRATCH), MScaled(RSCRATCH, SCALE_8, (u32)(u64)m_crTable));
+	MOV(64, PPCSTATE(cr_val[inst.CRFD]), R(RSCRATCH));
+
+	// Copying an exception bit clears it.
+	u32 clear = 0;
+	switch (inst.CRFS)
+	{
+	case 0:
+		clear = FPSCR_FX | FPSCR_OX;
+		break;
+	case 1:
+		clear = FPSCR_UX | FPSCR_ZX | FPSCR_XX | FPSCR_VXSNAN;
+		break;
+	case 2:
+		clear = FPSCR_VXISI | FPSCR_VXIDI | FPSCR_VXZDZ | FPSCR_VXIMZ;
+		break;
+	case 3:
+		clear = FPSCR_VXVC;
+		break;
+	case 5:
+		clear = FPSCR_VXSOFT | FPSCR_VXSQRT | FPSCR_VXCVI;
+		break;
+	}
+	if (clear)
+		AND(32, PPCSTATE(fpscr), Imm32(~clear));
+}
+
+void Jit64::mffsx(UGeckoInstruction inst)
+{
+	INSTRUCTION_START
+	JITDISABLE(bJITSystemRegistersOff);
+	FALLBACK_IF(inst.Rc);
+
+	int d = inst.FD;
+	UpdateFPSCRSummary();
+	fpr.Lock(d);
+	fpr.BindToRegister(d, true, true);
+	// d[64+] must not be modified
+	MOVQ_xmm(XMM0, R(RSCRATCH));
+	MOVSD(fpr.RX(d), R(XMM0));
+	fpr.UnlockAll();
+}
+
+void Jit64::mtfsb0x(UGeckoInstruction inst)
+{
+	INSTRUCTION_START
+	JITDISABLE(bJITSystemRegistersOff);
+	FALLBACK_IF(inst.Rc);
+
+	u32 mask = 0x80000000 >> inst.CRBD;
+	AND(32, PPCSTATE(fpscr), Imm32(~mask));
+	if (mask & FPSCR_HOST_MODE)
+		UpdateRoundingMode();
+}
+
+void Jit64::mtfsb1x(UGeckoInstruction inst)
+{
+	INSTRUCTION_START
+	JITDISABLE(bJITSystemRegistersOff);
+	FALLBACK_IF(inst.Rc);
+
+	u32 mask = 0x80000000 >> inst.CRBD;
+	if (mask & FPSCR_ANY_X)
+	{
+		// Setting an exception bit that was clear also sets FX.
+		MOV(32, R(RSCRATCH), PPCSTATE(fpscr));
+		TEST(32, R(RSCRATCH), Imm32(mask));
+		FixupBranch was_set = J_CC(CC_NZ);
+		OR(32, R(RSCRATCH), Imm32(FPSCR_FX | mask));
+		MOV(32, PPCSTATE(fpscr), R(RSCRATCH));
+		SetJumpTarget(was_set);
+	}
+	else
+	{
+		OR(32, PPCSTATE(fpscr), Imm32(mask));
+	}
+	if (mask & FPSCR_HOST_MODE)
+		UpdateRoundingMode();
+}
+
+void Jit64::mtfsfix(UGeckoInstruction inst)
+{
+	INSTRUCTION_START
+	JITDISABLE(bJITSystemRegistersOff);
+	FALLBACK_IF(inst.Rc);
+
+	u32 mask = 0xF0000000 >> (4 * inst.CRFD);
+	u32 imm = ((inst.hex << 16) & 0xF0000000) >> (4 * inst.CRFD);
+	AND(32, PPCSTATE(fpscr), Imm32(~mask));
+	if (imm)
+		OR(32, PPCSTATE(fpscr), Imm32(imm));
+	if (mask & FPSCR_HOST_MODE)
+		UpdateRoundingMode();
+}
+
+void Jit64::mtfsfx(UGeckoInstruction inst)
+{
+	INSTRUCTION_START
+	JITDISABLE(bJITSystemRegistersOff);
+	FALLBACK_IF(inst.Rc);
+
+	u32 mask = 0;
+	for (int i = 0; i < 8; i++)
+	{
+		if (inst.FM & (1 << i))
+			mask |= 0xF << (i * 4);
+	}
+
+	int b = inst.FB;
+	if (fpr.R(b).IsSimpleReg())
+		MOVD_xmm(R(RSCRATCH), fpr.RX(b));
+	else
+		MOV(32, R(RSCRATCH), fpr.R(b));
+	if (mask != 0xFFFFFFFF)
+	{
+		AND(32, R(RSCRATCH), Imm32(mask));
+		AND(32, PPCSTATE(fpscr), Imm32(~mask));
+		OR(32, PPCSTATE(fpscr), R(RSCRATCH));
+	}
+	else
+	{
+		MOV(32, PPCSTATE(fpscr), R(RSCRATCH));
+	}
+	if (mask & FPSCR_HOST_MODE)
+		UpdateRoundingMode();
+}
+
 void Jit64::crXXX(UGeckoInstruction inst)
 {
 	INSTRUCTION_START
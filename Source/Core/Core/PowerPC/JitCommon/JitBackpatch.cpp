@@ -2,7 +2,10 @@
 // Licensed under GPLv2+
 // Refer to the license.txt file included.
 
+#include <algorithm>
 #include <cinttypes>
+#include <utility>
+#include <vector>
 
 #include "disasm.h"
 
@@ -26,14 +29,30 @@ static void BackPatchError(const std::string &text, u8 *codePtr, u32 emAddress)
 
 // This generates some fairly heavy trampolines, but it doesn't really hurt.
 // Only instructions that access I/O will get these, and there won't be that
-// many of them in a typical program/game.
+// many of them in a typical program/game. Sites with the same access share
+// the bulk of their trampoline; see TrampolineCache.
 bool Jitx86Base::HandleFault(uintptr_t access_address, SContext* ctx)
 {
 	// TODO: do we properly handle off-the-end?
 	if (access_address >= (uintptr_t)Memory::physical_base && access_address < (uintptr_t)Memory::physical_base + 0x100010000)
 		return BackPatch((u32)(access_address - (uintptr_t)Memory::physical_base), ctx);
 	if (access_address >= (uintptr_t)Memory::logical_base && access_address < (uintptr_t)Memory::logical_base + 0x100010000)
-		return BackPatch((u32)(access_address - (uintptr_t)Memory::logical_base), ctx);
+	{
+		u32 emAddress = (u32)(access_address - (uintptr_t)Memory::logical_base);
+
+		// With the MMU on, most of these are accesses to pages of the guest page
+		// table that haven't been mirrored into the logical view yet. Map the page
+		// and retry the access, so the instruction stays on the fastmem path.
+		u8* codePtr = (u8*) ctx->CTX_PC;
+		InstructionInfo info = {};
+		if (IsInSpace(codePtr) && DisassembleMov(codePtr, &info) &&
+		    PowerPC::MapLogicalPage(emAddress, info.isMemoryWrite))
+		{
+			return true;
+		}
+
+		return BackPatch(emAddress, ctx);
+	}
 
 
 	return false;
@@ -172,11 +191,11 @@ bool Jitx86Base::BackPatch(u32 emAddress, SContext* ctx)
 		}
 
 		u32 pc = it3->second;
-		trampoline = trampolines.GenerateWriteTrampoline(info, registersInUse, exceptionHandler, returnPtr, pc);
+		trampoline = trampolines.GenerateWriteTrampoline(info, registersInUse, exceptionHandler, start, returnPtr, pc);
 	}
 	else
 	{
-		trampoline = trampolines.GenerateReadTrampoline(info, registersInUse, exceptionHandler, returnPtr);
+		trampoline = trampolines.GenerateReadTrampoline(info, registersInUse, exceptionHandler, start, returnPtr);
 	}
 
 	// Patch the original memory operation.
@@ -188,3 +207,29 @@ bool Jitx86Base::BackPatch(u32 emAddress, SContext* ctx)
 
 	return true;
 }
+
+bool Jitx86Base::CompactTrampolines()
+{
+	// A site inside an invalidated block can never run again. Blocks whose code
+	// space was evicted and reused have no code range left, so their old range
+	// can't take live sites with it.
+	std::vector<std::pair<const u8*, const u8*>> dead_blocks;
+	JitBaseBlockCache* cache = GetBlockCache();
+	for (int i = 0; i < cache->GetNumBlocks(); i++)
+	{
+		const JitBlock* b = cache->GetBlock(i);
+		if (b->invalid)
+			dead_blocks.emplace_back(b->checkedEntry, b->normalEntry + b->codeSize);
+	}
+	std::sort(dead_blocks.begin(), dead_blocks.end());
+
+	size_t reclaimed = trampolines.Compact([&](const u8* site) {
+		auto it = std::upper_bound(dead_blocks.begin(), dead_blocks.end(), std::make_pair(site, site),
+		                           [](const std::pair<const u8*, const u8*>& a, const std::pair<const u8*, const u8*>& b) {
+			return a.first < b.first;
+		});
+		return it != dead_blocks.begin() && site < (it - 1)->second;
+	});
+
+	return reclaimed && trampolines.GetSpaceLeft() >= 0x10000;
+}
@@ -2,6 +2,7 @@
 // Licensed under GPLv2+
 // Refer to the license.txt file included.
 
+#include <cinttypes>
 #include <sstream>
 #include <string>
 
@@ -9,6 +10,8 @@
 
 #include "Common/GekkoDisassembler.h"
 #include "Common/StringUtil.h"
+#include "Core/PowerPC/Interpreter/Interpreter.h"
+#include "Core/PowerPC/Profiler.h"
 #include "Core/PowerPC/JitCommon/JitBase.h"
 
 JitBase *jit;
@@ -64,6 +67,9 @@ bool JitBase::MergeAllowedNextInstructions(int count)
 {
 	if (PowerPC::GetState() == PowerPC::CPU_STEPPING || js.instructionsLeft < count)
 		return false;
+	// Execution statistics count every instruction on its own.
+	if (Profiler::g_ExecutionStats)
+		return false;
 	// Be careful: a breakpoint kills flags in between instructions
 	for (int i = 1; i <= count; i++)
 	{
@@ -72,6 +78,9 @@ bool JitBase::MergeAllowedNextInstructions(int count)
 			return false;
 		if (js.op[i].isBranchTarget)
 			return false;
+		// The merged branch code doesn't handle followed branches.
+		if (js.op[i].branchFollowed)
+			return false;
 	}
 	return true;
 }
@@ -86,3 +95,66 @@ void JitBase::UpdateMemoryOptions()
 	jo.alwaysUseMemFuncs = any_watchpoints;
 
 }
+
+bool JitBase::InterpretColdBlock(u32 em_address)
+{
+	if (jo.tierThreshold == 0 || SConfig::GetInstance().m_LocalCoreStartupParameter.bEnableDebugging)
+		return false;
+
+	u32& count = m_cold_block_counts[em_address];
+	if (++count >= jo.tierThreshold)
+	{
+		m_cold_block_counts.erase(em_address);
+		return false;
+	}
+
+	// The dispatcher checks the downcount when we return.
+	InterpretBlock();
+	return true;
+}
+
+void JitBase::InterpretBlock()
+{
+	// Same loop as the interpreter's fast path, for a single block.
+	Interpreter* interpreter = Interpreter::getInstance();
+	Interpreter::m_EndBlock = false;
+	int cycles = 0;
+	u32 start = PC;
+	u32 last_address = PC;
+	while (!Interpreter::m_EndBlock)
+	{
+		last_address = PC;
+		cycles += interpreter->SingleStepInner();
+	}
+	PowerPC::ppcState.downcount -= cycles;
+	m_interpreted_blocks++;
+	if (Profiler::g_ExecutionStats)
+		Profiler::CountBlockRun(start, cycles);
+
+	if (!analyzer.HasOption(PPCAnalyst::PPCAnalyzer::OPTION_BRANCH_FOLLOW) || !PowerPC::HostIsRAMAddress(last_address))
+		return;
+
+	UGeckoInstruction inst = PowerPC::HostRead_Instruction(last_address);
+	if (inst.OPCD == 16 && !inst.LK)
+	{
+		PPCAnalyst::BranchCounts& counts = m_branch_profile[last_address];
+		if (PC != last_address + 4)
+			counts.taken++;
+		else
+			counts.not_taken++;
+	}
+}
+
+void JitBase::LogTraceStats()
+{
+	if (!analyzer.HasOption(PPCAnalyst::PPCAnalyzer::OPTION_BRANCH_FOLLOW) || m_trace_blocks == 0)
+		return;
+
+	// Every followed branch would otherwise have ended a block of its own.
+	NOTICE_LOG(DYNA_REC, "Trace formation: %" PRIu64 " blocks, %" PRIu64 " branches followed, "
+	           "%.2f instructions per block (%.2f without trace formation), %u branches profiled",
+	           m_trace_blocks, m_trace_followed_branches,
+	           (double)m_trace_instructions / m_trace_blocks,
+	           (double)m_trace_instructions / (m_trace_blocks + m_trace_followed_branches),
+	           (u32)m_branch_profile.size());
+}
@@ -8,7 +8,9 @@
 //#define JIT_LOG_GPR     // Enables logging of the PPC general purpose regs
 //#define JIT_LOG_FPR     // Enables logging of the PPC floating point regs
 
+#include <unordered_map>
 #include <unordered_set>
+#include <vector>
 
 #include "Common/x64ABI.h"
 #include "Common/x64Analyzer.h"
@@ -64,6 +66,12 @@ protected:
 		bool fastmem;
 		bool memcheck;
 		bool alwaysUseMemFuncs;
+		// Number of times a block start has to be reached before it is compiled;
+		// until then it runs in the interpreter. 0 compiles immediately.
+		u32 tierThreshold;
+		// Checked against the interpreter block by block (see JitLockstep.h):
+		// every entry runs a single block, and blocks aren't linked.
+		bool lockstep;
 	};
 	struct JitState
 	{
@@ -94,6 +102,11 @@ protected:
 
 		int fifoBytesThisBlock;
 
+		// End of the paired multiply that left its splatted FC in XMM1 (see
+		// CodeOp::keepSplat); the next instruction can only use it if nothing
+		// has been emitted in between.
+		const u8* pairedSplatEnd;
+
 		PPCAnalyst::BlockStats st;
 		PPCAnalyst::BlockRegStats gpa;
 		PPCAnalyst::BlockRegStats fpa;
@@ -109,10 +122,37 @@ protected:
 	PPCAnalyst::CodeBlock code_block;
 	PPCAnalyst::PPCAnalyzer analyzer;
 
+	// Lockstep mode only: the addresses of the instructions in the block
+	// compiled last, in the order it runs them.
+	std::vector<u32> m_last_block_path;
+
+	// Entry counts of block starts that haven't been compiled yet (tiered mode).
+	std::unordered_map<u32, u32> m_cold_block_counts;
+	u64 m_interpreted_blocks;
+
+	// Outcomes of the conditional branches ending interpreted blocks; the
+	// analyzer uses them to pick the hot edge when forming traces.
+	PPCAnalyst::BranchProfile m_branch_profile;
+
+	// Trace formation statistics.
+	u64 m_trace_blocks;
+	u64 m_trace_instructions;
+	u64 m_trace_followed_branches;
+
 	bool MergeAllowedNextInstructions(int count);
 
 	void UpdateMemoryOptions();
 
+	// Runs the block at em_address in the interpreter if it hasn't been reached
+	// often enough to be worth compiling. Returns false if it should be compiled.
+	bool InterpretColdBlock(u32 em_address);
+
+	// Runs one block in the interpreter, starting at PC, and records the
+	// outcome of the branch that ends it.
+	void InterpretBlock();
+
+	void LogTraceStats();
+
 public:
 	// This should probably be removed from public:
 	JitOptions jo;
@@ -122,6 +162,22 @@ public:
 
 	virtual void Jit(u32 em_address) = 0;
 
+	const std::vector<u32>& GetLastBlockPath() const { return m_last_block_path; }
+
+	// Tiered mode: block executions run in the interpreter so far, and the
+	// entries of a block start that hasn't been compiled yet.
+	u64 GetInterpretedBlocks() const { return m_interpreted_blocks; }
+	u32 GetColdBlockCount(u32 em_address) const
+	{
+		auto it = m_cold_block_counts.find(em_address);
+		return it == m_cold_block_counts.end() ? 0 : it->second;
+	}
+
+	// Blocks until a block that is being compiled off the CPU thread (if any)
+	// has been published to the block cache. Anything that touches the block
+	// cache or the JIT state from outside Jit() has to call this first.
+	virtual void WaitForBackgroundCompile() {}
+
 	virtual const CommonAsmRoutinesBase *GetAsmRoutines() = 0;
 
 	virtual bool HandleFault(uintptr_t access_address, SContext* ctx) = 0;
@@ -131,6 +187,9 @@ class Jitx86Base : public JitBase, public EmuCodeBlock
 {
 protected:
 	bool BackPatch(u32 emAddress, SContext* ctx);
+	// Reclaims the trampolines of invalidated blocks; returns false if that
+	// didn't free enough space and the cache has to be cleared.
+	bool CompactTrampolines();
 	JitBlockCache blocks;
 	TrampolineCache trampolines;
 public:
@@ -0,0 +1,223 @@
+// Copyright 2015 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <algorithm>
+#include <vector>
+
+#include "Common/CommonTypes.h"
+
+// A multimap from u32 keys to block numbers, used by the JIT block cache for
+// its link and invalidation indexes.
+//
+// Keys live in an open-addressing hash table; the block numbers for each key
+// are kept in singly linked lists threaded through a node pool with a free
+// list. Lookups, inserts and erases don't allocate once the pool and the table
+// have grown to the working set size, and Clear() keeps their capacity around
+// for the next run.
+class JitBlockIndex final
+{
+public:
+	explicit JitBlockIndex(u32 initial_capacity = 1024)
+	{
+		u32 table_size = 16;
+		while (table_size < initial_capacity * 2)
+			table_size <<= 1;
+		m_slots.resize(table_size);
+		m_nodes.reserve(initial_capacity);
+		Clear();
+	}
+
+	void Clear()
+	{
+		std::fill(m_slots.begin(), m_slots.end(), Slot{0, EMPTY});
+		m_nodes.clear();
+		m_free_node = NONE;
+		m_used_slots = 0;
+	}
+
+	void Insert(u32 key, int value)
+	{
+		// Keep the load factor (including dead keys) at or below one half.
+		if ((m_used_slots + 1) * 2 > m_slots.size())
+			Rehash();
+
+		Slot& slot = FindSlot(key);
+		if (slot.head == EMPTY)
+		{
+			slot.key = key;
+			slot.head = NONE;
+			m_used_slots++;
+		}
+
+		s32 node = AllocateNode();
+		m_nodes[node].value = value;
+		m_nodes[node].next = slot.head;
+		slot.head = node;
+	}
+
+	// Removes one (key, value) pair, if present.
+	void Erase(u32 key, int value)
+	{
+		Slot& slot = FindSlot(key);
+		if (slot.head == EMPTY)
+			return;
+
+		s32* link = &slot.head;
+		while (*link != NONE)
+		{
+			s32 node = *link;
+			if (m_nodes[node].value == value)
+			{
+				*link = m_nodes[node].next;
+				FreeNode(node);
+				return;
+			}
+			link = &m_nodes[node].next;
+		}
+	}
+
+	// Removes every value stored under key.
+	void EraseKey(u32 key)
+	{
+		Slot& slot = FindSlot(key);
+		if (slot.head == EMPTY)
+			return;
+
+		s32 node = slot.head;
+		while (node != NONE)
+		{
+			s32 next = m_nodes[node].next;
+			FreeNode(node);
+			node = next;
+		}
+		// The slot stays claimed by the key (as an empty list) so probe chains
+		// through it remain intact; Rehash() drops it.
+		slot.head = NONE;
+	}
+
+	template <typename F>
+	void ForEach(u32 key, F f) const
+	{
+		const Slot& slot = FindSlot(key);
+		if (slot.head == EMPTY)
+			return;
+
+		for (s32 node = slot.head; node != NONE; node = m_nodes[node].next)
+			f(m_nodes[node].value);
+	}
+
+	bool Contains(u32 key, int value) const
+	{
+		bool found = false;
+		ForEach(key, [&](int v) { found |= v == value; });
+		return found;
+	}
+
+	size_t Size() const
+	{
+		size_t size = m_nodes.size();
+		for (s32 node = m_free_node; node != NONE; node = m_nodes[node].next)
+			size--;
+		return size;
+	}
+
+private:
+	enum : s32
+	{
+		NONE = -1,   // end of a value list
+		EMPTY = -2,  // slot has never been claimed by a key
+	};
+
+	struct Slot
+	{
+		u32 key;
+		s32 head;
+	};
+
+	struct Node
+	{
+		int value;
+		s32 next;
+	};
+
+	static u32 Hash(u32 key)
+	{
+		// Guest addresses are 4-byte aligned and cluster heavily, so mix the
+		// bits before masking (murmur3 finalizer).
+		key ^= key >> 16;
+		key *= 0x85ebca6b;
+		key ^= key >> 13;
+		key *= 0xc2b2ae35;
+		key ^= key >> 16;
+		return key;
+	}
+
+	Slot& FindSlot(u32 key)
+	{
+		return const_cast<Slot&>(static_cast<const JitBlockIndex*>(this)->FindSlot(key));
+	}
+
+	const Slot& FindSlot(u32 key) const
+	{
+		u32 mask = (u32)m_slots.size() - 1;
+		u32 i = Hash(key) & mask;
+		while (m_slots[i].head != EMPTY && m_slots[i].key != key)
+			i = (i + 1) & mask;
+		return m_slots[i];
+	}
+
+	s32 AllocateNode()
+	{
+		if (m_free_node != NONE)
+		{
+			s32 node = m_free_node;
+			m_free_node = m_nodes[node].next;
+			return node;
+		}
+		m_nodes.push_back(Node{0, NONE});
+		return (s32)m_nodes.size() - 1;
+	}
+
+	void FreeNode(s32 node)
+	{
+		m_nodes[node].next = m_free_node;
+		m_free_node = node;
+	}
+
+	void Rehash()
+	{
+		std::vector<Slot> old_slots;
+		old_slots.swap(m_slots);
+
+		u32 live_keys = 0;
+		for (const Slot& slot : old_slots)
+		{
+			if (slot.head >= 0)
+				live_keys++;
+		}
+
+		// Grow only if the live keys alone would keep the table over half full;
+		// otherwise just drop the dead keys.
+		size_t new_size = old_slots.size();
+		while ((live_keys + 1) * 2 > new_size / 2)
+			new_size *= 2;
+
+		m_slots.assign(new_size, Slot{0, EMPTY});
+		m_used_slots = 0;
+		for (const Slot& slot : old_slots)
+		{
+			if (slot.head < 0)
+				continue;
+			FindSlot(slot.key) = slot;
+			m_used_slots++;
+		}
+	}
+
+	std::vector<Slot> m_slots;
+	std::vector<Node> m_nodes;
+	s32 m_free_node;
+	u32 m_used_slots;
+};
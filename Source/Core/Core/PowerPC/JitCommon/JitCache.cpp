@@ -9,10 +9,14 @@
 // performance hit, it's not enabled by default, but it's useful for
 // locating performance issues.
 
+#include <algorithm>
+
 #include "disasm.h"
 
 #include "Common/CommonTypes.h"
+#include "Common/FileUtil.h"
 #include "Common/JitRegister.h"
+#include "Common/StringUtil.h"
 #include "Common/MemoryUtil.h"
 #include "Core/PowerPC/JitInterface.h"
 #include "Core/PowerPC/JitCommon/JitBase.h"
@@ -36,7 +40,16 @@ using namespace Gen;
 			return;
 		}
 
-		JitRegister::Init(SConfig::GetInstance().m_LocalCoreStartupParameter.m_perfDir);
+		JitRegister::Init(SConfig::GetInstance().m_LocalCoreStartupParameter.m_perfDir,
+		                  !SConfig::GetInstance().m_LocalCoreStartupParameter.m_sampleProfileFile.empty());
+
+		if (SConfig::GetInstance().m_LocalCoreStartupParameter.bJITPersistentCache)
+		{
+			std::string cache_dir = File::GetUserPath(D_CACHE_IDX);
+			File::CreateFullPath(cache_dir);
+			disk_cache.Open(StringFromFormat("%sjit-%s.cache", cache_dir.c_str(),
+				SConfig::GetInstance().m_LocalCoreStartupParameter.GetUniqueID().c_str()));
+		}
 
 		iCache.fill(JIT_ICACHE_INVALID_BYTE);
 		iCacheEx.fill(JIT_ICACHE_INVALID_BYTE);
@@ -51,6 +64,7 @@ using namespace Gen;
 		num_blocks = 0;
 		m_initialized = false;
 
+		disk_cache.Close();
 		JitRegister::Shutdown();
 	}
 
@@ -70,8 +84,10 @@ using namespace Gen;
 		{
 			DestroyBlock(i, false);
 		}
-		links_to.clear();
-		block_map.clear();
+		links_to.Clear();
+		block_map.Clear();
+		entry_hints.clear();
+		evicted_addresses.clear();
 
 		valid_block.ClearAll();
 
@@ -113,6 +129,11 @@ using namespace Gen;
 		b.invalid = false;
 		b.originalAddress = em_address;
 		b.linkData.clear();
+		b.physicalRanges.clear();
+		b.regEntry = nullptr;
+		b.entryRegs.Clear();
+		if (disk_cache.IsOpen())
+			disk_cache.Apply(em_address);
 		num_blocks++; //commit the current block
 		return num_blocks - 1;
 	}
@@ -124,25 +145,33 @@ using namespace Gen;
 		u32* icp = GetICachePtr(b.originalAddress);
 		*icp = block_num;
 
-		// Convert the logical address to a physical address for the block map
-		u32 pAddr = b.originalAddress & 0x1FFFFFFF;
-
-		for (u32 block = pAddr / 32; block <= (pAddr + (b.originalSize - 1) * 4) / 32; ++block)
-			valid_block.Set(block);
+		if (b.physicalRanges.empty())
+		{
+			// Convert the logical address to a physical address for the block map
+			u32 pAddr = b.originalAddress & 0x1FFFFFFF;
+			b.physicalRanges.emplace_back(pAddr, pAddr + b.originalSize * 4);
+		}
 
-		block_map[std::make_pair(pAddr + 4 * b.originalSize - 1, pAddr)] = block_num;
+		for (u32 line : GetBlockLines(b))
+		{
+			valid_block.Set(line);
+			block_map.Insert(line, block_num);
+		}
 
 		if (block_link)
 		{
 			for (const auto& e : b.linkData)
 			{
-				links_to.insert(std::pair<u32, int>(e.exitAddress, block_num));
+				links_to.Insert(e.exitAddress, block_num);
 			}
 
 			LinkBlock(block_num);
 			LinkBlockExits(block_num);
 		}
 
+		if (disk_cache.IsOpen())
+			disk_cache.Store(b);
+
 		JitRegister::Register(blockCodePointers[block_num], b.codeSize,
 			"JIT_PPC_%08x", b.originalAddress);
 	}
@@ -203,7 +232,7 @@ using namespace Gen;
 				int destinationBlock = GetBlockNumberFromStartAddress(e.exitAddress);
 				if (destinationBlock != -1)
 				{
-					WriteLinkBlock(e.exitPtrs, blocks[destinationBlock].checkedEntry);
+					WriteLinkBlock(e.exitPtrs, GetLinkTarget(e, blocks[destinationBlock]));
 					e.linkStatus = true;
 				}
 			}
@@ -214,38 +243,47 @@ using namespace Gen;
 	{
 		LinkBlockExits(i);
 		JitBlock &b = blocks[i];
-		// equal_range(b) returns pair<iterator,iterator> representing the range
-		// of element with key b
-		auto ppp = links_to.equal_range(b.originalAddress);
-
-		if (ppp.first == ppp.second)
-			return;
-
-		for (auto iter = ppp.first; iter != ppp.second; ++iter)
+		links_to.ForEach(b.originalAddress, [this](int source)
 		{
-			// PanicAlert("Linking block %i to block %i", iter->second, i);
-			LinkBlockExits(iter->second);
-		}
+			LinkBlockExits(source);
+		});
 	}
 
 	void JitBaseBlockCache::UnlinkBlock(int i)
 	{
 		JitBlock &b = blocks[i];
-		auto ppp = links_to.equal_range(b.originalAddress);
-
-		if (ppp.first == ppp.second)
-			return;
-
-		for (auto iter = ppp.first; iter != ppp.second; ++iter)
+		links_to.ForEach(b.originalAddress, [&](int source)
 		{
-			JitBlock &sourceBlock = blocks[iter->second];
+			JitBlock &sourceBlock = blocks[source];
 			for (auto& e : sourceBlock.linkData)
 			{
 				if (e.exitAddress == b.originalAddress)
 					e.linkStatus = false;
 			}
+		});
+		links_to.EraseKey(b.originalAddress);
+	}
+
+	void JitBaseBlockCache::UnmapBlock(int i)
+	{
+		for (u32 line : GetBlockLines(blocks[i]))
+			block_map.Erase(line, i);
+	}
+
+	const std::vector<u32>& JitBaseBlockCache::GetBlockLines(const JitBlock& b)
+	{
+		block_lines.clear();
+		for (const auto& range : b.physicalRanges)
+		{
+			for (u32 line = range.first / 32; line <= (range.second - 1) / 32; ++line)
+				block_lines.push_back(line);
+		}
+		if (b.physicalRanges.size() > 1)
+		{
+			std::sort(block_lines.begin(), block_lines.end());
+			block_lines.erase(std::unique(block_lines.begin(), block_lines.end()), block_lines.end());
 		}
-		links_to.erase(b.originalAddress);
+		return block_lines;
 	}
 
 	void JitBaseBlockCache::DestroyBlock(int block_num, bool invalidate)
@@ -269,8 +307,91 @@ using namespace Gen;
 
 		// Send anyone who tries to run this block back to the dispatcher.
 		// Not entirely ideal, but .. pretty good.
-		// Spurious entrances from previously linked blocks can only come through checkedEntry
+		// Spurious entrances from previously linked blocks can only come through checkedEntry or regEntry
 		WriteDestroyBlock(b.checkedEntry, b.originalAddress);
+		if (b.regEntry)
+			WriteDestroyBlock(b.regEntry, b.originalAddress);
+	}
+
+	int JitBaseBlockCache::EvictBlocks(const CodeRanges& ranges, const std::function<const u8*(u32)>& exit_stub)
+	{
+		auto in_ranges = [&](const u8* ptr)
+		{
+			return std::any_of(ranges.begin(), ranges.end(), [&](const std::pair<const u8*, const u8*>& range)
+			{
+				return ptr >= range.first && ptr < range.second;
+			});
+		};
+
+		int evicted = 0;
+		for (int i = 0; i < num_blocks; i++)
+		{
+			JitBlock &b = blocks[i];
+			if (!b.checkedEntry || !in_ranges(b.checkedEntry))
+				continue;
+			if (!b.invalid)
+			{
+				DestroyBlock(i, true);
+				UnmapBlock(i);
+				evicted_addresses.insert(b.originalAddress);
+				evicted++;
+			}
+			// The code is about to be overwritten, so this block (whether it was
+			// valid or destroyed earlier) no longer owns it.
+			b.checkedEntry = nullptr;
+			b.normalEntry = nullptr;
+			b.regEntry = nullptr;
+			b.codeSize = 0;
+			blockCodePointers[i] = nullptr;
+		}
+
+		// Exits can point into the ranges whether or not they are marked as
+		// linked: exits to blocks destroyed earlier still jump to the code
+		// WriteDestroyBlock left there. Send them all to the dispatcher, and
+		// have them relinked once their destination is compiled again.
+		for (int i = 0; i < num_blocks; i++)
+		{
+			JitBlock &b = blocks[i];
+			if (b.invalid)
+				continue;
+			for (auto& e : b.linkData)
+			{
+				const u8* target = GetLinkBlockTarget(e.exitPtrs);
+				if (!target || !in_ranges(target))
+					continue;
+				WriteLinkBlock(e.exitPtrs, exit_stub(e.exitAddress));
+				e.linkStatus = false;
+			}
+		}
+
+		eviction_stats.evictions++;
+		eviction_stats.blocks_evicted += evicted;
+		return evicted;
+	}
+
+	void JitBaseBlockCache::SetEntryHint(u32 em_address, const JitRegMap& regs)
+	{
+		entry_hints.emplace(em_address, regs);
+	}
+
+	bool JitBaseBlockCache::GetEntryHint(u32 em_address, JitRegMap* regs) const
+	{
+		auto it = entry_hints.find(em_address);
+		if (it == entry_hints.end())
+			return false;
+		*regs = it->second;
+		return true;
+	}
+
+	const u8* JitBaseBlockCache::GetLinkTarget(const JitBlock::LinkData& exit, const JitBlock& dest)
+	{
+		if (dest.regEntry && dest.entryRegs.IsSatisfiedBy(exit.exitRegs))
+		{
+			reg_entry_links++;
+			reg_entry_loads_avoided += dest.entryRegs.Count();
+			return dest.regEntry;
+		}
+		return dest.checkedEntry;
 	}
 
 	void JitBaseBlockCache::InvalidateICache(u32 address, const u32 length, bool forced)
@@ -292,17 +413,49 @@ using namespace Gen;
 		// !! this works correctly under assumption that any two overlapping blocks end at the same address
 		if (destroy_block)
 		{
-			std::map<std::pair<u32,u32>, u32>::iterator it1 = block_map.lower_bound(std::make_pair(pAddr, 0)), it2 = it1;
-			while (it2 != block_map.end() && it2->first.second < pAddr + length)
+			u64 range_end = (u64)pAddr + length;
+			auto overlaps = [&](int block_num)
 			{
-				JitBlock &b = blocks[it2->second];
-				*GetICachePtr(b.originalAddress) = JIT_ICACHE_INVALID_WORD;
-				DestroyBlock(it2->second, true);
-				++it2;
+				const JitBlock &b = blocks[block_num];
+				if (b.invalid)
+					return false;
+				return std::any_of(b.physicalRanges.begin(), b.physicalRanges.end(), [&](const std::pair<u32, u32>& range)
+				{
+					return range.first < range_end && range.second > pAddr;
+				});
+			};
+
+			// Collect the blocks first, since destroying them modifies the index.
+			// Huge ranges (full cache invalidations) are cheaper to handle by
+			// scanning the block list than by walking every 32-byte line.
+			invalidate_list.clear();
+			if (length / 32 > (u32)num_blocks)
+			{
+				for (int i = 0; i < num_blocks; i++)
+				{
+					if (overlaps(i))
+						invalidate_list.push_back(i);
+				}
 			}
-			if (it1 != it2)
+			else if (length > 0)
 			{
-				block_map.erase(it1, it2);
+				for (u32 line = pAddr / 32; line <= (u32)((range_end - 1) / 32); ++line)
+				{
+					block_map.ForEach(line, [&](int block_num)
+					{
+						if (overlaps(block_num) &&
+						    std::find(invalidate_list.begin(), invalidate_list.end(), block_num) == invalidate_list.end())
+						{
+							invalidate_list.push_back(block_num);
+						}
+					});
+				}
+			}
+
+			for (int block_num : invalidate_list)
+			{
+				DestroyBlock(block_num, true);
+				UnmapBlock(block_num);
 			}
 
 			// If the code was actually modified, we need to clear the relevant entries from the
@@ -329,6 +482,15 @@ using namespace Gen;
 			emit.JMP(address, true);
 	}
 
+	const u8* JitBlockCache::GetLinkBlockTarget(const u8* location)
+	{
+		// WriteLinkBlock and the JIT's exits both use a CALL or JMP with a 32-bit
+		// displacement.
+		if (*location != 0xE8 && *location != 0xE9)
+			return nullptr;
+		return location + 5 + *(const s32*)(location + 1);
+	}
+
 	void JitBlockCache::WriteDestroyBlock(const u8* location, u32 address)
 	{
 		XEmitter emit((u8 *)location);
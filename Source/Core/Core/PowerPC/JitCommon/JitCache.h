@@ -4,14 +4,20 @@
 
 #pragma once
 
+#include <algorithm>
 #include <array>
 #include <bitset>
-#include <map>
+#include <functional>
 #include <memory>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
 #include <vector>
 
 #include "Core/PowerPC/Gekko.h"
 #include "Core/PowerPC/PPCAnalyst.h"
+#include "Core/PowerPC/JitCommon/JitBlockIndex.h"
+#include "Core/PowerPC/JitCommon/JitDiskCache.h"
 
 // emulate CPU with unlimited instruction cache
 // the only way to invalidate a region is the "icbi" instruction
@@ -27,15 +33,54 @@
 #define JIT_ICACHE_INVALID_BYTE 0x80
 #define JIT_ICACHE_INVALID_WORD 0x80808080
 
+// Guest registers held in host registers across a block boundary: the host
+// register number for each GPR and FPR, or -1 if it's only in PowerPCState.
+struct JitRegMap
+{
+	std::array<s8, 32> gpr;
+	std::array<s8, 32> fpr;
+
+	JitRegMap() { Clear(); }
+
+	void Clear()
+	{
+		gpr.fill(-1);
+		fpr.fill(-1);
+	}
+
+	int Count() const
+	{
+		return (int)(std::count_if(gpr.begin(), gpr.end(), [](s8 r) { return r >= 0; }) +
+		             std::count_if(fpr.begin(), fpr.end(), [](s8 r) { return r >= 0; }));
+	}
+
+	// True if every register this map expects in a host register is in that
+	// same host register in other.
+	bool IsSatisfiedBy(const JitRegMap& other) const
+	{
+		for (int i = 0; i < 32; i++)
+		{
+			if ((gpr[i] >= 0 && gpr[i] != other.gpr[i]) || (fpr[i] >= 0 && fpr[i] != other.fpr[i]))
+				return false;
+		}
+		return true;
+	}
+};
+
 struct JitBlock
 {
 	const u8 *checkedEntry;
 	const u8 *normalEntry;
+	// Alternative to checkedEntry for linked predecessors that already hold
+	// the registers in entryRegs; skips loading them. Null if the block has
+	// no register entry convention.
+	const u8 *regEntry;
+	JitRegMap entryRegs;
 
 	u32 originalAddress;
 	u32 codeSize;
 	u32 originalSize;
-	int runCount;  // for profiling.
+	u64 runCount;  // for profiling and the code GC.
 
 	bool invalid;
 
@@ -44,9 +89,16 @@ struct JitBlock
 		u8 *exitPtrs;    // to be able to rewrite the exit jum
 		u32 exitAddress;
 		bool linkStatus; // is it already linked?
+		JitRegMap exitRegs; // guest registers still in host registers at the jump
 	};
 	std::vector<LinkData> linkData;
 
+	// Physical [start, end) address ranges of the guest code the block was
+	// compiled from. Filled in by FinalizeBlock from originalAddress and
+	// originalSize unless the JIT already set them: traces (see
+	// PPCAnalyst::OPTION_BRANCH_FOLLOW) can span several discontiguous ranges.
+	std::vector<std::pair<u32, u32>> physicalRanges;
+
 	// we don't really need to save start and stop
 	// TODO (mb2): ticStart and ticStop -> "local var" mean "in block" ... low priority ;)
 	u64 ticStart;   // for profiling - time.
@@ -56,6 +108,16 @@ struct JitBlock
 
 typedef void (*CompiledCode)();
 
+// Statistics of JitBaseBlockCache::EvictBlocks, for the profiler.
+struct JitEvictionStats
+{
+	u64 evictions;
+	u64 blocks_evicted;
+	// Compiles of addresses whose block was evicted, and the time they took.
+	u64 recompiles;
+	u64 recompile_us;
+};
+
 // This is essentially just an std::bitset, but Visual Studia 2013's
 // implementation of std::bitset is slow.
 class ValidBlockBitSet final
@@ -105,9 +167,21 @@ class JitBaseBlockCache
 	std::array<const u8*, MAX_NUM_BLOCKS> blockCodePointers;
 	std::array<JitBlock, MAX_NUM_BLOCKS> blocks;
 	int num_blocks;
-	std::multimap<u32, int> links_to;
-	std::map<std::pair<u32, u32>, u32> block_map; // (end_addr, start_addr) -> number
+	JitBlockIndex links_to;  // exit address -> numbers of the blocks exiting there
+	JitBlockIndex block_map; // physical 32-byte line -> numbers of the blocks covering it
+	std::vector<int> invalidate_list;
+	std::vector<u32> block_lines;
+	// Registers the first predecessor to exit to a not yet compiled address
+	// left in host registers; the block compiled there adopts them as its entry
+	// convention.
+	std::unordered_map<u32, JitRegMap> entry_hints;
+	u64 reg_entry_links;
+	u64 reg_entry_loads_avoided;
+	// Addresses whose block was evicted and hasn't been compiled again yet.
+	std::unordered_set<u32> evicted_addresses;
+	JitEvictionStats eviction_stats;
 	ValidBlockBitSet valid_block;
+	JitBlockDiskCache disk_cache;
 
 	bool m_initialized;
 
@@ -115,6 +189,9 @@ class JitBaseBlockCache
 	void LinkBlockExits(int i);
 	void LinkBlock(int i);
 	void UnlinkBlock(int i);
+	void UnmapBlock(int i);
+	// The physical 32-byte lines a block's guest code occupies.
+	const std::vector<u32>& GetBlockLines(const JitBlock& b);
 
 	u32* GetICachePtr(u32 addr);
 	void DestroyBlock(int block_num, bool invalidate);
@@ -122,9 +199,12 @@ class JitBaseBlockCache
 	// Virtual for overloaded
 	virtual void WriteLinkBlock(u8* location, const u8* address) = 0;
 	virtual void WriteDestroyBlock(const u8* location, u32 address) = 0;
+	// Where the exit written by WriteLinkBlock at location jumps to, or null if
+	// the backend can't tell. Only needed by EvictBlocks.
+	virtual const u8* GetLinkBlockTarget(const u8* location) { return nullptr; }
 
 public:
-	JitBaseBlockCache() : num_blocks(0), m_initialized(false)
+	JitBaseBlockCache() : num_blocks(0), reg_entry_links(0), reg_entry_loads_avoided(0), eviction_stats(), m_initialized(false)
 	{
 	}
 
@@ -142,6 +222,36 @@ public:
 
 	bool IsFull() const;
 
+	// Persistent cache statistics, for the profiler.
+	const JitBlockDiskCache& GetDiskCache() const { return disk_cache; }
+
+	// Cross-block register allocation.
+	void SetEntryHint(u32 em_address, const JitRegMap& regs);
+	bool GetEntryHint(u32 em_address, JitRegMap* regs) const;
+	// Where an exit should jump to enter dest: its register entry if the exit
+	// holds the registers dest expects, its checked entry otherwise.
+	const u8* GetLinkTarget(const JitBlock::LinkData& exit, const JitBlock& dest);
+	u64 GetRegEntryLinks() const { return reg_entry_links; }
+	u64 GetRegEntryLoadsAvoided() const { return reg_entry_loads_avoided; }
+
+	// Incremental code space reclamation, for JITs that reuse part of their
+	// code space instead of clearing all of it. Destroys the blocks whose code
+	// starts in one of the [start, end) ranges and points the exits of the
+	// other blocks that jump into the ranges at exit_stub(exit address), which
+	// has to set the PC and go to the dispatcher. Returns the number of blocks
+	// evicted.
+	typedef std::vector<std::pair<const u8*, const u8*>> CodeRanges;
+	int EvictBlocks(const CodeRanges& ranges, const std::function<const u8*(u32)>& exit_stub);
+	// Returns true, once, if em_address is being compiled again after its
+	// block was evicted.
+	bool TakeEvicted(u32 em_address) { return evicted_addresses.erase(em_address) != 0; }
+	void AddRecompileTime(u64 us)
+	{
+		eviction_stats.recompiles++;
+		eviction_stats.recompile_us += us;
+	}
+	const JitEvictionStats& GetEvictionStats() const { return eviction_stats; }
+
 	// Code Cache
 	JitBlock *GetBlock(int block_num);
 	int GetNumBlocks() const;
@@ -165,4 +275,5 @@ class JitBlockCache : public JitBaseBlockCache
 private:
 	void WriteLinkBlock(u8* location, const u8* address) override;
 	void WriteDestroyBlock(const u8* location, u32 address) override;
+	const u8* GetLinkBlockTarget(const u8* location) override;
 };
@@ -0,0 +1,216 @@
+// Copyright 2015 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <algorithm>
+
+#include "Common/Hash.h"
+#include "Common/Logging/Log.h"
+#include "Core/ConfigManager.h"
+#include "Core/PowerPC/PowerPC.h"
+#include "Core/PowerPC/JitCommon/JitBase.h"
+#include "Core/PowerPC/JitCommon/JitCache.h"
+#include "Core/PowerPC/JitCommon/JitDiskCache.h"
+
+class JitBlockDiskCache::Reader : public LinearDiskCacheReader<JitBlockDiskCache::Key, u32>
+{
+public:
+	Reader(JitBlockDiskCache* cache) : m_cache(cache) {}
+
+	void Read(const Key& key, const u32* value, u32 value_size) override
+	{
+		if (value_size < VALUE_HEADER_SIZE || value[VALUE_NUM_RANGES] == 0 ||
+		    value[VALUE_NUM_RANGES] > value_size / 2 || value[VALUE_NUM_FIFO_WRITES] > value_size ||
+		    value_size != VALUE_HEADER_SIZE + value[VALUE_NUM_RANGES] * 2 + value[VALUE_NUM_FIFO_WRITES])
+			return;
+		for (u32 i = 0; i < value[VALUE_NUM_RANGES]; i++)
+		{
+			u32 start = value[VALUE_HEADER_SIZE + i * 2];
+			u32 end = value[VALUE_HEADER_SIZE + i * 2 + 1];
+			if (start >= end || (start | end) & 3)
+				return;
+		}
+		m_cache->Insert(key, value, value_size);
+	}
+
+private:
+	JitBlockDiskCache* m_cache;
+};
+
+JitBlockDiskCache::JitBlockDiskCache()
+	: m_config_hash(0), m_open(false), m_hits(0), m_misses(0), m_stores(0)
+{
+}
+
+void JitBlockDiskCache::Open(const std::string& filename)
+{
+	Close();
+
+	m_config_hash = ComputeConfigHash();
+	m_hits = 0;
+	m_misses = 0;
+	m_stores = 0;
+
+	Reader reader(this);
+	u32 num_entries = m_file.OpenAndRead(filename, reader);
+	m_open = true;
+
+	INFO_LOG(DYNA_REC, "JIT block cache: loaded %u entries from %s", num_entries, filename.c_str());
+}
+
+void JitBlockDiskCache::Close()
+{
+	if (!m_open)
+		return;
+
+	NOTICE_LOG(DYNA_REC, "JIT block cache: %u hits, %u misses, %u blocks stored", m_hits, m_misses, m_stores);
+
+	m_file.Sync();
+	m_file.Close();
+	m_entries.clear();
+	m_open = false;
+}
+
+u32 JitBlockDiskCache::ComputeConfigHash()
+{
+	const SCoreStartupParameter& param = SConfig::GetInstance().m_LocalCoreStartupParameter;
+	const u32 config[] = {
+		FORMAT_VERSION,
+		(u32)param.iCPUCore,
+		param.bMMU,
+		param.bFastmem,
+		param.bFPRF,
+		param.bJITNoBlockLinking,
+	};
+	return (u32)GetMurmurHash3((const u8*)config, sizeof(config), 0);
+}
+
+std::vector<std::pair<u32, u32>> JitBlockDiskCache::GetGuestRanges(const JitBlock& b)
+{
+	if (b.physicalRanges.size() <= 1)
+		return { std::make_pair(b.originalAddress, b.originalAddress + b.originalSize * 4) };
+
+	// Traces only follow branches through BAT-mapped code, so every part of
+	// one is in the same segment as the block address.
+	std::vector<std::pair<u32, u32>> ranges;
+	u32 segment = b.originalAddress & ~0x1FFFFFFF;
+	for (const auto& range : b.physicalRanges)
+		ranges.emplace_back(range.first | segment, range.second | segment);
+	return ranges;
+}
+
+std::vector<std::pair<u32, u32>> JitBlockDiskCache::ReadRanges(const std::vector<u32>& value)
+{
+	std::vector<std::pair<u32, u32>> ranges;
+	for (u32 i = 0; i < value[VALUE_NUM_RANGES]; i++)
+		ranges.emplace_back(value[VALUE_HEADER_SIZE + i * 2], value[VALUE_HEADER_SIZE + i * 2 + 1]);
+	return ranges;
+}
+
+bool JitBlockDiskCache::HashGuestCode(const std::vector<std::pair<u32, u32>>& ranges, u64* hash)
+{
+	std::vector<u32> code;
+	for (const auto& range : ranges)
+	{
+		for (u32 inst_address = range.first; inst_address != range.second; inst_address += 4)
+		{
+			if (!PowerPC::HostIsRAMAddress(inst_address))
+				return false;
+			code.push_back(PowerPC::HostRead_Instruction(inst_address));
+		}
+	}
+	if (code.empty())
+		return false;
+
+	// MurmurHash3 rather than GetHash64, since the latter depends on the host CPU
+	// and the cache has to stay valid if it is moved between machines.
+	*hash = GetMurmurHash3((const u8*)code.data(), (u32)(code.size() * sizeof(u32)), 0);
+	return true;
+}
+
+void JitBlockDiskCache::Insert(const Key& key, const u32* value, u32 value_size)
+{
+	auto range = m_entries.equal_range(key.address);
+	for (auto it = range.first; it != range.second; ++it)
+	{
+		Entry& e = it->second;
+		if (e.key.code_hash != key.code_hash || e.key.config_hash != key.config_hash)
+			continue;
+
+		// Entries are only ever appended, so a later entry for the same block is
+		// at least as complete as an earlier one.
+		e.value.assign(value, value + value_size);
+		return;
+	}
+
+	Entry e;
+	e.key = key;
+	e.value.assign(value, value + value_size);
+	m_entries.emplace(key.address, std::move(e));
+}
+
+void JitBlockDiskCache::Apply(u32 em_address)
+{
+	auto range = m_entries.equal_range(em_address);
+	for (auto it = range.first; it != range.second; ++it)
+	{
+		const Entry& e = it->second;
+		if (e.key.config_hash != m_config_hash)
+			continue;
+
+		u64 hash;
+		if (!HashGuestCode(ReadRanges(e.value), &hash) || hash != e.key.code_hash)
+			continue;
+
+		const u32* fifo_writes = &e.value[VALUE_HEADER_SIZE + e.value[VALUE_NUM_RANGES] * 2];
+		for (u32 i = 0; i < e.value[VALUE_NUM_FIFO_WRITES]; i++)
+			jit->js.fifoWriteAddresses.insert(em_address + fifo_writes[i]);
+		if (e.value[VALUE_PAIRED_QUANTIZE])
+			jit->js.pairedQuantizeAddresses.insert(em_address);
+
+		m_hits++;
+		return;
+	}
+
+	m_misses++;
+}
+
+void JitBlockDiskCache::Store(const JitBlock& b)
+{
+	Key key;
+	key.address = b.originalAddress;
+	key.config_hash = m_config_hash;
+	std::vector<std::pair<u32, u32>> ranges = GetGuestRanges(b);
+	if (!HashGuestCode(ranges, &key.code_hash))
+		return;
+
+	std::vector<u32> value(VALUE_HEADER_SIZE);
+	value[VALUE_NUM_RANGES] = (u32)ranges.size();
+	value[VALUE_PAIRED_QUANTIZE] = jit->js.pairedQuantizeAddresses.count(b.originalAddress) != 0;
+	for (const auto& range : ranges)
+	{
+		value.push_back(range.first);
+		value.push_back(range.second);
+	}
+	for (const auto& range : ranges)
+	{
+		for (u32 inst_address = range.first; inst_address != range.second; inst_address += 4)
+		{
+			if (jit->js.fifoWriteAddresses.count(inst_address))
+				value.push_back(inst_address - b.originalAddress);
+		}
+	}
+	value[VALUE_NUM_FIFO_WRITES] = (u32)(value.size() - VALUE_HEADER_SIZE - ranges.size() * 2);
+
+	auto range = m_entries.equal_range(key.address);
+	for (auto it = range.first; it != range.second; ++it)
+	{
+		const Entry& e = it->second;
+		if (e.key.code_hash == key.code_hash && e.key.config_hash == key.config_hash && e.value == value)
+			return;
+	}
+
+	m_file.Append(key, value.data(), (u32)value.size());
+	Insert(key, value.data(), (u32)value.size());
+	m_stores++;
+}
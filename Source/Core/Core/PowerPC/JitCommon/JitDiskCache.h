@@ -0,0 +1,103 @@
+// Copyright 2015 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "Common/CommonTypes.h"
+#include "Common/LinearDiskCache.h"
+
+struct JitBlock;
+
+// Persistent per-title cache of block compilation state.
+//
+// The host code emitted by the x86 and ARM JITs is not relocatable (it embeds
+// absolute pointers into PowerPCState, the far code region, the trampoline
+// cache and the block link sites), so the compiled code itself is never
+// written to disk. Instead, every finalized block is recorded together with a
+// hash of its guest instructions and the state the JIT had to discover at
+// runtime to compile it correctly (gather pipe writes with a non-immediate
+// address, blocks that turned out to use paired quantization). Without this,
+// each such discovery costs an invalidation and a second compile of the block
+// on every boot.
+//
+// Entries are only applied if the guest code the block runs (all of it, for a
+// trace that follows branches) still hashes to the recorded value, so
+// self-modifying code and different game revisions fall back to a normal,
+// uncached compile.
+class JitBlockDiskCache
+{
+public:
+	struct Key
+	{
+		u64 code_hash;
+		u32 address;
+		u32 config_hash;
+	};
+
+	JitBlockDiskCache();
+
+	void Open(const std::string& filename);
+	void Close();
+	bool IsOpen() const { return m_open; }
+
+	// Called when a block is allocated: seeds the JIT state from a previous
+	// session if a matching entry exists.
+	void Apply(u32 em_address);
+
+	// Called when a block is finalized: records its compilation state.
+	void Store(const JitBlock& b);
+
+	u32 GetHits() const { return m_hits; }
+	u32 GetMisses() const { return m_misses; }
+	u32 GetStores() const { return m_stores; }
+
+private:
+	// Value layout: { num_ranges, num_fifo_writes, paired_quantize,
+	//                 range starts and ends..., fifo_write_offsets... }
+	// The ranges are the [start, end) effective addresses of the guest code the
+	// block runs, in order; more than one if it's a trace. FIFO writes are
+	// recorded as offsets from the block address.
+	enum
+	{
+		// Part of the config hash, so entries in an older layout never match.
+		FORMAT_VERSION = 2
+	};
+	enum
+	{
+		VALUE_NUM_RANGES,
+		VALUE_NUM_FIFO_WRITES,
+		VALUE_PAIRED_QUANTIZE,
+		VALUE_HEADER_SIZE
+	};
+
+	struct Entry
+	{
+		Key key;
+		std::vector<u32> value;
+	};
+
+	class Reader;
+
+	static u32 ComputeConfigHash();
+	static std::vector<std::pair<u32, u32>> GetGuestRanges(const JitBlock& b);
+	static bool HashGuestCode(const std::vector<std::pair<u32, u32>>& ranges, u64* hash);
+	static std::vector<std::pair<u32, u32>> ReadRanges(const std::vector<u32>& value);
+	void Insert(const Key& key, const u32* value, u32 value_size);
+
+	LinearDiskCache<Key, u32> m_file;
+	// Several entries may exist for the same address (overlays, different
+	// config hashes), so keep them all and pick the one that validates.
+	std::unordered_multimap<u32, Entry> m_entries;
+	u32 m_config_hash;
+	bool m_open;
+
+	u32 m_hits;
+	u32 m_misses;
+	u32 m_stores;
+};
@@ -0,0 +1,365 @@
+// Copyright 2015 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <cinttypes>
+#include <climits>
+#include <cstddef>
+#include <cstring>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "Common/GekkoDisassembler.h"
+#include "Common/StringUtil.h"
+#include "Common/Logging/Log.h"
+#include "Core/ConfigManager.h"
+#include "Core/CoreTiming.h"
+#include "Core/HLE/HLE.h"
+#include "Core/PowerPC/PowerPC.h"
+#include "Core/PowerPC/Interpreter/Interpreter.h"
+#include "Core/PowerPC/JitCommon/JitBase.h"
+#include "Core/PowerPC/JitCommon/JitLockstep.h"
+
+namespace JitLockstep
+{
+
+// Everything before the TLBs; they and the instruction cache behind them
+// only cache state that is architected elsewhere.
+static const size_t REGISTERS_SIZE = offsetof(PowerPC::PowerPCState, dtlb);
+
+struct BlockInfo
+{
+	std::vector<u32> path;
+	bool hle;
+};
+
+struct LoggedByte
+{
+	u32 address;
+	u8 before;
+	u8 after;
+};
+
+static std::unordered_map<u32, BlockInfo> s_blocks;
+static std::vector<LoggedByte> s_stores;
+static bool s_touched_hardware;
+static int s_max_block_size = INT_MAX;
+
+static PowerPC::PowerPCState s_before;
+static PowerPC::PowerPCState s_interpreter;
+
+static std::vector<Divergence> s_divergences;
+static std::unordered_set<u32> s_reported_blocks;
+static Stats s_stats;
+
+// PowerPCState isn't trivially copyable, but everything before the TLBs is
+// plain data.
+static void CopyRegisters(PowerPC::PowerPCState* dest, const PowerPC::PowerPCState& src)
+{
+	memcpy(static_cast<void*>(dest), &src, REGISTERS_SIZE);
+}
+
+static void LogAccess(u32 address, u32 size, bool write)
+{
+	if (s_touched_hardware)
+		return;
+
+	if (!PowerPC::HostIsRAMAddress(address) || !PowerPC::HostIsRAMAddress(address + size - 1))
+	{
+		s_touched_hardware = true;
+		return;
+	}
+
+	if (write)
+	{
+		for (u32 i = 0; i < size; i++)
+			s_stores.push_back({address + i, PowerPC::HostRead_U8(address + i), 0});
+	}
+}
+
+// The block at the address as the JIT compiled it, compiling it if needed.
+// nullptr if fetching it raised an ISI instead.
+static const BlockInfo* GetBlock(u32 address)
+{
+	JitBaseBlockCache* cache = jit->GetBlockCache();
+	int block_num = cache->GetBlockNumberFromStartAddress(address);
+	auto it = s_blocks.find(address);
+	if (block_num >= 0 && it != s_blocks.end())
+		return &it->second;
+
+	if (block_num >= 0)
+		cache->InvalidateICache(address, 4, true);
+	jit->Jit(address);
+	if (cache->GetBlockNumberFromStartAddress(address) < 0)
+		return nullptr;
+
+	BlockInfo& block = s_blocks[address];
+	block.path = jit->GetLastBlockPath();
+	block.hle = std::any_of(block.path.begin(), block.path.end(), [](u32 path_address) {
+		return HLE::GetFunctionIndex(path_address) != 0;
+	});
+	return &block;
+}
+
+// Runs the block's instructions until control leaves them. Returns how many
+// ran.
+static size_t RunInterpreter(const std::vector<u32>& path, size_t count)
+{
+	Interpreter* interpreter = Interpreter::getInstance();
+	int cycles = 0;
+	size_t executed = 0;
+	while (executed < count && PC == path[executed])
+	{
+		cycles += interpreter->SingleStepInner();
+		executed++;
+	}
+	PowerPC::ppcState.downcount -= cycles;
+	return executed;
+}
+
+static size_t RunLogged(const std::vector<u32>& path, size_t count)
+{
+	s_stores.clear();
+	s_touched_hardware = false;
+	PowerPC::SetMemoryAccessHook(LogAccess);
+	size_t executed = RunInterpreter(path, count);
+	PowerPC::SetMemoryAccessHook(nullptr);
+	return executed;
+}
+
+// Puts back the registers and the memory the last logged run stored to.
+static void Restore()
+{
+	CopyRegisters(&PowerPC::ppcState, s_before);
+	for (auto it = s_stores.rbegin(); it != s_stores.rend(); ++it)
+		PowerPC::HostWrite_U8(it->before, it->address);
+}
+
+// Keeps the result of a logged run for Compare, then restores.
+static void Rewind()
+{
+	CopyRegisters(&s_interpreter, PowerPC::ppcState);
+	// Translate the addresses the way they were when the block stored to them.
+	CopyRegisters(&PowerPC::ppcState, s_before);
+	for (LoggedByte& store : s_stores)
+		store.after = PowerPC::HostRead_U8(store.address);
+	Restore();
+}
+
+static void CompareValue(std::vector<std::string>* differences, const std::string& name, u32 interpreter, u32 jit_value)
+{
+	if (interpreter != jit_value)
+		differences->push_back(StringFromFormat("%s: %08x, %08x", name.c_str(), interpreter, jit_value));
+}
+
+static void CompareValue(std::vector<std::string>* differences, const std::string& name, u64 interpreter, u64 jit_value)
+{
+	if (interpreter != jit_value)
+		differences->push_back(StringFromFormat("%s: %016" PRIx64 ", %016" PRIx64, name.c_str(), interpreter, jit_value));
+}
+
+// GetCR without the SO bits.
+static u32 GetCR(const PowerPC::PowerPCState& state)
+{
+	u32 cr = 0;
+	for (int i = 0; i < 8; i++)
+	{
+		u64 cr_val = state.cr_val[i];
+		u32 field = 0;
+		field |= ((cr_val & 0xFFFFFFFF) == 0) << 1;
+		field |= ((s64)cr_val > 0) << 2;
+		field |= !!(cr_val & (1ull << 62)) << 3;
+		cr |= field << (28 - i * 4);
+	}
+	return cr;
+}
+
+static u32 GetXER(const PowerPC::PowerPCState& state)
+{
+	return state.xer_stringctrl | (state.xer_ca << XER_CA_SHIFT) | (state.xer_so_ov << XER_OV_SHIFT);
+}
+
+// The interpreter's result against the JIT's, which is in ppcState.
+static std::vector<std::string> Compare()
+{
+	const PowerPC::PowerPCState& a = s_interpreter;
+	const PowerPC::PowerPCState& b = PowerPC::ppcState;
+	std::vector<std::string> differences;
+
+	for (int i = 0; i < 32; i++)
+		CompareValue(&differences, StringFromFormat("r%d", i), a.gpr[i], b.gpr[i]);
+	CompareValue(&differences, "pc", a.pc, b.pc);
+	CompareValue(&differences, "cr", GetCR(a), GetCR(b));
+	CompareValue(&differences, "xer", GetXER(a), GetXER(b));
+	CompareValue(&differences, "msr", a.msr, b.msr);
+	u32 fpscr_mask = 0xFF;
+	if (SConfig::GetInstance().m_LocalCoreStartupParameter.bFPRF)
+		fpscr_mask |= FPRF_MASK;
+	CompareValue(&differences, "fpscr", a.fpscr & fpscr_mask, b.fpscr & fpscr_mask);
+	CompareValue(&differences, "exceptions", a.Exceptions, b.Exceptions);
+	CompareValue(&differences, "reserve", (u32)a.reserve, (u32)b.reserve);
+	if (a.reserve && b.reserve)
+		CompareValue(&differences, "reserve_address", a.reserve_address, b.reserve_address);
+	for (int i = 0; i < 32; i++)
+	{
+		CompareValue(&differences, StringFromFormat("ps%d_0", i), a.ps[i][0], b.ps[i][0]);
+		CompareValue(&differences, StringFromFormat("ps%d_1", i), a.ps[i][1], b.ps[i][1]);
+	}
+	for (int i = 0; i < 16; i++)
+		CompareValue(&differences, StringFromFormat("sr%d", i), a.sr[i], b.sr[i]);
+	for (int i = 0; i < 1024; i++)
+	{
+		if (i != SPR_TL && i != SPR_TU && i != SPR_DEC)
+			CompareValue(&differences, StringFromFormat("spr%d", i), a.spr[i], b.spr[i]);
+	}
+
+	u32 msr = MSR;
+	MSR = s_before.msr;
+	std::unordered_set<u32> reported;
+	for (const LoggedByte& store : s_stores)
+	{
+		u8 value = PowerPC::HostRead_U8(store.address);
+		if (value != store.after && reported.insert(store.address).second)
+			differences.push_back(StringFromFormat("[%08x]: %02x, %02x", store.address, store.after, value));
+	}
+	MSR = msr;
+
+	return differences;
+}
+
+// Finds the first instruction whose result differs when the block is cut off
+// right after it. Blames the last one that ran if no shorter block differs on
+// its own.
+static u32 FindFirstDivergence(u32 start, const std::vector<u32>& path, size_t executed, std::vector<std::string>* differences)
+{
+	JitBaseBlockCache* cache = jit->GetBlockCache();
+	u32 address = executed ? path[executed - 1] : start;
+	for (size_t count = 1; count < executed; count++)
+	{
+		Restore();
+		RunLogged(path, count);
+		Rewind();
+
+		cache->InvalidateICache(start, 4, true);
+		s_max_block_size = (int)count;
+		jit->Jit(start);
+		s_max_block_size = INT_MAX;
+		jit->SingleStep();
+
+		std::vector<std::string> cut = Compare();
+		if (!cut.empty())
+		{
+			address = path[count - 1];
+			*differences = std::move(cut);
+			break;
+		}
+	}
+
+	// Compile the whole block again next time.
+	cache->InvalidateICache(start, 4, true);
+	return address;
+}
+
+bool Step()
+{
+	const u32 start = PC;
+	const BlockInfo* block = GetBlock(start);
+	if (!block)
+		return true;
+
+	CopyRegisters(&s_before, PowerPC::ppcState);
+	if (block->hle)
+	{
+		RunInterpreter(block->path, block->path.size());
+		s_stats.blocks_skipped++;
+		return true;
+	}
+
+	size_t executed = RunLogged(block->path, block->path.size());
+	if (s_touched_hardware)
+	{
+		s_stats.blocks_skipped++;
+		return true;
+	}
+	Rewind();
+
+	// An icbi in the block may have dropped it.
+	block = GetBlock(start);
+	if (!block)
+		return true;
+	jit->SingleStep();
+
+	std::vector<std::string> differences = Compare();
+	if (differences.empty())
+	{
+		// The cores may still differ in what isn't compared.
+		CopyRegisters(&PowerPC::ppcState, s_interpreter);
+		s_stats.blocks_compared++;
+		return true;
+	}
+
+	s_stats.divergences++;
+	if (s_reported_blocks.insert(start).second)
+	{
+		Divergence divergence;
+		divergence.block_address = start;
+		divergence.address = FindFirstDivergence(start, block->path, executed, &differences);
+		divergence.differences = std::move(differences);
+
+		Restore();
+		divergence.disassembly = GekkoDisassembler::Disassemble(PowerPC::HostRead_Instruction(divergence.address), divergence.address);
+		ERROR_LOG(DYNA_REC, "Lockstep: block %08x diverges at %08x %s (interpreter, JIT):",
+		          start, divergence.address, divergence.disassembly.c_str());
+		for (const std::string& difference : divergence.differences)
+			ERROR_LOG(DYNA_REC, "  %s", difference.c_str());
+		s_divergences.push_back(std::move(divergence));
+	}
+
+	// Carry on from the interpreter's result.
+	Restore();
+	RunInterpreter(block->path, block->path.size());
+	return false;
+}
+
+void Run()
+{
+	while (PowerPC::GetState() == PowerPC::CPU_RUNNING)
+	{
+		CoreTiming::Advance();
+
+		while (PowerPC::ppcState.downcount > 0)
+			Step();
+
+		if (PowerPC::ppcState.Exceptions & (EXCEPTION_EXTERNAL_INT | EXCEPTION_PERFORMANCE_MONITOR | EXCEPTION_DECREMENTER))
+		{
+			NPC = PC;
+			PowerPC::CheckExternalExceptions();
+		}
+	}
+}
+
+int GetMaxBlockSize()
+{
+	return s_max_block_size;
+}
+
+const std::vector<Divergence>& GetDivergences()
+{
+	return s_divergences;
+}
+
+const Stats& GetStats()
+{
+	return s_stats;
+}
+
+void Reset()
+{
+	s_blocks.clear();
+	s_divergences.clear();
+	s_reported_blocks.clear();
+	s_stats = Stats();
+}
+
+}
@@ -0,0 +1,61 @@
+// Copyright 2015 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "Common/CommonTypes.h"
+
+// Checks the JIT against the interpreter one block at a time
+// (SCoreStartupParameter::bJITLockstep). Each block first runs in the
+// interpreter, with its stores logged, then the registers and the stored-to
+// memory are put back and the compiled block runs from the same state. The
+// guest carries on from the interpreter's result.
+//
+// When the results differ, the block is compiled again cut off after one
+// instruction, then two, and so on; the first cut that differs ends with the
+// instruction that is reported.
+//
+// Blocks that touch hardware or call HLE functions can't run twice, so they
+// only run in the interpreter. Only memory the interpreter stored to is
+// compared. Known differences between the cores aren't reported: CR SO bits,
+// which Jit64 derives from the sign of results, FPSCR status bits, which Jit64
+// doesn't track, and the timing state.
+namespace JitLockstep
+{
+
+struct Divergence
+{
+	u32 block_address;
+	u32 address;
+	std::string disassembly;
+	// "name: interpreter value, JIT value" for each register or byte.
+	std::vector<std::string> differences;
+};
+
+struct Stats
+{
+	u64 blocks_compared;
+	u64 blocks_skipped;
+	u64 divergences;
+};
+
+// Runs the block at PC in both cores. Returns false if they disagreed.
+bool Step();
+
+// Jit64::Run in lockstep mode: Step, with the timing and external exception
+// checks the dispatcher does in between.
+void Run();
+
+// Jit() doesn't compile blocks longer than this.
+int GetMaxBlockSize();
+
+// The first divergence of each block, in the order they were found.
+const std::vector<Divergence>& GetDivergences();
+const Stats& GetStats();
+void Reset();
+
+}
@@ -46,6 +46,14 @@ static const int FARCODE_SIZE_MMU = 1024 * 1024 * 48;
 static const int TRAMPOLINE_CODE_SIZE = 1024 * 1024 * 8;
 static const int TRAMPOLINE_CODE_SIZE_MMU = 1024 * 1024 * 32;
 
+// With incremental code space reclamation, near and far code are split into
+// this many chunks, which are evicted and reused one at a time.
+static const int CODE_CHUNKS = 16;
+// Room at the start of near code for the stubs that exits into evicted chunks
+// are redirected to. Running out of it clears the whole cache.
+static const int EXIT_STUB_SPACE = 1024 * 256;
+static const int EXIT_STUB_SIZE = 16;
+
 // Like XCodeBlock but has some utilities for memory access.
 class EmuCodeBlock : public Gen::X64CodeBlock
 {
@@ -2,6 +2,7 @@
 // Licensed under GPLv2+
 // Refer to the license.txt file included.
 
+#include <algorithm>
 #include <cinttypes>
 #include <string>
 
@@ -23,47 +24,130 @@ using namespace Gen;
 void TrampolineCache::Init(int size)
 {
 	AllocCodeSpace(size);
+	m_num_sites = 0;
+	m_num_bodies_reused = 0;
+	m_num_compactions = 0;
+	m_bytes_reclaimed = 0;
 }
 
 void TrampolineCache::ClearCodeSpace()
 {
 	X64CodeBlock::ClearCodeSpace();
+	m_bodies.clear();
+	m_sites.clear();
 }
 
 void TrampolineCache::Shutdown()
 {
 	FreeCodeSpace();
+	m_bodies.clear();
+	m_sites.clear();
 }
 
-const u8* TrampolineCache::GenerateReadTrampoline(const InstructionInfo &info, BitSet32 registersInUse, u8* exceptionHandler, u8* returnPtr)
+TrampolineCache::BodyKey TrampolineCache::MakeKey(const InstructionInfo &info, BitSet32 registersInUse, bool checkExceptions)
+{
+	BodyKey key;
+	key.isWrite = info.isMemoryWrite;
+	key.operandSize = info.operandSize;
+	key.signExtend = !info.isMemoryWrite && info.signExtend;
+	key.addrReg = info.scaledReg;
+	key.dataReg = info.hasImmediate ? -1 : info.regOperandReg;
+	key.displacement = info.displacement;
+	key.hasImmediate = info.hasImmediate;
+	key.immediate = info.hasImmediate ? info.immediate : 0;
+	key.registersInUse = registersInUse.m_val;
+	key.checkExceptions = checkExceptions;
+	return key;
+}
+
+const u8* TrampolineCache::GenerateReadTrampoline(const InstructionInfo &info, BitSet32 registersInUse, u8* exceptionHandler, u8* start, u8* returnPtr)
+{
+	// A read that raises a DSI exception must leave the destination register
+	// alone, so the body skips the move in that case.
+	return AddSite(start, MakeKey(info, registersInUse, exceptionHandler != nullptr), exceptionHandler, returnPtr, 0);
+}
+
+const u8* TrampolineCache::GenerateWriteTrampoline(const InstructionInfo &info, BitSet32 registersInUse, u8* exceptionHandler, u8* start, u8* returnPtr, u32 pc)
+{
+	return AddSite(start, MakeKey(info, registersInUse, false), exceptionHandler, returnPtr, pc);
+}
+
+const u8* TrampolineCache::AddSite(u8* start, const BodyKey& key, u8* exceptionHandler, u8* returnPtr, u32 pc)
 {
 	if (GetSpaceLeft() < 1024)
 		PanicAlert("Trampoline cache full");
 
+	if (m_bodies.count(key))
+		m_num_bodies_reused++;
+	m_num_sites++;
+
+	Site site = { start, nullptr, key, exceptionHandler, returnPtr, pc };
+	site.stub = GenerateStub(site, GetBody(key));
+	m_sites.push_back(site);
+	return site.stub;
+}
+
+const u8* TrampolineCache::GetBody(const BodyKey& key)
+{
+	auto it = m_bodies.find(key);
+	if (it != m_bodies.end())
+		return it->second;
+
+	const u8* body = key.isWrite ? GenerateWriteBody(key) : GenerateReadBody(key);
+	m_bodies[key] = body;
+	return body;
+}
+
+const u8* TrampolineCache::GenerateStub(const Site& site, const u8* body)
+{
+	const u8* stub = GetCodePtr();
+
+	// PC is used by memory watchpoints (if enabled) or to print accurate PC locations in debug logs
+	if (site.key.isWrite)
+		MOV(32, PPCSTATE(pc), Imm32(site.pc));
+
+	CALL(body);
+
+	if (site.exceptionHandler)
+	{
+		TEST(32, PPCSTATE(Exceptions), Imm32(EXCEPTION_DSI));
+		J_CC(CC_NZ, site.exceptionHandler);
+	}
+
+	JMP(site.returnPtr, true);
+
+	JitRegister::Register(stub, GetCodePtr(), "JIT_TrampolineStub_%x", site.pc);
+	return stub;
+}
+
+const u8* TrampolineCache::GenerateReadBody(const BodyKey& key)
+{
 	const u8* trampoline = GetCodePtr();
-	X64Reg addrReg = (X64Reg)info.scaledReg;
-	X64Reg dataReg = (X64Reg)info.regOperandReg;
-	int stack_offset = 0;
+	X64Reg addrReg = (X64Reg)key.addrReg;
+	X64Reg dataReg = (X64Reg)key.dataReg;
+	BitSet32 registersInUse(key.registersInUse);
+	// The stub's CALL pushed the return address.
+	int stack_offset = 8;
 	bool push_param1 = registersInUse[ABI_PARAM1];
 
 	if (push_param1)
 	{
 		PUSH(ABI_PARAM1);
-		stack_offset = 8;
+		stack_offset += 8;
 		registersInUse[ABI_PARAM1] = 0;
 	}
 
-	int dataRegSize = info.operandSize == 8 ? 64 : 32;
-	if (addrReg != ABI_PARAM1 && info.displacement)
-		LEA(32, ABI_PARAM1, MDisp(addrReg, info.displacement));
+	int dataRegSize = key.operandSize == 8 ? 64 : 32;
+	if (addrReg != ABI_PARAM1 && key.displacement)
+		LEA(32, ABI_PARAM1, MDisp(addrReg, key.displacement));
 	else if (addrReg != ABI_PARAM1)
 		MOV(32, R(ABI_PARAM1), R(addrReg));
-	else if (info.displacement)
-		ADD(32, R(ABI_PARAM1), Imm32(info.displacement));
+	else if (key.displacement)
+		ADD(32, R(ABI_PARAM1), Imm32(key.displacement));
 
 	ABI_PushRegistersAndAdjustStack(registersInUse, stack_offset);
 
-	switch (info.operandSize)
+	switch (key.operandSize)
 	{
 	case 8:
 		CALL((void*)&PowerPC::Read_U64);
@@ -84,74 +168,74 @@ const u8* TrampolineCache::GenerateReadTrampoline(const InstructionInfo &info, B
 	if (push_param1)
 		POP(ABI_PARAM1);
 
-	if (exceptionHandler)
+	FixupBranch exception;
+	if (key.checkExceptions)
 	{
 		TEST(32, PPCSTATE(Exceptions), Imm32(EXCEPTION_DSI));
-		J_CC(CC_NZ, exceptionHandler);
+		exception = J_CC(CC_NZ);
 	}
 
-	if (info.signExtend)
-		MOVSX(dataRegSize, info.operandSize * 8, dataReg, R(ABI_RETURN));
-	else if (dataReg != ABI_RETURN || info.operandSize < 4)
-		MOVZX(dataRegSize, info.operandSize * 8, dataReg, R(ABI_RETURN));
+	if (key.signExtend)
+		MOVSX(dataRegSize, key.operandSize * 8, dataReg, R(ABI_RETURN));
+	else if (dataReg != ABI_RETURN || key.operandSize < 4)
+		MOVZX(dataRegSize, key.operandSize * 8, dataReg, R(ABI_RETURN));
+
+	if (key.checkExceptions)
+		SetJumpTarget(exception);
 
-	JMP(returnPtr, true);
+	RET();
 
 	JitRegister::Register(trampoline, GetCodePtr(), "JIT_ReadTrampoline");
 	return trampoline;
 }
 
-const u8* TrampolineCache::GenerateWriteTrampoline(const InstructionInfo &info, BitSet32 registersInUse, u8* exceptionHandler, u8* returnPtr, u32 pc)
+const u8* TrampolineCache::GenerateWriteBody(const BodyKey& key)
 {
-	if (GetSpaceLeft() < 1024)
-		PanicAlert("Trampoline cache full");
-
 	const u8* trampoline = GetCodePtr();
 
-	X64Reg dataReg = (X64Reg)info.regOperandReg;
-	X64Reg addrReg = (X64Reg)info.scaledReg;
+	X64Reg dataReg = (X64Reg)key.dataReg;
+	X64Reg addrReg = (X64Reg)key.addrReg;
+	BitSet32 registersInUse(key.registersInUse);
 
 	// Don't treat FIFO writes specially for now because they require a burst
 	// check anyway.
 
-	// PC is used by memory watchpoints (if enabled) or to print accurate PC locations in debug logs
-	MOV(32, PPCSTATE(pc), Imm32(pc));
-
-	ABI_PushRegistersAndAdjustStack(registersInUse, 0);
+	// The stub's CALL pushed the return address.
+	ABI_PushRegistersAndAdjustStack(registersInUse, 8);
 
-	if (info.hasImmediate)
+	if (key.hasImmediate)
 	{
-		if (addrReg != ABI_PARAM2 && info.displacement)
-			LEA(32, ABI_PARAM2, MDisp(addrReg, info.displacement));
+		if (addrReg != ABI_PARAM2 && key.displacement)
+			LEA(32, ABI_PARAM2, MDisp(addrReg, key.displacement));
 		else if (addrReg != ABI_PARAM2)
 			MOV(32, R(ABI_PARAM2), R(addrReg));
-		else if (info.displacement)
-			ADD(32, R(ABI_PARAM2), Imm32(info.displacement));
+		else if (key.displacement)
+			ADD(32, R(ABI_PARAM2), Imm32(key.displacement));
 
 		// we have to swap back the immediate to pass it to the write functions
-		switch (info.operandSize)
+		switch (key.operandSize)
 		{
 		case 8:
 			PanicAlert("Invalid 64-bit immediate!");
 			break;
 		case 4:
-			MOV(32, R(ABI_PARAM1), Imm32(Common::swap32((u32)info.immediate)));
+			MOV(32, R(ABI_PARAM1), Imm32(Common::swap32((u32)key.immediate)));
 			break;
 		case 2:
-			MOV(16, R(ABI_PARAM1), Imm16(Common::swap16((u16)info.immediate)));
+			MOV(16, R(ABI_PARAM1), Imm16(Common::swap16((u16)key.immediate)));
 			break;
 		case 1:
-			MOV(8, R(ABI_PARAM1), Imm8((u8)info.immediate));
+			MOV(8, R(ABI_PARAM1), Imm8((u8)key.immediate));
 			break;
 		}
 	}
 	else
 	{
-		int dataRegSize = info.operandSize == 8 ? 64 : 32;
-		MOVTwo(dataRegSize, ABI_PARAM2, addrReg, info.displacement, ABI_PARAM1, dataReg);
+		int dataRegSize = key.operandSize == 8 ? 64 : 32;
+		MOVTwo(dataRegSize, ABI_PARAM2, addrReg, key.displacement, ABI_PARAM1, dataReg);
 	}
 
-	switch (info.operandSize)
+	switch (key.operandSize)
 	{
 	case 8:
 		CALL((void *)&PowerPC::Write_U64);
@@ -167,14 +251,47 @@ const u8* TrampolineCache::GenerateWriteTrampoline(const InstructionInfo &info,
 		break;
 	}
 
-	ABI_PopRegistersAndAdjustStack(registersInUse, 0);
-	if (exceptionHandler)
+	ABI_PopRegistersAndAdjustStack(registersInUse, 8);
+	RET();
+
+	JitRegister::Register(trampoline, GetCodePtr(), "JIT_WriteTrampoline");
+	return trampoline;
+}
+
+size_t TrampolineCache::Compact(std::function<bool(const u8*)> is_dead)
+{
+	std::vector<Site> live;
+	for (const Site& site : m_sites)
+	{
+		// Skip sites whose code was thrown away or patched over since.
+		const u8* target = site.start + 5 + *(const s32*)(site.start + 1);
+		if (site.start[0] != 0xE9 || target != site.stub || is_dead(site.start))
+			continue;
+		live.push_back(site);
+	}
+
+	size_t used = GetCodePtr() - region;
+	ClearCodeSpace();
+
+	// Nothing can be running in here: we only get called between blocks, and
+	// the bodies only call into the memory functions.
+	for (Site& site : live)
 	{
-		TEST(32, PPCSTATE(Exceptions), Imm32(EXCEPTION_DSI));
-		J_CC(CC_NZ, exceptionHandler);
+		site.stub = GenerateStub(site, GetBody(site.key));
+		XEmitter emitter(site.start);
+		emitter.JMP(site.stub, true);
+		m_sites.push_back(site);
 	}
-	JMP(returnPtr, true);
 
-	JitRegister::Register(trampoline, GetCodePtr(), "JIT_WriteTrampoline_%x", pc);
-	return trampoline;
+	size_t reclaimed = used - (GetCodePtr() - region);
+	m_num_compactions++;
+	m_bytes_reclaimed += reclaimed;
+	return reclaimed;
+}
+
+void TrampolineCache::ForgetSites(const u8* start, const u8* end)
+{
+	m_sites.erase(std::remove_if(m_sites.begin(), m_sites.end(), [&](const Site& site) {
+		return site.start >= start && site.start < end;
+	}), m_sites.end());
 }
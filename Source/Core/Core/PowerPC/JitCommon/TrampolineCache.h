@@ -4,7 +4,10 @@
 
 #pragma once
 
-#include <unordered_map>
+#include <functional>
+#include <map>
+#include <tuple>
+#include <vector>
 
 #include "Common/BitSet.h"
 #include "Common/CommonTypes.h"
@@ -14,13 +17,78 @@
 // We need at least this many bytes for backpatching.
 const int BACKPATCH_SIZE = 5;
 
+// Each backpatched site jumps to a small stub of its own, which stores the PC
+// for writes, calls a trampoline body shared by every site with the same
+// access, checks for DSI exceptions and jumps back into the block.
 class TrampolineCache : public Gen::X64CodeBlock
 {
 public:
 	void Init(int size);
 	void Shutdown();
 
-	const u8* GenerateReadTrampoline(const InstructionInfo &info, BitSet32 registersInUse, u8* exceptionHandler, u8* returnPtr);
-	const u8* GenerateWriteTrampoline(const InstructionInfo &info, BitSet32 registersInUse, u8* exceptionHandler, u8* returnPtr, u32 pc);
+	// start is the backpatched site, which the caller patches to jump to the
+	// returned stub.
+	const u8* GenerateReadTrampoline(const InstructionInfo &info, BitSet32 registersInUse, u8* exceptionHandler, u8* start, u8* returnPtr);
+	const u8* GenerateWriteTrampoline(const InstructionInfo &info, BitSet32 registersInUse, u8* exceptionHandler, u8* start, u8* returnPtr, u32 pc);
 	void ClearCodeSpace();
+
+	// Regenerates the stubs of the sites that still jump to them and aren't
+	// reported dead by is_dead, along with the bodies they use, and repatches
+	// the sites. Returns the number of bytes reclaimed.
+	size_t Compact(std::function<bool(const u8*)> is_dead);
+	// Drops the sites in [start, end), whose code is about to be reused. Their
+	// stubs stay until the next compaction.
+	void ForgetSites(const u8* start, const u8* end);
+
+	u64 GetNumSites() const { return m_num_sites; }
+	u64 GetNumBodiesReused() const { return m_num_bodies_reused; }
+	u64 GetNumCompactions() const { return m_num_compactions; }
+	u64 GetBytesReclaimed() const { return m_bytes_reclaimed; }
+
+private:
+	struct BodyKey
+	{
+		bool isWrite;
+		int operandSize;
+		bool signExtend;
+		int addrReg;
+		int dataReg;
+		s32 displacement;
+		bool hasImmediate;
+		u64 immediate;
+		u32 registersInUse;
+		bool checkExceptions;
+
+		bool operator<(const BodyKey& other) const
+		{
+			return std::tie(isWrite, operandSize, signExtend, addrReg, dataReg, displacement, hasImmediate, immediate, registersInUse, checkExceptions) <
+			       std::tie(other.isWrite, other.operandSize, other.signExtend, other.addrReg, other.dataReg, other.displacement,
+			                other.hasImmediate, other.immediate, other.registersInUse, other.checkExceptions);
+		}
+	};
+
+	struct Site
+	{
+		u8* start;
+		const u8* stub;
+		BodyKey key;
+		u8* exceptionHandler;
+		u8* returnPtr;
+		u32 pc;
+	};
+
+	static BodyKey MakeKey(const InstructionInfo &info, BitSet32 registersInUse, bool checkExceptions);
+	const u8* GetBody(const BodyKey& key);
+	const u8* GenerateReadBody(const BodyKey& key);
+	const u8* GenerateWriteBody(const BodyKey& key);
+	const u8* GenerateStub(const Site& site, const u8* body);
+	const u8* AddSite(u8* start, const BodyKey& key, u8* exceptionHandler, u8* returnPtr, u32 pc);
+
+	std::map<BodyKey, const u8*> m_bodies;
+	std::vector<Site> m_sites;
+
+	u64 m_num_sites;
+	u64 m_num_bodies_reused;
+	u64 m_num_compactions;
+	u64 m_bytes_reclaimed;
 };
@@ -14,6 +14,7 @@
 
 #include "Core/ConfigManager.h"
 #include "Core/HW/Memmap.h"
+#include "Core/PowerPC/Interpreter/Interpreter.h"
 #include "Core/PowerPC/JitInterface.h"
 #include "Core/PowerPC/PowerPC.h"
 #include "Core/PowerPC/PPCSymbolDB.h"
@@ -45,7 +46,10 @@ namespace JitInterface
 	void DoState(PointerWrap &p)
 	{
 		if (jit && p.GetMode() == PointerWrap::MODE_READ)
+		{
+			jit->WaitForBackgroundCompile();
 			jit->GetBlockCache()->Clear();
+		}
 	}
 	CPUCoreBase *InitJitCore(int core)
 	{
@@ -161,6 +165,27 @@ namespace JitInterface
 						(double)block->ticCounter*1000.0/(double)countsPerSec, block->codeSize);
 			}
 		}
+
+		const JitEvictionStats& evictions = jit->GetBlockCache()->GetEvictionStats();
+		if (evictions.evictions)
+		{
+			fprintf(f.GetHandle(), "\nevictions\tblocksEvicted\trecompiles\trecompileTime(ms)\n");
+			fprintf(f.GetHandle(), "%" PRIu64 "\t%" PRIu64 "\t%" PRIu64 "\t%.2f\n",
+			        evictions.evictions, evictions.blocks_evicted, evictions.recompiles,
+			        (double)evictions.recompile_us / 1000.0);
+		}
+
+		const auto& idle_loops = PowerPC::GetIdleLoopStats();
+		if (!idle_loops.empty())
+		{
+			fprintf(f.GetHandle(), "\nidleLoop\tfuncName\thits\tcyclesSkipped\n");
+			for (const auto& loop : idle_loops)
+			{
+				std::string name = g_symbolDB.GetDescription(loop.first);
+				fprintf(f.GetHandle(), "%08x\t%s\t%" PRIu64 "\t%" PRIu64 "\n",
+				        loop.first, name.c_str(), loop.second.hits, loop.second.cycles_skipped);
+			}
+		}
 	}
 	bool HandleFault(uintptr_t access_address, SContext* ctx)
 	{
@@ -169,8 +194,12 @@ namespace JitInterface
 
 	void ClearCache()
 	{
+		Interpreter::getInstance()->ClearCache();
 		if (jit)
+		{
+			jit->WaitForBackgroundCompile();
 			jit->ClearCache();
+		}
 	}
 	void ClearSafe()
 	{
@@ -178,14 +207,22 @@ namespace JitInterface
 		// inside a JIT'ed block: it clears the instruction cache, but not
 		// the JIT'ed code.
 		// TODO: There's probably a better way to handle this situation.
+		Interpreter::getInstance()->ClearCache();
 		if (jit)
+		{
+			jit->WaitForBackgroundCompile();
 			jit->GetBlockCache()->Clear();
+		}
 	}
 
 	void InvalidateICache(u32 address, u32 size, bool forced)
 	{
+		Interpreter::getInstance()->InvalidateICache(address, size);
 		if (jit)
+		{
+			jit->WaitForBackgroundCompile();
 			jit->GetBlockCache()->InvalidateICache(address, size, forced);
+		}
 	}
 
 	void CompileExceptionCheck(ExceptionType type)
@@ -193,6 +230,8 @@ namespace JitInterface
 		if (!jit)
 			return;
 
+		jit->WaitForBackgroundCompile();
+
 		std::unordered_set<u32>* exception_addresses = nullptr;
 
 		switch (type)
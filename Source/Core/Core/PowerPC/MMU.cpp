@@ -2,6 +2,9 @@
 // Licensed under GPLv2+
 // Refer to the license.txt file included.
 
+#include <algorithm>
+#include <cstring>
+
 #include "Common/Atomic.h"
 #include "Common/BitSet.h"
 #include "Common/CommonTypes.h"
@@ -437,8 +440,18 @@ u32 HostRead_Instruction(const u32 address)
 	return inst.hex;
 }
 
+static MemoryAccessHook s_access_hook;
+
+void SetMemoryAccessHook(MemoryAccessHook hook)
+{
+	s_access_hook = hook;
+}
+
 static __forceinline void Memcheck(u32 address, u32 var, bool write, int size)
 {
+	if (s_access_hook)
+		s_access_hook(address, size, write);
+
 #ifdef ENABLE_MEM_CHECK
 	TMemCheck *mc = PowerPC::memchecks.GetMemCheck(address);
 	if (mc)
@@ -681,6 +694,9 @@ bool HostIsRAMAddress(u32 address)
 
 void DMA_LCToMemory(const u32 memAddr, const u32 cacheAddr, const u32 numBlocks)
 {
+	if (s_access_hook)
+		s_access_hook(memAddr, 32 * numBlocks, true);
+
 	// TODO: It's not completely clear this is the right spot for this code;
 	// what would happen if, for example, the DVD drive tried to write to the EFB?
 	// TODO: This is terribly slow.
@@ -718,6 +734,12 @@ void DMA_LCToMemory(const u32 memAddr, const u32 cacheAddr, const u32 numBlocks)
 
 void DMA_MemoryToLC(const u32 cacheAddr, const u32 memAddr, const u32 numBlocks)
 {
+	if (s_access_hook)
+	{
+		s_access_hook(memAddr, 32 * numBlocks, false);
+		s_access_hook(cacheAddr, 32 * numBlocks, true);
+	}
+
 	const u8* src = Memory::GetPointer(memAddr);
 	u8* dst = Memory::m_pL1Cache + (cacheAddr & 0x3FFFF);
 
@@ -914,6 +936,8 @@ static void GenerateISIException(u32 _EffectiveAddress)
 
 void SDRUpdated()
 {
+	Memory::UnmapLogicalPages();
+
 	u32 htabmask = SDR1_HTABMASK(PowerPC::ppcState.spr[SPR_SDR]);
 	u32 x = 1;
 	u32 xx = 0;
@@ -944,54 +968,93 @@ enum TLBLookupResult
 	TLB_UPDATE_C
 };
 
-static __forceinline TLBLookupResult LookupTLBPageAddress(const XCheckTLBFlag flag, const u32 vpa, u32 *paddr)
+static TLBStats s_tlb_stats[NUM_TLBS];
+
+void ResetTLB()
 {
-	u32 tag = vpa >> HW_PAGE_INDEX_SHIFT;
-	PowerPC::tlb_entry *tlbe = &PowerPC::ppcState.tlb[flag == FLAG_OPCODE][tag & HW_PAGE_INDEX_MASK];
-	if (tlbe->tag[0] == tag)
+	for (PowerPC::tlb_entry& tlbe : PowerPC::ppcState.dtlb)
 	{
-		// Check if C bit requires updating
-		if (flag == FLAG_WRITE)
-		{
-			UPTE2 PTE2;
-			PTE2.Hex = tlbe->pte[0];
-			if (PTE2.C == 0)
-			{
-				PTE2.C = 1;
-				tlbe->pte[0] = PTE2.Hex;
-				return TLB_UPDATE_C;
-			}
-		}
+		for (int way = 0; way < TLB_WAYS; way++)
+			tlbe.tag[way] = TLB_TAG_INVALID;
+		tlbe.lru = 0;
+	}
+	for (PowerPC::tlb_entry& tlbe : PowerPC::ppcState.itlb)
+	{
+		for (int way = 0; way < TLB_WAYS; way++)
+			tlbe.tag[way] = TLB_TAG_INVALID;
+		tlbe.lru = 0;
+	}
+	memset(s_tlb_stats, 0, sizeof(s_tlb_stats));
+}
 
-		if (flag != FLAG_NO_EXCEPTION)
-			tlbe->recent = 0;
+const TLBStats& GetTLBStats(bool instruction)
+{
+	return s_tlb_stats[instruction];
+}
 
-		*paddr = tlbe->paddr[0] | (vpa & 0xfff);
+static __forceinline PowerPC::tlb_entry* GetTLBSet(const XCheckTLBFlag flag, u32 tag)
+{
+	if (flag == FLAG_OPCODE)
+		return &PowerPC::ppcState.itlb[tag & (INST_TLB_SETS - 1)];
+	return &PowerPC::ppcState.dtlb[tag & (DATA_TLB_SETS - 1)];
+}
 
-		return TLB_FOUND;
+static __forceinline void TouchTLBWay(PowerPC::tlb_entry* tlbe, int way)
+{
+	// Point the tree bits away from the way that was just used.
+	static_assert(TLB_WAYS == 4, "The pseudo-LRU tree assumes four ways");
+	if (way < 2)
+		tlbe->lru = (tlbe->lru & ~3) | 1 | ((way == 0) << 1);
+	else
+		tlbe->lru = (tlbe->lru & ~5) | ((way == 2) << 2);
+}
+
+static __forceinline int GetTLBVictim(const PowerPC::tlb_entry* tlbe)
+{
+	for (int way = 0; way < TLB_WAYS; way++)
+	{
+		if (tlbe->tag[way] == TLB_TAG_INVALID)
+			return way;
 	}
-	if (tlbe->tag[1] == tag)
+	if (tlbe->lru & 1)
+		return (tlbe->lru & 4) ? 3 : 2;
+	return (tlbe->lru & 2) ? 1 : 0;
+}
+
+static __forceinline TLBLookupResult LookupTLBPageAddress(const XCheckTLBFlag flag, const u32 vpa, u32 *paddr)
+{
+	u32 tag = vpa >> HW_PAGE_INDEX_SHIFT;
+	PowerPC::tlb_entry *tlbe = GetTLBSet(flag, tag);
+	TLBStats& stats = s_tlb_stats[flag == FLAG_OPCODE];
+	for (int way = 0; way < TLB_WAYS; way++)
 	{
+		if (tlbe->tag[way] != tag)
+			continue;
+
 		// Check if C bit requires updating
 		if (flag == FLAG_WRITE)
 		{
 			UPTE2 PTE2;
-			PTE2.Hex = tlbe->pte[1];
+			PTE2.Hex = tlbe->pte[way];
 			if (PTE2.C == 0)
 			{
 				PTE2.C = 1;
-				tlbe->pte[1] = PTE2.Hex;
+				tlbe->pte[way] = PTE2.Hex;
+				stats.page_walks++;
 				return TLB_UPDATE_C;
 			}
 		}
 
 		if (flag != FLAG_NO_EXCEPTION)
-			tlbe->recent = 1;
+			TouchTLBWay(tlbe, way);
 
-		*paddr = tlbe->paddr[1] | (vpa & 0xfff);
+		*paddr = tlbe->paddr[way] | (vpa & 0xfff);
 
+		stats.hits++;
 		return TLB_FOUND;
 	}
+	stats.misses++;
+	stats.page_walks++;
 	return TLB_NOTFOUND;
 }
 
@@ -1000,23 +1063,66 @@ static __forceinline void UpdateTLBEntry(const XCheckTLBFlag flag, UPTE2 PTE2, c
 	if (flag == FLAG_NO_EXCEPTION)
 		return;
 
-	int tag = address >> HW_PAGE_INDEX_SHIFT;
-	PowerPC::tlb_entry *tlbe = &PowerPC::ppcState.tlb[flag == FLAG_OPCODE][tag & HW_PAGE_INDEX_MASK];
-	int index = tlbe->recent == 0 && tlbe->tag[0] != TLB_TAG_INVALID;
-	tlbe->recent = index;
-	tlbe->paddr[index] = PTE2.RPN << HW_PAGE_INDEX_SHIFT;
-	tlbe->pte[index] = PTE2.Hex;
-	tlbe->tag[index] = tag;
+	u32 tag = address >> HW_PAGE_INDEX_SHIFT;
+	PowerPC::tlb_entry *tlbe = GetTLBSet(flag, tag);
+	int way = GetTLBVictim(tlbe);
+	TouchTLBWay(tlbe, way);
+	tlbe->paddr[way] = PTE2.RPN << HW_PAGE_INDEX_SHIFT;
+	tlbe->pte[way] = PTE2.Hex;
+	tlbe->tag[way] = tag;
+}
+
+// tlbie invalidates a whole congruence class of Gekko's 64-set TLB, whatever
+// the segment, so invalidate every set that can hold part of it.
+static const u32 TLB_CLASSES = 64;
+static void InvalidateTLBSets(PowerPC::tlb_entry* tlb, u32 num_sets, u32 address)
+{
+	u32 step = std::min(num_sets, TLB_CLASSES);
+	for (u32 set = (address >> HW_PAGE_INDEX_SHIFT) & (step - 1); set < num_sets; set += step)
+	{
+		for (int way = 0; way < TLB_WAYS; way++)
+			tlb[set].tag[way] = TLB_TAG_INVALID;
+	}
 }
 
 void InvalidateTLBEntry(u32 address)
 {
-	PowerPC::tlb_entry *tlbe = &PowerPC::ppcState.tlb[0][(address >> HW_PAGE_INDEX_SHIFT) & HW_PAGE_INDEX_MASK];
-	tlbe->tag[0] = TLB_TAG_INVALID;
-	tlbe->tag[1] = TLB_TAG_INVALID;
-	PowerPC::tlb_entry *tlbe_i = &PowerPC::ppcState.tlb[1][(address >> HW_PAGE_INDEX_SHIFT) & HW_PAGE_INDEX_MASK];
-	tlbe_i->tag[0] = TLB_TAG_INVALID;
-	tlbe_i->tag[1] = TLB_TAG_INVALID;
+	// Pages mapped from any entry of the class are gone with it.
+	Memory::UnmapLogicalPages(address, (TLB_CLASSES - 1) << HW_PAGE_INDEX_SHIFT);
+
+	InvalidateTLBSets(PowerPC::ppcState.dtlb, DATA_TLB_SETS, address);
+	InvalidateTLBSets(PowerPC::ppcState.itlb, INST_TLB_SETS, address);
+}
+
+void SRUpdated()
+{
+	Memory::UnmapLogicalPages();
+}
+
+void DBATUpdated()
+{
+	// The BATs themselves are hardcoded (see Memmap.cpp), but they take
+	// precedence over the page table, so forget the pages mapped from it.
+	Memory::UnmapLogicalPages();
+}
+
+bool MapLogicalPage(u32 address, bool write)
+{
+	const SCoreStartupParameter& params = SConfig::GetInstance().m_LocalCoreStartupParameter;
+	if (!params.bMMU || !params.bMMUFastmem || !UReg_MSR(MSR).DR || memchecks.HasAny())
+		return false;
+
+	// Only segments that are never covered by the hardcoded BATs.
+	if (!BitSet32(0x8CFE)[address >> 28])
+		return false;
+
+	if (!TranslateAddress<FLAG_NO_EXCEPTION>(address))
+		return false;
+
+	// Set the referenced and changed bits like the access itself would. Pages are
+	// mapped read-only until they are written to, so the C bit gets set.
+	u32 physical_address = write ? TranslateAddress<FLAG_WRITE>(address) : TranslateAddress<FLAG_READ>(address);
+	return Memory::MapLogicalPage(address, physical_address, write);
 }
 
 // Page Address Translation
@@ -10,6 +10,7 @@
 
 #include "Core/ConfigManager.h"
 #include "Core/GeckoCode.h"
+#include "Core/HLE/HLE.h"
 #include "Core/HW/Memmap.h"
 #include "Core/PowerPC/JitInterface.h"
 #include "Core/PowerPC/PPCAnalyst.h"
@@ -34,6 +35,12 @@ namespace PPCAnalyst
 static const int CODEBUFFER_SIZE = 32000;
 // 0 does not perform block merging
 static const u32 FUNCTION_FOLLOWING_THRESHOLD = 16;
+// Maximum number of branches a single trace continues through.
+static const u32 BRANCH_FOLLOWING_THRESHOLD = 8;
+// A conditional branch is followed if it has been seen at least this many
+// times, and taken at least this percentage of the time.
+static const u32 BRANCH_FOLLOWING_MIN_SAMPLES = 4;
+static const u32 BRANCH_FOLLOWING_TAKEN_PERCENT = 90;
 
 CodeBuffer::CodeBuffer(int size)
 {
@@ -419,6 +426,32 @@ static bool isCror(const CodeOp& a)
 	return a.inst.OPCD == 19 && a.inst.SUBOP10 == 449;
 }
 
+// Which half of FC a paired multiply(-add) splats across the product: 0 or 1 for
+// ps_muls0/ps_madds0 and ps_muls1/ps_madds1, 2 for the ps_madd family (which use
+// both halves as they are), -1 for everything else.
+static int GetPairedSplat(const CodeOp& a)
+{
+	if (a.inst.OPCD != 4 || a.inst.Rc)
+		return -1;
+
+	switch (a.inst.SUBOP5)
+	{
+	case 12: // ps_muls0
+	case 14: // ps_madds0
+		return 0;
+	case 13: // ps_muls1
+	case 15: // ps_madds1
+		return 1;
+	case 28: // ps_msub
+	case 29: // ps_madd
+	case 30: // ps_nmsub
+	case 31: // ps_nmadd
+		return 2;
+	default:
+		return -1;
+	}
+}
+
 void PPCAnalyzer::ReorderInstructionsCore(u32 instructions, CodeOp* code, bool reverse, ReorderType type)
 {
 	// Bubbling an instruction sometimes reveals another opportunity to bubble an instruction, so do
@@ -483,10 +516,217 @@ void PPCAnalyzer::ReorderInstructions(u32 instructions, CodeOp *code)
 		ReorderInstructionsCore(instructions, code, false, REORDER_CMP);
 }
 
+void PPCAnalyzer::FindPairedSplats(u32 instructions, CodeOp* code)
+{
+	// Matrix and vector code typically multiplies several vectors by the same
+	// scalar in a row (ps_muls0 f4,f1,f3 / ps_madds0 f5,f2,f3,f4 / ...).
+	for (u32 i = 1; i < instructions; i++)
+	{
+		CodeOp& a = code[i - 1];
+		CodeOp& b = code[i];
+		int splat = GetPairedSplat(a);
+		if (splat < 0 || splat != GetPairedSplat(b) || a.inst.FC != b.inst.FC)
+			continue;
+
+		// The first instruction must not overwrite FC. For the unsplatted forms,
+		// there is only something to gain if FC needs rounding.
+		if (a.fregOut == a.inst.FC || (splat == 2 && b.fprIsSingle[b.inst.FC]))
+			continue;
+
+		a.keepSplat = true;
+		b.reuseSplat = true;
+	}
+}
+
+// Computes the GPR an instruction writes, if its inputs are known. Only covers
+// instructions whose single output doesn't depend on CA or on memory.
+static bool EvaluateConstant(const CodeOp& op, BitSet32 known, const u32* values, u32* result)
+{
+	UGeckoInstruction inst = op.inst;
+	if (op.regsOut.Count() != 1)
+		return false;
+
+	u32 a = values[inst.RA], b = values[inst.RB], s = values[inst.RS];
+	bool knownA = known[inst.RA], knownB = known[inst.RB], knownS = known[inst.RS];
+	u32 mask = (u32)-1 >> inst.MB ^ (inst.ME >= 31 ? 0 : (u32)-1 >> (inst.ME + 1));
+	if (inst.MB > inst.ME)
+		mask = ~mask;
+
+	switch (inst.OPCD)
+	{
+	case 7: // mulli
+		*result = a * (u32)(s32)inst.SIMM_16;
+		return knownA;
+	case 14: // addi
+		*result = (inst.RA ? a : 0) + (u32)(s32)inst.SIMM_16;
+		return !inst.RA || knownA;
+	case 15: // addis
+		*result = (inst.RA ? a : 0) + ((u32)inst.SIMM_16 << 16);
+		return !inst.RA || knownA;
+	case 20: // rlwimix
+		*result = (a & ~mask) | (_rotl(s, inst.SH) & mask);
+		return knownA && knownS;
+	case 21: // rlwinmx
+		*result = _rotl(s, inst.SH) & mask;
+		return knownS;
+	case 23: // rlwnmx
+		*result = _rotl(s, b & 0x1F) & mask;
+		return knownS && knownB;
+	case 24: *result = s | inst.UIMM; return knownS;         // ori
+	case 25: *result = s | (inst.UIMM << 16); return knownS; // oris
+	case 26: *result = s ^ inst.UIMM; return knownS;         // xori
+	case 27: *result = s ^ (inst.UIMM << 16); return knownS; // xoris
+	case 28: *result = s & inst.UIMM; return knownS;         // andi.
+	case 29: *result = s & (inst.UIMM << 16); return knownS; // andis.
+	case 31:
+		// The OE forms have their own SUBOP10s, so they never match.
+		switch (inst.SUBOP10)
+		{
+		case 266: *result = a + b; return knownA && knownB;  // addx
+		case 40:  *result = b - a; return knownA && knownB;  // subfx
+		case 104: *result = 0 - a; return knownA;            // negx
+		case 235: *result = a * b; return knownA && knownB;  // mullwx
+		case 28:  *result = s & b; return knownS && knownB;  // andx
+		case 60:  *result = s & ~b; return knownS && knownB; // andcx
+		case 124: *result = ~(s | b); return knownS && knownB; // norx
+		case 284: *result = ~(s ^ b); return knownS && knownB; // eqvx
+		case 316: *result = s ^ b; return knownS && knownB;  // xorx
+		case 412: *result = s | ~b; return knownS && knownB; // orcx
+		case 444: *result = s | b; return knownS && knownB;  // orx
+		case 476: *result = ~(s & b); return knownS && knownB; // nandx
+		case 24:  *result = (b & 0x20) ? 0 : s << (b & 0x1F); return knownS && knownB; // slwx
+		case 536: *result = (b & 0x20) ? 0 : s >> (b & 0x1F); return knownS && knownB; // srwx
+		case 954: *result = (u32)(s32)(s8)s; return knownS;   // extsbx
+		case 922: *result = (u32)(s32)(s16)s; return knownS;  // extshx
+		case 26:                                              // cntlzwx
+			*result = 0;
+			while (*result < 32 && !(s & (0x80000000 >> *result)))
+				(*result)++;
+			return knownS;
+		}
+		break;
+	}
+	return false;
+}
+
+void PPCAnalyzer::PropagateConstants(u32 instructions, CodeOp* code)
+{
+	// Games build addresses in registers all the time (lis r3, X / addi r3, r3, Y /
+	// lwz r4, 0(r3)), and the register cache forgets them as soon as an instruction
+	// binds the register to a host register.
+	BitSet32 known;
+	u32 values[32] = {};
+	for (u32 i = 0; i < instructions; i++)
+	{
+		CodeOp& op = code[i];
+
+		// HLE hooks can change any register.
+		if (HLE::GetFunctionIndex(op.address))
+			known = BitSet32(0);
+
+		op.knownA = known[op.inst.RA];
+		op.knownB = known[op.inst.RB];
+		op.valueA = values[op.inst.RA];
+		op.valueB = values[op.inst.RB];
+
+		u32 result;
+		op.knownOut = EvaluateConstant(op, known, values, &result);
+		op.valueOut = op.knownOut ? result : 0;
+
+		known &= ~op.regsOut;
+		// The table only lists RD for lswi and lswx, which load up to all 32 GPRs.
+		if ((op.opinfo->flags & FL_EVIL) && op.opinfo->type == OPTYPE_LOAD)
+			known = BitSet32(0);
+		if (op.knownOut)
+		{
+			int reg = *op.regsOut.begin();
+			known[reg] = true;
+			values[reg] = result;
+		}
+		else if (op.inst.OPCD >= 32 && op.inst.OPCD < 56 && (op.inst.OPCD & 1) && op.knownA &&
+		         op.regsOut[op.inst.RA])
+		{
+			// D-form load/store with update: RA gets the effective address.
+			known[op.inst.RA] = true;
+			values[op.inst.RA] = op.valueA + (u32)(s32)op.inst.SIMM_16;
+		}
+	}
+}
+
+// Whether nothing can observe the results of an instruction, given the GPRs that
+// are live after it. Its flag outputs have to be dead too, and it mustn't read CA,
+// which the JIT may be passing to it in the host carry flag.
+static bool IsDeadInstruction(const CodeOp& op, BitSet32 gprLive, bool readsCA)
+{
+	return op.opinfo->type == OPTYPE_INTEGER && !op.canEndBlock && !readsCA && !op.outputOV &&
+	       op.regsOut.Count() != 0 && (op.regsOut & gprLive).Count() == 0 &&
+	       (op.crfOut & op.crfWanted).Count() == 0 && !(op.outputCA && op.wantsCA);
+}
+
+void PPCAnalyzer::FindIdleLoop(CodeBlock* block, CodeOp* code)
+{
+	// Polling loops (waiting for a VI, DSP or DVD status bit, or for an interrupt
+	// handler to set a flag) look like
+	//   loop: lwz r0, flag(r13)
+	//         cmpwi r0, 0
+	//         beq loop
+	// Everything before the branch runs again with the same inputs as long as the
+	// memory it reads doesn't change.
+	BitSet32 gprWritten, gprReadFirst;
+	BitSet8 crfWritten, crfReadFirst;
+	bool caWritten = false, caReadFirst = false;
+	for (u32 i = 0; i < block->m_num_instructions; i++)
+	{
+		CodeOp& op = code[i];
+		UGeckoInstruction inst = op.inst;
+		if (HLE::GetFunctionIndex(op.address))
+			return;
+
+		if (op.opinfo->flags & FL_ENDBLOCK)
+		{
+			u32 destination;
+			if (inst.OPCD == 18 && !inst.LK)
+				destination = (inst.AA ? 0 : op.address) + SignExt26(inst.LI << 2);
+			else if (inst.OPCD == 16 && !inst.LK && (inst.BO & BO_DONT_DECREMENT_FLAG))
+				destination = (inst.AA ? 0 : op.address) + SignExt16(inst.BD << 2);
+			else
+				return;
+
+			if (destination != block->m_address || op.branchFollowed)
+				return;
+			gprReadFirst |= op.regsIn & ~gprWritten;
+			crfReadFirst |= op.crfIn & ~crfWritten;
+			if (!(gprReadFirst & gprWritten) && !(crfReadFirst & crfWritten) && !(caReadFirst && caWritten))
+			{
+				op.branchIsIdleLoop = true;
+				block->m_idle_loop = true;
+			}
+			return;
+		}
+
+		// Loads with update carry RA over, which the register check catches. The
+		// string loads and lwarx write more state than regsOut says.
+		if (op.opinfo->type != OPTYPE_INTEGER && op.opinfo->type != OPTYPE_CR && op.opinfo->type != OPTYPE_LOAD)
+			return;
+		if ((op.opinfo->flags & FL_TIMER) || (op.opinfo->type == OPTYPE_LOAD && (op.opinfo->flags & FL_EVIL)))
+			return;
+
+		gprReadFirst |= op.regsIn & ~gprWritten;
+		crfReadFirst |= op.crfIn & ~crfWritten;
+		caReadFirst |= (op.opinfo->flags & FL_READ_CA) && !caWritten;
+		gprWritten |= op.regsOut;
+		crfWritten |= op.crfOut;
+		caWritten |= op.outputCA;
+	}
+}
+
 void PPCAnalyzer::SetInstructionStats(CodeBlock *block, CodeOp *code, GekkoOPInfo *opinfo, u32 index)
 {
 	code->wantsCR0 = false;
 	code->wantsCR1 = false;
+	code->knownA = false;
+	code->knownB = false;
+	code->knownOut = false;
 
 	if (opinfo->flags & FL_USE_FPU)
 		block->m_fpa->any = true;
@@ -532,6 +772,71 @@ void PPCAnalyzer::SetInstructionStats(CodeBlock *block, CodeOp *code, GekkoOPInf
 	if (code->inst.OPCD == 31 && code->inst.SUBOP10 == 467) // mtspr
 		code->outputCA = ((code->inst.SPRU << 5) | (code->inst.SPRL & 0x1F)) == SPR_XER;
 
+	// XER[OV] is only read by mfspr and mcrxr (which also clears it). Record forms
+	// only copy SO, which is sticky, so instructions that set OV always need to run.
+	bool xer_spr = ((code->inst.SPRU << 5) | (code->inst.SPRL & 0x1F)) == SPR_XER;
+	code->wantsOV = code->inst.OPCD == 31 && (code->inst.SUBOP10 == 512 || (code->inst.SUBOP10 == 339 && xer_spr));
+	code->outputOV = (opinfo->flags & FL_SET_OE) ||
+	                 (code->inst.OPCD == 31 && (code->inst.SUBOP10 == 512 || (code->inst.SUBOP10 == 467 && xer_spr)));
+
+	// Which CR fields are read and written. The CR logical instructions only
+	// write a single bit, so they read the field they write as well.
+	code->crfIn = BitSet8(0);
+	code->crfOut = BitSet8(0);
+	if (code->outputCR0)
+		code->crfOut[0] = true;
+	if (code->outputCR1)
+		code->crfOut[1] = true;
+	if (opinfo->flags & FL_SET_CRn)
+		code->crfOut[code->inst.CRFD] = true;
+	switch (code->inst.OPCD)
+	{
+	case 16: // bcx
+		if (!(code->inst.BO & BO_DONT_CHECK_CONDITION))
+			code->crfIn[code->inst.BI >> 2] = true;
+		break;
+	case 19:
+		switch (code->inst.SUBOP10)
+		{
+		case 16:  // bclrx
+		case 528: // bcctrx
+			if (!(code->inst.BO & BO_DONT_CHECK_CONDITION))
+				code->crfIn[code->inst.BI >> 2] = true;
+			break;
+		case 0:   // mcrf
+			code->crfIn[code->inst.CRFS] = true;
+			break;
+		case 33:  // crnor
+		case 129: // crandc
+		case 193: // crxor
+		case 225: // crnand
+		case 257: // crand
+		case 289: // creqv
+		case 417: // crorc
+		case 449: // cror
+			code->crfIn[code->inst.CRBA >> 2] = true;
+			code->crfIn[code->inst.CRBB >> 2] = true;
+			code->crfIn[code->inst.CRBD >> 2] = true;
+			break;
+		}
+		break;
+	case 31:
+		if (code->inst.SUBOP10 == 19) // mfcr
+		{
+			code->crfIn = BitSet8::AllTrue(8);
+		}
+		else if (code->inst.SUBOP10 == 144) // mtcrf
+		{
+			// FL_SET_CRn doesn't apply; the mask decides which fields are written.
+			code->crfOut = BitSet8(0);
+			for (int i = 0; i < 8; i++)
+				code->crfOut[i] = (code->inst.CRM & (0x80 >> i)) != 0;
+		}
+		break;
+	}
+	code->outputCR0 = code->crfOut[0];
+	code->outputCR1 = code->crfOut[1];
+
 	code->regsIn = BitSet32(0);
 	code->regsOut = BitSet32(0);
 	if (opinfo->flags & FL_OUT_A)
@@ -622,6 +927,41 @@ void PPCAnalyzer::SetInstructionStats(CodeBlock *block, CodeOp *code, GekkoOPInf
 	}
 }
 
+bool PPCAnalyzer::ShouldFollowBranch(UGeckoInstruction inst, u32 address, u32* destination) const
+{
+	// Calls aren't followed: with the BLR optimization the JIT relies on
+	// calls and returns being paired on the host stack.
+	if (inst.OPCD == 18)
+	{
+		if (inst.LK)
+			return false;
+		*destination = (inst.AA ? 0 : address) + SignExt26(inst.LI << 2);
+		return true;
+	}
+
+	if (inst.OPCD == 16)
+	{
+		if (inst.LK)
+			return false;
+		*destination = (inst.AA ? 0 : address) + SignExt16(inst.BD << 2);
+
+		// bc always
+		if ((inst.BO & BO_DONT_DECREMENT_FLAG) && (inst.BO & BO_DONT_CHECK_CONDITION))
+			return true;
+
+		if (!m_branch_profile)
+			return false;
+		auto it = m_branch_profile->find(address);
+		if (it == m_branch_profile->end())
+			return false;
+		u64 total = (u64)it->second.taken + it->second.not_taken;
+		return total >= BRANCH_FOLLOWING_MIN_SAMPLES &&
+		       it->second.taken * 100ULL >= total * BRANCH_FOLLOWING_TAKEN_PERCENT;
+	}
+
+	return false;
+}
+
 u32 PPCAnalyzer::Analyze(u32 address, CodeBlock *block, CodeBuffer *buffer, u32 blockSize)
 {
 	// Clear block stats
@@ -641,6 +981,9 @@ u32 PPCAnalyzer::Analyze(u32 address, CodeBlock *block, CodeBuffer *buffer, u32
 	block->m_broken = false;
 	block->m_memory_exception = false;
 	block->m_num_instructions = 0;
+	block->m_num_followed_branches = 0;
+	block->m_num_dead_instructions = 0;
+	block->m_idle_loop = false;
 	block->m_gqr_used = BitSet8(0);
 
 	CodeOp *code = buffer->codebuffer;
@@ -651,6 +994,11 @@ u32 PPCAnalyzer::Analyze(u32 address, CodeBlock *block, CodeBuffer *buffer, u32
 	u32 num_inst = 0;
 	bool prev_inst_from_bat = true;
 
+	// Start of the straight-line run of code currently being scanned, and the
+	// runs already in the block, so traces never loop back onto themselves.
+	u32 segment_start = address;
+	std::vector<std::pair<u32, u32>> segments;
+
 	for (u32 i = 0; i < blockSize; ++i)
 	{
 		auto result = PowerPC::TryReadInstruction(address);
@@ -767,6 +1115,35 @@ u32 PPCAnalyzer::Analyze(u32 address, CodeBlock *block, CodeBuffer *buffer, u32
 			}
 		}
 
+		// Only follow a branch if its target can go in this block as well, so a
+		// followed branch is never the last instruction.
+		if (!follow && HasOption(OPTION_BRANCH_FOLLOW) && result.from_bat && i + 1 < blockSize &&
+		    block->m_num_followed_branches < BRANCH_FOLLOWING_THRESHOLD &&
+		    ShouldFollowBranch(inst, address, &destination))
+		{
+			segments.emplace_back(segment_start, address + 4);
+			bool seen = std::any_of(segments.begin(), segments.end(), [&](const std::pair<u32, u32>& s)
+			{
+				return destination >= s.first && destination < s.second;
+			});
+			auto target = PowerPC::TryReadInstruction(destination);
+			if (seen || !target.valid || !target.from_bat)
+			{
+				segments.pop_back();
+			}
+			else
+			{
+				code[i].branchFollowed = true;
+				// An unconditional branch we continue through never leaves the block.
+				if (inst.OPCD == 18 || ((inst.BO & BO_DONT_CHECK_CONDITION) && (inst.BO & BO_DONT_DECREMENT_FLAG)))
+					code[i].canEndBlock = false;
+				block->m_num_followed_branches++;
+				segment_start = destination;
+				address = destination;
+				continue;
+			}
+		}
+
 		if (!follow)
 		{
 			address += 4;
@@ -803,30 +1180,62 @@ u32 PPCAnalyzer::Analyze(u32 address, CodeBlock *block, CodeBuffer *buffer, u32
 
 	// Scan for flag dependencies; assume the next block (or any branch that can leave the block)
 	// wants flags, to be safe.
-	bool wantsCR0 = true, wantsCR1 = true, wantsFPRF = true, wantsCA = true;
+	bool wantsFPRF = true, wantsCA = true, wantsOV = true;
+	BitSet8 crfWanted = BitSet8::AllTrue(8);
+	// Unlike gprInUse, gprLive only holds the registers that may actually be read
+	// (by the rest of the block, or by whatever runs after it) before being overwritten.
+	BitSet32 gprLive = BitSet32::AllTrue(32);
 	BitSet32 fprInUse, gprInUse, gprInReg, fprInXmm;
 	for (int i = block->m_num_instructions - 1; i >= 0; i--)
 	{
-		bool opWantsCR0 = code[i].wantsCR0;
-		bool opWantsCR1 = code[i].wantsCR1;
 		bool opWantsFPRF = code[i].wantsFPRF;
 		bool opWantsCA = code[i].wantsCA;
-		code[i].wantsCR0 = wantsCR0 || code[i].canEndBlock;
-		code[i].wantsCR1 = wantsCR1 || code[i].canEndBlock;
+		bool opWantsOV = code[i].wantsOV;
+		if (code[i].canEndBlock)
+		{
+			crfWanted = BitSet8::AllTrue(8);
+			gprLive = BitSet32::AllTrue(32);
+		}
+		code[i].crfWanted = crfWanted;
+		code[i].wantsCR0 = crfWanted[0];
+		code[i].wantsCR1 = crfWanted[1];
 		code[i].wantsFPRF = wantsFPRF || code[i].canEndBlock;
 		code[i].wantsCA = wantsCA || code[i].canEndBlock;
-		wantsCR0 |= opWantsCR0 || code[i].canEndBlock;
-		wantsCR1 |= opWantsCR1 || code[i].canEndBlock;
+		code[i].wantsOV = wantsOV || code[i].canEndBlock;
 		wantsFPRF |= opWantsFPRF || code[i].canEndBlock;
 		wantsCA |= opWantsCA || code[i].canEndBlock;
-		wantsCR0 &= !code[i].outputCR0 || opWantsCR0;
-		wantsCR1 &= !code[i].outputCR1 || opWantsCR1;
+		wantsOV |= opWantsOV || code[i].canEndBlock;
+		crfWanted = (crfWanted & ~code[i].crfOut) | code[i].crfIn;
 		wantsFPRF &= !code[i].outputFPRF || opWantsFPRF;
 		wantsCA &= !code[i].outputCA || opWantsCA;
+		wantsOV &= !code[i].outputOV || opWantsOV;
+
+		if (HasOption(OPTION_DEAD_CODE_ELIM) && IsDeadInstruction(code[i], gprLive, opWantsCA))
+		{
+			code[i].skip = true;
+			block->m_num_dead_instructions++;
+		}
+
+		// Anything but plain integer and CR instructions may let the rest of the system see the
+		// registers as they are at this point (memory exceptions, the FPU unavailable check,
+		// system instructions), or may read registers the opcode table doesn't know about.
+		// HLE hooks read the registers of the functions they're attached to.
+		if (HLE::GetFunctionIndex(code[i].address))
+		{
+			crfWanted = BitSet8::AllTrue(8);
+			gprLive = BitSet32::AllTrue(32);
+		}
+		else if (code[i].opinfo->type != OPTYPE_INTEGER && code[i].opinfo->type != OPTYPE_CR)
+			gprLive = BitSet32::AllTrue(32);
+		else if (!code[i].skip)
+			gprLive = (gprLive & ~code[i].regsOut) | code[i].regsIn;
+
 		code[i].gprInUse = gprInUse;
 		code[i].fprInUse = fprInUse;
 		code[i].gprInReg = gprInReg;
 		code[i].fprInXmm = fprInXmm;
+		if (code[i].skip)
+			continue;
 		// TODO: if there's no possible endblocks or exceptions in between, tell the regcache
 		// we can throw away a register if it's going to be overwritten later.
 		gprInUse |= code[i].regsIn;
@@ -899,6 +1308,14 @@ u32 PPCAnalyzer::Analyze(u32 address, CodeBlock *block, CodeBuffer *buffer, u32
 	}
 	block->m_gqr_used = gqrUsed;
 	block->m_gqr_modified = gqrModified;
+
+	if (HasOption(OPTION_PAIRED_FUSION))
+		FindPairedSplats(block->m_num_instructions, code);
+	if (HasOption(OPTION_CONSTANT_PROPAGATION))
+		PropagateConstants(block->m_num_instructions, code);
+	if (HasOption(OPTION_IDLE_LOOP_DETECTION))
+		FindIdleLoop(block, code);
+
 	return address;
 }
 
@@ -8,6 +8,7 @@
 #include <cstdlib>
 #include <map>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #include "Common/BitSet.h"
@@ -37,12 +38,26 @@ struct CodeOp //16B
 	bool wantsFPRF;
 	bool wantsCA;
 	bool wantsCAInFlags;
+	bool wantsOV;
 	bool outputCR0;
 	bool outputCR1;
 	bool outputFPRF;
 	bool outputCA;
+	bool outputOV;
 	bool canEndBlock;
+	bool branchFollowed;  // the block continues at the branch target (trace formation)
+	// ps_muls*/ps_madd* multiplier reuse (see OPTION_PAIRED_FUSION): whether this instruction
+	// takes the same splatted and rounded FC as the previous one, and whether the next one does.
+	bool reuseSplat;
+	bool keepSplat;
 	bool skip;  // followed BL-s for example
+	// A branch back to the start of a busy-wait loop (see OPTION_IDLE_LOOP_DETECTION).
+	bool branchIsIdleLoop;
+	// CR fields this instruction reads, and the ones it overwrites completely.
+	BitSet8 crfIn;
+	BitSet8 crfOut;
+	// which CR fields may be read after this instruction before being overwritten
+	BitSet8 crfWanted;
 	// which registers are still needed after this instruction in this block
 	BitSet32 fprInUse;
 	BitSet32 gprInUse;
@@ -58,6 +73,14 @@ struct CodeOp //16B
 	// whether an fpr is the output of a single-precision arithmetic instruction, i.e. whether we can safely
 	// skip PPC_FP.
 	BitSet32 fprIsStoreSafe;
+	// Values known at compile time (see OPTION_CONSTANT_PROPAGATION): of RA and RB
+	// before this instruction, and of the one GPR it writes.
+	bool knownA;
+	bool knownB;
+	bool knownOut;
+	u32 valueA;
+	u32 valueB;
+	u32 valueOut;
 };
 
 struct BlockStats
@@ -67,6 +90,18 @@ struct BlockStats
 	int numCycles;
 };
 
+// How often a conditional branch was seen taken and not taken.
+struct BranchCounts
+{
+	u32 taken;
+	u32 not_taken;
+};
+
+// Branch outcomes recorded while code runs outside the JIT, keyed by the
+// address of the branch instruction. Used to pick the hot edge when forming
+// traces.
+typedef std::unordered_map<u32, BranchCounts> BranchProfile;
+
 struct BlockRegStats
 {
 	short firstRead[32];
@@ -160,6 +195,17 @@ struct CodeBlock
 
 	// Which GQRs this block modifies, if any.
 	BitSet8 m_gqr_modified;
+
+	// Number of branches the block continues through (see OPTION_BRANCH_FOLLOW).
+	u32 m_num_followed_branches;
+
+	// Number of instructions marked skip because their results are dead (see
+	// OPTION_DEAD_CODE_ELIM).
+	u32 m_num_dead_instructions;
+
+	// Whether the block starts with a busy-wait loop (see
+	// OPTION_IDLE_LOOP_DETECTION).
+	bool m_idle_loop;
 };
 
 class PPCAnalyzer
@@ -175,10 +221,17 @@ private:
 
 	void ReorderInstructionsCore(u32 instructions, CodeOp* code, bool reverse, ReorderType type);
 	void ReorderInstructions(u32 instructions, CodeOp *code);
+	void FindPairedSplats(u32 instructions, CodeOp* code);
+	void PropagateConstants(u32 instructions, CodeOp* code);
+	void FindIdleLoop(CodeBlock* block, CodeOp* code);
 	void SetInstructionStats(CodeBlock *block, CodeOp *code, GekkoOPInfo *opinfo, u32 index);
 
+	bool ShouldFollowBranch(UGeckoInstruction inst, u32 address, u32* destination) const;
+
 	// Options
 	u32 m_options;
+
+	const BranchProfile* m_branch_profile;
 public:
 
 	enum AnalystOption
@@ -217,16 +270,46 @@ public:
 
 		// Reorder cror instructions next to their associated fcmp.
 		OPTION_CROR_MERGE =  (1 << 6),
+
+		// Trace formation: continue the block at the target of unconditional
+		// branches, and at the target of conditional branches the branch profile
+		// says are almost always taken. The JIT has to exit the block on the
+		// not-taken path of a followed conditional branch.
+		OPTION_BRANCH_FOLLOW = (1 << 7),
+
+		// Find adjacent paired-single multiply(-add)s that use the same half of the
+		// same FC register, so the JIT can splat and round it once and keep it in a
+		// scratch register for the rest of the run.
+		OPTION_PAIRED_FUSION = (1 << 8),
+
+		// Skip integer instructions whose register and flag outputs are all
+		// overwritten before anything can read them. Requires JIT support for
+		// CodeOp::skip.
+		OPTION_DEAD_CODE_ELIM = (1 << 9),
+
+		// Track which GPRs hold values known at compile time through the whole
+		// block, including followed branches, so the JIT can rebuild constants the
+		// register cache dropped and resolve constant load/store addresses.
+		OPTION_CONSTANT_PROPAGATION = (1 << 10),
+
+		// Mark a branch back to the start of the block as an idle loop if the
+		// code before it only polls memory: no stores, no system instructions, and
+		// no register or CR value carried from one iteration to the next. Running
+		// such a loop again can't change anything until an interrupt or a device
+		// changes the memory it reads, so the JIT can skip to the next event.
+		OPTION_IDLE_LOOP_DETECTION = (1 << 11),
 	};
 
 
-	PPCAnalyzer() : m_options(0) {}
+	PPCAnalyzer() : m_options(0), m_branch_profile(nullptr) {}
 
 	// Option setting/getting
 	void SetOption(AnalystOption option) { m_options |= option; }
 	void ClearOption(AnalystOption option) { m_options &= ~(option); }
 	bool HasOption(AnalystOption option) { return !!(m_options & option); }
 
+	void SetBranchProfile(const BranchProfile* profile) { m_branch_profile = profile; }
+
 	u32 Analyze(u32 address, CodeBlock *block, CodeBuffer *buffer, u32 blockSize);
 };
 
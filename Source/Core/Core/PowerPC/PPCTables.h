@@ -87,6 +87,8 @@ struct GekkoOPInfo
 	u64 runCount;
 	int compileCount;
 	u32 lastUse;
+	// Runs that Jit64 handed to the interpreter (Profiler::g_ExecutionStats).
+	u64 fallbackCount;
 };
 extern GekkoOPInfo *m_infoTable[64];
 extern GekkoOPInfo *m_infoTable4[1024];
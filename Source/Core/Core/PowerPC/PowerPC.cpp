@@ -2,11 +2,14 @@
 // Licensed under GPLv2+
 // Refer to the license.txt file included.
 
+#include <cinttypes>
+
 #include "Common/ChunkFile.h"
 #include "Common/CommonTypes.h"
 #include "Common/FPURoundMode.h"
 #include "Common/MathUtil.h"
 
+#include "Core/ConfigManager.h"
 #include "Core/Core.h"
 #include "Core/CoreTiming.h"
 #include "Core/Host.h"
@@ -18,6 +21,7 @@
 #include "Core/PowerPC/CPUCoreBase.h"
 #include "Core/PowerPC/JitInterface.h"
 #include "Core/PowerPC/PowerPC.h"
+#include "Core/PowerPC/PPCSymbolDB.h"
 #include "Core/PowerPC/PPCTables.h"
 #include "Core/PowerPC/Interpreter/Interpreter.h"
 
@@ -35,6 +39,8 @@ Interpreter * const interpreter = Interpreter::getInstance();
 static CoreMode mode;
 
 Watches watches;
+
+static std::map<u32, IdleLoopStats> s_idle_loops;
 BreakPoints breakpoints;
 MemChecks memchecks;
 PPCDebugInterface debug_interface;
@@ -57,6 +63,14 @@ void ExpandCR(u32 cr)
 	}
 }
 
+void RoundingModeUpdated()
+{
+	FPURoundMode::SetRoundMode(FPSCR.RN);
+
+	// Set SSE rounding mode and denormal handling
+	FPURoundMode::SetSIMDMode(FPSCR.RN, FPSCR.NI);
+}
+
 void DoState(PointerWrap &p)
 {
 	// some of this code has been disabled, because
@@ -99,6 +113,7 @@ static void ResetRegisters()
 	ppcState.pc = 0;
 	ppcState.npc = 0;
 	ppcState.Exceptions = 0;
+	ppcState.reserve = false;
 	for (auto& v : ppcState.cr_val)
 		v = 0x8000000000000001;
 
@@ -120,19 +135,8 @@ void Init(int cpu_core)
 	ppcState.pagetable_base = 0;
 	ppcState.pagetable_hashmask = 0;
 
-	for (int tlb = 0; tlb < 2; tlb++)
-	{
-		for (int set = 0; set < 64; set++)
-		{
-			ppcState.tlb[tlb][set].recent = 0;
-			for (int way = 0; way < 2; way++)
-			{
-				ppcState.tlb[tlb][set].paddr[way] = 0;
-				ppcState.tlb[tlb][set].pte[way] = 0;
-				ppcState.tlb[tlb][set].tag[way] = TLB_TAG_INVALID;
-			}
-		}
-	}
+	ResetTLB();
+	s_idle_loops.clear();
 
 	ResetRegisters();
 	PPCTables::InitTables(cpu_core);
@@ -175,6 +179,32 @@ void Init(int cpu_core)
 
 void Shutdown()
 {
+	if (SConfig::GetInstance().m_LocalCoreStartupParameter.bMMU)
+	{
+		const TLBStats& data = GetTLBStats(false);
+		const TLBStats& inst = GetTLBStats(true);
+		NOTICE_LOG(POWERPC, "Data TLB: %" PRIu64 " hits, %" PRIu64 " misses, %" PRIu64 " page walks",
+		           data.hits, data.misses, data.page_walks);
+		NOTICE_LOG(POWERPC, "Instruction TLB: %" PRIu64 " hits, %" PRIu64 " misses, %" PRIu64 " page walks",
+		           inst.hits, inst.misses, inst.page_walks);
+	}
+
+	if (!s_idle_loops.empty())
+	{
+		u64 cycles = 0;
+		for (const auto& loop : s_idle_loops)
+			cycles += loop.second.cycles_skipped;
+		NOTICE_LOG(POWERPC, "Idle loops in %s: %u found, %" PRIu64 " cycles skipped",
+		           SConfig::GetInstance().m_LocalCoreStartupParameter.GetUniqueID().c_str(),
+		           (u32)s_idle_loops.size(), cycles);
+		for (const auto& loop : s_idle_loops)
+		{
+			Symbol* function = g_symbolDB.GetSymbolFromAddr(loop.first);
+			NOTICE_LOG(POWERPC, "  %08x %s: %" PRIu64 " hits, %" PRIu64 " cycles skipped", loop.first,
+			           function ? function->name.c_str() : "", loop.second.hits, loop.second.cycles_skipped);
+		}
+	}
+
 	JitInterface::Shutdown();
 	interpreter->Shutdown();
 	cpu_core_base = nullptr;
@@ -517,6 +547,18 @@ void OnIdle()
 	CoreTiming::Idle();
 }
 
+void OnIdleLoop(u32 address)
+{
+	IdleLoopStats& stats = s_idle_loops[address];
+	stats.hits++;
+	stats.cycles_skipped += CoreTiming::Idle();
+}
+
+const std::map<u32, IdleLoopStats>& GetIdleLoopStats()
+{
+	return s_idle_loops;
+}
+
 }  // namespace
 
 
@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include <map>
 #include <tuple>
 
 #include "Common/BreakPoints.h"
@@ -37,12 +38,15 @@ enum CoreMode
 };
 
 // TLB cache
-#define TLB_SIZE 128
+// Separate set-associative caches for data and instruction translations. The
+// set counts must be powers of two; the data TLB is larger since MMU titles
+// mostly miss on data accesses. Gekko itself has 64 sets x 2 ways each.
 #define NUM_TLBS 2
-#define TLB_WAYS 2
+#define TLB_WAYS 4
+#define DATA_TLB_SETS 128
+#define INST_TLB_SETS 32
 
 #define HW_PAGE_INDEX_SHIFT 12
-#define HW_PAGE_INDEX_MASK 0x3f
 #define HW_PAGE_TAG_SHIFT 18
 
 #define TLB_TAG_INVALID 0xffffffff
@@ -52,7 +56,24 @@ struct tlb_entry
 	u32 tag[TLB_WAYS];
 	u32 paddr[TLB_WAYS];
 	u32 pte[TLB_WAYS];
-	u8 recent;
+	// Tree pseudo-LRU: bit 0 picks the half to evict from, bits 1 and 2 the
+	// way within the lower and upper half.
+	u8 lru;
+};
+
+struct TLBStats
+{
+	u64 hits;
+	u64 misses;
+	// Misses plus hits that had to write back the C bit.
+	u64 page_walks;
+};
+
+// How often the JIT skipped ahead from an idle loop, and how far.
+struct IdleLoopStats
+{
+	u64 hits;
+	u64 cycles_skipped;
 };
 
 // This contains the entire state of the emulated PowerPC "Gekko" CPU.
@@ -95,6 +116,10 @@ struct GC_ALIGNED64(PowerPCState)
 	// The Broadway CPU implements bits 16-23 of the XER register... even though it doesn't support lscbx
 	u16 xer_stringctrl;
 
+	// The reservation lwarx makes for stwcx.
+	u32 reserve_address;
+	bool reserve;
+
 #if _M_X86_64
 	// This member exists for the purpose of an assertion in x86 JitBase.cpp
 	// that its offset <= 0x100.  To minimize code size on x86, we want as much
@@ -115,7 +140,8 @@ struct GC_ALIGNED64(PowerPCState)
 	// also for power management, but we don't care about that.
 	u32 spr[1024];
 
-	tlb_entry tlb[NUM_TLBS][TLB_SIZE / TLB_WAYS];
+	tlb_entry dtlb[DATA_TLB_SETS];
+	tlb_entry itlb[INST_TLB_SETS];
 
 	u32 pagetable_base;
 	u32 pagetable_hashmask;
@@ -162,7 +188,14 @@ volatile CPUState *GetStatePtr();  // this oddity is here instead of an extern d
 u32 CompactCR();
 void ExpandCR(u32 cr);
 
+// Sets the host FPU's rounding and denormal modes from FPSCR.
+void RoundingModeUpdated();
+
 void OnIdle();
+// Called by the JIT when a loop found by the analyzer's idle loop detection
+// branches back to its start at address.
+void OnIdleLoop(u32 address);
+const std::map<u32, IdleLoopStats>& GetIdleLoopStats();
 
 void UpdatePerformanceMonitor(u32 cycles, u32 num_load_stores, u32 num_fp_inst);
 
@@ -261,9 +294,22 @@ void DMA_LCToMemory(const u32 memAddr, const u32 cacheAddr, const u32 numBlocks)
 void DMA_MemoryToLC(const u32 cacheAddr, const u32 memAddr, const u32 numBlocks);
 void ClearCacheLine(const u32 address); // Zeroes 32 bytes; address should be 32-byte-aligned
 
+// While set, called after every load and before every store made through the
+// Read_ and Write_ functions above, and for locked cache DMA. JitLockstep uses
+// it to undo the stores of a block the interpreter ran.
+typedef void (*MemoryAccessHook)(u32 address, u32 size, bool write);
+void SetMemoryAccessHook(MemoryAccessHook hook);
+
 // TLB functions
+void ResetTLB();
+const TLBStats& GetTLBStats(bool instruction);
 void SDRUpdated();
+void SRUpdated();
+void DBATUpdated();
 void InvalidateTLBEntry(u32 address);
+// Mirrors the page containing a translated address into the logical view;
+// called by the JIT when a fastmem access faults.
+bool MapLogicalPage(u32 address, bool write);
 
 // Result changes based on the BAT registers and MSR.DR.  Returns whether
 // it's safe to optimize a read or write to this address to an unguarded
@@ -2,8 +2,13 @@
 // Licensed under GPLv2+
 // Refer to the license.txt file included.
 
+#include <cinttypes>
 #include <string>
+
+#include "Common/FileUtil.h"
+#include "Core/ConfigManager.h"
 #include "Core/PowerPC/JitInterface.h"
+#include "Core/PowerPC/PowerPC.h"
 #include "Core/PowerPC/Profiler.h"
 
 namespace Profiler
@@ -14,6 +19,23 @@ bool g_ProfileBlocks;
 void WriteProfileResults(const std::string& filename)
 {
 	JitInterface::WriteProfileResults(filename);
+
+	if (!SConfig::GetInstance().m_LocalCoreStartupParameter.bMMU)
+		return;
+
+	File::IOFile f(filename, "a");
+	if (!f)
+		return;
+	fprintf(f.GetHandle(), "\nTLB\tsets\tways\thits\tmisses\tpageWalks\thitPercent\n");
+	for (int tlb = 0; tlb < NUM_TLBS; tlb++)
+	{
+		const PowerPC::TLBStats& stats = PowerPC::GetTLBStats(tlb != 0);
+		u64 lookups = stats.hits + stats.misses;
+		fprintf(f.GetHandle(), "%s\t%i\t%i\t%" PRIu64 "\t%" PRIu64 "\t%" PRIu64 "\t%.2f\n",
+		        tlb ? "instruction" : "data", tlb ? INST_TLB_SETS : DATA_TLB_SETS, TLB_WAYS,
+		        stats.hits, stats.misses, stats.page_walks,
+		        lookups ? 100.0 * (double)stats.hits / (double)lookups : 0.0);
+	}
 }
 
 }  // namespace
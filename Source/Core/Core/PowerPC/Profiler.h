@@ -57,4 +57,36 @@ namespace Profiler
 extern bool g_ProfileBlocks;
 
 void WriteProfileResults(const std::string& filename);
+
+// Sampling profiler. Interrupts the calling thread rate_hz times a second and
+// attributes its host PC to JIT code through the JitRegister symbol table,
+// which the JIT has to be started with (see
+// SCoreStartupParameter::m_sampleProfileFile). Unlike g_ProfileBlocks, the
+// generated code isn't changed. StopSampling has to be called on the same
+// thread; it writes the samples in the collapsed stack format that
+// flamegraph.pl reads.
+void StartSampling(int rate_hz);
+void StopSampling(const std::string& filename);
+
+// Execution statistics (SCoreStartupParameter::m_executionStatsFile): how
+// often each opcode ran and how often Jit64 handed it to the interpreter
+// (GekkoOPInfo::runCount and fallbackCount), and how often each block ran and
+// the cycles it was charged. Jit64 only emits the counters while
+// g_ExecutionStats is set, so they cost nothing otherwise.
+extern bool g_ExecutionStats;
+
+struct BlockExecutionStats
+{
+	u64 runs;
+	u64 cycles;
+};
+
+// Blocks are keyed by start address. The entry stays where it is, so compiled
+// code can count into it directly.
+BlockExecutionStats* GetBlockExecutionStats(u32 address);
+void CountBlockRun(u32 address, int cycles);
+// Only while no compiled code counts into the entries.
+void ResetExecutionStats();
+// As JSON if the name ends in .json, otherwise as CSV.
+void WriteExecutionStats(const std::string& filename);
 }
@@ -0,0 +1,184 @@
+// Copyright 2015 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <map>
+#include <memory>
+#include <string>
+#include <thread>
+
+#include "Common/CommonTypes.h"
+#include "Common/Event.h"
+#include "Common/FileUtil.h"
+#include "Common/JitRegister.h"
+#include "Common/Thread.h"
+#include "Common/Logging/Log.h"
+#include "Core/MachineContext.h"
+#include "Core/PowerPC/PPCSymbolDB.h"
+#include "Core/PowerPC/Profiler.h"
+
+#if !defined(_WIN32) && !defined(__APPLE__) && !defined(_M_GENERIC)
+#include <pthread.h>
+#include <signal.h>
+#include <ucontext.h>
+#define HAVE_SAMPLING_PROFILER 1
+#endif
+
+namespace Profiler
+{
+
+#ifdef HAVE_SAMPLING_PROFILER
+
+// One JitRegister symbol number per sample. Only the signal handler adds
+// samples, on the sampled thread.
+static const size_t MAX_SAMPLES = 1 << 20;
+static std::unique_ptr<u32[]> s_samples;
+static std::atomic<size_t> s_num_samples;
+static std::atomic<u64> s_dropped_samples;
+static std::atomic<bool> s_sampling(false);
+
+static pthread_t s_sampled_thread;
+static std::thread s_sampler_thread;
+static Common::Event s_stop_sampler;
+static struct sigaction s_old_action;
+
+static void SampleHandler(int sig, siginfo_t* info, void* raw_context)
+{
+	if (!s_sampling.load(std::memory_order_relaxed))
+		return;
+
+	SContext* ctx = &((ucontext_t*)raw_context)->uc_mcontext;
+	u32 symbol = JitRegister::FindSymbol((const void*)ctx->CTX_PC);
+
+	size_t n = s_num_samples.load(std::memory_order_relaxed);
+	if (n < MAX_SAMPLES)
+	{
+		s_samples[n] = symbol;
+		s_num_samples.store(n + 1, std::memory_order_release);
+	}
+	else
+	{
+		s_dropped_samples++;
+	}
+}
+
+static void SamplerThread(int rate_hz)
+{
+	Common::SetCurrentThreadName("Sampling profiler");
+	std::chrono::microseconds period(1000000 / rate_hz);
+	while (!s_stop_sampler.WaitFor(period))
+		pthread_kill(s_sampled_thread, SIGPROF);
+}
+
+// Collapsed stack frames can't contain the separator.
+static std::string Frame(std::string name)
+{
+	std::replace(name.begin(), name.end(), ';', ':');
+	return name;
+}
+
+void StartSampling(int rate_hz)
+{
+	if (s_sampling || rate_hz <= 0)
+		return;
+
+	s_samples.reset(new u32[MAX_SAMPLES]);
+	s_num_samples = 0;
+	s_dropped_samples = 0;
+	s_sampled_thread = pthread_self();
+
+	struct sigaction sa;
+	sa.sa_sigaction = &SampleHandler;
+	sa.sa_flags = SA_SIGINFO | SA_RESTART;
+	sigemptyset(&sa.sa_mask);
+	sigaction(SIGPROF, &sa, &s_old_action);
+
+	s_sampling = true;
+	s_stop_sampler.Reset();
+	s_sampler_thread = std::thread(SamplerThread, rate_hz);
+}
+
+void StopSampling(const std::string& filename)
+{
+	if (!s_sampling)
+		return;
+
+	s_stop_sampler.Set();
+	s_sampler_thread.join();
+	s_sampling = false;
+	sigaction(SIGPROF, &s_old_action, nullptr);
+
+	// Blocks are registered as JIT_PPC_<address>; put them under the guest
+	// function they belong to. Everything else the JIT registered (the
+	// dispatcher, trampolines, the common asm routines) is a frame of its own,
+	// and samples outside JIT code are attributed to the host.
+	std::map<u32, u64> counts;
+	size_t num_samples = s_num_samples.load(std::memory_order_acquire);
+	for (size_t i = 0; i < num_samples; i++)
+		counts[s_samples[i]]++;
+
+	std::map<std::string, u64> stacks;
+	u64 jit_samples = 0;
+	for (const auto& count : counts)
+	{
+		std::string stack;
+		if (count.first == JitRegister::NO_SYMBOL)
+		{
+			stack = "[host]";
+		}
+		else if (count.first == JitRegister::SYMBOL_TABLE_BUSY)
+		{
+			stack = "[unknown]";
+		}
+		else
+		{
+			std::string name = JitRegister::GetSymbolName(count.first);
+			u32 address;
+			if (sscanf(name.c_str(), "JIT_PPC_%x", &address) == 1)
+			{
+				Symbol* function = g_symbolDB.GetSymbolFromAddr(address);
+				stack = Frame(function ? function->name : "[unknown function]") + ";" + Frame(name);
+			}
+			else
+			{
+				stack = Frame(name);
+			}
+			jit_samples += count.second;
+		}
+		stacks[stack] += count.second;
+	}
+
+	File::IOFile f(filename, "w");
+	if (!f)
+	{
+		ERROR_LOG(POWERPC, "Sampling profiler: failed to open %s", filename.c_str());
+		return;
+	}
+	for (const auto& stack : stacks)
+		fprintf(f.GetHandle(), "%s %" PRIu64 "\n", stack.first.c_str(), stack.second);
+
+	NOTICE_LOG(POWERPC, "Sampling profiler: %" PRIu64 " samples (%" PRIu64 " dropped), %.1f%% in JIT code, written to %s",
+	           (u64)num_samples, s_dropped_samples.load(),
+	           num_samples ? 100.0 * (double)jit_samples / (double)num_samples : 0.0, filename.c_str());
+	s_samples.reset();
+}
+
+#else
+
+void StartSampling(int rate_hz)
+{
+	WARN_LOG(POWERPC, "The sampling profiler isn't supported on this platform");
+}
+
+void StopSampling(const std::string& filename)
+{
+}
+
+#endif
+
+}  // namespace
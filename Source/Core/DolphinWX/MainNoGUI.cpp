@@ -288,19 +288,32 @@ static Platform* GetPlatform()
 int main(int argc, char* argv[])
 {
 	int ch, help = 0;
+	std::string perf_dir, sample_profile_file, stats_file;
 	struct option longopts[] = {
-		{ "exec",    no_argument, nullptr, 'e' },
-		{ "help",    no_argument, nullptr, 'h' },
-		{ "version", no_argument, nullptr, 'v' },
+		{ "exec",     no_argument,       nullptr, 'e' },
+		{ "help",     no_argument,       nullptr, 'h' },
+		{ "version",  no_argument,       nullptr, 'v' },
+		{ "perf_dir", required_argument, nullptr, 'P' },
+		{ "profile",  required_argument, nullptr, 'p' },
+		{ "stats",    required_argument, nullptr, 's' },
 		{ nullptr,      0,           nullptr,  0  }
 	};
 
-	while ((ch = getopt_long(argc, argv, "eh?v", longopts, 0)) != -1)
+	while ((ch = getopt_long(argc, argv, "eh?vP:p:s:", longopts, 0)) != -1)
 	{
 		switch (ch)
 		{
 		case 'e':
 			break;
+		case 'P':
+			perf_dir = optarg;
+			break;
+		case 'p':
+			sample_profile_file = optarg;
+			break;
+		case 's':
+			stats_file = optarg;
+			break;
 		case 'h':
 		case '?':
 			help = 1;
@@ -315,10 +328,15 @@ int main(int argc, char* argv[])
 	{
 		fprintf(stderr, "%s\n\n", scm_rev_str);
 		fprintf(stderr, "A multi-platform GameCube/Wii emulator\n\n");
-		fprintf(stderr, "Usage: %s [-e <file>] [-h] [-v]\n", argv[0]);
-		fprintf(stderr, "  -e, --exec     Load the specified file\n");
-		fprintf(stderr, "  -h, --help     Show this help message\n");
-		fprintf(stderr, "  -v, --version  Print version and exit\n");
+		fprintf(stderr, "Usage: %s [-e <file>] [-h] [-v] [-P <dir>] [-p <file>] [-s <file>]\n", argv[0]);
+		fprintf(stderr, "  -e, --exec      Load the specified file\n");
+		fprintf(stderr, "  -h, --help      Show this help message\n");
+		fprintf(stderr, "  -v, --version   Print version and exit\n");
+		fprintf(stderr, "  -P, --perf_dir  Write the JIT's perf map to the specified directory\n");
+		fprintf(stderr, "  -p, --profile   Sample the CPU thread and write collapsed stacks\n"
+		                "                  for flamegraph.pl to the specified file\n");
+		fprintf(stderr, "  -s, --stats     Count the opcodes and blocks run and write them to the\n"
+		                "                  specified file at exit, as JSON if it ends in .json\n");
 		return 1;
 	}
 
@@ -331,6 +349,9 @@ int main(int argc, char* argv[])
 
 	UICommon::SetUserDirectory(""); // Auto-detect user folder
 	UICommon::Init();
+	SConfig::GetInstance().m_LocalCoreStartupParameter.m_perfDir = perf_dir;
+	SConfig::GetInstance().m_LocalCoreStartupParameter.m_sampleProfileFile = sample_profile_file;
+	SConfig::GetInstance().m_LocalCoreStartupParameter.m_executionStatsFile = stats_file;
 
 	platform->Init();
 
@@ -0,0 +1,117 @@
+// Copyright 2015 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "Common/BulkCopy.h"
+#include "Common/CommonTypes.h"
+
+static std::vector<u8> Pattern(size_t size)
+{
+	std::vector<u8> data(size);
+	for (size_t i = 0; i < size; i++)
+		data[i] = (u8)(i * 7 + 3);
+	return data;
+}
+
+static std::vector<u8> Reference(const u8* src, size_t size, int element_size)
+{
+	std::vector<u8> data(size);
+	for (size_t i = 0; i < size; i++)
+		data[i] = src[i - i % element_size + element_size - 1 - i % element_size];
+	return data;
+}
+
+TEST(BulkCopy, AllKernelsMatchReference)
+{
+	std::vector<u8> src = Pattern(1024);
+	for (int k = 0; k < Common::NUM_SWAP_KERNELS; k++)
+	{
+		Common::SwapKernel kernel = (Common::SwapKernel)k;
+		if (!Common::IsSwapKernelSupported(kernel))
+			continue;
+		SCOPED_TRACE(Common::GetSwapKernelName(kernel));
+
+		for (int element_size : {2, 4, 8})
+		{
+			// Every length up to a few vectors, at every alignment.
+			for (size_t size = 0; size <= 320; size += element_size)
+			{
+				for (size_t offset = 0; offset < 4; offset++)
+				{
+					std::vector<u8> expected = Reference(&src[offset], size, element_size);
+					std::vector<u8> dst(size + 8, 0xcc);
+					Common::CopySwap(kernel, &dst[1], &src[offset], size, element_size);
+					ASSERT_EQ(0, memcmp(expected.data(), &dst[1], size)) << element_size << " " << size << " " << offset;
+					ASSERT_EQ(0xcc, dst[0]);
+					ASSERT_EQ(0xcc, dst[size + 1]);
+
+					std::vector<u8> in_place(src.begin() + offset, src.begin() + offset + size);
+					Common::CopySwap(kernel, in_place.data(), in_place.data(), size, element_size);
+					ASSERT_EQ(expected, in_place);
+				}
+			}
+		}
+	}
+}
+
+TEST(BulkCopy, ElementCounts)
+{
+	const u16 in16[3] = { 0x1234, 0x5678, 0x9abc };
+	u16 out16[3];
+	Common::CopySwap16(out16, in16, 3);
+	EXPECT_EQ(0x3412, out16[0]);
+	EXPECT_EQ(0xbc9a, out16[2]);
+
+	const u32 in32[2] = { 0x12345678, 0x9abcdef0 };
+	u32 out32[2];
+	Common::CopySwap32(out32, in32, 2);
+	EXPECT_EQ(0x78563412u, out32[0]);
+	EXPECT_EQ(0xf0debc9au, out32[1]);
+
+	const u64 in64 = 0x0123456789abcdefULL;
+	u64 out64;
+	Common::CopySwap64(&out64, &in64, 1);
+	EXPECT_EQ(0xefcdab8967452301ULL, out64);
+}
+
+TEST(BulkCopy, Throughput)
+{
+	const size_t SIZE = 4 * 1024 * 1024;
+	const int ROUNDS = 16;
+	std::vector<u8> src = Pattern(SIZE);
+	std::vector<u8> dst(SIZE);
+
+	using Clock = std::chrono::steady_clock;
+	auto report = [&](const char* name, Clock::time_point start) {
+		double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+		printf("%-16s %6.2f GB/s\n", name, (double)SIZE * ROUNDS / seconds / 1e9);
+	};
+
+	auto start = Clock::now();
+	for (int r = 0; r < ROUNDS; r++)
+		memcpy(dst.data(), src.data(), SIZE);
+	report("memcpy", start);
+
+	for (int k = 0; k < Common::NUM_SWAP_KERNELS; k++)
+	{
+		Common::SwapKernel kernel = (Common::SwapKernel)k;
+		if (!Common::IsSwapKernelSupported(kernel))
+			continue;
+		for (int element_size : {2, 4, 8})
+		{
+			start = Clock::now();
+			for (int r = 0; r < ROUNDS; r++)
+				Common::CopySwap(kernel, dst.data(), src.data(), SIZE, element_size);
+			char name[32];
+			snprintf(name, sizeof(name), "%s swap%d", Common::GetSwapKernelName(kernel), element_size * 8);
+			report(name, start);
+		}
+	}
+}
@@ -868,9 +868,26 @@ TWO_OP_SSE_TEST(PMOVZXWD, "qword")
 TWO_OP_SSE_TEST(PMOVZXWQ, "dword")
 TWO_OP_SSE_TEST(PMOVZXDQ, "qword")
 
-// TODO: BLEND
+// TODO: BLENDV
 
-// TODO: AVX
+// for SSE4.1 blends that take the form op reg, r/m, imm
+#define SSE_BLEND_TEST(Name) \
+	TEST_F(x64EmitterTest, Name) \
+	{ \
+		for (const auto& r1 : xmmnames) \
+		{ \
+			for (const auto& r2 : xmmnames) \
+			{ \
+				emitter->Name(r1.reg, R(r2.reg), 0x05); \
+				ExpectDisassembly(#Name " " + r1.name + ", " + r2.name + ", 0x05"); \
+			} \
+			emitter->Name(r1.reg, MatR(R12), 0x05); \
+			ExpectDisassembly(#Name " " + r1.name + ", dqword ptr ds:[r12], 0x05"); \
+		} \
+	}
+
+SSE_BLEND_TEST(BLENDPS)
+SSE_BLEND_TEST(BLENDPD)
 
 // for VEX GPR instructions that take the form op reg, r/m, reg
 #define VEX_RMR_TEST(Name) \
@@ -1025,6 +1042,83 @@ AVX_RRM_TEST(VPAND,   "dqword")
 AVX_RRM_TEST(VPANDN,  "dqword")
 AVX_RRM_TEST(VPOR,    "dqword")
 AVX_RRM_TEST(VPXOR,   "dqword")
+AVX_RRM_TEST(VPADDQ,  "dqword")
+AVX_RRM_TEST(VPSUBQ,  "dqword")
+AVX_RRM_TEST(VPSHUFB, "dqword")
+
+AVX_RRM_TEST(VADDSS, "dword")
+AVX_RRM_TEST(VSUBSS, "dword")
+AVX_RRM_TEST(VMULSS, "dword")
+AVX_RRM_TEST(VDIVSS, "dword")
+AVX_RRM_TEST(VADDSD, "qword")
+AVX_RRM_TEST(VSUBSD, "qword")
+AVX_RRM_TEST(VMULSD, "qword")
+AVX_RRM_TEST(VDIVSD, "qword")
+AVX_RRM_TEST(VADDPS, "dqword")
+AVX_RRM_TEST(VSUBPS, "dqword")
+AVX_RRM_TEST(VMULPS, "dqword")
+AVX_RRM_TEST(VDIVPS, "dqword")
+AVX_RRM_TEST(VADDPD, "dqword")
+AVX_RRM_TEST(VSUBPD, "dqword")
+AVX_RRM_TEST(VMULPD, "dqword")
+AVX_RRM_TEST(VDIVPD, "dqword")
+AVX_RRM_TEST(VSQRTSD, "qword")
+AVX_RRM_TEST(VUNPCKLPD, "dqword")
+AVX_RRM_TEST(VUNPCKHPD, "dqword")
+AVX_RRM_TEST(VCVTSD2SS, "qword")
+AVX_RRM_TEST(VCVTSS2SD, "dword")
+
+// AVX2
+AVX_RRM_TEST(VPSLLVD, "dqword")
+AVX_RRM_TEST(VPSLLVQ, "dqword")
+AVX_RRM_TEST(VPSRLVD, "dqword")
+AVX_RRM_TEST(VPSRLVQ, "dqword")
+AVX_RRM_TEST(VPSRAVD, "dqword")
+
+// for AVX instructions that take the form op reg, reg, r/m, imm
+#define AVX_RRMI_TEST(Name) \
+	TEST_F(x64EmitterTest, Name) \
+	{ \
+		for (const auto& r : xmmnames) \
+		{ \
+			emitter->Name(r.reg, XMM0, R(XMM0), 0x05); \
+			emitter->Name(XMM0, XMM0, R(r.reg), 0x05); \
+			emitter->Name(XMM0, r.reg, MatR(R12), 0x05); \
+			ExpectDisassembly(#Name " " + r.name + ", xmm0, xmm0, 0x05 " \
+			                  #Name " xmm0, xmm0, " + r.name + ", 0x05 " \
+			                  #Name " xmm0, " + r.name + ", dqword ptr ds:[r12], 0x05"); \
+		} \
+	}
+
+AVX_RRMI_TEST(VSHUFPD)
+AVX_RRMI_TEST(VBLENDPS)
+AVX_RRMI_TEST(VBLENDPD)
+AVX_RRMI_TEST(VPBLENDD)
+
+// for AVX instructions that take the form op reg, r/m
+#define AVX_RM_TEST(Name, sizename) \
+	TEST_F(x64EmitterTest, Name) \
+	{ \
+		for (const auto& r : xmmnames) \
+		{ \
+			emitter->Name(r.reg, R(XMM0)); \
+			emitter->Name(XMM0, R(r.reg)); \
+			emitter->Name(r.reg, MatR(R12)); \
+			ExpectDisassembly(#Name " " + r.name + ", xmm0 " \
+			                  #Name " xmm0, " + r.name + " " \
+			                  #Name " " + r.name + ", " sizename " ptr ds:[r12]"); \
+		} \
+	}
+
+AVX_RM_TEST(VMOVDDUP,  "qword")
+AVX_RM_TEST(VCVTPD2PS, "dqword")
+AVX_RM_TEST(VCVTPS2PD, "dqword")
+
+// AVX2
+AVX_RM_TEST(VPBROADCASTB, "byte")
+AVX_RM_TEST(VPBROADCASTW, "word")
+AVX_RM_TEST(VPBROADCASTD, "dword")
+AVX_RM_TEST(VPBROADCASTQ, "qword")
 
 #define FMA3_TEST(Name, P, packed) \
 	AVX_RRM_TEST(Name ## 132 ## P ## S, packed ? "dqword" : "dword") \
@@ -0,0 +1,103 @@
+// Copyright 2015 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <vector>
+
+#include <gtest/gtest.h>
+
+// Jit.h pulls in the x64Emitter, whose TEST method conflicts with gtest's
+// macro. Only TEST_F is used here.
+#undef TEST
+
+#include "Common/CommonTypes.h"
+#include "Core/ConfigManager.h"
+#include "Core/Movie.h"
+#include "Core/HW/Memmap.h"
+#include "Core/PowerPC/PowerPC.h"
+#include "Core/PowerPC/Profiler.h"
+#include "Core/PowerPC/Interpreter/Interpreter.h"
+#include "Core/PowerPC/Jit64/Jit.h"
+
+#include "PowerPCTestUtil.h"
+
+#if _M_X86_64
+
+class BackgroundCompileTest : public PowerPCTest
+{
+protected:
+	void SetUp() override
+	{
+		PowerPCTest::SetUp();
+		SConfig::GetInstance().m_LocalCoreStartupParameter.bJITBackgroundCompile = true;
+		InitCore(PowerPC::CORE_JIT64);
+
+		Memory::Write_U32(Branch(HALT, HALT), HALT);
+	}
+
+	static Jit64* GetJit()
+	{
+		return static_cast<Jit64*>(jit);
+	}
+
+	// Runs from CODE until it reaches HALT; the first blocks may take more
+	// than a timeslice while they are interpreted.
+	static void Run()
+	{
+		StartAt(CODE);
+		for (int i = 0; i < 100 && PowerPC::ppcState.pc != HALT; i++)
+			PowerPC::SingleStep();
+		EXPECT_EQ(HALT, PowerPC::ppcState.pc);
+	}
+};
+
+TEST_F(BackgroundCompileTest, PublishesBlocks)
+{
+	WriteChecksumLoop(1000);
+	StartAt(CODE);
+	while (PowerPC::ppcState.pc != HALT)
+		Interpreter::getInstance()->SingleStepInner();
+	u32 r5 = PowerPC::ppcState.gpr[5];
+	u32 data = Memory::Read_U32(DATA + 4);
+
+	ASSERT_TRUE(GetJit()->CanCompileInBackground());
+	WriteChecksumLoop(1000);
+	Run();
+	EXPECT_EQ(r5, PowerPC::ppcState.gpr[5]);
+	EXPECT_EQ(data, Memory::Read_U32(DATA + 4));
+	EXPECT_EQ(1000u, PowerPC::ppcState.gpr[7]);
+
+	// The CPU thread waits for a pending compile before it leaves Jit(), so
+	// the first block has been published whatever ran in the meantime.
+	EXPECT_GE(jit->GetBlockCache()->GetBlockNumberFromStartAddress(CODE), 0);
+	EXPECT_GE(GetJit()->GetBackgroundCompiles(), 1u);
+}
+
+TEST_F(BackgroundCompileTest, SynchronousWhenReproducible)
+{
+	SCoreStartupParameter& param = SConfig::GetInstance().m_LocalCoreStartupParameter;
+	EXPECT_TRUE(GetJit()->CanCompileInBackground());
+
+	param.bEnableDebugging = true;
+	EXPECT_FALSE(GetJit()->CanCompileInBackground());
+	param.bEnableDebugging = false;
+
+	Profiler::g_ExecutionStats = true;
+	EXPECT_FALSE(GetJit()->CanCompileInBackground());
+	Profiler::g_ExecutionStats = false;
+
+	ASSERT_TRUE(Movie::BeginRecordingInput(1));
+	EXPECT_FALSE(GetJit()->CanCompileInBackground());
+
+	// Nothing goes to the compile thread while the movie records.
+	WriteChecksumLoop(10);
+	Run();
+	EXPECT_EQ(10u, PowerPC::ppcState.gpr[7]);
+	EXPECT_GE(jit->GetBlockCache()->GetBlockNumberFromStartAddress(CODE), 0);
+	EXPECT_EQ(0u, GetJit()->GetBackgroundCompiles());
+	Movie::EndPlayInput(false);
+
+	EXPECT_TRUE(GetJit()->CanCompileInBackground());
+}
+
+#endif
@@ -0,0 +1,317 @@
+// Copyright 2015 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <chrono>
+#include <cstdio>
+#include <list>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "Common/ChunkFile.h"
+#include "Common/CommonTypes.h"
+#include "Core/CoreTiming.h"
+#include "Core/CoreTimingQueue.h"
+#include "Core/PowerPC/PowerPC.h"
+
+#include "PowerPCTestUtil.h"
+
+using CoreTiming::BaseEvent;
+using CoreTiming::EventQueue;
+
+static BaseEvent MakeEvent(s64 time, int type, u64 userdata = 0)
+{
+	BaseEvent ev;
+	ev.time = time;
+	ev.type = type;
+	ev.userdata = userdata;
+	return ev;
+}
+
+static std::vector<u64> PopAll(EventQueue* queue)
+{
+	std::vector<u64> order;
+	BaseEvent ev;
+	while (queue->PopDue(INT64_MAX, &ev))
+		order.push_back(ev.userdata);
+	return order;
+}
+
+TEST(EventQueue, OrdersByTimeThenSchedulingOrder)
+{
+	EventQueue queue;
+	queue.Push(MakeEvent(30, 0, 1));
+	queue.Push(MakeEvent(10, 1, 2));
+	queue.Push(MakeEvent(20, 0, 3));
+	queue.Push(MakeEvent(10, 2, 4));
+	queue.Push(MakeEvent(10, 0, 5));
+
+	BaseEvent ev;
+	EXPECT_FALSE(queue.PopDue(9, &ev));
+	ASSERT_TRUE(queue.PopDue(10, &ev));
+	EXPECT_EQ(2u, ev.userdata);
+	EXPECT_EQ(std::vector<u64>({4, 5, 3, 1}), PopAll(&queue));
+	EXPECT_TRUE(queue.Empty());
+}
+
+TEST(EventQueue, RemoveIsLazy)
+{
+	EventQueue queue;
+	queue.Push(MakeEvent(10, 1, 1));
+	queue.Push(MakeEvent(20, 2, 2));
+	queue.Push(MakeEvent(30, 1, 3));
+	EXPECT_TRUE(queue.IsScheduled(1));
+
+	queue.Remove(1);
+	EXPECT_FALSE(queue.IsScheduled(1));
+	EXPECT_TRUE(queue.IsScheduled(2));
+	s64 time;
+	ASSERT_TRUE(queue.GetNextTime(&time));
+	EXPECT_EQ(20, time);
+
+	// Events scheduled after the removal aren't affected by it.
+	queue.Push(MakeEvent(5, 1, 4));
+	EXPECT_EQ(1, queue.GetSorted().front().type);
+	EXPECT_EQ(std::vector<u64>({4, 2}), PopAll(&queue));
+	EXPECT_TRUE(queue.Empty());
+	EXPECT_FALSE(queue.GetNextTime(&time));
+}
+
+TEST(EventQueue, CompactsDeadEvents)
+{
+	EventQueue queue;
+	for (int round = 0; round < 100; round++)
+	{
+		for (int i = 0; i < 10; i++)
+			queue.Push(MakeEvent(1000000 + i, 1));
+		queue.Remove(1);
+		queue.Push(MakeEvent(round, 2, round));
+	}
+	EXPECT_FALSE(queue.IsScheduled(1));
+	EXPECT_EQ(100u, queue.GetSorted().size());
+	std::vector<u64> order = PopAll(&queue);
+	ASSERT_EQ(100u, order.size());
+	for (u64 i = 0; i < order.size(); i++)
+		EXPECT_EQ(i, order[i]);
+}
+
+TEST(EventQueue, KeepsOrderPastTheFrontArray)
+{
+	// More events than fit in front of the heap, in no particular order.
+	EventQueue queue;
+	for (u64 i = 0; i < 100; i++)
+		queue.Push(MakeEvent((i * 37) % 100, 1, (i * 37) % 100));
+	queue.Push(MakeEvent(-1, 2, 100));
+
+	std::vector<u64> expected = {100};
+	for (u64 i = 0; i < 100; i++)
+		expected.push_back(i);
+	EXPECT_EQ(expected, PopAll(&queue));
+}
+
+static std::vector<u64> s_fired;
+
+static void RecordEvent(u64 userdata, int cyclesLate)
+{
+	s_fired.push_back(userdata);
+}
+
+class CoreTimingTest : public ConfigTest
+{
+protected:
+	void SetUp() override
+	{
+		ConfigTest::SetUp();
+		CoreTiming::Init();
+		s_fired.clear();
+	}
+
+	void TearDown() override
+	{
+		CoreTiming::Shutdown();
+		ConfigTest::TearDown();
+	}
+};
+
+TEST_F(CoreTimingTest, AdvanceRunsDueEvents)
+{
+	int a = CoreTiming::RegisterEvent("A", RecordEvent);
+	int b = CoreTiming::RegisterEvent("B", RecordEvent);
+	CoreTiming::ScheduleEvent_Threadsafe(100, a, 1);
+	CoreTiming::ScheduleEvent_Threadsafe(50, b, 2);
+	CoreTiming::ScheduleEvent_Threadsafe(100, b, 3);
+	CoreTiming::ScheduleEvent_Threadsafe(30000, a, 4);
+	CoreTiming::MoveEvents();
+	EXPECT_TRUE(CoreTiming::IsScheduled(a));
+
+	PowerPC::ppcState.downcount = 0;
+	CoreTiming::Advance();
+	EXPECT_EQ(std::vector<u64>({2, 1, 3}), s_fired);
+	EXPECT_EQ(30000 - 20000, CoreTiming::slicelength);
+
+	CoreTiming::RemoveAllEvents(a);
+	EXPECT_FALSE(CoreTiming::IsScheduled(a));
+}
+
+TEST_F(CoreTimingTest, SaveStateRoundTrip)
+{
+	int a = CoreTiming::RegisterEvent("A", RecordEvent);
+	int b = CoreTiming::RegisterEvent("B", RecordEvent);
+	CoreTiming::ScheduleEvent_Threadsafe(100, a, 1);
+	CoreTiming::ScheduleEvent_Threadsafe(50, b, 2);
+	CoreTiming::ScheduleEvent_Threadsafe(100, b, 3);
+	CoreTiming::ScheduleEvent_Threadsafe(70, a, 4);
+	CoreTiming::MoveEvents();
+	CoreTiming::RemoveEvent(a);
+	CoreTiming::ScheduleEvent_Threadsafe(60, a, 5);
+	CoreTiming::MoveEvents();
+	std::string summary = CoreTiming::GetScheduledEventsSummary();
+
+	u8* ptr = nullptr;
+	PointerWrap measure(&ptr, PointerWrap::MODE_MEASURE);
+	CoreTiming::DoState(measure);
+	std::vector<u8> buffer((size_t)ptr);
+
+	ptr = buffer.data();
+	PointerWrap write(&ptr, PointerWrap::MODE_WRITE);
+	CoreTiming::DoState(write);
+	CoreTiming::ClearPendingEvents();
+	EXPECT_FALSE(CoreTiming::IsScheduled(b));
+
+	ptr = buffer.data();
+	PointerWrap read(&ptr, PointerWrap::MODE_READ);
+	CoreTiming::DoState(read);
+	EXPECT_EQ(summary, CoreTiming::GetScheduledEventsSummary());
+	EXPECT_EQ("Scheduled events\n"
+	          "B : 50 0000000000000002\n"
+	          "A : 60 0000000000000005\n"
+	          "B : 100 0000000000000003\n", summary);
+}
+
+TEST_F(CoreTimingTest, ThreadsafeEventsKeepOrderWhenOverflowing)
+{
+	int a = CoreTiming::RegisterEvent("A", RecordEvent);
+	std::vector<u64> expected;
+	for (u64 i = 0; i < 1000; i++)
+	{
+		CoreTiming::ScheduleEvent_Threadsafe(0, a, i);
+		expected.push_back(i);
+	}
+	CoreTiming::MoveEvents();
+	CoreTiming::ScheduleEvent_Threadsafe(0, a, 1000);
+	expected.push_back(1000);
+
+	PowerPC::ppcState.downcount = 0;
+	CoreTiming::Advance();
+	EXPECT_EQ(expected, s_fired);
+}
+
+TEST_F(CoreTimingTest, LoadingStateDropsThreadsafeEvents)
+{
+	int a = CoreTiming::RegisterEvent("A", RecordEvent);
+	u8* ptr = nullptr;
+	PointerWrap measure(&ptr, PointerWrap::MODE_MEASURE);
+	CoreTiming::DoState(measure);
+	std::vector<u8> buffer((size_t)ptr);
+	ptr = buffer.data();
+	PointerWrap write(&ptr, PointerWrap::MODE_WRITE);
+	CoreTiming::DoState(write);
+
+	// Enough to overflow, so both places they're kept in are covered.
+	for (u64 i = 0; i < 1000; i++)
+		CoreTiming::ScheduleEvent_Threadsafe(0, a, i);
+	ptr = buffer.data();
+	PointerWrap read(&ptr, PointerWrap::MODE_READ);
+	CoreTiming::DoState(read);
+	CoreTiming::ScheduleEvent_Threadsafe(0, a, 1000);
+
+	PowerPC::ppcState.downcount = 0;
+	CoreTiming::Advance();
+	EXPECT_EQ(std::vector<u64>({1000}), s_fired);
+}
+
+// The sorted list CoreTiming used to keep its events in, for comparison.
+class ListQueue
+{
+public:
+	void Push(const BaseEvent& event)
+	{
+		auto it = m_list.begin();
+		while (it != m_list.end() && it->time <= event.time)
+			++it;
+		m_list.insert(it, event);
+	}
+
+	bool PopDue(s64 time, BaseEvent* event)
+	{
+		if (m_list.empty() || m_list.front().time > time)
+			return false;
+		*event = m_list.front();
+		m_list.pop_front();
+		return true;
+	}
+
+	void Remove(int type)
+	{
+		m_list.remove_if([type](const BaseEvent& ev) { return ev.type == type; });
+	}
+
+private:
+	std::list<BaseEvent> m_list;
+};
+
+// Periodic events with the periods of a running game (VI, audio, SI polling,
+// DSP, EXI, IPC, decrementer), plus types that get removed and rescheduled on
+// every run like interrupt and DMA completion events.
+template <typename Queue>
+static double RunEventMix(int num_rescheduled, u64* checksum)
+{
+	static const s64 periods[] = { 486000000 / 60 / 525, 486000000 / 60, 486000000 / 32000 * 32,
+	                               486000000 / 200, 6750, 2000, 8000, 48000, 1200, 4000,
+	                               486000000 / 1000, 900 };
+	const int num_periodic = sizeof(periods) / sizeof(periods[0]);
+	const int num_events = 2000000;
+
+	Queue queue;
+	for (int type = 0; type < num_periodic; type++)
+		queue.Push(MakeEvent(periods[type], type));
+
+	auto start = std::chrono::steady_clock::now();
+	s64 now = 0;
+	u64 sum = 0;
+	for (int i = 0; i < num_events;)
+	{
+		now += 1000;
+		BaseEvent ev;
+		while (queue.PopDue(now, &ev))
+		{
+			i++;
+			sum = sum * 31 + ev.type;
+			if (ev.type < num_periodic)
+			{
+				queue.Push(MakeEvent(ev.time + periods[ev.type], ev.type));
+				int other = num_periodic + (int)(ev.time / periods[ev.type]) % num_rescheduled;
+				queue.Remove(other);
+				queue.Push(MakeEvent(now + 500 + 37 * (other % 64), other));
+			}
+		}
+	}
+	*checksum = sum;
+	return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+TEST(EventQueue, Throughput)
+{
+	// What a game usually has pending, and a heavier load.
+	for (int num_rescheduled : {8, 256})
+	{
+		u64 heap_sum, list_sum;
+		double heap_seconds = RunEventMix<EventQueue>(num_rescheduled, &heap_sum);
+		double list_seconds = RunEventMix<ListQueue>(num_rescheduled, &list_sum);
+		EXPECT_EQ(list_sum, heap_sum);
+		printf("%3d rescheduled types: heap %5.1f M events/s, list %5.1f M events/s\n",
+		       num_rescheduled, 2.0 / heap_seconds, 2.0 / list_seconds);
+	}
+}
@@ -0,0 +1,197 @@
+// Copyright 2015 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+// DSPCore.h pulls in the x64Emitter, whose TEST method conflicts with gtest's
+// macro. Only TEST_F is used here.
+#undef TEST
+
+#include "Common/CommonTypes.h"
+#include "Common/MemoryUtil.h"
+#include "Common/MsgHandler.h"
+#include "Core/ConfigManager.h"
+#include "Core/DSP/DSPAnalyzer.h"
+#include "Core/DSP/DSPCodeUtil.h"
+#include "Core/DSP/DSPCore.h"
+#include "Core/DSP/DSPTables.h"
+
+#include "PowerPCTestUtil.h"
+
+// Five iterations of a two-instruction body, short enough to be unrolled.
+static const char UNROLLED[] =
+	"	clr $ACC0\n"
+	"	clr $ACC1\n"
+	"	lri $AX0.L, #0x0003\n"
+	"	bloopi #5, end\n"
+	"		addax $ACC0, $AX0\n"
+	"end:\n"
+	"		inc $ACC1\n"
+	"	halt\n";
+
+// 64 iterations of a body that loads and stores DRAM, looped over natively.
+static const char NATIVE[] =
+	"	lri $AR0, #0x0000\n"
+	"	lri $AR1, #0x0100\n"
+	"	lri $AX1.H, #0x0040\n"
+	"	lri $AX0.L, #0x0001\n"
+	"	clr $ACC0\n"
+	"	clr $ACC1\n"
+	"	bloop $AX1.H, end\n"
+	"		addax $ACC0, $AX0\n"
+	"		srri @$AR0, $AC0.L\n"
+	"		lrri $AX1.L, @$AR1\n"
+	"end:\n"
+	"		addax $ACC1, $AX1\n"
+	"	halt\n";
+
+// A loop whose body changes the loop stacks can't be compiled as one.
+static const char STACK_ACCESS[] =
+	"	bloopi #4, end\n"
+	"		inc $ACC0\n"
+	"end:\n"
+	"		mrr $AX0.L, $ST3\n"
+	"	halt\n";
+
+static bool AnswerNo(const char*, const char*, bool, int)
+{
+	return false;
+}
+
+struct DSPState
+{
+	DSP_Regs r;
+	std::vector<u16> dram;
+};
+
+class DSPJitTest : public ConfigTest
+{
+protected:
+	void SetUp() override
+	{
+		ConfigTest::SetUp();
+		SConfig::GetInstance().m_LocalCoreStartupParameter.bDSPThread = false;
+		InitInstructionTable();
+		// The zeroed ROMs fail the hash check.
+		RegisterMsgAlertHandler(AnswerNo);
+	}
+
+	void TearDown() override
+	{
+		DSPCore_Shutdown();
+		RegisterMsgAlertHandler(nullptr);
+		ConfigTest::TearDown();
+	}
+
+	void Load(DSPInitOptions::CoreType core, const char* text)
+	{
+		std::vector<u16> code;
+		ASSERT_TRUE(Assemble(text, code));
+
+		DSPCore_Shutdown();
+		DSPInitOptions opts;
+		opts.irom_contents.fill(0);
+		opts.coef_contents.fill(0);
+		opts.core_type = core;
+		ASSERT_TRUE(DSPCore_Init(opts));
+
+		UnWriteProtectMemory(g_dsp.iram, DSP_IRAM_BYTE_SIZE, false);
+		std::copy(code.begin(), code.end(), g_dsp.iram);
+		WriteProtectMemory(g_dsp.iram, DSP_IRAM_BYTE_SIZE, false);
+		for (int i = 0; i < 0x40; i++)
+			g_dsp.dram[0x100 + i] = i * 3;
+
+		DSPCore_Reset();
+		g_dsp.pc = 0;
+		g_dsp.cr &= ~CR_HALT;
+	}
+
+	// Runs the program until it halts, in slices of the given length.
+	DSPState Run(DSPInitOptions::CoreType core, const char* text, int slice)
+	{
+		Load(core, text);
+		for (int i = 0; i < 10000 && !(g_dsp.cr & CR_HALT); i++)
+			DSPCore_RunCycles(slice);
+		EXPECT_TRUE(g_dsp.cr & CR_HALT);
+		return {g_dsp.r, std::vector<u16>(g_dsp.dram, g_dsp.dram + 0x200)};
+	}
+
+	void ExpectSameAsInterpreter(const char* text, int slice)
+	{
+		DSPState expected = Run(DSPInitOptions::CORE_INTERPRETER, text, 1000);
+		DSPState actual = Run(DSPInitOptions::CORE_JIT, text, slice);
+
+		// The JIT only computes $sr where a conditional branch reads it.
+		for (int i = 0; i < 4; i++)
+		{
+			EXPECT_EQ(expected.r.ar[i], actual.r.ar[i]) << "ar" << i;
+			EXPECT_EQ(expected.r.ix[i], actual.r.ix[i]) << "ix" << i;
+			EXPECT_EQ(expected.r.st[i], actual.r.st[i]) << "st" << i;
+		}
+		for (int i = 0; i < 2; i++)
+		{
+			EXPECT_EQ(expected.r.ax[i].val, actual.r.ax[i].val) << "ax" << i;
+			EXPECT_EQ(expected.r.ac[i].l, actual.r.ac[i].l) << "ac" << i;
+			EXPECT_EQ(expected.r.ac[i].m, actual.r.ac[i].m) << "ac" << i;
+			EXPECT_EQ(expected.r.ac[i].h, actual.r.ac[i].h) << "ac" << i;
+		}
+		EXPECT_EQ(expected.dram, actual.dram);
+	}
+};
+
+TEST_F(DSPJitTest, AnalyzesLoops)
+{
+	Load(DSPInitOptions::CORE_INTERPRETER, UNROLLED);
+	u16 body = 6;
+	EXPECT_TRUE(DSPAnalyzer::code_flags[body] & DSPAnalyzer::CODE_SIMPLE_LOOP);
+	EXPECT_TRUE(DSPAnalyzer::code_flags[body] & DSPAnalyzer::CODE_LOOP_NO_INT);
+
+	Load(DSPInitOptions::CORE_INTERPRETER, NATIVE);
+	body = 12;
+	EXPECT_TRUE(DSPAnalyzer::code_flags[body] & DSPAnalyzer::CODE_SIMPLE_LOOP);
+	EXPECT_FALSE(DSPAnalyzer::code_flags[body] & DSPAnalyzer::CODE_LOOP_NO_INT);
+	// Only LRRI may read the accelerator.
+	EXPECT_FALSE(DSPAnalyzer::code_flags[body + 1] & DSPAnalyzer::CODE_CHECK_INT);
+	EXPECT_FALSE(DSPAnalyzer::code_flags[body + 2] & DSPAnalyzer::CODE_CHECK_INT);
+	EXPECT_TRUE(DSPAnalyzer::code_flags[body + 3] & DSPAnalyzer::CODE_CHECK_INT);
+
+	Load(DSPInitOptions::CORE_INTERPRETER, STACK_ACCESS);
+	EXPECT_FALSE(DSPAnalyzer::code_flags[2] & DSPAnalyzer::CODE_SIMPLE_LOOP);
+}
+
+TEST_F(DSPJitTest, LRFromHardwareChecksExceptions)
+{
+	Load(DSPInitOptions::CORE_INTERPRETER,
+	     "	lr $AC0.M, @0x0010\n"
+	     "	lr $AC1.M, @0xffdd\n"
+	     "	halt\n");
+	EXPECT_FALSE(DSPAnalyzer::code_flags[2] & DSPAnalyzer::CODE_CHECK_INT);
+	EXPECT_TRUE(DSPAnalyzer::code_flags[4] & DSPAnalyzer::CODE_CHECK_INT);
+}
+
+#if _M_X86_64
+
+TEST_F(DSPJitTest, UnrolledLoop)
+{
+	ExpectSameAsInterpreter(UNROLLED, 1000);
+	EXPECT_EQ(15u, g_dsp.r.ac[0].l);
+	EXPECT_EQ(5u, g_dsp.r.ac[1].l);
+}
+
+TEST_F(DSPJitTest, NativeLoop)
+{
+	ExpectSameAsInterpreter(NATIVE, 1000);
+	EXPECT_EQ(64u, g_dsp.dram[63]);
+}
+
+TEST_F(DSPJitTest, NativeLoopOutOfCycles)
+{
+	ExpectSameAsInterpreter(NATIVE, 7);
+	ExpectSameAsInterpreter(NATIVE, 23);
+}
+
+#endif
@@ -0,0 +1,156 @@
+// Copyright 2015 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "Common/CommonTypes.h"
+#include "Common/FileUtil.h"
+#include "Core/ConfigManager.h"
+#include "Core/CoreTiming.h"
+#include "Core/HW/Memmap.h"
+#include "Core/PowerPC/PowerPC.h"
+#include "Core/PowerPC/PPCTables.h"
+#include "Core/PowerPC/Profiler.h"
+#include "Core/PowerPC/Interpreter/Interpreter.h"
+#include "VideoCommon/VideoBackendBase.h"
+
+#include "PowerPCTestUtil.h"
+
+static const u32 LOOP = CODE + 8;
+
+static const GekkoOPInfo* GetInfo(u32 inst)
+{
+	return GetOpInfo(UGeckoInstruction(inst));
+}
+
+class ExecutionStatsTest : public PowerPCTest
+{
+protected:
+	void SetUp() override
+	{
+		PowerPCTest::SetUp();
+		Profiler::g_ExecutionStats = true;
+	}
+
+	void TearDown() override
+	{
+		Profiler::g_ExecutionStats = false;
+		PowerPCTest::TearDown();
+	}
+
+	// Five iterations of a two-instruction loop, after two instructions that
+	// fall into it.
+	void Init(int core)
+	{
+		InitCore(core);
+		Profiler::ResetExecutionStats();
+
+		Memory::Write_U32(Addi(3, 0, 0), CODE);
+		Memory::Write_U32(Addi(4, 0, 0), CODE + 4);
+		Memory::Write_U32(Addi(3, 3, 1), LOOP);
+		Memory::Write_U32(Bdnz(LOOP + 4, LOOP), LOOP + 4);
+		Memory::Write_U32(Branch(LOOP + 8, HALT), LOOP + 8);
+		Memory::Write_U32(Branch(HALT, HALT), HALT);
+
+		PowerPC::ppcState.msr = 0x2000; // FP available, translation off
+		PowerPC::ppcState.pc = CODE;
+		PowerPC::ppcState.npc = CODE;
+		PowerPC::ppcState.spr[SPR_CTR] = 5;
+	}
+};
+
+TEST_F(ExecutionStatsTest, Interpreter)
+{
+	for (bool cached : {false, true})
+	{
+		SConfig::GetInstance().m_LocalCoreStartupParameter.bInterpreterBlockCache = cached;
+		Init(PowerPC::CORE_INTERPRETER);
+		Interpreter::getInstance()->ClearCache();
+		while (PowerPC::ppcState.pc != HALT)
+			Interpreter::getInstance()->RunBlock();
+		EXPECT_EQ(5u, PowerPC::ppcState.gpr[3]);
+
+		EXPECT_EQ(7u, GetInfo(Addi(3, 3, 1))->runCount);
+		EXPECT_EQ(5u, GetInfo(Bdnz(0, 0))->runCount);
+		EXPECT_EQ(1u, GetInfo(Branch(0, 0))->runCount);
+		EXPECT_EQ(0u, GetInfo(Addi(3, 3, 1))->fallbackCount);
+
+		// The interpreter's blocks end at every branch.
+		EXPECT_EQ(1u, Profiler::GetBlockExecutionStats(CODE)->runs);
+		EXPECT_EQ(4u, Profiler::GetBlockExecutionStats(CODE)->cycles);
+		EXPECT_EQ(4u, Profiler::GetBlockExecutionStats(LOOP)->runs);
+		EXPECT_EQ(8u, Profiler::GetBlockExecutionStats(LOOP)->cycles);
+		EXPECT_EQ(1u, Profiler::GetBlockExecutionStats(LOOP + 8)->runs);
+
+		Interpreter::getInstance()->ClearCache();
+		PowerPC::Shutdown();
+		CoreTiming::Shutdown();
+		Memory::Shutdown();
+		VideoBackend::ClearList();
+	}
+	Init(PowerPC::CORE_INTERPRETER);
+}
+
+TEST_F(ExecutionStatsTest, WritesCSVAndJSON)
+{
+	Init(PowerPC::CORE_INTERPRETER);
+	while (PowerPC::ppcState.pc != HALT)
+		Interpreter::getInstance()->RunBlock();
+
+	std::string filename = File::GetTempFilenameForAtomicWrite("ExecutionStatsTest") + ".csv";
+	Profiler::WriteExecutionStats(filename);
+	std::string csv;
+	ASSERT_TRUE(File::ReadFileToString(filename, csv));
+	File::Delete(filename);
+	EXPECT_EQ(0u, csv.find("opcode,runs,fallbacks\naddi,7,0\nbcx,5,0\nbx,1,0\n\nblock,symbol,runs,cycles\n"));
+	EXPECT_NE(std::string::npos, csv.find("\n00003008,"));
+
+	filename = File::GetTempFilenameForAtomicWrite("ExecutionStatsTest") + ".json";
+	Profiler::WriteExecutionStats(filename);
+	std::string json;
+	ASSERT_TRUE(File::ReadFileToString(filename, json));
+	File::Delete(filename);
+	EXPECT_NE(std::string::npos, json.find("{\"name\": \"addi\", \"runs\": 7, \"fallbacks\": 0}"));
+	EXPECT_NE(std::string::npos, json.find("{\"address\": \"00003008\", "));
+	EXPECT_NE(std::string::npos, json.find("\"runs\": 4, \"cycles\": 8}"));
+}
+
+#if _M_X86_64
+
+TEST_F(ExecutionStatsTest, Jit64)
+{
+	Init(PowerPC::CORE_JIT64);
+	PowerPC::SingleStep();
+	EXPECT_EQ(HALT, PowerPC::ppcState.pc);
+	EXPECT_EQ(5u, PowerPC::ppcState.gpr[3]);
+
+	EXPECT_EQ(7u, GetInfo(Addi(3, 3, 1))->runCount);
+	EXPECT_EQ(5u, GetInfo(Bdnz(0, 0))->runCount);
+	EXPECT_EQ(0u, GetInfo(Addi(3, 3, 1))->fallbackCount);
+
+	// Jit64's blocks carry on past conditional branches; exits charge the
+	// cycles of the instructions before them.
+	EXPECT_EQ(1u, Profiler::GetBlockExecutionStats(CODE)->runs);
+	EXPECT_EQ(4u, Profiler::GetBlockExecutionStats(CODE)->cycles);
+	EXPECT_EQ(4u, Profiler::GetBlockExecutionStats(LOOP)->runs);
+	EXPECT_EQ(9u, Profiler::GetBlockExecutionStats(LOOP)->cycles);
+	EXPECT_EQ(0u, Profiler::GetBlockExecutionStats(LOOP + 8)->runs);
+}
+
+TEST_F(ExecutionStatsTest, Jit64Fallbacks)
+{
+	SConfig::GetInstance().m_LocalCoreStartupParameter.bJITIntegerOff = true;
+	Init(PowerPC::CORE_JIT64);
+	PowerPC::SingleStep();
+	EXPECT_EQ(5u, PowerPC::ppcState.gpr[3]);
+
+	EXPECT_EQ(7u, GetInfo(Addi(3, 3, 1))->runCount);
+	EXPECT_EQ(7u, GetInfo(Addi(3, 3, 1))->fallbackCount);
+	EXPECT_EQ(0u, GetInfo(Bdnz(0, 0))->fallbackCount);
+}
+
+#endif
@@ -0,0 +1,236 @@
+// Copyright 2015 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <cmath>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "Common/CommonTypes.h"
+#include "Core/ConfigManager.h"
+#include "Core/Core.h"
+#include "Core/HLE/HLE.h"
+#include "Core/HLE/HLE_SDK.h"
+#include "Core/HW/Memmap.h"
+#include "Core/PowerPC/PowerPC.h"
+#include "Core/PowerPC/PPCSymbolDB.h"
+
+#include "PowerPCTestUtil.h"
+
+#if _M_X86_64
+
+// DATA through the cached BAT.
+static const u32 CACHED_DATA = 0x80000000 | DATA;
+static const u32 BLR = 0x4e800020;
+
+// A byte-at-a-time memcpy, like the one in the SDK's C library.
+static const std::vector<u32> s_memcpy_code = {
+	0x7c661b78, // or r6, r3, r3
+	0x2c050000, // cmpwi r5, 0
+	0x4d820020, // beqlr
+	0x7ca903a6, // mtctr r5
+	0x3884ffff, // addi r4, r4, -1
+	0x38c6ffff, // addi r6, r6, -1
+	0x8c040001, // lbzu r0, 1(r4)
+	0x9c060001, // stbu r0, 1(r6)
+	0x4200fff8, // bdnz -8
+	0x4e800020, // blr
+};
+
+static float ReadFloat(u32 address)
+{
+	u32 hex = Memory::Read_U32(address & 0x3fffffff);
+	float f;
+	memcpy(&f, &hex, sizeof(f));
+	return f;
+}
+
+static void WriteFloat(float f, u32 address)
+{
+	u32 hex;
+	memcpy(&hex, &f, sizeof(hex));
+	Memory::Write_U32(hex, address & 0x3fffffff);
+}
+
+class HLEFastPathTest : public PowerPCTest
+{
+protected:
+	void SetUp() override
+	{
+		PowerPCTest::SetUp();
+		SCoreStartupParameter& param = SConfig::GetInstance().m_LocalCoreStartupParameter;
+		param.bSkipIdle = false;
+		param.bHLEFastPaths = true;
+		param.bHLEVerifyFastPaths = false;
+		InitCore(PowerPC::CORE_JIT64);
+		HLE_SDK::ResetVerifyStats();
+
+		Memory::Write_U32(Branch(HALT, HALT), HALT);
+	}
+
+	void TearDown() override
+	{
+		Core::g_want_determinism = false;
+		g_symbolDB.Clear();
+		HLE::PatchFunctions();
+		PowerPCTest::TearDown();
+	}
+
+	void AddFunction(u32 address, const std::string& name, const std::vector<u32>& code)
+	{
+		for (size_t i = 0; i < code.size(); i++)
+			Memory::Write_U32(code[i], address + (u32)i * 4);
+		g_symbolDB.AddKnownSymbol(address, (u32)code.size() * 4, name);
+		HLE::PatchFunctions();
+	}
+
+	void Call(u32 address)
+	{
+		PowerPC::ppcState.msr = 0x2010; // FP available, data translation on
+		PowerPC::ppcState.pc = address;
+		PowerPC::ppcState.npc = address;
+		PowerPC::ppcState.spr[SPR_LR] = HALT;
+		PowerPC::SingleStep();
+		EXPECT_EQ(HALT, PowerPC::ppcState.pc);
+	}
+};
+
+TEST_F(HLEFastPathTest, ReplacesGuestCode)
+{
+	// The guest versions do nothing, so anything they should have done was
+	// done natively.
+	AddFunction(0x3000, "memcpy", {BLR});
+	AddFunction(0x3010, "memset", {BLR});
+	AddFunction(0x3020, "PSMTXIdentity", {BLR});
+	AddFunction(0x3030, "PSMTXConcat", {BLR});
+	AddFunction(0x3040, "sin", {BLR});
+
+	for (u32 i = 0; i < 16; i++)
+		Memory::Write_U8(i + 1, DATA + i);
+	PowerPC::ppcState.gpr[3] = CACHED_DATA + 0x100;
+	PowerPC::ppcState.gpr[4] = CACHED_DATA;
+	PowerPC::ppcState.gpr[5] = 16;
+	Call(0x3000);
+	EXPECT_EQ(CACHED_DATA + 0x100, PowerPC::ppcState.gpr[3]);
+	for (u32 i = 0; i < 16; i++)
+		EXPECT_EQ(i + 1, Memory::Read_U8(DATA + 0x100 + i));
+
+	PowerPC::ppcState.gpr[3] = CACHED_DATA + 0x200;
+	PowerPC::ppcState.gpr[4] = 0xab;
+	PowerPC::ppcState.gpr[5] = 10;
+	Call(0x3010);
+	EXPECT_EQ(0xab, Memory::Read_U8(DATA + 0x209));
+	EXPECT_EQ(0, Memory::Read_U8(DATA + 0x20a));
+
+	PowerPC::ppcState.gpr[3] = CACHED_DATA + 0x300;
+	Call(0x3020);
+	for (u32 i = 0; i < 3; i++)
+		for (u32 j = 0; j < 4; j++)
+			EXPECT_EQ(i == j ? 1.0f : 0.0f, ReadFloat(CACHED_DATA + 0x300 + (i * 4 + j) * 4));
+
+	const float a[3][4] = {{1, 2, 3, 4}, {5, 6, 7, 8}, {9, 10, 11, 12}};
+	const float b[3][4] = {{2, 0, 1, 3}, {1, 1, 0, 2}, {0, 3, 1, 1}};
+	for (u32 i = 0; i < 3; i++)
+	{
+		for (u32 j = 0; j < 4; j++)
+		{
+			WriteFloat(a[i][j], CACHED_DATA + 0x400 + (i * 4 + j) * 4);
+			WriteFloat(b[i][j], CACHED_DATA + 0x500 + (i * 4 + j) * 4);
+		}
+	}
+	PowerPC::ppcState.gpr[3] = CACHED_DATA + 0x400;
+	PowerPC::ppcState.gpr[4] = CACHED_DATA + 0x500;
+	PowerPC::ppcState.gpr[5] = CACHED_DATA + 0x400;
+	Call(0x3030);
+	for (u32 i = 0; i < 3; i++)
+	{
+		for (u32 j = 0; j < 4; j++)
+		{
+			float expected = a[i][0] * b[0][j] + a[i][1] * b[1][j] + a[i][2] * b[2][j] + (j == 3 ? a[i][3] : 0);
+			EXPECT_EQ(expected, ReadFloat(CACHED_DATA + 0x400 + (i * 4 + j) * 4));
+		}
+	}
+
+	rPS0(1) = 0.5;
+	Call(0x3040);
+	EXPECT_DOUBLE_EQ(sin(0.5), rPS0(1));
+}
+
+TEST_F(HLEFastPathTest, DisabledRunsGuestCode)
+{
+	SConfig::GetInstance().m_LocalCoreStartupParameter.bHLEFastPaths = false;
+	AddFunction(0x3000, "memset", {BLR});
+
+	PowerPC::ppcState.gpr[3] = CACHED_DATA;
+	PowerPC::ppcState.gpr[4] = 0xab;
+	PowerPC::ppcState.gpr[5] = 4;
+	Call(0x3000);
+	EXPECT_EQ(0, Memory::Read_U8(DATA));
+}
+
+TEST_F(HLEFastPathTest, VerifyComparesWithGuestCode)
+{
+	SConfig::GetInstance().m_LocalCoreStartupParameter.bHLEVerifyFastPaths = true;
+	AddFunction(0x3000, "memcpy", s_memcpy_code);
+	AddFunction(0x3100, "memset", {BLR});
+
+	for (u32 i = 0; i < 64; i++)
+		Memory::Write_U8(i * 3, DATA + i);
+	PowerPC::ppcState.gpr[3] = CACHED_DATA + 0x100;
+	PowerPC::ppcState.gpr[4] = CACHED_DATA;
+	PowerPC::ppcState.gpr[5] = 64;
+	Call(0x3000);
+	for (u32 i = 0; i < 64; i++)
+		EXPECT_EQ((u8)(i * 3), Memory::Read_U8(DATA + 0x100 + i));
+	EXPECT_EQ(1u, HLE_SDK::GetVerifyStats().calls);
+	EXPECT_EQ(0u, HLE_SDK::GetVerifyStats().mismatches);
+
+	// The guest memset is broken; its result is the one that stays.
+	PowerPC::ppcState.gpr[3] = CACHED_DATA + 0x200;
+	PowerPC::ppcState.gpr[4] = 0xab;
+	PowerPC::ppcState.gpr[5] = 4;
+	Call(0x3100);
+	EXPECT_EQ(0, Memory::Read_U8(DATA + 0x200));
+	EXPECT_EQ(2u, HLE_SDK::GetVerifyStats().calls);
+	EXPECT_EQ(1u, HLE_SDK::GetVerifyStats().mismatches);
+	EXPECT_EQ(0u, HLE_SDK::GetVerifyStats().skipped);
+}
+
+TEST_F(HLEFastPathTest, HostMathOffWhenDeterministic)
+{
+	// Movies and netplay can't depend on the host's libm.
+	Core::g_want_determinism = true;
+	AddFunction(0x3000, "sin", {BLR});
+	AddFunction(0x3010, "memset", {BLR});
+
+	rPS0(1) = 0.5;
+	Call(0x3000);
+	EXPECT_EQ(0.5, rPS0(1));
+
+	PowerPC::ppcState.gpr[3] = CACHED_DATA;
+	PowerPC::ppcState.gpr[4] = 0xab;
+	PowerPC::ppcState.gpr[5] = 4;
+	Call(0x3010);
+	EXPECT_EQ(0xab, Memory::Read_U8(DATA));
+}
+
+TEST_F(HLEFastPathTest, VerifyGivesUpOnLongCalls)
+{
+	SConfig::GetInstance().m_LocalCoreStartupParameter.bHLEVerifyFastPaths = true;
+	// Never returns, and stomps on r3.
+	AddFunction(0x3000, "memset", {Addi(3, 0, 0), Branch(0x3004, 0x3000)});
+
+	PowerPC::ppcState.gpr[3] = CACHED_DATA;
+	PowerPC::ppcState.gpr[4] = 0xab;
+	PowerPC::ppcState.gpr[5] = 4;
+	Call(0x3000);
+	EXPECT_EQ(CACHED_DATA, PowerPC::ppcState.gpr[3]);
+	EXPECT_EQ(0xab, Memory::Read_U8(DATA + 3));
+	EXPECT_EQ(1u, HLE_SDK::GetVerifyStats().skipped);
+	EXPECT_EQ(0u, HLE_SDK::GetVerifyStats().mismatches);
+}
+
+#endif
@@ -0,0 +1,108 @@
+// Copyright 2015 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "Common/CommonTypes.h"
+#include "Core/ConfigManager.h"
+#include "Core/HW/Memmap.h"
+#include "Core/PowerPC/PowerPC.h"
+#include "Core/PowerPC/PPCAnalyst.h"
+
+#include "PowerPCTestUtil.h"
+
+#if _M_X86_64
+
+static const u32 LOOP = CODE;
+static const u32 FLAG = DATA;
+
+class IdleLoopTest : public PowerPCTest
+{
+protected:
+	void SetUp() override
+	{
+		PowerPCTest::SetUp();
+		SCoreStartupParameter& param = SConfig::GetInstance().m_LocalCoreStartupParameter;
+		param.bSkipIdle = true;
+		param.bSyncGPUOnSkipIdleHack = false;
+		InitCore(PowerPC::CORE_JIT64);
+	}
+
+	// Writes the loop at LOOP, followed by a block that spins until the
+	// timeslice runs out.
+	void WriteCode(const std::vector<u32>& code)
+	{
+		::WriteCode(code, LOOP);
+		u32 address = LOOP + (u32)code.size() * 4;
+		Memory::Write_U32(Branch(address, address + 4), address);
+		Memory::Write_U32(Branch(address + 4, address + 4), address + 4);
+	}
+
+	bool IsIdleLoop(const std::vector<u32>& code)
+	{
+		WriteCode(code);
+		PPCAnalyst::PPCAnalyzer analyzer;
+		analyzer.SetOption(PPCAnalyst::PPCAnalyzer::OPTION_CONDITIONAL_CONTINUE);
+		analyzer.SetOption(PPCAnalyst::PPCAnalyzer::OPTION_BRANCH_MERGE);
+		analyzer.SetOption(PPCAnalyst::PPCAnalyzer::OPTION_IDLE_LOOP_DETECTION);
+		PPCAnalyst::CodeBlock code_block;
+		PPCAnalyst::CodeBuffer code_buffer(32);
+		PPCAnalyst::BlockStats st;
+		PPCAnalyst::BlockRegStats gpa, fpa;
+		code_block.m_stats = &st;
+		code_block.m_gpa = &gpa;
+		code_block.m_fpa = &fpa;
+		PowerPC::ppcState.msr = 0;
+		analyzer.Analyze(LOOP, &code_block, &code_buffer, 32);
+		return code_block.m_idle_loop;
+	}
+
+	void Run()
+	{
+		StartAt(LOOP);
+		PowerPC::SingleStep();
+	}
+};
+
+TEST_F(IdleLoopTest, AnalyzerFindsPollingLoops)
+{
+	EXPECT_TRUE(IsIdleLoop({Lwz(4, 3, 0), Cmpwi(4, 0), Bc(true, LOOP + 8, LOOP)}));
+	EXPECT_TRUE(IsIdleLoop({Addi(5, 0, 0x40), Lwz(4, 5, 0), Cmpwi(4, 0), Bc(false, LOOP + 12, LOOP)}));
+	EXPECT_TRUE(IsIdleLoop({Lwz(4, 3, 0), Branch(LOOP + 4, LOOP)}));
+
+	// Counting iterations.
+	EXPECT_FALSE(IsIdleLoop({Addi(5, 5, 1), Lwz(4, 3, 0), Cmpwi(4, 0), Bc(true, LOOP + 12, LOOP)}));
+	// Walking through memory.
+	EXPECT_FALSE(IsIdleLoop({Lwzu(4, 3, 4), Cmpwi(4, 0), Bc(true, LOOP + 8, LOOP)}));
+	// The branch tests the compare from the previous iteration.
+	EXPECT_FALSE(IsIdleLoop({Lwz(4, 3, 0), Mcrf(1, 0), Cmpwi(4, 0), Bc(true, LOOP + 12, LOOP, 1)}));
+	// Writing memory.
+	EXPECT_FALSE(IsIdleLoop({Stw(5, 3, 4), Lwz(4, 3, 0), Cmpwi(4, 0), Bc(true, LOOP + 12, LOOP)}));
+	// Branching somewhere else.
+	EXPECT_FALSE(IsIdleLoop({Lwz(4, 3, 0), Cmpwi(4, 0), Bc(true, LOOP + 8, LOOP + 4)}));
+}
+
+TEST_F(IdleLoopTest, JitSkipsToNextEvent)
+{
+	WriteCode({Lwz(4, 3, 0), Cmpwi(4, 0), Bc(true, LOOP + 8, LOOP)});
+	PowerPC::ppcState.gpr[3] = FLAG;
+	Memory::Write_U32(0, FLAG);
+	Run();
+
+	EXPECT_EQ(LOOP, PowerPC::ppcState.pc);
+	const auto& stats = PowerPC::GetIdleLoopStats();
+	ASSERT_EQ(1u, stats.count(LOOP));
+	EXPECT_EQ(1u, stats.at(LOOP).hits);
+	EXPECT_GT(stats.at(LOOP).cycles_skipped, 0u);
+
+	// Once the flag is set, the loop falls through.
+	Memory::Write_U32(0x1234, FLAG);
+	Run();
+	EXPECT_EQ(0x1234u, PowerPC::ppcState.gpr[4]);
+	EXPECT_EQ(1u, stats.at(LOOP).hits);
+}
+
+#endif
@@ -0,0 +1,335 @@
+// Copyright 2015 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "Common/CommonTypes.h"
+#include "Core/ConfigManager.h"
+#include "Core/HW/Memmap.h"
+#include "Core/PowerPC/JitInterface.h"
+#include "Core/PowerPC/PowerPC.h"
+#include "Core/PowerPC/PPCAnalyst.h"
+#include "Core/PowerPC/Interpreter/Interpreter.h"
+
+#include "PowerPCTestUtil.h"
+
+#if _M_X86_64
+
+// Runs short integer sequences through Jit64 and through the interpreter and
+// checks that GPRs, CR and XER agree. The sequences overwrite CR fields, CA
+// and GPRs before anything reads them, so Jit64 drops the dead computations;
+// everything is live again when the block ends.
+
+enum
+{
+	XO_ADDC = 10,
+	XO_ADDE = 138,
+	XO_ADD = 266,
+	XO_SUBF = 40,
+	XO_OR = 444,
+	XO_MFSPR = 339,
+	XO_LSWI = 597,
+};
+
+// XO-form arithmetic; also X-form ops with the D field in bits 6-10.
+static u32 IntOp(u32 xo, u32 d, u32 a, u32 b, bool rc = false, bool oe = false)
+{
+	return (31 << 26) | (d << 21) | (a << 16) | (b << 11) | ((u32)oe << 10) | (xo << 1) | (u32)rc;
+}
+
+static u32 Or(u32 a, u32 s, u32 b, bool rc = false)
+{
+	return IntOp(XO_OR, s, a, b, rc);
+}
+
+static u32 Cmpw(u32 crf, u32 a, u32 b)
+{
+	return (31 << 26) | (crf << 23) | (a << 16) | (b << 11);
+}
+
+static u32 PsMrRc(u32 d, u32 b)
+{
+	return (4 << 26) | (d << 21) | (b << 11) | (72 << 1) | 1;
+}
+
+static u32 Mfxer(u32 d)
+{
+	return IntOp(XO_MFSPR, d, SPR_XER, 0);
+}
+
+class IntegerJitTest : public PowerPCTest
+{
+protected:
+	void SetUp() override
+	{
+		PowerPCTest::SetUp();
+		SConfig::GetInstance().m_LocalCoreStartupParameter.bJITIntegerOff = false;
+		InitCore(PowerPC::CORE_JIT64);
+	}
+
+	void WriteCode(const std::vector<u32>& code)
+	{
+		::WriteCode(code);
+		// Leave the block, then spin in a block of its own until the timeslice
+		// runs out, so the code under test runs exactly once.
+		u32 address = CODE + (u32)code.size() * 4;
+		Memory::Write_U32(0x48000004, address); // b +4
+		Memory::Write_U32(0x48000000, address + 4); // b .
+		m_num_instructions = (u32)code.size();
+	}
+
+	struct State
+	{
+		u32 gpr[32];
+		u32 cr;
+		u32 xer;
+	};
+
+	static State RandomState(u32 seed)
+	{
+		std::mt19937 rng(seed);
+		State state;
+		for (u32& reg : state.gpr)
+		{
+			// Mostly large values so that adds carry and overflow.
+			reg = rng();
+			if (rng() % 4 == 0)
+				reg = rng() % 16;
+		}
+		state.cr = rng();
+		// Only CA: the interpreter doesn't implement OE.
+		state.xer = rng() & 0x20000000;
+		return state;
+	}
+
+	void ResetCPU(const State& state)
+	{
+		memcpy(PowerPC::ppcState.gpr, state.gpr, sizeof(state.gpr));
+		SetCR(state.cr);
+		UReg_XER xer(state.xer);
+		SetXER(xer);
+		StartAt(CODE);
+	}
+
+	static State CurrentState()
+	{
+		State state;
+		memcpy(state.gpr, PowerPC::ppcState.gpr, sizeof(state.gpr));
+		// Jit64's CR format sets SO along with LT for negative results.
+		state.cr = GetCR() & 0xEEEEEEEE;
+		state.xer = GetXER().Hex;
+		return state;
+	}
+
+	void Check(const std::vector<u32>& code)
+	{
+		WriteCode(code);
+
+		for (u32 seed = 0; seed < 50; seed++)
+		{
+			State initial = RandomState(seed);
+
+			ResetCPU(initial);
+			for (u32 i = 0; i < m_num_instructions; i++)
+				Interpreter::getInstance()->SingleStepInner();
+			State expected = CurrentState();
+
+			ResetCPU(initial);
+			JitInterface::ClearCache();
+			PowerPC::SingleStep();
+			State actual = CurrentState();
+
+			for (int i = 0; i < 32; i++)
+				EXPECT_EQ(expected.gpr[i], actual.gpr[i]) << "r" << i << " (seed " << seed << ")";
+			EXPECT_EQ(expected.cr, actual.cr) << "CR (seed " << seed << ")";
+			EXPECT_EQ(expected.xer, actual.xer) << "XER (seed " << seed << ")";
+		}
+	}
+
+	u32 m_num_instructions;
+};
+
+TEST_F(IntegerJitTest, DeadCRFields)
+{
+	Check({
+		Cmpw(2, 3, 4),
+		IntOp(XO_ADD, 5, 3, 4, true),
+		Cmpw(2, 5, 6),
+		IntOp(XO_ADD, 6, 6, 7, true),
+		Cmpw(3, 3, 5),
+		Mcrf(4, 3),
+		Cmpw(3, 6, 4),
+	});
+}
+
+TEST_F(IntegerJitTest, DeadCarry)
+{
+	Check({
+		IntOp(XO_ADDC, 5, 3, 4),
+		IntOp(XO_ADDC, 6, 4, 3),
+		IntOp(XO_ADDE, 7, 5, 6),
+		IntOp(XO_ADDC, 8, 7, 3),
+		IntOp(XO_ADDC, 9, 8, 8),
+	});
+}
+
+TEST_F(IntegerJitTest, DeadRegisters)
+{
+	Check({
+		IntOp(XO_ADD, 5, 3, 4),
+		Or(6, 5, 5),
+		IntOp(XO_ADD, 5, 6, 7),
+		Addi(6, 0, 12),
+		IntOp(XO_ADDC, 9, 3, 4),
+		IntOp(XO_ADD, 9, 9, 6),
+	});
+}
+
+TEST_F(IntegerJitTest, KnownAddresses)
+{
+	Check({
+		Addis(3, 0, 0x8000),
+		Ori(3, 3, 0x4000),
+		// ps_mr. still falls back to the interpreter, so the register cache
+		// flushes and forgets r3.
+		PsMrRc(1, 1),
+		LoadStore(36, 5, 3, 0x10),
+		LoadStore(32, 6, 3, 0x10),
+		LoadStore(37, 4, 3, 0x20),
+		LoadStore(34, 7, 3, -0x10),
+		Rlwinm(8, 3, 16, 16, 31),
+		IntOp(XO_ADD, 9, 8, 4),
+		IntOp(XO_ADD, 10, 8, 8),
+		LoadStore(33, 11, 3, -0x20),
+	});
+}
+
+TEST_F(IntegerJitTest, KnownValueOverwrittenByStringLoad)
+{
+	Check({
+		Addi(3, 0, 0x4000),
+		Addi(5, 0, 0x5000),
+		LoadStore(36, 3, 3, 4),
+		// Loads r4 and r5, though the opcode table only lists r4.
+		IntOp(XO_LSWI, 4, 3, 8),
+		IntOp(XO_ADD, 7, 5, 5),
+		LoadStore(32, 8, 5, 0),
+	});
+}
+
+TEST_F(IntegerJitTest, AnalyzerFindsDeadCode)
+{
+	WriteCode({
+		Cmpw(2, 3, 4),
+		IntOp(XO_ADD, 5, 3, 4),
+		IntOp(XO_ADDC, 6, 3, 4),
+		IntOp(XO_ADD, 5, 3, 7),
+		Cmpw(2, 5, 4),
+		IntOp(XO_ADDE, 6, 5, 5),
+	});
+
+	PPCAnalyst::PPCAnalyzer analyzer;
+	analyzer.SetOption(PPCAnalyst::PPCAnalyzer::OPTION_DEAD_CODE_ELIM);
+	PPCAnalyst::CodeBlock code_block;
+	PPCAnalyst::CodeBuffer code_buffer(32);
+	PPCAnalyst::BlockStats st;
+	PPCAnalyst::BlockRegStats gpa, fpa;
+	code_block.m_stats = &st;
+	code_block.m_gpa = &gpa;
+	code_block.m_fpa = &fpa;
+	PowerPC::ppcState.msr = 0;
+	analyzer.Analyze(CODE, &code_block, &code_buffer, 32);
+
+	const PPCAnalyst::CodeOp* ops = code_buffer.codebuffer;
+	ASSERT_EQ(7u, code_block.m_num_instructions);
+	// cr2 is overwritten by the second compare before anything reads it.
+	EXPECT_FALSE(ops[0].crfWanted[2]);
+	EXPECT_TRUE(ops[4].crfWanted[2]);
+	// r5 is overwritten without being read.
+	EXPECT_TRUE(ops[1].skip);
+	// r6 is overwritten too, but adde reads the carry.
+	EXPECT_FALSE(ops[2].skip);
+	EXPECT_TRUE(ops[2].wantsCA);
+	EXPECT_FALSE(ops[3].skip);
+	EXPECT_EQ(1u, code_block.m_num_dead_instructions);
+}
+
+TEST_F(IntegerJitTest, AnalyzerFindsDeadOverflow)
+{
+	WriteCode({
+		IntOp(XO_ADD, 5, 3, 4, false, true),
+		IntOp(XO_SUBF, 6, 3, 4, false, true),
+		Mfxer(7),
+		IntOp(XO_ADD, 8, 4, 4, false, true),
+	});
+
+	PPCAnalyst::PPCAnalyzer analyzer;
+	analyzer.SetOption(PPCAnalyst::PPCAnalyzer::OPTION_DEAD_CODE_ELIM);
+	PPCAnalyst::CodeBlock code_block;
+	PPCAnalyst::CodeBuffer code_buffer(32);
+	PPCAnalyst::BlockStats st;
+	PPCAnalyst::BlockRegStats gpa, fpa;
+	code_block.m_stats = &st;
+	code_block.m_gpa = &gpa;
+	code_block.m_fpa = &fpa;
+	PowerPC::ppcState.msr = 0;
+	analyzer.Analyze(CODE, &code_block, &code_buffer, 32);
+
+	const PPCAnalyst::CodeOp* ops = code_buffer.codebuffer;
+	ASSERT_EQ(5u, code_block.m_num_instructions);
+	// subfo overwrites OV before mfxer reads it.
+	EXPECT_FALSE(ops[0].wantsOV);
+	EXPECT_TRUE(ops[1].wantsOV);
+	// The block's exit might read it.
+	EXPECT_TRUE(ops[3].wantsOV);
+	// Instructions that set OV are never skipped, since SO is sticky.
+	EXPECT_EQ(0u, code_block.m_num_dead_instructions);
+}
+
+TEST_F(IntegerJitTest, AnalyzerPropagatesConstants)
+{
+	WriteCode({
+		Addis(3, 0, 0x8000),
+		Ori(3, 3, 0x4000),
+		LoadStore(37, 4, 3, 0x20),
+		LoadStore(32, 5, 3, 0),
+		Rlwinm(6, 5, 16, 16, 31),
+		IntOp(XO_ADD, 7, 3, 3),
+	});
+
+	PPCAnalyst::PPCAnalyzer analyzer;
+	analyzer.SetOption(PPCAnalyst::PPCAnalyzer::OPTION_CONSTANT_PROPAGATION);
+	PPCAnalyst::CodeBlock code_block;
+	PPCAnalyst::CodeBuffer code_buffer(32);
+	PPCAnalyst::BlockStats st;
+	PPCAnalyst::BlockRegStats gpa, fpa;
+	code_block.m_stats = &st;
+	code_block.m_gpa = &gpa;
+	code_block.m_fpa = &fpa;
+	PowerPC::ppcState.msr = 0;
+	analyzer.Analyze(CODE, &code_block, &code_buffer, 32);
+
+	const PPCAnalyst::CodeOp* ops = code_buffer.codebuffer;
+	ASSERT_EQ(7u, code_block.m_num_instructions);
+	EXPECT_TRUE(ops[0].knownOut);
+	EXPECT_EQ(0x80000000u, ops[0].valueOut);
+	EXPECT_TRUE(ops[1].knownOut);
+	EXPECT_EQ(0x80004000u, ops[1].valueOut);
+	// stwu updates r3 to the effective address.
+	EXPECT_TRUE(ops[2].knownA);
+	EXPECT_EQ(0x80004000u, ops[2].valueA);
+	EXPECT_TRUE(ops[3].knownA);
+	EXPECT_EQ(0x80004020u, ops[3].valueA);
+	// The loaded value isn't known.
+	EXPECT_FALSE(ops[3].knownOut);
+	EXPECT_FALSE(ops[4].knownOut);
+	EXPECT_TRUE(ops[5].knownOut);
+	EXPECT_EQ(0x00008040u, ops[5].valueOut);
+}
+
+#endif
@@ -0,0 +1,129 @@
+// Copyright 2015 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "Common/CommonTypes.h"
+#include "Core/ConfigManager.h"
+#include "Core/HW/Memmap.h"
+#include "Core/PowerPC/JitInterface.h"
+#include "Core/PowerPC/PowerPC.h"
+#include "Core/PowerPC/Interpreter/Interpreter.h"
+#include "Core/PowerPC/Interpreter/Interpreter_BlockCache.h"
+
+#include "PowerPCTestUtil.h"
+
+class InterpreterBlockCacheTest : public PowerPCTest
+{
+protected:
+	void SetUp() override
+	{
+		PowerPCTest::SetUp();
+		SConfig::GetInstance().m_LocalCoreStartupParameter.bInterpreterBlockCache = true;
+		InitCore(PowerPC::CORE_INTERPRETER);
+		Interpreter::getInstance()->ClearCache();
+
+		Memory::Write_U32(Branch(HALT, HALT), HALT);
+	}
+
+	void TearDown() override
+	{
+		Interpreter::getInstance()->ClearCache();
+		PowerPCTest::TearDown();
+	}
+
+	// Runs from CODE until it reaches HALT; returns the cycles taken.
+	u64 Run()
+	{
+		PowerPC::ppcState.msr = 0x2000; // FP available, translation off
+		PowerPC::ppcState.pc = CODE;
+		PowerPC::ppcState.npc = CODE;
+		u64 cycles = 0;
+		while (PowerPC::ppcState.pc != HALT)
+			cycles += Interpreter::getInstance()->RunBlock();
+		return cycles;
+	}
+};
+
+TEST_F(InterpreterBlockCacheTest, MatchesUncachedInterpreter)
+{
+	SCoreStartupParameter& param = SConfig::GetInstance().m_LocalCoreStartupParameter;
+
+	param.bInterpreterBlockCache = false;
+	WriteChecksumLoop(1000);
+	u64 uncached_cycles = Run();
+	u32 uncached_r5 = PowerPC::ppcState.gpr[5];
+	u32 uncached_data = Memory::Read_U32(DATA + 4);
+	EXPECT_EQ(1000u, PowerPC::ppcState.gpr[7]);
+	EXPECT_EQ(0u, Interpreter::GetBlockCache().GetBlockCount());
+
+	param.bInterpreterBlockCache = true;
+	WriteChecksumLoop(1000);
+	EXPECT_EQ(uncached_cycles, Run());
+	EXPECT_EQ(uncached_r5, PowerPC::ppcState.gpr[5]);
+	EXPECT_EQ(uncached_data, Memory::Read_U32(DATA + 4));
+	EXPECT_EQ(1000u, PowerPC::ppcState.gpr[7]);
+	EXPECT_EQ(3u, Interpreter::GetBlockCache().GetBlockCount());
+}
+
+TEST_F(InterpreterBlockCacheTest, InvalidatedLikeTheJit)
+{
+	WriteCode({ Addi(3, 0, 1), Branch(CODE + 4, HALT) });
+	Run();
+	EXPECT_EQ(1u, PowerPC::ppcState.gpr[3]);
+
+	// Like the JIT, the interpreter doesn't notice code changing until the
+	// icache is invalidated.
+	Memory::Write_U32(Addi(3, 0, 2), CODE);
+	Run();
+	EXPECT_EQ(1u, PowerPC::ppcState.gpr[3]);
+
+	JitInterface::InvalidateICache(CODE, 32, false);
+	EXPECT_EQ(0u, Interpreter::GetBlockCache().GetBlockCount());
+	Run();
+	EXPECT_EQ(2u, PowerPC::ppcState.gpr[3]);
+}
+
+TEST_F(InterpreterBlockCacheTest, CodeModifiedByTheRunningBlock)
+{
+	// Overwrite an instruction further down the same block, flush it with
+	// dcbst, then run it.
+	WriteCode({
+		Lwz(5, 6, 0),
+		Stw(5, 7, 0x14),
+		XForm(54, 0, 7, 9), // dcbst r7, r9
+		Addi(4, 4, 1),
+		Addi(4, 4, 1),
+		Addi(3, 0, 1),
+		Branch(CODE + 0x18, HALT),
+	});
+	Memory::Write_U32(Addi(3, 0, 2), DATA);
+	PowerPC::ppcState.gpr[6] = DATA;
+	PowerPC::ppcState.gpr[7] = CODE;
+	PowerPC::ppcState.gpr[9] = 0x14;
+	Run();
+	EXPECT_EQ(2u, PowerPC::ppcState.gpr[3]);
+}
+
+TEST_F(InterpreterBlockCacheTest, Throughput)
+{
+	SCoreStartupParameter& param = SConfig::GetInstance().m_LocalCoreStartupParameter;
+	const u32 iterations = 1000000;
+	const double instructions = iterations * 7.0;
+
+	for (bool cached : {false, true})
+	{
+		param.bInterpreterBlockCache = cached;
+		WriteChecksumLoop(iterations);
+		auto start = std::chrono::steady_clock::now();
+		Run();
+		double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		EXPECT_EQ(iterations, PowerPC::ppcState.gpr[7]);
+		printf("%-8s %6.1f MIPS\n", cached ? "cached" : "uncached", instructions / seconds / 1e6);
+	}
+}
@@ -0,0 +1,181 @@
+// Copyright 2015 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <map>
+#include <random>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "Core/PowerPC/JitCommon/JitBlockIndex.h"
+
+static std::vector<int> Values(const JitBlockIndex& index, u32 key)
+{
+	std::vector<int> values;
+	index.ForEach(key, [&](int v) { values.push_back(v); });
+	std::sort(values.begin(), values.end());
+	return values;
+}
+
+TEST(JitBlockIndex, InsertAndLookup)
+{
+	JitBlockIndex index;
+	index.Insert(0x80003100, 1);
+	index.Insert(0x80003100, 2);
+	index.Insert(0x80003104, 3);
+
+	EXPECT_EQ(std::vector<int>({1, 2}), Values(index, 0x80003100));
+	EXPECT_EQ(std::vector<int>({3}), Values(index, 0x80003104));
+	EXPECT_TRUE(Values(index, 0x80003108).empty());
+	EXPECT_EQ(3u, index.Size());
+}
+
+TEST(JitBlockIndex, Erase)
+{
+	JitBlockIndex index;
+	index.Insert(10, 1);
+	index.Insert(10, 2);
+	index.Insert(10, 3);
+
+	index.Erase(10, 2);
+	EXPECT_EQ(std::vector<int>({1, 3}), Values(index, 10));
+
+	// Erasing something that isn't there is a no-op.
+	index.Erase(10, 2);
+	index.Erase(11, 1);
+	EXPECT_EQ(2u, index.Size());
+
+	index.EraseKey(10);
+	EXPECT_TRUE(Values(index, 10).empty());
+	EXPECT_EQ(0u, index.Size());
+
+	// A dead key can be reused.
+	index.Insert(10, 4);
+	EXPECT_EQ(std::vector<int>({4}), Values(index, 10));
+}
+
+TEST(JitBlockIndex, Clear)
+{
+	JitBlockIndex index;
+	for (int i = 0; i < 100; i++)
+		index.Insert(i, i);
+	index.Clear();
+	EXPECT_EQ(0u, index.Size());
+	for (int i = 0; i < 100; i++)
+		EXPECT_TRUE(Values(index, i).empty());
+}
+
+TEST(JitBlockIndex, MatchesMultimap)
+{
+	// Random operations, including enough inserts to force several rehashes,
+	// checked against std::multimap.
+	std::mt19937 rng(1234);
+	JitBlockIndex index(16);
+	std::multimap<u32, int> reference;
+
+	for (int i = 0; i < 100000; i++)
+	{
+		u32 key = 0x80000000 + (rng() % 4096) * 4;
+		int value = rng() % 64;
+		switch (rng() % 4)
+		{
+		case 0:
+		case 1:
+			if (!index.Contains(key, value))
+			{
+				index.Insert(key, value);
+				reference.emplace(key, value);
+			}
+			break;
+		case 2:
+		{
+			index.Erase(key, value);
+			auto range = reference.equal_range(key);
+			for (auto it = range.first; it != range.second; ++it)
+			{
+				if (it->second == value)
+				{
+					reference.erase(it);
+					break;
+				}
+			}
+			break;
+		}
+		case 3:
+			if (rng() % 8 == 0)
+			{
+				index.EraseKey(key);
+				reference.erase(key);
+			}
+			break;
+		}
+	}
+
+	EXPECT_EQ(reference.size(), index.Size());
+	for (u32 key = 0x80000000; key < 0x80000000 + 4096 * 4; key += 4)
+	{
+		std::vector<int> expected;
+		auto range = reference.equal_range(key);
+		for (auto it = range.first; it != range.second; ++it)
+			expected.push_back(it->second);
+		std::sort(expected.begin(), expected.end());
+		EXPECT_EQ(expected, Values(index, key));
+	}
+}
+
+// Microbenchmark of the block cache's invalidation pattern: register blocks
+// over 32-byte lines, then repeatedly invalidate single lines and recompile.
+// Run with --gtest_also_run_disabled_tests.
+TEST(JitBlockIndex, DISABLED_Benchmark)
+{
+	const int NUM_BLOCKS = 20000;
+	const int ROUNDS = 2000000;
+	std::mt19937 rng(42);
+	std::vector<u32> lines(NUM_BLOCKS);
+	for (u32& line : lines)
+		line = rng() % (0x01800000 / 32);
+
+	using Clock = std::chrono::steady_clock;
+
+	auto start = Clock::now();
+	{
+		std::map<std::pair<u32, u32>, u32> block_map;
+		for (int i = 0; i < NUM_BLOCKS; i++)
+			block_map[std::make_pair(lines[i] * 32 + 31, lines[i] * 32)] = i;
+		for (int r = 0; r < ROUNDS; r++)
+		{
+			int i = r % NUM_BLOCKS;
+			u32 addr = lines[i] * 32;
+			auto it1 = block_map.lower_bound(std::make_pair(addr, 0u)), it2 = it1;
+			while (it2 != block_map.end() && it2->first.second < addr + 32)
+				++it2;
+			block_map.erase(it1, it2);
+			block_map[std::make_pair(addr + 31, addr)] = i;
+		}
+	}
+	double map_ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+
+	start = Clock::now();
+	{
+		JitBlockIndex block_map;
+		for (int i = 0; i < NUM_BLOCKS; i++)
+			block_map.Insert(lines[i], i);
+		std::vector<int> found;
+		for (int r = 0; r < ROUNDS; r++)
+		{
+			int i = r % NUM_BLOCKS;
+			found.clear();
+			block_map.ForEach(lines[i], [&](int v) { found.push_back(v); });
+			for (int v : found)
+				block_map.Erase(lines[i], v);
+			block_map.Insert(lines[i], i);
+		}
+	}
+	double index_ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+
+	printf("std::map: %.1f ms, JitBlockIndex: %.1f ms (%.2fx)\n", map_ms, index_ms, map_ms / index_ms);
+}
@@ -0,0 +1,142 @@
+// Copyright 2015 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include "Common/CommonTypes.h"
+#include "Core/ConfigManager.h"
+#include "Core/HW/Memmap.h"
+#include "Core/PowerPC/PowerPC.h"
+#include "Core/PowerPC/Jit64/Jit.h"
+
+// include order is important
+#include <gtest/gtest.h> // NOLINT
+
+#include "PowerPCTestUtil.h"
+
+#if _M_X86_64
+
+// A hot block that branches to a cold one, which ends in an idle loop.
+static const u32 HOT_BLOCK = 0x00003000;
+static const u32 COLD_BLOCK = 0x00003100;
+static const u32 LOOP = 0x00003200;
+
+class JitCodeGCTest : public PowerPCTest
+{
+protected:
+	void SetUp() override
+	{
+		PowerPCTest::SetUp();
+		SCoreStartupParameter& param = SConfig::GetInstance().m_LocalCoreStartupParameter;
+		param.bFastmem = true;
+		param.bJITCodeGC = true;
+		InitCore(PowerPC::CORE_JIT64);
+
+		Memory::Write_U32(Addi(3, 3, 1), HOT_BLOCK);
+		Memory::Write_U32(Branch(HOT_BLOCK + 4, COLD_BLOCK), HOT_BLOCK + 4);
+		Memory::Write_U32(Addi(4, 4, 1), COLD_BLOCK);
+		Memory::Write_U32(Branch(COLD_BLOCK + 4, LOOP), COLD_BLOCK + 4);
+		Memory::Write_U32(Branch(LOOP, LOOP), LOOP);
+
+		m_jit = static_cast<Jit64*>(jit);
+	}
+
+	// Uses up every chunk. The first time, that clears the cache and blocks
+	// start counting their runs.
+	void FillCodeSpace()
+	{
+		for (int i = 0; i < CODE_CHUNKS; i++)
+			m_jit->SwitchCodeChunk();
+		EXPECT_EQ(0, m_jit->GetCodeChunk());
+	}
+
+	void RunHotBlock()
+	{
+		PowerPC::ppcState.gpr[3] = 0;
+		PowerPC::ppcState.gpr[4] = 0;
+		StartAt(HOT_BLOCK);
+		PowerPC::SingleStep();
+		EXPECT_EQ(1u, PowerPC::ppcState.gpr[3]);
+		EXPECT_EQ(1u, PowerPC::ppcState.gpr[4]);
+	}
+
+	JitBlock* GetBlock(u32 address)
+	{
+		int block = m_jit->GetBlockCache()->GetBlockNumberFromStartAddress(address);
+		return block < 0 ? nullptr : m_jit->GetBlockCache()->GetBlock(block);
+	}
+
+	Jit64* m_jit;
+};
+
+TEST_F(JitCodeGCTest, CountsRunsOnceFull)
+{
+	// Until the code space fills up nothing is evicted, so blocks don't
+	// count their runs.
+	RunHotBlock();
+	EXPECT_EQ(0u, GetBlock(HOT_BLOCK)->runCount);
+
+	FillCodeSpace();
+	EXPECT_EQ(nullptr, GetBlock(HOT_BLOCK));
+	EXPECT_EQ(0u, m_jit->GetBlockCache()->GetEvictionStats().evictions);
+	RunHotBlock();
+	EXPECT_EQ(1u, GetBlock(HOT_BLOCK)->runCount);
+}
+
+TEST_F(JitCodeGCTest, EvictsColdestChunk)
+{
+	FillCodeSpace();
+	m_jit->Jit(HOT_BLOCK);
+	EXPECT_EQ(0, m_jit->GetCodeChunk());
+	m_jit->SwitchCodeChunk();
+	m_jit->Jit(COLD_BLOCK);
+	m_jit->Jit(LOOP);
+	for (int i = 2; i < CODE_CHUNKS; i++)
+		m_jit->SwitchCodeChunk();
+	EXPECT_EQ(CODE_CHUNKS - 1, m_jit->GetCodeChunk());
+	EXPECT_EQ(0u, m_jit->GetBlockCache()->GetEvictionStats().evictions);
+
+	// As if the hot block had been running since the last switch. The chunk
+	// with the cold blocks is the least recently filled of the idle ones.
+	GetBlock(HOT_BLOCK)->runCount += 100;
+	m_jit->SwitchCodeChunk();
+	EXPECT_EQ(1, m_jit->GetCodeChunk());
+	const JitEvictionStats& stats = m_jit->GetBlockCache()->GetEvictionStats();
+	EXPECT_EQ(1u, stats.evictions);
+	EXPECT_EQ(2u, stats.blocks_evicted);
+	EXPECT_NE(nullptr, GetBlock(HOT_BLOCK));
+	EXPECT_EQ(nullptr, GetBlock(COLD_BLOCK));
+	EXPECT_EQ(nullptr, GetBlock(LOOP));
+
+	// The hot block was linked to the cold one; it now exits to the
+	// dispatcher, which compiles the cold blocks again.
+	RunHotBlock();
+	EXPECT_EQ(101u, GetBlock(HOT_BLOCK)->runCount);
+	ASSERT_NE(nullptr, GetBlock(COLD_BLOCK));
+	EXPECT_EQ(1u, GetBlock(COLD_BLOCK)->runCount);
+	EXPECT_EQ(2u, stats.recompiles);
+}
+
+TEST_F(JitCodeGCTest, InvalidatedBlocksKeepChunkWarm)
+{
+	FillCodeSpace();
+	m_jit->Jit(HOT_BLOCK);
+	m_jit->Jit(LOOP);
+	m_jit->SwitchCodeChunk();
+	m_jit->Jit(COLD_BLOCK);
+	for (int i = 2; i < CODE_CHUNKS - 1; i++)
+		m_jit->SwitchCodeChunk();
+	GetBlock(HOT_BLOCK)->runCount += 100;
+	GetBlock(LOOP)->runCount += 100;
+	m_jit->SwitchCodeChunk();
+
+	// The hot block's runs are gone from the count once it is invalidated,
+	// but the chunk's other block kept running.
+	m_jit->GetBlockCache()->InvalidateICache(HOT_BLOCK, 4, true);
+	GetBlock(LOOP)->runCount += 10;
+	m_jit->SwitchCodeChunk();
+	EXPECT_EQ(1, m_jit->GetCodeChunk());
+	EXPECT_NE(nullptr, GetBlock(LOOP));
+	EXPECT_EQ(nullptr, GetBlock(COLD_BLOCK));
+}
+
+#endif
@@ -0,0 +1,126 @@
+// Copyright 2015 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "Common/CommonTypes.h"
+#include "Core/ConfigManager.h"
+#include "Core/HW/GPFifo.h"
+#include "Core/HW/Memmap.h"
+#include "Core/PowerPC/PowerPC.h"
+#include "Core/PowerPC/Interpreter/Interpreter.h"
+#include "Core/PowerPC/JitCommon/JitLockstep.h"
+
+#include "PowerPCTestUtil.h"
+
+#if _M_X86_64
+
+class JitLockstepTest : public PowerPCTest
+{
+protected:
+	void SetUp() override
+	{
+		PowerPCTest::SetUp();
+		SConfig::GetInstance().m_LocalCoreStartupParameter.bJITLockstep = true;
+		InitCore(PowerPC::CORE_JIT64);
+
+		Memory::Write_U32(Branch(HALT, HALT), HALT);
+	}
+
+	void TearDown() override
+	{
+		GPFifo::ResetGatherPipe();
+		PowerPCTest::TearDown();
+	}
+
+	void Start()
+	{
+		PowerPC::ppcState.msr = 0x2000; // FP available, translation off
+		PowerPC::ppcState.pc = CODE;
+		PowerPC::ppcState.npc = CODE;
+		PowerPC::ppcState.downcount = 1000000;
+	}
+
+	// Steps from CODE until it reaches HALT; returns how many steps disagreed.
+	int Run()
+	{
+		Start();
+		int divergences = 0;
+		while (PowerPC::ppcState.pc != HALT)
+			divergences += !JitLockstep::Step();
+		return divergences;
+	}
+};
+
+TEST_F(JitLockstepTest, AgreesOnCleanCode)
+{
+	WriteChecksumLoop(100);
+	Start();
+	while (PowerPC::ppcState.pc != HALT)
+		Interpreter::getInstance()->SingleStepInner();
+	u32 r5 = PowerPC::ppcState.gpr[5];
+	u32 data = Memory::Read_U32(DATA + 4);
+
+	WriteChecksumLoop(100);
+	EXPECT_EQ(0, Run());
+	EXPECT_EQ(r5, PowerPC::ppcState.gpr[5]);
+	EXPECT_EQ(data, Memory::Read_U32(DATA + 4));
+	EXPECT_EQ(100u, PowerPC::ppcState.gpr[7]);
+	EXPECT_TRUE(JitLockstep::GetDivergences().empty());
+	EXPECT_EQ(100u, JitLockstep::GetStats().blocks_compared);
+	EXPECT_EQ(0u, JitLockstep::GetStats().blocks_skipped);
+}
+
+TEST_F(JitLockstepTest, SkipsBlocksThatTouchHardware)
+{
+	// A gather pipe write can't be taken back.
+	WriteCode({
+		Addis(3, 0, 0x0C00),
+		Ori(3, 3, 0x8000),
+		Stw(4, 3, 0),
+		Addi(5, 0, 7),
+		Branch(CODE + 16, HALT),
+	});
+	EXPECT_EQ(0, Run());
+	EXPECT_EQ(7u, PowerPC::ppcState.gpr[5]);
+	EXPECT_EQ(4u, GPFifo::m_gatherPipeCount);
+	EXPECT_EQ(0u, JitLockstep::GetStats().blocks_compared);
+	EXPECT_EQ(1u, JitLockstep::GetStats().blocks_skipped);
+}
+
+TEST_F(JitLockstepTest, ReportsFirstDivergentInstruction)
+{
+	// The block overwrites one of its own instructions. The interpreter runs
+	// the new one; the JIT already compiled the old one.
+	WriteCode({
+		Lwz(5, 6, 0),
+		Stw(5, 7, 12),
+		Addi(4, 4, 1),
+		Addi(3, 0, 1),
+		Branch(CODE + 16, HALT),
+	});
+	Memory::Write_U32(Addi(3, 0, 2), DATA);
+	PowerPC::ppcState.gpr[6] = DATA;
+	PowerPC::ppcState.gpr[7] = CODE;
+	EXPECT_EQ(1, Run());
+
+	// The guest carries on from the interpreter's result.
+	EXPECT_EQ(2u, PowerPC::ppcState.gpr[3]);
+	EXPECT_EQ(1u, PowerPC::ppcState.gpr[4]);
+	EXPECT_EQ(Addi(3, 0, 2), Memory::Read_U32(CODE + 12));
+
+	const std::vector<JitLockstep::Divergence>& divergences = JitLockstep::GetDivergences();
+	ASSERT_EQ(1u, divergences.size());
+	EXPECT_EQ(CODE, divergences[0].block_address);
+	EXPECT_EQ(CODE + 12, divergences[0].address);
+	EXPECT_NE(std::string::npos, divergences[0].disassembly.find("r3"));
+	ASSERT_EQ(1u, divergences[0].differences.size());
+	EXPECT_EQ("r3: 00000002, 00000001", divergences[0].differences[0]);
+	EXPECT_EQ(1u, JitLockstep::GetStats().divergences);
+}
+
+#endif
@@ -0,0 +1,123 @@
+// Copyright 2015 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <gtest/gtest.h>
+
+// Jit.h pulls in the x64Emitter, whose TEST method conflicts with gtest's
+// macro. Only TEST_F is used here.
+#undef TEST
+
+#include "Common/CommonTypes.h"
+#include "Core/HW/Memmap.h"
+#include "Core/PowerPC/PowerPC.h"
+#include "Core/PowerPC/Profiler.h"
+#include "Core/PowerPC/Interpreter/Interpreter.h"
+#include "Core/PowerPC/Jit64/Jit.h"
+
+#include "PowerPCTestUtil.h"
+
+#if _M_X86_64
+
+// The first block loads two registers and, if the first is nonzero, branches
+// to the second, which subtracts them straight away. The rest of the first
+// block uses both as well, so they are still in host registers at the exit.
+// Once the blocks are linked, the second one takes them from there.
+
+static const u32 SECOND = CODE + 0x100;
+
+class JitRegEntryTest : public PowerPCTest
+{
+protected:
+	void SetUp() override
+	{
+		PowerPCTest::SetUp();
+		// Register entries only count the loads they skip while blocks are profiled.
+		Profiler::g_ProfileBlocks = true;
+		InitCore(PowerPC::CORE_JIT64);
+
+		WriteCode({
+			Addi(3, 0, DATA),
+			Lwz(4, 3, 0),
+			Lwz(6, 3, 8),
+			Cmpwi(4, 0),
+			Bc(false, CODE + 16, SECOND),
+			XForm(266, 5, 4, 6), // add r5, r4, r6
+			Stw(5, 3, 4),
+			Branch(CODE + 28, HALT),
+		});
+		WriteCode({
+			XForm(40, 5, 4, 6), // subf r5, r4, r6
+			Stw(5, 3, 4),
+			Branch(SECOND + 8, HALT),
+		}, SECOND);
+		Memory::Write_U32(Branch(HALT, HALT), HALT);
+	}
+
+	void TearDown() override
+	{
+		Profiler::g_ProfileBlocks = false;
+		PowerPCTest::TearDown();
+	}
+
+	static Jit64* GetJit()
+	{
+		return static_cast<Jit64*>(jit);
+	}
+
+	static void WriteData(u32 a, u32 b)
+	{
+		Memory::Write_U32(a, DATA);
+		Memory::Write_U32(0, DATA + 4);
+		Memory::Write_U32(b, DATA + 8);
+	}
+
+	static u32 Interpret()
+	{
+		StartAt(CODE);
+		while (PowerPC::ppcState.pc != HALT)
+			Interpreter::getInstance()->SingleStepInner();
+		return Memory::Read_U32(DATA + 4);
+	}
+
+	static u32 RunJit()
+	{
+		StartAt(CODE);
+		PowerPC::SingleStep();
+		EXPECT_EQ(HALT, PowerPC::ppcState.pc);
+		return Memory::Read_U32(DATA + 4);
+	}
+};
+
+TEST_F(JitRegEntryTest, LinkedBlocksPassRegisters)
+{
+	WriteData(100, 20);
+	u32 expected = Interpret();
+	EXPECT_EQ((u32)-80, expected);
+	WriteData(100, 20);
+	EXPECT_EQ(expected, RunJit());
+
+	// The first run compiled the second block from the first one's exit hint,
+	// then linked that exit to its register entry.
+	JitBlockCache* blocks = GetJit()->GetBlockCache();
+	int block_num = blocks->GetBlockNumberFromStartAddress(SECOND);
+	ASSERT_GE(block_num, 0);
+	const JitBlock* b = blocks->GetBlock(block_num);
+	ASSERT_NE(nullptr, b->regEntry);
+	EXPECT_GE(b->entryRegs.gpr[4], 0);
+	EXPECT_GE(b->entryRegs.gpr[6], 0);
+	EXPECT_EQ(2, b->entryRegs.Count());
+	EXPECT_EQ(1u, blocks->GetRegEntryLinks());
+	EXPECT_EQ(0u, GetJit()->GetRegEntryLoadsAvoided());
+
+	// The second block was entered through normalEntry then; now it is
+	// reached through the link and skips both loads.
+	WriteData(-7, 3000);
+	expected = Interpret();
+	EXPECT_EQ(3007u, expected);
+	WriteData(-7, 3000);
+	EXPECT_EQ(expected, RunJit());
+	EXPECT_EQ(2u, GetJit()->GetRegEntryLoadsAvoided());
+}
+
+#endif
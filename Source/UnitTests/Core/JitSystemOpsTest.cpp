@@ -0,0 +1,277 @@
+// Copyright 2015 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <cstring>
+#include <functional>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "Common/CommonTypes.h"
+#include "Core/ConfigManager.h"
+#include "Core/HW/Memmap.h"
+#include "Core/PowerPC/JitInterface.h"
+#include "Core/PowerPC/PowerPC.h"
+#include "Core/PowerPC/PPCTables.h"
+#include "Core/PowerPC/Profiler.h"
+#include "Core/PowerPC/Interpreter/Interpreter.h"
+
+#include "PowerPCTestUtil.h"
+
+#if _M_X86_64
+
+// Runs the system, cache, string and FPSCR instructions Jit64 used to hand to
+// the interpreter through both cores, checks that they leave the same state,
+// and that Jit64 compiled every one of them itself.
+
+static const u32 DATA_SIZE = 0x100;
+
+static u32 FpOp(u32 xo, u32 d, u32 a, u32 b)
+{
+	return (63 << 26) | (d << 21) | (a << 16) | (b << 11) | (xo << 1);
+}
+
+static u32 Mcrfs(u32 crfd, u32 crfs)
+{
+	return (63 << 26) | (crfd << 23) | (crfs << 18) | (64 << 1);
+}
+
+static u32 Mtfsfi(u32 crfd, u32 imm)
+{
+	return (63 << 26) | (crfd << 23) | (imm << 12) | (134 << 1);
+}
+
+static u32 Mtfsf(u32 fm, u32 b)
+{
+	return (63 << 26) | (fm << 17) | (b << 11) | (711 << 1);
+}
+
+static u32 DcbzL(u32 a, u32 b)
+{
+	return (4 << 26) | (a << 16) | (b << 11) | (1014 << 1);
+}
+
+class JitSystemOpsTest : public PowerPCTest
+{
+protected:
+	void SetUp() override
+	{
+		PowerPCTest::SetUp();
+		SConfig::GetInstance().m_LocalCoreStartupParameter.bFPRF = true;
+		InitCore(PowerPC::CORE_JIT64);
+		Profiler::ResetExecutionStats();
+	}
+
+	void TearDown() override
+	{
+		Profiler::g_ExecutionStats = false;
+		PowerPC::ppcState.fpscr = 0;
+		PowerPC::RoundingModeUpdated();
+		PowerPCTest::TearDown();
+	}
+
+	struct State
+	{
+		u32 gpr[32];
+		u32 cr;
+		u32 xer;
+		u32 fpscr;
+		u64 ps[32][2];
+		u32 sr[16];
+		bool reserve;
+		u32 reserve_address;
+		u8 data[DATA_SIZE];
+	};
+
+	static State CurrentState()
+	{
+		State state;
+		memcpy(state.gpr, PowerPC::ppcState.gpr, sizeof(state.gpr));
+		state.cr = GetCR();
+		state.xer = GetXER().Hex;
+		state.fpscr = PowerPC::ppcState.fpscr;
+		memcpy(state.ps, PowerPC::ppcState.ps, sizeof(state.ps));
+		memcpy(state.sr, PowerPC::ppcState.sr, sizeof(state.sr));
+		state.reserve = PowerPC::ppcState.reserve;
+		state.reserve_address = PowerPC::ppcState.reserve_address;
+		Memory::CopyFromEmu(state.data, DATA, DATA_SIZE);
+		return state;
+	}
+
+	// Writes the code, followed by a branch to HALT, and runs it from the
+	// state init sets up in each core.
+	void Check(const std::vector<u32>& code, const std::function<void()>& init)
+	{
+		WriteCode(code);
+		u32 end = CODE + (u32)code.size() * 4;
+		Memory::Write_U32(Branch(end, HALT), end);
+		Memory::Write_U32(Branch(HALT, HALT), HALT);
+
+		Reset(init);
+		while (PowerPC::ppcState.pc != HALT)
+			Interpreter::getInstance()->SingleStepInner();
+		State expected = CurrentState();
+
+		Reset(init);
+		Profiler::g_ExecutionStats = true;
+		PowerPC::SingleStep();
+		Profiler::g_ExecutionStats = false;
+		ASSERT_EQ(HALT, PowerPC::ppcState.pc);
+		State actual = CurrentState();
+
+		for (int i = 0; i < 32; i++)
+			EXPECT_EQ(expected.gpr[i], actual.gpr[i]) << "r" << i;
+		EXPECT_EQ(expected.cr, actual.cr);
+		EXPECT_EQ(expected.xer, actual.xer);
+		EXPECT_EQ(expected.fpscr, actual.fpscr);
+		for (int i = 0; i < 32; i++)
+		{
+			EXPECT_EQ(expected.ps[i][0], actual.ps[i][0]) << "f" << i;
+			EXPECT_EQ(expected.ps[i][1], actual.ps[i][1]) << "f" << i;
+		}
+		for (int i = 0; i < 16; i++)
+			EXPECT_EQ(expected.sr[i], actual.sr[i]) << "sr" << i;
+		EXPECT_EQ(expected.reserve, actual.reserve);
+		EXPECT_EQ(expected.reserve_address, actual.reserve_address);
+		for (u32 i = 0; i < DATA_SIZE; i++)
+			EXPECT_EQ(expected.data[i], actual.data[i]) << "DATA+" << i;
+
+		for (u32 inst : code)
+		{
+			const GekkoOPInfo* info = GetOpInfo(UGeckoInstruction(inst));
+			EXPECT_NE(0u, info->runCount) << info->opname;
+			EXPECT_EQ(0u, info->fallbackCount) << info->opname;
+		}
+	}
+
+	void Reset(const std::function<void()>& init)
+	{
+		Profiler::ResetExecutionStats();
+		JitInterface::ClearCache();
+		memset(PowerPC::ppcState.gpr, 0, sizeof(PowerPC::ppcState.gpr));
+		memset(PowerPC::ppcState.ps, 0, sizeof(PowerPC::ppcState.ps));
+		memset(PowerPC::ppcState.sr, 0, sizeof(PowerPC::ppcState.sr));
+		SetCR(0);
+		SetXER(UReg_XER(0));
+		PowerPC::ppcState.fpscr = 0;
+		PowerPC::RoundingModeUpdated();
+		PowerPC::ppcState.reserve = false;
+		PowerPC::ppcState.Exceptions = 0;
+		PowerPC::ppcState.msr = 0x2000; // FP available, translation off
+		PowerPC::ppcState.pc = CODE;
+		PowerPC::ppcState.npc = CODE;
+		for (u32 i = 0; i < DATA_SIZE; i++)
+			Memory::Write_U8((u8)(i * 37 + 1), DATA + i);
+		init();
+	}
+};
+
+TEST_F(JitSystemOpsTest, Reservation)
+{
+	Check({
+		XForm(20, 4, 0, 3),          // lwarx r4, 0, r3
+		Addi(4, 4, 1),
+		XForm(150, 4, 0, 3, true),   // stwcx. r4, 0, r3
+		XForm(19, 5, 0, 0),          // mfcr r5
+		XForm(150, 4, 0, 3, true),   // stwcx. r4, 0, r3
+		XForm(19, 6, 0, 0),          // mfcr r6
+		XForm(20, 7, 3, 8),          // lwarx r7, r3, r8
+		XForm(150, 7, 0, 3, true),   // stwcx. r7, 0, r3
+		XForm(19, 9, 0, 0),          // mfcr r9
+	}, [] {
+		PowerPC::ppcState.gpr[3] = DATA;
+		PowerPC::ppcState.gpr[8] = 8;
+		PowerPC::ppcState.xer_so_ov = 2;
+	});
+	// The first store is made; the others find no reservation or the
+	// wrong address.
+	EXPECT_EQ(0x30000000u, PowerPC::ppcState.gpr[5]);
+	EXPECT_EQ(0x10000000u, PowerPC::ppcState.gpr[6]);
+	EXPECT_EQ(0x10000000u, PowerPC::ppcState.gpr[9]);
+	EXPECT_TRUE(PowerPC::ppcState.reserve);
+}
+
+TEST_F(JitSystemOpsTest, StringLoadsAndStores)
+{
+	Check({
+		XForm(597, 5, 3, 11),   // lswi r5, r3, 11
+		XForm(725, 5, 4, 11),   // stswi r5, r4, 11
+		XForm(597, 24, 3, 0),   // lswi r24, r3, 32
+		XForm(597, 30, 3, 10),  // lswi r30, r3, 10, wrapping to r0
+		XForm(725, 30, 4, 9),   // stswi r30, r4, 9
+		XForm(533, 20, 3, 9),   // lswx r20, r3, r9
+		XForm(661, 20, 4, 10),  // stswx r20, r4, r10
+	}, [] {
+		PowerPC::ppcState.gpr[3] = DATA + 1;
+		PowerPC::ppcState.gpr[4] = DATA + 0x80;
+		PowerPC::ppcState.gpr[9] = 0x21;
+		PowerPC::ppcState.gpr[10] = 0x42;
+		PowerPC::ppcState.xer_stringctrl = 7;
+	});
+}
+
+TEST_F(JitSystemOpsTest, SegmentRegisters)
+{
+	Check({
+		XForm(210, 3, 5, 0),    // mtsr 5, r3
+		XForm(595, 6, 5, 0),    // mfsr r6, 5
+		XForm(242, 4, 0, 7),    // mtsrin r4, r7
+		XForm(659, 8, 0, 7),    // mfsrin r8, r7
+		XForm(659, 7, 0, 7),    // mfsrin r7, r7
+	}, [] {
+		PowerPC::ppcState.gpr[3] = 0x12345678;
+		PowerPC::ppcState.gpr[4] = 0x9abcdef0;
+		PowerPC::ppcState.gpr[7] = 0x7fffffff;
+	});
+	EXPECT_EQ(0x9abcdef0u, PowerPC::ppcState.sr[7]);
+}
+
+TEST_F(JitSystemOpsTest, FloatingPointStatus)
+{
+	Check({
+		Mtfsfi(7, 1),           // round toward zero
+		FpOp(38, 3, 0, 0),      // mtfsb1 3 (OX, which sets FX)
+		FpOp(38, 8, 0, 0),      // mtfsb1 8 (VXISI)
+		FpOp(70, 29, 0, 0),     // mtfsb0 29 (NI)
+		FpOp(583, 1, 0, 0),     // mffs f1
+		Mcrfs(2, 0),
+		Mcrfs(3, 2),
+		Mtfsf(0xc0, 2),
+		FpOp(22, 3, 0, 4),      // fsqrt f3, f4
+		FpOp(583, 5, 0, 0),     // mffs f5
+		Mtfsfi(7, 0),
+	}, [] {
+		PowerPC::ppcState.ps[1][1] = 0x1111111111111111;
+		PowerPC::ppcState.ps[2][0] = 0x8123456760000000;
+		PowerPC::ppcState.ps[4][0] = 0x4000000000000000; // 2.0
+		PowerPC::ppcState.ps[5][1] = 0x5555555555555555;
+	});
+	EXPECT_EQ(0x1111111111111111u, PowerPC::ppcState.ps[1][1]);
+}
+
+TEST_F(JitSystemOpsTest, CacheAndTLB)
+{
+	Check({
+		XForm(54, 0, 0, 3),     // dcbst 0, r3
+		XForm(86, 0, 3, 4),     // dcbf r3, r4
+		XForm(470, 0, 0, 3),    // dcbi 0, r3
+		DcbzL(3, 4),
+		XForm(306, 0, 0, 3),    // tlbie r3
+		XForm(310, 5, 0, 3),    // eciwx r5, 0, r3
+		XForm(438, 5, 3, 4),    // ecowx r5, r3, r4
+		XForm(982, 0, 0, 6),    // icbi 0, r6
+		Addi(7, 0, 1),
+		(19 << 26) | (18 << 1), // rfid
+		Addi(8, 0, 2),
+	}, [] {
+		PowerPC::ppcState.gpr[3] = DATA + 4;
+		PowerPC::ppcState.gpr[4] = 0x40;
+		PowerPC::ppcState.gpr[6] = CODE;
+		PowerPC::ppcState.spr[SPR_EAR] = 0x80000000;
+	});
+	EXPECT_EQ(0u, Memory::Read_U32(DATA + 0x40));
+	EXPECT_EQ(2u, PowerPC::ppcState.gpr[8]);
+}
+
+#endif
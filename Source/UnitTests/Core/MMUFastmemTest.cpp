@@ -0,0 +1,149 @@
+// Copyright 2015 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "Common/CommonTypes.h"
+#include "Core/ConfigManager.h"
+#include "Core/MemTools.h"
+#include "Core/HW/Memmap.h"
+#include "Core/PowerPC/JitInterface.h"
+#include "Core/PowerPC/PowerPC.h"
+
+#include "PowerPCTestUtil.h"
+
+#if _M_X86_64 && !defined(_WIN32)
+
+// Runs loads and stores through Jit64 with data translation on, to a page
+// that is only mapped by the guest page table. The first access faults, the
+// page gets mirrored into the logical view and the access is retried.
+
+static const u32 PAGE_TABLE = 0x00100000;
+static const u32 VSID = 0x123;
+static const u32 LOGICAL_PAGE = 0x70004000;
+static const u32 PHYSICAL_PAGE = 0x00005000;
+
+class MMUFastmemTest : public PowerPCTest
+{
+protected:
+	void SetUp() override
+	{
+		PowerPCTest::SetUp();
+		SCoreStartupParameter& param = SConfig::GetInstance().m_LocalCoreStartupParameter;
+		param.bMMU = true;
+		param.bMMUFastmem = true;
+		param.bFastmem = true;
+		InitCore(PowerPC::CORE_JIT64);
+		EMM::InstallExceptionHandler();
+
+		// A 64KB page table with a single entry, for LOGICAL_PAGE in segment 7.
+		PowerPC::ppcState.spr[SPR_SDR] = PAGE_TABLE;
+		PowerPC::SDRUpdated();
+		PowerPC::ppcState.sr[7] = VSID;
+		u32 page_index = (LOGICAL_PAGE >> 12) & 0xffff;
+		u32 api = (LOGICAL_PAGE >> 22) & 0x3f;
+		m_pte = PAGE_TABLE | (((VSID ^ page_index) & 0x3ff) << 6);
+		Memory::Write_U32(0x80000000 | (VSID << 7) | api, m_pte);
+		Memory::Write_U32(PHYSICAL_PAGE | 2, m_pte + 4);
+	}
+
+	void TearDown() override
+	{
+		EMM::UninstallExceptionHandler();
+		PowerPCTest::TearDown();
+	}
+
+	void Run(const std::vector<u32>& code)
+	{
+		WriteCode(code);
+		u32 address = CODE + (u32)code.size() * 4;
+		Memory::Write_U32(0x48000004, address); // b +4
+		Memory::Write_U32(0x48000000, address + 4); // b .
+
+		StartAt(CODE);
+		PowerPC::ppcState.msr = 0x2010; // FP available, data translation on
+		JitInterface::ClearCache();
+		PowerPC::SingleStep();
+	}
+
+	u32 m_pte;
+};
+
+TEST_F(MMUFastmemTest, MapsPagesOnFault)
+{
+	Memory::Write_U32(0x12345678, PHYSICAL_PAGE + 0x10);
+	PowerPC::ppcState.gpr[3] = LOGICAL_PAGE;
+	PowerPC::ppcState.gpr[5] = 0xCAFEF00D;
+	Run({
+		LoadStore(32, 4, 3, 0x10), // lwz r4, 0x10(r3)
+		LoadStore(36, 5, 3, 0x20), // stw r5, 0x20(r3)
+		LoadStore(32, 6, 3, 0x20), // lwz r6, 0x20(r3)
+	});
+
+	EXPECT_EQ(0x12345678u, PowerPC::ppcState.gpr[4]);
+	EXPECT_EQ(0xCAFEF00Du, Memory::Read_U32(PHYSICAL_PAGE + 0x20));
+	EXPECT_EQ(0xCAFEF00Du, PowerPC::ppcState.gpr[6]);
+	// Referenced and changed.
+	EXPECT_EQ(0x180u, Memory::Read_U32(m_pte + 4) & 0x180);
+
+	// The page is now in the logical view, backed by the same memory.
+	Memory::Write_U32(0xDEADBEEF, PHYSICAL_PAGE + 0x30);
+	EXPECT_EQ(0xEFBEADDEu, *(u32*)(Memory::logical_base + LOGICAL_PAGE + 0x30));
+}
+
+TEST_F(MMUFastmemTest, ReadOnlyUntilWritten)
+{
+	PowerPC::ppcState.gpr[3] = LOGICAL_PAGE;
+	PowerPC::ppcState.gpr[5] = 0xCAFEF00D;
+	Run({
+		LoadStore(32, 4, 3, 0x10), // lwz r4, 0x10(r3)
+	});
+	EXPECT_EQ(0x100u, Memory::Read_U32(m_pte + 4) & 0x180);
+
+	Run({
+		LoadStore(36, 5, 3, 0x20), // stw r5, 0x20(r3)
+	});
+	EXPECT_EQ(0x180u, Memory::Read_U32(m_pte + 4) & 0x180);
+	EXPECT_EQ(0xCAFEF00Du, Memory::Read_U32(PHYSICAL_PAGE + 0x20));
+}
+
+TEST_F(MMUFastmemTest, RemapsAfterTLBInvalidate)
+{
+	PowerPC::ppcState.gpr[3] = LOGICAL_PAGE;
+	Run({
+		LoadStore(32, 4, 3, 0x10), // lwz r4, 0x10(r3)
+	});
+
+	// Point the page somewhere else, as an OS would, then tlbie it.
+	Memory::Write_U32(0x11111111, PHYSICAL_PAGE + 0x1010);
+	Memory::Write_U32((PHYSICAL_PAGE + 0x1000) | 2, m_pte + 4);
+	PowerPC::InvalidateTLBEntry(LOGICAL_PAGE);
+
+	Run({
+		LoadStore(32, 4, 3, 0x10), // lwz r4, 0x10(r3)
+	});
+	EXPECT_EQ(0x11111111u, PowerPC::ppcState.gpr[4]);
+}
+
+TEST_F(MMUFastmemTest, UnmapsWholeCongruenceClass)
+{
+	PowerPC::ppcState.gpr[3] = LOGICAL_PAGE;
+	Run({
+		LoadStore(32, 4, 3, 0x10), // lwz r4, 0x10(r3)
+	});
+
+	// tlbie of another page in the same class drops LOGICAL_PAGE's entry too.
+	Memory::Write_U32(0x11111111, PHYSICAL_PAGE + 0x1010);
+	Memory::Write_U32((PHYSICAL_PAGE + 0x1000) | 2, m_pte + 4);
+	PowerPC::InvalidateTLBEntry(LOGICAL_PAGE + 0x40000);
+
+	Run({
+		LoadStore(32, 4, 3, 0x10), // lwz r4, 0x10(r3)
+	});
+	EXPECT_EQ(0x11111111u, PowerPC::ppcState.gpr[4]);
+}
+
+#endif
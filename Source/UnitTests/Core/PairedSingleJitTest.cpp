@@ -0,0 +1,269 @@
+// Copyright 2015 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "Common/CommonTypes.h"
+#include "Common/CPUDetect.h"
+#include "Core/ConfigManager.h"
+#include "Core/HW/Memmap.h"
+#include "Core/PowerPC/JitInterface.h"
+#include "Core/PowerPC/PowerPC.h"
+#include "Core/PowerPC/PPCAnalyst.h"
+#include "Core/PowerPC/Interpreter/Interpreter.h"
+
+#include "PowerPCTestUtil.h"
+
+#if _M_X86_64
+
+// Runs short paired-single sequences through Jit64 and through the interpreter
+// and checks that both produce bit-identical registers. The sequences cover the
+// multiplier reuse the analyzer sets up for adjacent ps_muls*/ps_madd* with the
+// same FC, and the cases it has to leave alone.
+
+enum
+{
+	PS_MULS0 = 12,
+	PS_MULS1 = 13,
+	PS_MADDS0 = 14,
+	PS_MADDS1 = 15,
+	PS_MSUB = 28,
+	PS_MADD = 29,
+	PS_NMSUB = 30,
+	PS_NMADD = 31,
+};
+
+static u32 PairedOp(u32 xo, u32 d, u32 a, u32 c, u32 b = 0)
+{
+	return (4 << 26) | (d << 21) | (a << 16) | (b << 11) | (c << 6) | (xo << 1);
+}
+
+// fmadd and friends; opcd 59 for the single precision forms, 63 for double.
+static u32 ScalarOp(u32 opcd, u32 xo, u32 d, u32 a, u32 c, u32 b)
+{
+	return (opcd << 26) | (d << 21) | (a << 16) | (b << 11) | (c << 6) | (xo << 1);
+}
+
+static u64 Bits(double value)
+{
+	u64 bits;
+	memcpy(&bits, &value, sizeof(bits));
+	return bits;
+}
+
+class PairedSingleJitTest : public PowerPCTest
+{
+protected:
+	void SetUp() override
+	{
+		PowerPCTest::SetUp();
+		SCoreStartupParameter& param = SConfig::GetInstance().m_LocalCoreStartupParameter;
+		param.bFPRF = false;
+		param.bJITPairedOff = false;
+
+		// Fused multiply-adds round once; the interpreter rounds twice.
+		m_host_fma = cpu_info.bFMA;
+		m_host_avx = cpu_info.bAVX;
+		cpu_info.bFMA = false;
+
+		InitCore(PowerPC::CORE_JIT64);
+	}
+
+	void TearDown() override
+	{
+		PowerPCTest::TearDown();
+		cpu_info.bFMA = m_host_fma;
+		cpu_info.bAVX = m_host_avx;
+	}
+
+	void WriteCode(const std::vector<u32>& code)
+	{
+		::WriteCode(code);
+		// Leave the block, then spin in a block of its own until the timeslice
+		// runs out, so the code under test runs exactly once.
+		u32 address = CODE + (u32)code.size() * 4;
+		Memory::Write_U32(0x48000004, address); // b +4
+		Memory::Write_U32(0x48000000, address + 4); // b .
+		m_num_instructions = (u32)code.size();
+	}
+
+	void RandomizeRegisters(u32 seed)
+	{
+		std::mt19937 rng(seed);
+		std::uniform_real_distribution<double> dist(-100.0, 100.0);
+		for (int i = 0; i < 32; i++)
+		{
+			// f5-f9 hold multipliers with more precision than a single, to
+			// exercise the 25-bit rounding of FC; everything else is a single.
+			bool full_precision = i >= 5 && i <= 9;
+			for (int j = 0; j < 2; j++)
+			{
+				double value = dist(rng);
+				PowerPC::ppcState.ps[i][j] = Bits(full_precision ? value : (double)(float)value);
+			}
+		}
+	}
+
+	void ResetCPU(const u64 (&ps)[32][2])
+	{
+		memcpy(PowerPC::ppcState.ps, ps, sizeof(ps));
+		StartAt(CODE);
+	}
+
+	void RunInterpreter()
+	{
+		for (u32 i = 0; i < m_num_instructions; i++)
+			Interpreter::getInstance()->SingleStepInner();
+	}
+
+	void RunJit()
+	{
+		JitInterface::ClearCache();
+		PowerPC::SingleStep();
+	}
+
+	// Runs the code with random inputs through both cores, once with the host's
+	// instruction set and once without AVX.
+	void Check(const std::vector<u32>& code)
+	{
+		WriteCode(code);
+
+		std::vector<bool> avx_settings = {false};
+		if (m_host_avx)
+			avx_settings.push_back(true);
+
+		for (bool avx : avx_settings)
+		{
+			cpu_info.bAVX = avx;
+			for (u32 seed = 0; seed < 50; seed++)
+			{
+				u64 initial[32][2], expected[32][2];
+				RandomizeRegisters(seed);
+				memcpy(initial, PowerPC::ppcState.ps, sizeof(initial));
+
+				ResetCPU(initial);
+				RunInterpreter();
+				memcpy(expected, PowerPC::ppcState.ps, sizeof(expected));
+
+				ResetCPU(initial);
+				RunJit();
+
+				for (int i = 0; i < 32; i++)
+				{
+					for (int j = 0; j < 2; j++)
+					{
+						EXPECT_EQ(expected[i][j], PowerPC::ppcState.ps[i][j])
+							<< "f" << i << " ps" << j << " (seed " << seed << ", AVX " << avx << ")";
+					}
+				}
+			}
+		}
+	}
+
+	u32 m_num_instructions;
+	bool m_host_fma;
+	bool m_host_avx;
+};
+
+TEST_F(PairedSingleJitTest, SplatLow)
+{
+	Check({
+		PairedOp(PS_MULS0, 10, 1, 5),
+		PairedOp(PS_MADDS0, 11, 2, 5, 10),
+		PairedOp(PS_MADDS0, 12, 3, 5, 11),
+		PairedOp(PS_MULS0, 13, 4, 5),
+	});
+}
+
+TEST_F(PairedSingleJitTest, SplatHigh)
+{
+	Check({
+		PairedOp(PS_MULS1, 10, 1, 6),
+		PairedOp(PS_MADDS1, 11, 2, 6, 10),
+		PairedOp(PS_MULS1, 12, 3, 6),
+		PairedOp(PS_MADDS1, 13, 4, 6, 12),
+	});
+}
+
+TEST_F(PairedSingleJitTest, MaddFamily)
+{
+	Check({
+		PairedOp(PS_MADD, 10, 1, 7, 2),
+		PairedOp(PS_MSUB, 11, 2, 7, 3),
+		PairedOp(PS_NMADD, 12, 3, 7, 4),
+		PairedOp(PS_NMSUB, 13, 4, 7, 1),
+	});
+}
+
+TEST_F(PairedSingleJitTest, MixedHalves)
+{
+	Check({
+		PairedOp(PS_MULS0, 10, 1, 5),
+		PairedOp(PS_MULS1, 11, 2, 5),
+		PairedOp(PS_MADDS1, 12, 3, 5, 11),
+		PairedOp(PS_MADDS0, 13, 4, 5, 10),
+		PairedOp(PS_MADDS0, 14, 1, 6, 13),
+	});
+}
+
+TEST_F(PairedSingleJitTest, MultiplierOverwritten)
+{
+	Check({
+		PairedOp(PS_MULS0, 5, 1, 5),
+		PairedOp(PS_MADDS0, 10, 2, 5, 3),
+		PairedOp(PS_MADD, 8, 3, 8, 4),
+		PairedOp(PS_MADD, 11, 4, 8, 1),
+	});
+}
+
+TEST_F(PairedSingleJitTest, ScalarMadd)
+{
+	Check({
+		ScalarOp(63, PS_MADD, 10, 1, 2, 10),
+		ScalarOp(63, PS_MSUB, 11, 2, 7, 3),
+		ScalarOp(63, PS_NMSUB, 12, 12, 4, 12),
+		ScalarOp(59, PS_NMADD, 13, 4, 8, 13),
+		ScalarOp(59, PS_MADD, 14, 3, 2, 1),
+		ScalarOp(59, PS_NMSUB, 15, 1, 9, 4),
+	});
+}
+
+TEST_F(PairedSingleJitTest, AnalyzerMarksRuns)
+{
+	WriteCode({
+		PairedOp(PS_MULS0, 10, 1, 5),
+		PairedOp(PS_MADDS0, 11, 2, 5, 10),
+		PairedOp(PS_MADDS1, 12, 3, 5, 11),
+		PairedOp(PS_MULS0, 5, 4, 5),
+		PairedOp(PS_MULS0, 13, 1, 5),
+	});
+
+	PPCAnalyst::PPCAnalyzer analyzer;
+	analyzer.SetOption(PPCAnalyst::PPCAnalyzer::OPTION_PAIRED_FUSION);
+	PPCAnalyst::CodeBlock code_block;
+	PPCAnalyst::CodeBuffer code_buffer(32);
+	PPCAnalyst::BlockStats st;
+	PPCAnalyst::BlockRegStats gpa, fpa;
+	code_block.m_stats = &st;
+	code_block.m_gpa = &gpa;
+	code_block.m_fpa = &fpa;
+	PowerPC::ppcState.msr = 0;
+	analyzer.Analyze(CODE, &code_block, &code_buffer, 32);
+
+	const PPCAnalyst::CodeOp* ops = code_buffer.codebuffer;
+	ASSERT_EQ(6u, code_block.m_num_instructions);
+	EXPECT_TRUE(ops[0].keepSplat && !ops[0].reuseSplat);
+	EXPECT_TRUE(!ops[1].keepSplat && ops[1].reuseSplat);
+	// Different half of f5.
+	EXPECT_TRUE(!ops[2].keepSplat && !ops[2].reuseSplat);
+	// Overwrites f5, so the next one has to build its own splat.
+	EXPECT_TRUE(!ops[3].keepSplat && !ops[3].reuseSplat);
+	EXPECT_TRUE(!ops[4].keepSplat && !ops[4].reuseSplat);
+}
+
+#endif
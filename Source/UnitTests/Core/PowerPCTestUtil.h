@@ -0,0 +1,193 @@
+// Copyright 2015 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "Common/CommonTypes.h"
+#include "Core/ConfigManager.h"
+#include "Core/CoreTiming.h"
+#include "Core/HW/Memmap.h"
+#include "Core/PowerPC/PowerPC.h"
+#include "VideoCommon/VideoBackendBase.h"
+
+// Encoders and core bring-up for the tests that run guest code, with
+// translation off.
+
+static const u32 CODE = 0x00003000;
+static const u32 HALT = 0x00003f00;
+static const u32 DATA = 0x00004000;
+
+static inline u32 Addi(u32 d, u32 a, s16 simm)
+{
+	return (14 << 26) | (d << 21) | (a << 16) | (u16)simm;
+}
+
+static inline u32 Addis(u32 d, u32 a, u16 imm)
+{
+	return (15 << 26) | (d << 21) | (a << 16) | imm;
+}
+
+static inline u32 Ori(u32 a, u32 s, u16 imm)
+{
+	return (24 << 26) | (s << 21) | (a << 16) | imm;
+}
+
+static inline u32 Cmpwi(u32 a, s16 simm)
+{
+	return (11 << 26) | (a << 16) | (u16)simm;
+}
+
+static inline u32 Mcrf(u32 crfd, u32 crfs)
+{
+	return (19 << 26) | (crfd << 23) | (crfs << 18);
+}
+
+// D-form loads and stores: lwz 32, lwzu 33, lbz 34, stw 36, stwu 37.
+static inline u32 LoadStore(u32 opcd, u32 d, u32 a, s16 offset)
+{
+	return (opcd << 26) | (d << 21) | (a << 16) | (u16)offset;
+}
+
+static inline u32 Lwz(u32 d, u32 a, s16 offset)
+{
+	return LoadStore(32, d, a, offset);
+}
+
+static inline u32 Lwzu(u32 d, u32 a, s16 offset)
+{
+	return LoadStore(33, d, a, offset);
+}
+
+static inline u32 Stw(u32 s, u32 a, s16 offset)
+{
+	return LoadStore(36, s, a, offset);
+}
+
+// Opcode 31 ops, with the D (or S) field in bits 6-10.
+static inline u32 XForm(u32 xo, u32 d, u32 a, u32 b, bool rc = false)
+{
+	return (31 << 26) | (d << 21) | (a << 16) | (b << 11) | (xo << 1) | (u32)rc;
+}
+
+static inline u32 Rlwinm(u32 a, u32 s, u32 sh, u32 mb, u32 me)
+{
+	return (21 << 26) | (s << 21) | (a << 16) | (sh << 11) | (mb << 6) | (me << 1);
+}
+
+static inline u32 Bdnz(u32 from, u32 to)
+{
+	return (16 << 26) | (16 << 21) | ((to - from) & 0xfffc);
+}
+
+// beq/bne on a CR field, without touching CTR.
+static inline u32 Bc(bool if_equal, u32 from, u32 to, u32 crf = 0)
+{
+	u32 bo = if_equal ? 12 : 4;
+	return (16 << 26) | (bo << 21) | ((crf * 4 + 2) << 16) | ((to - from) & 0xfffc);
+}
+
+static inline u32 Branch(u32 from, u32 to)
+{
+	return 0x48000000 | ((to - from) & 0x03fffffc);
+}
+
+static inline void WriteCode(const std::vector<u32>& code, u32 address = CODE)
+{
+	for (u32 inst : code)
+	{
+		Memory::Write_U32(inst, address);
+		address += 4;
+	}
+}
+
+// Sums and scrambles the word at DATA count times, storing each step at
+// DATA + 4 and counting the iterations in r7, then branches to HALT. The loop
+// starts at CODE + 8, with 7 instructions per iteration.
+static inline void WriteChecksumLoop(u32 count)
+{
+	const u32 loop = CODE + 8;
+	WriteCode({
+		Addi(3, 0, DATA),
+		Addi(5, 0, 0),
+		Lwz(4, 3, 0),
+		XForm(266, 5, 5, 4), // add r5, r5, r4
+		Rlwinm(6, 5, 3, 0, 28),
+		XForm(316, 5, 5, 6), // xor r5, r5, r6
+		Stw(5, 3, 4),
+		Addi(7, 7, 1),
+		Bdnz(loop + 24, loop),
+		Branch(loop + 28, HALT),
+	});
+	Memory::Write_U32(0x12345678, DATA);
+	Memory::Write_U32(0, DATA + 4);
+	PowerPC::ppcState.gpr[7] = 0;
+	PowerPC::ppcState.spr[SPR_CTR] = count;
+}
+
+// Points the CPU at address, with FP available and translation off.
+static inline void StartAt(u32 address)
+{
+	PowerPC::ppcState.msr = 0x2000;
+	PowerPC::ppcState.pc = address;
+	PowerPC::ppcState.npc = address;
+}
+
+// Sets up a GameCube without MMU emulation, with the JIT compiling every
+// block in the foreground as soon as it runs. Fixtures adjust the settings
+// after calling SetUp, then call InitCore.
+// For tests that only need the configuration, not a running core.
+class ConfigTest : public testing::Test
+{
+protected:
+	void SetUp() override
+	{
+		SConfig::Init();
+	}
+
+	void TearDown() override
+	{
+		SConfig::Shutdown();
+	}
+};
+
+class PowerPCTest : public ConfigTest
+{
+protected:
+	void SetUp() override
+	{
+		ConfigTest::SetUp();
+		SCoreStartupParameter& param = SConfig::GetInstance().m_LocalCoreStartupParameter;
+		param.bWii = false;
+		param.bMMU = false;
+		param.bEnableDebugging = false;
+		param.bJITOff = false;
+		param.bJITNoBlockCache = false;
+		param.iJITTierThreshold = 0;
+		param.bJITBackgroundCompile = false;
+		param.bJITFollowBranch = false;
+	}
+
+	void TearDown() override
+	{
+		PowerPC::Shutdown();
+		CoreTiming::Shutdown();
+		Memory::Shutdown();
+		VideoBackend::ClearList();
+		ConfigTest::TearDown();
+	}
+
+	void InitCore(int core)
+	{
+		// Memory::Init registers the command processor's MMIO handlers.
+		VideoBackend::PopulateList();
+		VideoBackend::ActivateBackend("");
+		Memory::Init();
+		CoreTiming::Init();
+		PowerPC::Init(core);
+	}
+};
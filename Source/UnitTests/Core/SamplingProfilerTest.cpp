@@ -0,0 +1,72 @@
+// Copyright 2015 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <chrono>
+#include <string>
+
+#include "Common/CommonTypes.h"
+#include "Common/FileUtil.h"
+#include "Common/JitRegister.h"
+#include "Common/x64Emitter.h"
+#include "Core/PowerPC/Profiler.h"
+
+// include order is important
+#include <gtest/gtest.h> // NOLINT
+
+TEST(JitRegister, SymbolTable)
+{
+	static u8 code[0x100];
+	JitRegister::Init("", true);
+	JitRegister::Register(code, 0x40, "JIT_PPC_%08x", 0x80003000);
+	JitRegister::Register(code + 0x40, 0x40, "JIT_Loop");
+
+	u32 block = JitRegister::FindSymbol(code + 0x10);
+	EXPECT_EQ("JIT_PPC_80003000", JitRegister::GetSymbolName(block));
+	EXPECT_EQ("JIT_Loop", JitRegister::GetSymbolName(JitRegister::FindSymbol(code + 0x7f)));
+	EXPECT_EQ(JitRegister::NO_SYMBOL, JitRegister::FindSymbol(code + 0x80));
+
+	// New code replaces the end of the block; the old symbol keeps its name.
+	JitRegister::Register(code + 0x20, 0x10, "JIT_PPC_%08x", 0x80003100);
+	EXPECT_EQ(block, JitRegister::FindSymbol(code + 0x1f));
+	EXPECT_EQ("JIT_PPC_80003100", JitRegister::GetSymbolName(JitRegister::FindSymbol(code + 0x20)));
+	EXPECT_EQ(JitRegister::NO_SYMBOL, JitRegister::FindSymbol(code + 0x30));
+	EXPECT_EQ("JIT_PPC_80003000", JitRegister::GetSymbolName(block));
+
+	JitRegister::Shutdown();
+	EXPECT_EQ(JitRegister::NO_SYMBOL, JitRegister::FindSymbol(code + 0x10));
+}
+
+#if _M_X86_64 && !defined(_WIN32) && !defined(__APPLE__)
+
+using namespace Gen;
+
+TEST(SamplingProfiler, AttributesJitCode)
+{
+	X64CodeBlock block;
+	block.AllocCodeSpace(4096);
+	const u8* loop_start = block.GetCodePtr();
+	block.MOV(32, R(EAX), Imm32(1000000));
+	const u8* loop = block.GetCodePtr();
+	block.SUB(32, R(EAX), Imm8(1));
+	block.J_CC(CC_NZ, loop);
+	block.RET();
+
+	JitRegister::Init("", true);
+	JitRegister::Register(loop_start, block.GetCodePtr(), "JIT_PPC_%08x", 0x80003000);
+
+	std::string filename = File::GetTempFilenameForAtomicWrite("SamplingProfilerTest");
+	Profiler::StartSampling(997);
+	auto end = std::chrono::steady_clock::now() + std::chrono::milliseconds(200);
+	while (std::chrono::steady_clock::now() < end)
+		((void (*)())loop_start)();
+	Profiler::StopSampling(filename);
+	JitRegister::Shutdown();
+
+	std::string profile;
+	ASSERT_TRUE(File::ReadFileToString(filename, profile));
+	File::Delete(filename);
+	EXPECT_NE(std::string::npos, profile.find("[unknown function];JIT_PPC_80003000 "));
+}
+
+#endif
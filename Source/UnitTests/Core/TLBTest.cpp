@@ -0,0 +1,98 @@
+// Copyright 2015 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <gtest/gtest.h>
+
+#include "Common/CommonTypes.h"
+#include "Core/ConfigManager.h"
+#include "Core/HW/Memmap.h"
+#include "Core/PowerPC/PowerPC.h"
+
+#include "PowerPCTestUtil.h"
+
+// Pages in segment 7 that all land in the same data TLB set.
+static const u32 PAGE_TABLE = 0x00100000;
+static const u32 VSID = 0x123;
+static const u32 NUM_PAGES = TLB_WAYS + 1;
+static const u32 PAGE_STRIDE = DATA_TLB_SETS << HW_PAGE_INDEX_SHIFT;
+
+static u32 LogicalPage(u32 i)
+{
+	return 0x70000000 + i * PAGE_STRIDE;
+}
+
+class TLBTest : public PowerPCTest
+{
+protected:
+	void SetUp() override
+	{
+		PowerPCTest::SetUp();
+		SConfig::GetInstance().m_LocalCoreStartupParameter.bMMU = true;
+		InitCore(PowerPC::CORE_INTERPRETER);
+
+		PowerPC::ppcState.spr[SPR_SDR] = PAGE_TABLE;
+		PowerPC::SDRUpdated();
+		PowerPC::ppcState.sr[7] = VSID;
+		PowerPC::ppcState.msr = 0x10; // data translation on
+
+		for (u32 i = 0; i < NUM_PAGES; i++)
+		{
+			u32 address = LogicalPage(i);
+			u32 page_index = (address >> 12) & 0xffff;
+			u32 api = (address >> 22) & 0x3f;
+			m_pte[i] = PAGE_TABLE | (((VSID ^ page_index) & 0x3ff) << 6);
+			Memory::Write_U32(0x80000000 | (VSID << 7) | api, m_pte[i]);
+			Memory::Write_U32((0x00010000 + i * 0x1000) | 2, m_pte[i] + 4);
+			Memory::Write_U32(i, 0x00010000 + i * 0x1000);
+		}
+	}
+
+	// Reads each page in turn; returns how many of the reads missed.
+	static u64 Read(std::initializer_list<u32> pages)
+	{
+		u64 misses = PowerPC::GetTLBStats(false).misses;
+		for (u32 i : pages)
+			EXPECT_EQ(i, PowerPC::Read_U32(LogicalPage(i)));
+		return PowerPC::GetTLBStats(false).misses - misses;
+	}
+
+	u32 m_pte[NUM_PAGES];
+};
+
+TEST_F(TLBTest, SetAssociative)
+{
+	EXPECT_EQ(4u, Read({0, 1, 2, 3}));
+	EXPECT_EQ(0u, Read({0, 1, 2, 3}));
+	EXPECT_EQ(0u, PowerPC::GetTLBStats(true).misses);
+
+	// The fifth page evicts the least recently used one.
+	EXPECT_EQ(1u, Read({4}));
+	EXPECT_EQ(0u, Read({1, 2, 3, 4}));
+	EXPECT_EQ(1u, Read({0}));
+}
+
+TEST_F(TLBTest, ChangedBitWalksPageTable)
+{
+	EXPECT_EQ(1u, Read({0}));
+	PowerPC::TLBStats before = PowerPC::GetTLBStats(false);
+
+	PowerPC::Write_U32(0x12345678, LogicalPage(0));
+	PowerPC::Write_U32(0x12345678, LogicalPage(0));
+	PowerPC::TLBStats after = PowerPC::GetTLBStats(false);
+	EXPECT_EQ(before.misses, after.misses);
+	EXPECT_EQ(before.page_walks + 1, after.page_walks);
+	EXPECT_EQ(0x180u, Memory::Read_U32(m_pte[0] + 4) & 0x180);
+}
+
+TEST_F(TLBTest, InvalidateCongruenceClass)
+{
+	EXPECT_EQ(2u, Read({0, 1}));
+
+	// tlbie for any segment invalidates the whole class.
+	PowerPC::InvalidateTLBEntry(0x30000000);
+	EXPECT_EQ(2u, Read({0, 1}));
+
+	PowerPC::InvalidateTLBEntry(0x30001000);
+	EXPECT_EQ(0u, Read({0, 1}));
+}
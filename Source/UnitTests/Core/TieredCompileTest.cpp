@@ -0,0 +1,106 @@
+// Copyright 2015 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <vector>
+
+#include <gtest/gtest.h>
+
+// JitBase.h pulls in the x64Emitter, whose TEST method conflicts with gtest's
+// macro. Only TEST_F is used here.
+#undef TEST
+
+#include "Common/CommonTypes.h"
+#include "Core/ConfigManager.h"
+#include "Core/HW/Memmap.h"
+#include "Core/PowerPC/PowerPC.h"
+#include "Core/PowerPC/Interpreter/Interpreter.h"
+#include "Core/PowerPC/JitCommon/JitBase.h"
+
+#include "PowerPCTestUtil.h"
+
+#if _M_X86_64
+
+// Runs a loop with a threshold of three entries: the block before it and
+// the first entries of the loop run in the interpreter, the rest in Jit64.
+// The result has to match a run that is interpreted throughout.
+
+static const u32 THRESHOLD = 3;
+static const u32 LOOP = CODE + 8;
+
+class TieredCompileTest : public PowerPCTest
+{
+protected:
+	void SetUp() override
+	{
+		PowerPCTest::SetUp();
+		SConfig::GetInstance().m_LocalCoreStartupParameter.iJITTierThreshold = THRESHOLD;
+		InitCore(PowerPC::CORE_JIT64);
+
+		Memory::Write_U32(Branch(HALT, HALT), HALT);
+	}
+
+	static bool IsCompiled(u32 address)
+	{
+		return jit->GetBlockCache()->GetBlockNumberFromStartAddress(address) >= 0;
+	}
+};
+
+TEST_F(TieredCompileTest, CompilesAtThreshold)
+{
+	WriteChecksumLoop(10);
+	StartAt(CODE);
+	while (PowerPC::ppcState.pc != HALT)
+		Interpreter::getInstance()->SingleStepInner();
+	u32 r5 = PowerPC::ppcState.gpr[5];
+	u32 data = Memory::Read_U32(DATA + 4);
+
+	WriteChecksumLoop(10);
+	StartAt(CODE);
+	PowerPC::SingleStep();
+	EXPECT_EQ(HALT, PowerPC::ppcState.pc);
+	EXPECT_EQ(r5, PowerPC::ppcState.gpr[5]);
+	EXPECT_EQ(data, Memory::Read_U32(DATA + 4));
+	EXPECT_EQ(10u, PowerPC::ppcState.gpr[7]);
+
+	// The first block runs the first iteration and is only entered once. The
+	// loop and HALT are interpreted twice each, and compiled on the third entry.
+	EXPECT_FALSE(IsCompiled(CODE));
+	EXPECT_EQ(1u, jit->GetColdBlockCount(CODE));
+	EXPECT_TRUE(IsCompiled(LOOP));
+	EXPECT_EQ(0u, jit->GetColdBlockCount(LOOP));
+	EXPECT_TRUE(IsCompiled(HALT));
+	EXPECT_EQ(1u + 2 * (THRESHOLD - 1), jit->GetInterpretedBlocks());
+
+	// Below the threshold, the first block still runs in the interpreter.
+	WriteChecksumLoop(10);
+	StartAt(CODE);
+	PowerPC::SingleStep();
+	EXPECT_EQ(r5, PowerPC::ppcState.gpr[5]);
+	EXPECT_FALSE(IsCompiled(CODE));
+	EXPECT_EQ(2u, jit->GetColdBlockCount(CODE));
+	EXPECT_EQ(2u + 2 * (THRESHOLD - 1), jit->GetInterpretedBlocks());
+
+	// At it, the block is compiled and the cold count is gone.
+	WriteChecksumLoop(10);
+	StartAt(CODE);
+	PowerPC::SingleStep();
+	EXPECT_EQ(r5, PowerPC::ppcState.gpr[5]);
+	EXPECT_EQ(data, Memory::Read_U32(DATA + 4));
+	EXPECT_TRUE(IsCompiled(CODE));
+	EXPECT_EQ(0u, jit->GetColdBlockCount(CODE));
+	EXPECT_EQ(2u + 2 * (THRESHOLD - 1), jit->GetInterpretedBlocks());
+}
+
+TEST_F(TieredCompileTest, CompilesEverythingWhileDebugging)
+{
+	// Stepping and breakpoints need compiled blocks.
+	SConfig::GetInstance().m_LocalCoreStartupParameter.bEnableDebugging = true;
+	WriteChecksumLoop(10);
+	StartAt(CODE);
+	PowerPC::SingleStep();
+	EXPECT_TRUE(IsCompiled(CODE));
+	EXPECT_EQ(0u, jit->GetInterpretedBlocks());
+}
+
+#endif
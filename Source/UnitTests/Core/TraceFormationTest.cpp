@@ -0,0 +1,140 @@
+// Copyright 2015 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <vector>
+
+#include <gtest/gtest.h>
+
+// JitBase.h pulls in the x64Emitter, whose TEST method conflicts with gtest's
+// macro. Only TEST_F is used here.
+#undef TEST
+
+#include "Common/CommonTypes.h"
+#include "Core/ConfigManager.h"
+#include "Core/HW/Memmap.h"
+#include "Core/PowerPC/PowerPC.h"
+#include "Core/PowerPC/Interpreter/Interpreter.h"
+#include "Core/PowerPC/JitCommon/JitBase.h"
+
+#include "PowerPCTestUtil.h"
+
+#if _M_X86_64
+
+// Blocks that continue through a taken branch into code elsewhere have to
+// behave like the interpreter on both sides of it, and get invalidated
+// through either part.
+
+static const u32 FAR = CODE + 0x100;
+static const u32 NEAR = CODE + 0x10;
+
+class TraceFormationTest : public PowerPCTest
+{
+protected:
+	void SetUp() override
+	{
+		PowerPCTest::SetUp();
+		SConfig::GetInstance().m_LocalCoreStartupParameter.bJITFollowBranch = true;
+	}
+
+	// Loads the word at DATA, adds 1 to it on the FAR path or 100 on the
+	// NEAR one, and stores the result at DATA + 4.
+	static void WriteDiamond(u32 branch, u32 value)
+	{
+		WriteCode({
+			Addi(3, 0, DATA),
+			Lwz(4, 3, 0),
+			Cmpwi(4, 0),
+			branch,
+			Addi(4, 4, 100),
+			Stw(4, 3, 4),
+			Branch(NEAR + 8, HALT),
+		});
+		WriteCode({
+			Addi(4, 4, 1),
+			Stw(4, 3, 4),
+			Branch(FAR + 8, HALT),
+		}, FAR);
+		Memory::Write_U32(Branch(HALT, HALT), HALT);
+		Memory::Write_U32(value, DATA);
+		Memory::Write_U32(0xdeadbeef, DATA + 4);
+	}
+
+	static u32 Interpret()
+	{
+		StartAt(CODE);
+		while (PowerPC::ppcState.pc != HALT)
+			Interpreter::getInstance()->SingleStepInner();
+		return Memory::Read_U32(DATA + 4);
+	}
+
+	static u32 RunJit()
+	{
+		StartAt(CODE);
+		PowerPC::SingleStep();
+		EXPECT_EQ(HALT, PowerPC::ppcState.pc);
+		return Memory::Read_U32(DATA + 4);
+	}
+
+	static const JitBlock* GetBlock(u32 address)
+	{
+		int block_num = jit->GetBlockCache()->GetBlockNumberFromStartAddress(address);
+		return block_num < 0 ? nullptr : jit->GetBlockCache()->GetBlock(block_num);
+	}
+};
+
+TEST_F(TraceFormationTest, FollowsUnconditionalBranch)
+{
+	InitCore(PowerPC::CORE_JIT64);
+	WriteDiamond(Branch(CODE + 12, FAR), 5);
+	u32 expected = Interpret();
+	EXPECT_EQ(6u, expected);
+
+	WriteDiamond(Branch(CODE + 12, FAR), 5);
+	EXPECT_EQ(expected, RunJit());
+
+	const JitBlock* b = GetBlock(CODE);
+	ASSERT_NE(nullptr, b);
+	// The branch to HALT is followed as well, and ends the trace since HALT
+	// branches back into it.
+	ASSERT_EQ(3u, b->physicalRanges.size());
+	EXPECT_EQ(std::make_pair(CODE, CODE + 16), b->physicalRanges[0]);
+	EXPECT_EQ(std::make_pair(FAR, FAR + 12), b->physicalRanges[1]);
+	EXPECT_EQ(std::make_pair(HALT, HALT + 4), b->physicalRanges[2]);
+
+	// Writing to the followed-to part invalidates the whole trace.
+	jit->GetBlockCache()->InvalidateICache(FAR + 4, 4, false);
+	EXPECT_EQ(nullptr, GetBlock(CODE));
+}
+
+TEST_F(TraceFormationTest, FollowsHotConditionalBranch)
+{
+	// The interpreted entries below the threshold profile the branch.
+	SConfig::GetInstance().m_LocalCoreStartupParameter.iJITTierThreshold = 5;
+	InitCore(PowerPC::CORE_JIT64);
+
+	const u32 beq = Bc(true, CODE + 12, FAR);
+	WriteDiamond(beq, 0);
+	u32 expected = Interpret();
+	EXPECT_EQ(1u, expected);
+	for (int i = 0; i < 5; i++)
+	{
+		WriteDiamond(beq, 0);
+		EXPECT_EQ(expected, RunJit());
+	}
+
+	const JitBlock* b = GetBlock(CODE);
+	ASSERT_NE(nullptr, b);
+	ASSERT_EQ(3u, b->physicalRanges.size());
+	EXPECT_EQ(std::make_pair(FAR, FAR + 12), b->physicalRanges[1]);
+
+	// Not taken, the trace exits to the fall-through path.
+	WriteDiamond(beq, 7);
+	expected = Interpret();
+	EXPECT_EQ(107u, expected);
+	WriteDiamond(beq, 7);
+	EXPECT_EQ(expected, RunJit());
+	EXPECT_EQ(b, GetBlock(CODE));
+}
+
+#endif
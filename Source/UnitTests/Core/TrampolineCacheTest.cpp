@@ -0,0 +1,203 @@
+// Copyright 2015 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <vector>
+
+#include "Common/CommonTypes.h"
+#include "Common/x64ABI.h"
+#include "Common/x64Emitter.h"
+#include "Core/ConfigManager.h"
+#include "Core/MemTools.h"
+#include "Core/HW/Memmap.h"
+#include "Core/PowerPC/JitInterface.h"
+#include "Core/PowerPC/PowerPC.h"
+#include "Core/PowerPC/JitCommon/TrampolineCache.h"
+
+// include order is important
+#include <gtest/gtest.h> // NOLINT
+
+#include "PowerPCTestUtil.h"
+
+#if _M_X86_64
+
+using namespace Gen;
+
+class FakeBlockCode : public X64CodeBlock
+{
+public:
+	FakeBlockCode() { AllocCodeSpace(4096); }
+
+	// A 5-byte site jumping to a trampoline, like BackPatch leaves it.
+	u8* AddSite()
+	{
+		u8* site = GetWritableCodePtr();
+		for (int i = 0; i < BACKPATCH_SIZE; i++)
+			INT3();
+		return site;
+	}
+
+	static void Patch(u8* site, const u8* trampoline)
+	{
+		XEmitter emitter(site);
+		emitter.JMP(trampoline, true);
+	}
+
+	static const u8* Target(const u8* site)
+	{
+		return site + 5 + *(const s32*)(site + 1);
+	}
+};
+
+static InstructionInfo LoadInfo(s32 displacement)
+{
+	InstructionInfo info = {};
+	info.operandSize = 4;
+	info.regOperandReg = RDX;
+	info.scaledReg = RCX;
+	info.displacement = displacement;
+	return info;
+}
+
+TEST(TrampolineCache, SharesBodies)
+{
+	TrampolineCache trampolines;
+	trampolines.Init(1024 * 1024);
+	FakeBlockCode code;
+	BitSet32 registersInUse{RBX, R12};
+
+	u8* a = code.AddSite();
+	u8* b = code.AddSite();
+	u8* c = code.AddSite();
+	const u8* before_a = trampolines.GetCodePtr();
+	trampolines.GenerateReadTrampoline(LoadInfo(0x10), registersInUse, nullptr, a, a + 5);
+	const u8* after_a = trampolines.GetCodePtr();
+	trampolines.GenerateReadTrampoline(LoadInfo(0x10), registersInUse, nullptr, b, b + 5);
+	const u8* after_b = trampolines.GetCodePtr();
+	trampolines.GenerateReadTrampoline(LoadInfo(0x20), registersInUse, nullptr, c, c + 5);
+
+	EXPECT_EQ(3u, trampolines.GetNumSites());
+	EXPECT_EQ(1u, trampolines.GetNumBodiesReused());
+	// The second site only needed a stub.
+	EXPECT_LT(after_b - after_a, after_a - before_a);
+
+	trampolines.Shutdown();
+}
+
+TEST(TrampolineCache, CompactKeepsLiveSites)
+{
+	TrampolineCache trampolines;
+	trampolines.Init(1024 * 1024);
+	FakeBlockCode code;
+	BitSet32 registersInUse{RBX};
+
+	u8* live = code.AddSite();
+	u8* dead = code.AddSite();
+	u8* overwritten = code.AddSite();
+	FakeBlockCode::Patch(live, trampolines.GenerateReadTrampoline(LoadInfo(0x10), registersInUse, nullptr, live, live + 5));
+	FakeBlockCode::Patch(dead, trampolines.GenerateReadTrampoline(LoadInfo(0x20), registersInUse, nullptr, dead, dead + 5));
+	trampolines.GenerateReadTrampoline(LoadInfo(0x30), registersInUse, nullptr, overwritten, overwritten + 5);
+	size_t used = trampolines.GetCodePtr() - FakeBlockCode::Target(live);
+
+	size_t reclaimed = trampolines.Compact([&](const u8* site) { return site == dead; });
+	EXPECT_GT(reclaimed, 0u);
+	EXPECT_LT(trampolines.GetCodePtr() - FakeBlockCode::Target(live), (ptrdiff_t)used);
+	EXPECT_EQ(1u, trampolines.GetNumCompactions());
+
+	// The live site was repatched to a stub in the compacted space, the dead
+	// one was left alone.
+	EXPECT_TRUE(trampolines.IsInSpace((u8*)FakeBlockCode::Target(live)));
+	EXPECT_LT(FakeBlockCode::Target(live), trampolines.GetCodePtr());
+	EXPECT_EQ(0xCC, overwritten[0]);
+
+	// Compacting again keeps the same layout.
+	EXPECT_EQ(0u, trampolines.Compact([](const u8*) { return false; }));
+
+	trampolines.Shutdown();
+}
+
+// Jit64 with the MMU on and the page table not mirrored into fastmem: every
+// translated access gets a trampoline.
+static const u32 PAGE_TABLE = 0x00100000;
+static const u32 VSID = 0x123;
+static const u32 LOGICAL_PAGE = 0x70004000;
+static const u32 PHYSICAL_PAGE = 0x00005000;
+
+class TrampolineJitTest : public PowerPCTest
+{
+protected:
+	void SetUp() override
+	{
+		PowerPCTest::SetUp();
+		SCoreStartupParameter& param = SConfig::GetInstance().m_LocalCoreStartupParameter;
+		param.bMMU = true;
+		param.bMMUFastmem = false;
+		param.bFastmem = true;
+		InitCore(PowerPC::CORE_JIT64);
+		EMM::InstallExceptionHandler();
+
+		PowerPC::ppcState.spr[SPR_SDR] = PAGE_TABLE;
+		PowerPC::SDRUpdated();
+		PowerPC::ppcState.sr[7] = VSID;
+		u32 page_index = (LOGICAL_PAGE >> 12) & 0xffff;
+		u32 api = (LOGICAL_PAGE >> 22) & 0x3f;
+		u32 pte = PAGE_TABLE | (((VSID ^ page_index) & 0x3ff) << 6);
+		Memory::Write_U32(0x80000000 | (VSID << 7) | api, pte);
+		Memory::Write_U32(PHYSICAL_PAGE | 2, pte + 4);
+	}
+
+	void TearDown() override
+	{
+		EMM::UninstallExceptionHandler();
+		PowerPCTest::TearDown();
+	}
+
+	void Run(const std::vector<u32>& code)
+	{
+		WriteCode(code);
+		u32 address = CODE + (u32)code.size() * 4;
+		Memory::Write_U32(0x48000004, address); // b +4
+		Memory::Write_U32(0x48000000, address + 4); // b .
+
+		StartAt(CODE);
+		PowerPC::ppcState.msr = 0x2010; // FP available, data translation on
+		PowerPC::SingleStep();
+	}
+};
+
+TEST_F(TrampolineJitTest, SharedTrampolines)
+{
+	Memory::Write_U32(0x12345678, PHYSICAL_PAGE + 0x10);
+	Memory::Write_U16(0x8001, PHYSICAL_PAGE + 0x20);
+	PowerPC::ppcState.gpr[3] = LOGICAL_PAGE;
+	PowerPC::ppcState.gpr[4] = LOGICAL_PAGE + 0x10;
+	PowerPC::ppcState.gpr[9] = 0xCAFEF00D;
+	std::vector<u32> code = {
+		LoadStore(32, 5, 3, 0x10), // lwz r5, 0x10(r3)
+		LoadStore(32, 6, 4, 0),    // lwz r6, 0(r4)
+		LoadStore(42, 7, 3, 0x20), // lha r7, 0x20(r3)
+		LoadStore(40, 8, 3, 0x20), // lhz r8, 0x20(r3)
+		LoadStore(36, 9, 3, 0x30), // stw r9, 0x30(r3)
+		LoadStore(36, 9, 4, 0x24), // stw r9, 0x24(r4)
+	};
+
+	// The second run goes through the trampolines installed by the first.
+	for (int run = 0; run < 2; run++)
+	{
+		Memory::Write_U32(0, PHYSICAL_PAGE + 0x30);
+		Memory::Write_U32(0, PHYSICAL_PAGE + 0x34);
+		for (int reg = 5; reg <= 8; reg++)
+			PowerPC::ppcState.gpr[reg] = 0;
+		Run(code);
+
+		EXPECT_EQ(0x12345678u, PowerPC::ppcState.gpr[5]);
+		EXPECT_EQ(0x12345678u, PowerPC::ppcState.gpr[6]);
+		EXPECT_EQ(0xFFFF8001u, PowerPC::ppcState.gpr[7]);
+		EXPECT_EQ(0x00008001u, PowerPC::ppcState.gpr[8]);
+		EXPECT_EQ(0xCAFEF00Du, Memory::Read_U32(PHYSICAL_PAGE + 0x30));
+		EXPECT_EQ(0xCAFEF00Du, Memory::Read_U32(PHYSICAL_PAGE + 0x34));
+		EXPECT_EQ(LOGICAL_PAGE, PowerPC::ppcState.gpr[3]);
+	}
+}
+
+#endif